@@ -0,0 +1,101 @@
+#include <dynamics/Particle.hpp>
+#include <dynamics/ParticleParticleCollision.hpp>
+#include <dynamics/BruteForceBroadPhase.hpp>
+#include <dynamics/UniformGridBroadPhase.hpp>
+#include <dynamics/SweepAndPruneBroadPhase.hpp>
+
+#include <glm/gtc/random.hpp>
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Compare the broad phases of the collision detection on random particles.
+// No window is opened: run it with ./benchmark_broadphase [max particle number]
+
+typedef std::chrono::steady_clock benchmark_clock;
+
+// Fill a cube with particles, keeping the same density whatever their number
+// so that the number of contacts per particle stays the same.
+void createParticles(size_t number, std::vector<ParticlePtr>& particles,
+                     std::vector<glm::vec3>& positions, std::vector<float>& radii)
+{
+    const float radius = 0.05f, volumeFraction = 0.1f;
+    const float sphereVolume = 4.0f / 3.0f * M_PI * radius * radius * radius;
+    const float side = std::cbrt(number * sphereVolume / volumeFraction);
+
+    particles.clear();
+    positions.clear();
+    radii.clear();
+    for(size_t i=0; i<number; ++i)
+    {
+        glm::vec3 x = glm::linearRand(glm::vec3(0), glm::vec3(side));
+        particles.push_back(std::make_shared<Particle>(x, glm::vec3(0), 1.0f, radius));
+        positions.push_back(x);
+        radii.push_back(radius);
+    }
+}
+
+// Average time in milliseconds to find the colliding pairs with a broad phase.
+double benchmark(BroadPhasePtr broadPhase, int steps,
+                 const std::vector<ParticlePtr>& particles,
+                 const std::vector<glm::vec3>& positions, const std::vector<float>& radii,
+                 size_t& collisionNumber)
+{
+    std::vector<CandidatePair> pairs;
+    std::vector<unsigned char> flags(positions.size(), 0);
+    benchmark_clock::time_point start = benchmark_clock::now();
+    for(int step=0; step<steps; ++step)
+    {
+        collisionNumber = 0;
+        broadPhase->computePairs(positions, radii, flags, pairs);
+        for(const CandidatePair& pair : pairs)
+        {
+            if(testParticleParticle(particles[pair.first], particles[pair.second]))
+                ++collisionNumber;
+        }
+    }
+    std::chrono::duration<double, std::milli> elapsed = benchmark_clock::now() - start;
+    return elapsed.count() / steps;
+}
+
+int main(int argc, char** argv)
+{
+    size_t maxNumber = argc > 1 ? std::stoul(argv[1]) : 100000;
+
+    std::vector<ParticlePtr> particles;
+    std::vector<glm::vec3> positions;
+    std::vector<float> radii;
+
+    std::cout << std::setw(10) << "particles"
+              << std::setw(18) << "broad phase"
+              << std::setw(14) << "time (ms)"
+              << std::setw(14) << "collisions" << std::endl;
+
+    for(size_t number = 1000; number <= maxNumber; number *= 10)
+    {
+        createParticles(number, particles, positions, radii);
+
+        std::vector< std::pair<std::string, BroadPhasePtr> > broadPhases = {
+            { "brute force", std::make_shared<BruteForceBroadPhase>() },
+            { "uniform grid", std::make_shared<UniformGridBroadPhase>() },
+            { "sweep and prune", std::make_shared<SweepAndPruneBroadPhase>() }
+        };
+
+        for(const std::pair<std::string, BroadPhasePtr>& broadPhase : broadPhases)
+        {
+            // The quadratic broad phase is too slow to be run many times
+            int steps = (broadPhase.first == "brute force" && number > 10000) ? 1 : 10;
+            size_t collisionNumber = 0;
+            double time = benchmark(broadPhase.second, steps, particles, positions, radii, collisionNumber);
+            std::cout << std::setw(10) << number
+                      << std::setw(18) << broadPhase.first
+                      << std::setw(14) << std::fixed << std::setprecision(3) << time
+                      << std::setw(14) << collisionNumber << std::endl;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,142 @@
+#include <dynamics/DynamicSystem.hpp>
+#include <dynamics/ConstantForceField.hpp>
+#include <dynamics/EulerExplicitSolver.hpp>
+#include <dynamics/SinglePassContactSolver.hpp>
+#include <dynamics/SequentialImpulseContactSolver.hpp>
+
+#include <glm/gtc/random.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Compare the contact solvers on a pile of particles resting in a box: the
+// penetration and the residual motion of the particles once the pile should
+// be at rest, and the computation time of a step.
+// No window is opened: run it with ./benchmark_contacts [particles per side]
+// It fails as soon as a solver produces a non finite state: its measures
+// would be meaningless.
+
+typedef std::chrono::steady_clock benchmark_clock;
+
+const float radius = 0.1f;
+
+// Drop a cube of particles in a box slightly larger than the cube.
+DynamicSystemPtr createPile(int particlePerSide, ContactSolverPtr contactSolver)
+{
+    DynamicSystemPtr system = std::make_shared<DynamicSystem>();
+    system->setSolver(std::make_shared<EulerExplicitSolver>());
+    system->setContactSolver(contactSolver);
+    system->setDt(0.01);
+    system->setRestitution(0.2f);
+
+    const float spacing = 2.2f * radius, side = particlePerSide * spacing + radius;
+    system->addPlaneObstacle(std::make_shared<Plane>(glm::vec3(0,1,0), glm::vec3(0,0,0)));
+    system->addPlaneObstacle(std::make_shared<Plane>(glm::vec3(1,0,0), glm::vec3(0,0,0)));
+    system->addPlaneObstacle(std::make_shared<Plane>(glm::vec3(-1,0,0), glm::vec3(side,0,0)));
+    system->addPlaneObstacle(std::make_shared<Plane>(glm::vec3(0,0,1), glm::vec3(0,0,0)));
+    system->addPlaneObstacle(std::make_shared<Plane>(glm::vec3(0,0,-1), glm::vec3(0,0,side)));
+
+    for(int i=0; i<particlePerSide; ++i)
+    {
+        for(int j=0; j<particlePerSide; ++j)
+        {
+            for(int k=0; k<particlePerSide; ++k)
+            {
+                glm::vec3 x = glm::vec3(i+0.5f, j+1.0f, k+0.5f) * spacing
+                        + glm::linearRand(glm::vec3(-0.02f), glm::vec3(0.02f));
+                system->addParticle(std::make_shared<Particle>(x, glm::vec3(0), 1.0f, radius));
+            }
+        }
+    }
+    system->addForceField(std::make_shared<ConstantForceField>(system->getParticles(), DynamicSystem::gravity));
+    return system;
+}
+
+// Check that the positions and velocities of the particles are finite.
+bool isFinite(DynamicSystemPtr system)
+{
+    const std::vector<glm::vec3>& x = system->getStore()->getPositions();
+    const std::vector<glm::vec3>& v = system->getStore()->getVelocities();
+    for(size_t i=0; i<x.size(); ++i)
+    {
+        for(int c=0; c<3; ++c)
+        {
+            if(!std::isfinite(x[i][c]) || !std::isfinite(v[i][c]))
+                return false;
+        }
+    }
+    return true;
+}
+
+// Deepest penetration among the contacts of the last step.
+float maxPenetration(DynamicSystemPtr system)
+{
+    const std::vector<glm::vec3>& x = system->getStore()->getPositions();
+    float penetration = 0.0f;
+    for(const ParticleParticleContact& c : system->getContacts().getParticleParticleContacts())
+        penetration = std::max(penetration, 2.0f * radius - glm::distance(x[c.particle1], x[c.particle2]));
+    return penetration;
+}
+
+int main(int argc, char** argv)
+{
+    int particlePerSide = argc > 1 ? std::stoi(argv[1]) : 8;
+    const int settlingSteps = 1500, measuredSteps = 200;
+
+    std::vector< std::pair<std::string, ContactSolverPtr> > contactSolvers = {
+        { "single pass", std::make_shared<SinglePassContactSolver>() },
+        { "sequential impulse", std::make_shared<SequentialImpulseContactSolver>() }
+    };
+
+    std::cout << std::setw(20) << "contact solver"
+              << std::setw(18) << "penetration (%)"
+              << std::setw(16) << "mean speed"
+              << std::setw(16) << "step (ms)"
+              << std::setw(12) << "sleeping" << std::endl;
+
+    for(const std::pair<std::string, ContactSolverPtr>& contactSolver : contactSolvers)
+    {
+        std::srand(0);
+        DynamicSystemPtr system = createPile(particlePerSide, contactSolver.second);
+        float penetration = 0.0f;
+        double speed = 0.0;
+        benchmark_clock::time_point start;
+        for(int step=0; step<settlingSteps + measuredSteps; ++step)
+        {
+            // Measure the pile once it should be at rest
+            if(step == settlingSteps)
+                start = benchmark_clock::now();
+            system->computeSimulationStep();
+            if(!isFinite(system))
+            {
+                std::cerr << contactSolver.first << ": non finite particle state at step " << step << std::endl;
+                return EXIT_FAILURE;
+            }
+            if(step >= settlingSteps)
+            {
+                penetration = std::max(penetration, maxPenetration(system));
+                for(const glm::vec3& v : system->getStore()->getVelocities())
+                    speed += glm::length(v);
+            }
+        }
+        std::chrono::duration<double, std::milli> elapsed = benchmark_clock::now() - start;
+        speed /= measuredSteps * system->getStore()->size();
+
+        unsigned int sleeping = 0;
+        for(ParticlePtr p : system->getParticles())
+            sleeping += p->isSleeping() ? 1 : 0;
+
+        std::cout << std::setw(20) << contactSolver.first
+                  << std::setw(18) << std::fixed << std::setprecision(2) << 100.0f * penetration / (2.0f * radius)
+                  << std::setw(16) << std::setprecision(4) << speed
+                  << std::setw(16) << std::setprecision(3) << elapsed.count() / measuredSteps
+                  << std::setw(12) << sleeping
+                  << std::defaultfloat << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,118 @@
+#include <Viewer.hpp>
+#include <ShaderProgram.hpp>
+
+#include <lighting/Material.hpp>
+#include <lighting/LightedCubeRenderable.hpp>
+#include <lighting/LightedMeshRenderable.hpp>
+#include <GeometricTransformation.hpp>
+#include <Utils.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+// Compare the time to draw a frame of a street of lamps with bunnies, lit by
+// the forward shading (with the lights of the block Lights, or from clusters)
+// and by the deferred shading. A headless viewer draws the frames, no window
+// is opened: run it with ./benchmark_deferred
+//
+// The forward shading with the block Lights only shades the first 10 point
+// lights: its time is a lower bound beyond 10 lights.
+
+typedef std::chrono::steady_clock benchmark_clock;
+
+enum Shading { FORWARD, CLUSTERED, DEFERRED };
+
+static const std::string shader_directory = "../../sfmlGraphicsPipeline/shaders/";
+static const unsigned int warmup_frame_number = 5;
+static const unsigned int frame_number = 50;
+static const int bunny_side = 7;
+
+// Lamps on a square grid, bunnies in between, overlapping on screen
+void initialize_scene(Viewer& viewer, Shading shading, unsigned int lampNumber)
+{
+    viewer.getCamera().setViewMatrix( glm::lookAt( glm::vec3(0, 10, 40), glm::vec3(0, 0, 0), glm::vec3( 0, 1, 0 ) ) );
+    viewer.addDirectionalLight(std::make_shared<DirectionalLight>(glm::vec3(-1,-2,-1), glm::vec3(0.02), glm::vec3(0.05), glm::vec3(0)));
+
+    const int side = std::ceil(std::sqrt(float(lampNumber)));
+    const float spacing = 60.0f / side;
+    for(unsigned int i = 0; i < lampNumber; ++i)
+    {
+        glm::vec3 position( (i % side - 0.5f * (side - 1)) * spacing, 1.5f, (i / side - 0.5f * (side - 1)) * spacing );
+        glm::vec3 color = (i % 2) ? glm::vec3(1.0, 0.7, 0.3) : glm::vec3(0.4, 0.6, 1.0);
+        viewer.addPointLight(std::make_shared<PointLight>(position, glm::vec3(0), color, color, 1.0f, 0.35f, 0.44f));
+    }
+
+    ShaderProgram::Defines defines;
+    if( shading == FORWARD )
+        defines = viewer.getLightDefines();
+    else if( shading == CLUSTERED )
+        defines = viewer.getClusteredLightDefines();
+    else
+        defines = viewer.getDeferredShadingDefines();
+    ShaderProgramPtr phongShader = std::make_shared<ShaderProgram>(shader_directory + "phongVertex.glsl",
+                                                                   shader_directory + "phongFragment.glsl", defines);
+    viewer.addShaderProgram(phongShader);
+
+    auto mat = std::make_shared<Material>(glm::vec3(1), glm::vec3(0.8), glm::vec3(0.3), 20.0f);
+    auto ground = std::make_shared<LightedCubeRenderable>(phongShader, false, mat);
+    ground->setLocalTransform(getTranslationMatrix(0,-0.1,0) * getScaleMatrix(60, 0.2, 60));
+    viewer.addRenderable(ground);
+
+    // Large bunnies, hiding each other
+    std::string bunny_obj_path = "../../sfmlGraphicsPipeline/meshes/bunny.obj";
+    for(int row = 0; row < bunny_side; ++row)
+        for(int column = 0; column < bunny_side; ++column)
+        {
+            auto bunny = std::make_shared<LightedMeshRenderable>(phongShader, bunny_obj_path, mat);
+            bunny->setGlobalTransform(getTranslationMatrix((column - 0.5f * (bunny_side - 1)) * 7.0f, 0.6f,
+                                                           (row - 0.5f * (bunny_side - 1)) * 7.0f));
+            bunny->setLocalTransform(getScaleMatrix(5,5,5));
+            viewer.addRenderable(bunny);
+        }
+}
+
+// Time in milliseconds to draw a frame, finished by the driver.
+double benchmark(Shading shading, unsigned int lampNumber)
+{
+    Viewer viewer(1280, 720, glm::vec4(0.0, 0.0, 0.0, 1.0), true);
+    initialize_scene(viewer, shading, lampNumber);
+    viewer.setFixedFrameRate(30);
+    viewer.startAnimation();
+    for(unsigned int i = 0; i < warmup_frame_number; ++i)
+    {
+        viewer.animate();
+        viewer.draw();
+        viewer.display();
+    }
+    glFinish();
+
+    benchmark_clock::time_point start = benchmark_clock::now();
+    for(unsigned int i = 0; i < frame_number; ++i)
+    {
+        viewer.animate();
+        viewer.draw();
+        viewer.display();
+    }
+    glFinish();
+    std::chrono::duration<double, std::milli> elapsed = benchmark_clock::now() - start;
+    return elapsed.count() / frame_number;
+}
+
+int main(int argc, char** argv)
+{
+    std::cout << "1280x720, " << bunny_side * bunny_side << " bunnies, time per frame (ms)" << std::endl;
+    std::cout << std::setw(10) << "lights" << std::setw(14) << "forward" << std::setw(14) << "clustered"
+              << std::setw(14) << "deferred" << std::endl;
+    for(unsigned int lampNumber : { 8u, 64u, 256u, 1024u })
+    {
+        double forward = benchmark(FORWARD, lampNumber);
+        double clustered = benchmark(CLUSTERED, lampNumber);
+        double deferred = benchmark(DEFERRED, lampNumber);
+        std::cout << std::setw(10) << lampNumber << std::setw(14) << forward << std::setw(14) << clustered
+                  << std::setw(14) << deferred << std::endl;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,91 @@
+#include <Viewer.hpp>
+#include <ShaderProgram.hpp>
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Compare the time to build the shader programs of the scenes from their
+// sources, one after the other or all in the background, and from the program
+// binary cache. A headless viewer provides the OpenGL context, no window is
+// opened: run it with ./benchmark_shader_cache
+//
+// Some drivers keep their own cache of compiled shaders: the compilation from
+// the sources is then faster from the second run of this benchmark on.
+
+typedef std::chrono::steady_clock benchmark_clock;
+
+static const std::string shader_directory = "../../sfmlGraphicsPipeline/shaders/";
+
+// The programs built at the start of the scenes
+static const std::vector< std::pair<std::string, std::string> > programs = {
+    { "flatVertex.glsl", "flatFragment.glsl" },
+    { "defaultVertex.glsl", "defaultFragment.glsl" },
+    { "phongVertex.glsl", "phongFragment.glsl" },
+    { "textureVertex.glsl", "textureFragment.glsl" },
+    { "simpleTextureVertex.glsl", "simpleTextureFragment.glsl" },
+    { "multiTextureVertex.glsl", "multiTextureFragment.glsl" },
+    { "cubeMapVertex.glsl", "cubeMapFragment.glsl" },
+    { "envmapVertex.glsl", "envmapFragment.glsl" },
+    { "billboardVertex.glsl", "billboardFragment.glsl" },
+    { "instancedVertex.glsl", "instancedFragment.glsl" },
+    { "nonRigidVertex.glsl", "nonRigidFragment.glsl" },
+    { "cubeMapToPanoramaVertex.glsl", "cubeMapToPanoramaFragment.glsl" },
+    { "blurVertex.glsl", "blurFragment.glsl" },
+    { "panoramaToCubeMapVertex.glsl", "panoramaToCubeMapFragment.glsl" },
+};
+
+// Time in milliseconds to build all the programs, finished by the driver.
+double benchmark()
+{
+    std::vector<ShaderProgramPtr> built;
+    benchmark_clock::time_point start = benchmark_clock::now();
+    for(const std::pair<std::string, std::string>& program : programs)
+        built.push_back(std::make_shared<ShaderProgram>(shader_directory + program.first, shader_directory + program.second));
+    glFinish();
+    std::chrono::duration<double, std::milli> elapsed = benchmark_clock::now() - start;
+    return elapsed.count();
+}
+
+// Same, with all the compilations started before waiting for the first one.
+double benchmarkAsync()
+{
+    std::vector<ShaderProgramPtr> built;
+    benchmark_clock::time_point start = benchmark_clock::now();
+    for(const std::pair<std::string, std::string>& program : programs)
+        built.push_back(std::make_shared<ShaderProgram>(shader_directory + program.first, shader_directory + program.second, nullptr));
+    for(const ShaderProgramPtr& program : built)
+        program->wait();
+    glFinish();
+    std::chrono::duration<double, std::milli> elapsed = benchmark_clock::now() - start;
+    return elapsed.count();
+}
+
+int main(int argc, char** argv)
+{
+    Viewer viewer(64, 64, glm::vec4(0.0, 0.0, 0.0, 1.0), true);
+
+    // A new cache directory, so that the first start is a cold one
+    const std::string cacheDirectory = "shader_cache_benchmark_"
+        + std::to_string(benchmark_clock::now().time_since_epoch().count());
+
+    ShaderProgram::setBinaryCacheDirectory("");
+    double sources = benchmark();
+    double parallel = benchmarkAsync();
+    ShaderProgram::setBinaryCacheDirectory(cacheDirectory);
+    double cold = benchmark();
+    double warm = benchmark();
+
+    std::cout << programs.size() << " shader programs" << std::endl;
+    std::cout << std::setw(24) << "start" << std::setw(14) << "time (ms)" << std::endl;
+    std::cout << std::setw(24) << "without cache" << std::setw(14) << sources << std::endl;
+    std::cout << std::setw(24) << "in the background" << std::setw(14) << parallel << std::endl;
+    std::cout << std::setw(24) << "cold (cache filled)" << std::setw(14) << cold << std::endl;
+    std::cout << std::setw(24) << "warm (cache read)" << std::setw(14) << warm << std::endl;
+    std::cout << "The binaries are left in " << cacheDirectory << std::endl;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,135 @@
+#include <dynamics/DynamicSystem.hpp>
+#include <dynamics/ConstantForceField.hpp>
+#include <dynamics/SpringForceField.hpp>
+#include <dynamics/EulerExplicitSolver.hpp>
+#include <dynamics/VerletSolver.hpp>
+#include <dynamics/RungeKutta4Solver.hpp>
+#include <dynamics/EulerImplicitSolver.hpp>
+#include <dynamics/PositionBasedSolver.hpp>
+#include <dynamics/DistanceConstraint.hpp>
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Compare the solvers on a stiff cloth: for each solver, find the largest
+// stable time step and the computation time of one second of simulation.
+// No window is opened: run it with ./benchmark_solvers [particles per line]
+
+typedef std::chrono::steady_clock benchmark_clock;
+
+typedef std::pair<ParticlePtr, ParticlePtr> Link;
+
+// A square cloth hanging between two fixed borders, as in practical5. The
+// particles are linked by springs, or by distance constraints of the same
+// stiffness for the position based solver.
+void createCloth(DynamicSystemPtr system, int particlePerLine, bool constraints,
+                 std::vector<Link>& links)
+{
+    const float width = 4.0f, mass = 1.0f, radius = 0.05f;
+    const float stiffness = 2e4, damping = 10.0f;
+    const float l0 = width / (particlePerLine-1);
+
+    system->clear();
+    links.clear();
+    std::vector<ParticlePtr> particles(particlePerLine*particlePerLine);
+    for(int i=0; i<particlePerLine; ++i)
+    {
+        for(int j=0; j<particlePerLine; ++j)
+        {
+            glm::vec3 x(i*l0, 0.0, j*l0);
+            ParticlePtr p = std::make_shared<Particle>(x, glm::vec3(0), mass, radius);
+            p->setFixed(i == 0 || i == particlePerLine-1);
+            particles[i*particlePerLine+j] = p;
+            system->addParticle(p);
+        }
+    }
+
+    for(int i=0; i<particlePerLine; ++i)
+    {
+        for(int j=0; j<particlePerLine; ++j)
+        {
+            if(i > 0)
+                links.push_back(Link(particles[(i-1)*particlePerLine+j], particles[i*particlePerLine+j]));
+            if(j > 0)
+                links.push_back(Link(particles[i*particlePerLine+j-1], particles[i*particlePerLine+j]));
+        }
+    }
+    for(const Link& link : links)
+    {
+        if(constraints)
+            system->addConstraint(std::make_shared<DistanceConstraint>(link.first, link.second, l0, 1.0f / stiffness));
+        else
+            system->addForceField(std::make_shared<SpringForceField>(link.first, link.second, stiffness, l0, damping));
+    }
+    system->addForceField(std::make_shared<ConstantForceField>(system->getParticles(), DynamicSystem::gravity));
+}
+
+// Simulate the cloth for a few seconds. The simulation is considered stable
+// if no spring is stretched more than twice its rest length.
+bool simulate(SolverPtr solver, float dt, int particlePerLine, double& timePerSecond)
+{
+    const float duration = 3.0f;
+    DynamicSystemPtr system = std::make_shared<DynamicSystem>();
+    std::vector<Link> links;
+    createCloth(system, particlePerLine, std::dynamic_pointer_cast<PositionBasedSolver>(solver) != nullptr, links);
+    system->setSolver(solver);
+    system->setDt(dt);
+    system->setCollisionsDetection(false);
+
+    const int steps = std::ceil(duration / dt);
+    benchmark_clock::time_point start = benchmark_clock::now();
+    for(int step=0; step<steps; ++step)
+        system->computeSimulationStep();
+    std::chrono::duration<double, std::milli> elapsed = benchmark_clock::now() - start;
+    timePerSecond = elapsed.count() / duration;
+
+    const float l0 = 4.0f / (particlePerLine-1);
+    for(const Link& link : links)
+    {
+        float length = glm::length(link.second->getPosition() - link.first->getPosition());
+        if(!std::isfinite(length) || length > 2.0f*l0)
+            return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    int particlePerLine = argc > 1 ? std::stoi(argv[1]) : 21;
+
+    std::vector< std::pair<std::string, SolverPtr> > solvers = {
+        { "explicit euler", std::make_shared<EulerExplicitSolver>() },
+        { "verlet", std::make_shared<VerletSolver>() },
+        { "runge kutta 4", std::make_shared<RungeKutta4Solver>() },
+        { "implicit euler", std::make_shared<EulerImplicitSolver>() },
+        { "xpbd", std::make_shared<PositionBasedSolver>() }
+    };
+
+    std::cout << std::setw(18) << "solver"
+              << std::setw(16) << "largest dt"
+              << std::setw(22) << "time per second (ms)" << std::endl;
+
+    for(const std::pair<std::string, SolverPtr>& solver : solvers)
+    {
+        // Double the time step until the simulation is not stable anymore
+        float largestDt = 0.0f;
+        double timePerSecond = 0.0;
+        for(float dt = 1e-4f; dt <= 1.0f; dt *= 2.0f)
+        {
+            double time = 0.0;
+            if(!simulate(solver.second, dt, particlePerLine, time))
+                break;
+            largestDt = dt;
+            timePerSecond = time;
+        }
+        std::cout << std::setw(18) << solver.first
+                  << std::setw(16) << std::setprecision(4) << largestDt
+                  << std::setw(22) << std::fixed << std::setprecision(3) << timePerSecond
+                  << std::defaultfloat << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,130 @@
+#include <KeyframedHierarchicalRenderable.hpp>
+#include <GeometricTransformation.hpp>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Compare two ways of computing the model and normal matrices of the deep
+// keyframed hierarchies of the scenes (e.g. the caterpillar of scene0chenille):
+// - recursive: each node composes the global transforms up to the root and
+//   inverts its normal matrix, every frame, as the hierarchies used to do;
+// - dirty flags: the transforms are flattened parent before children and only
+//   the subtrees whose transforms changed are recomputed, once per frame.
+// No window is opened: run it with ./benchmark_transforms [depth] [frames]
+
+typedef std::chrono::steady_clock benchmark_clock;
+
+// A node of the hierarchy, with nothing to draw
+class Joint : public KeyframedHierarchicalRenderable
+{
+public:
+    Joint() : KeyframedHierarchicalRenderable(nullptr) {}
+private:
+    void do_draw() {}
+};
+typedef std::shared_ptr<Joint> JointPtr;
+
+// Chains of `depth` joints starting from a root, `branches` of them. Every
+// `animatedPeriod`-th joint is animated by keyframes, the others are static.
+JointPtr createHierarchy(int depth, int branches, int animatedPeriod, std::vector<JointPtr>& joints)
+{
+    joints.clear();
+    JointPtr root = std::make_shared<Joint>();
+    joints.push_back(root);
+    for(int b=0; b<branches; ++b)
+    {
+        JointPtr parent = root;
+        for(int d=0; d<depth; ++d)
+        {
+            JointPtr joint = std::make_shared<Joint>();
+            glm::vec3 offset(0.5f, 0.0f, 0.0f);
+            if(d % animatedPeriod == 0)
+            {
+                for(int k=0; k<=4; ++k)
+                {
+                    float angle = (k % 2 ? 0.2f : -0.2f);
+                    joint->addGlobalTransformKeyframe(GeometricTransformation(offset, glm::angleAxis(angle, glm::vec3(0,1,0))), k);
+                }
+            }
+            else
+            {
+                joint->setGlobalTransform(glm::translate(glm::mat4(1.0), offset));
+            }
+            joint->setLocalTransform(glm::scale(glm::mat4(1.0), glm::vec3(0.4f, 0.2f, 0.2f)));
+            HierarchicalRenderable::addChild(parent, joint);
+            joints.push_back(joint);
+            parent = joint;
+        }
+    }
+    return root;
+}
+
+// Animate the hierarchy for some frames and compute the matrices each frame
+// as the draw of each joint needs them. Return the time per frame.
+double run(bool dirtyFlags, int depth, int branches, int animatedPeriod, int frames, float& checksum)
+{
+    std::vector<JointPtr> joints;
+    JointPtr root = createHierarchy(depth, branches, animatedPeriod, joints);
+
+    checksum = 0.0f;
+    benchmark_clock::time_point start = benchmark_clock::now();
+    for(int frame=0; frame<frames; ++frame)
+    {
+        root->animate(frame * 0.01f);
+        for(const JointPtr& joint : joints)
+        {
+            glm::mat4 model;
+            glm::mat3 normal;
+            if(dirtyFlags)
+            {
+                joint->updateModelMatrix();
+                model = joint->getModelMatrix();
+                normal = joint->getNormalMatrix();
+            }
+            else
+            {
+                model = joint->computeTotalGlobalTransform() * joint->getLocalTransform();
+                normal = glm::transpose(glm::inverse(glm::mat3(model)));
+            }
+            checksum += model[3][0] + normal[0][0];
+        }
+    }
+    std::chrono::duration<double, std::milli> elapsed = benchmark_clock::now() - start;
+    return elapsed.count() / frames;
+}
+
+int main(int argc, char** argv)
+{
+    int depth = argc > 1 ? std::stoi(argv[1]) : 32;
+    int frames = argc > 2 ? std::stoi(argv[2]) : 200;
+    const int branches = 8;
+
+    std::cout << "hierarchies of " << branches << " chains of " << depth << " joints" << std::endl;
+    std::cout << std::setw(16) << "animated"
+              << std::setw(18) << "recursive (ms)"
+              << std::setw(20) << "dirty flags (ms)"
+              << std::setw(12) << "speedup" << std::endl;
+
+    // From all the joints animated, as a walking character, to one in eight
+    for(int animatedPeriod : { 1, 2, 8 })
+    {
+        float recursiveChecksum = 0.0f, dirtyChecksum = 0.0f;
+        double recursive = run(false, depth, branches, animatedPeriod, frames, recursiveChecksum);
+        double dirty = run(true, depth, branches, animatedPeriod, frames, dirtyChecksum);
+        if(std::abs(recursiveChecksum - dirtyChecksum) > 1e-3f * std::abs(recursiveChecksum))
+            std::cerr << "the model matrices differ: " << recursiveChecksum << " != " << dirtyChecksum << std::endl;
+        std::cout << std::setw(16) << ("1/" + std::to_string(animatedPeriod))
+                  << std::setw(18) << std::fixed << std::setprecision(3) << recursive
+                  << std::setw(20) << dirty
+                  << std::setw(12) << std::setprecision(1) << recursive / dirty
+                  << std::defaultfloat << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
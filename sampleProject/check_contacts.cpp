@@ -0,0 +1,128 @@
+#include <dynamics/DynamicSystem.hpp>
+#include <dynamics/ConstantForceField.hpp>
+#include <dynamics/EulerExplicitSolver.hpp>
+#include <dynamics/ParticleParticleCollision.hpp>
+
+#include <cmath>
+#include <iostream>
+
+// Check that the contacts between particles never produce non finite states,
+// even when their centres coincide: particle-particle vectors of zero length
+// used to be normalized into NaN. Also check that a particle which moved to
+// another system leaves no obstacle behind it.
+// No window is opened: run it with ./check_contacts, it fails on the first
+// non finite state.
+
+const float radius = 0.1f;
+
+bool isFinite(const glm::vec3& v)
+{
+    return std::isfinite(v.x) && std::isfinite(v.y) && std::isfinite(v.z);
+}
+
+// Two particles solved in place, with the same centre.
+bool checkCoincidentPair()
+{
+    glm::vec3 x1(1,2,3), v1(0,-1,0), x2(1,2,3), v2(0,1,0);
+    solveParticleParticle(x1, v1, 1.0f, radius, false, x2, v2, 2.0f, radius, false, 0.2f);
+    if(!isFinite(x1) || !isFinite(v1) || !isFinite(x2) || !isFinite(v2))
+        return false;
+    // Separated, out of contact
+    return glm::distance(x1, x2) >= 2.0f * radius - 1e-5f;
+}
+
+// An aligned pile of particles in a box, with columns of particles falling
+// exactly on each other, then pairs of particles spawned at the same centre.
+bool checkPile(int particlePerSide, int steps)
+{
+    DynamicSystemPtr system = std::make_shared<DynamicSystem>();
+    system->setSolver(std::make_shared<EulerExplicitSolver>());
+    system->setDt(0.01);
+    system->setRestitution(0.2f);
+
+    const float spacing = 2.2f * radius, side = particlePerSide * spacing + radius;
+    system->addPlaneObstacle(std::make_shared<Plane>(glm::vec3(0,1,0), glm::vec3(0,0,0)));
+    system->addPlaneObstacle(std::make_shared<Plane>(glm::vec3(1,0,0), glm::vec3(0,0,0)));
+    system->addPlaneObstacle(std::make_shared<Plane>(glm::vec3(-1,0,0), glm::vec3(side,0,0)));
+    system->addPlaneObstacle(std::make_shared<Plane>(glm::vec3(0,0,1), glm::vec3(0,0,0)));
+    system->addPlaneObstacle(std::make_shared<Plane>(glm::vec3(0,0,-1), glm::vec3(0,0,side)));
+
+    for(int i=0; i<particlePerSide; ++i)
+        for(int j=0; j<particlePerSide; ++j)
+            for(int k=0; k<particlePerSide; ++k)
+                system->addParticle(std::make_shared<Particle>(glm::vec3(i+0.5f, j+1.0f, k+0.5f) * spacing,
+                                                               glm::vec3(0), 1.0f, radius));
+    for(int i=0; i<particlePerSide; ++i)
+    {
+        glm::vec3 x = glm::vec3(i+0.5f, particlePerSide+2.0f, 0.5f) * spacing;
+        system->addParticle(std::make_shared<Particle>(x, glm::vec3(0), 1.0f, radius));
+        system->addParticle(std::make_shared<Particle>(x, glm::vec3(0), 1.0f, radius));
+    }
+    system->addForceField(std::make_shared<ConstantForceField>(system->getParticles(), DynamicSystem::gravity));
+
+    for(int step=0; step<steps; ++step)
+    {
+        system->computeSimulationStep();
+        const std::vector<glm::vec3>& x = system->getStore()->getPositions();
+        const std::vector<glm::vec3>& v = system->getStore()->getVelocities();
+        for(size_t i=0; i<x.size(); ++i)
+        {
+            if(!isFinite(x[i]) || !isFinite(v[i]))
+            {
+                std::cerr << "particle " << i << " not finite at step " << step << std::endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// A particle moved to another system, while it overlaps a particle of the
+// first system: the entry it leaves in the first store must not collide.
+bool checkReleasedEntry()
+{
+    DynamicSystemPtr first = std::make_shared<DynamicSystem>(), second = std::make_shared<DynamicSystem>();
+    first->setSolver(std::make_shared<EulerExplicitSolver>());
+    first->setDt(0.01);
+
+    const glm::vec3 x(0, 1, 0);
+    ParticlePtr resting = std::make_shared<Particle>(x, glm::vec3(0), 1.0f, radius);
+    ParticlePtr moving = std::make_shared<Particle>(x + glm::vec3(0.5f * radius, 0, 0), glm::vec3(0), 1.0f, radius);
+    first->addParticle(resting);
+    first->addParticle(moving);
+    second->addParticle(moving);
+    for(int step=0; step<10; ++step)
+        first->computeSimulationStep();
+
+    // The entry is reused by the next particle added to the first system
+    ParticlePtr added = std::make_shared<Particle>(glm::vec3(1, 1, 1), glm::vec3(0), 1.0f, radius);
+    first->addParticle(added);
+
+    return first->getParticles().size() == 2 && first->getStore()->size() == 2
+        && first->getParticles()[1] == added && added->getIndex() == 1
+        && second->getParticles().size() == 1
+        && resting->getPosition() == x && resting->getVelocity() == glm::vec3(0);
+}
+
+int main(int argc, char** argv)
+{
+    bool success = true;
+    if(!checkCoincidentPair())
+    {
+        std::cerr << "coincident pair: FAILED" << std::endl;
+        success = false;
+    }
+    if(!checkPile(8, 500))
+    {
+        std::cerr << "aligned pile: FAILED" << std::endl;
+        success = false;
+    }
+    if(!checkReleasedEntry())
+    {
+        std::cerr << "released entry: FAILED" << std::endl;
+        success = false;
+    }
+    if(success)
+        std::cout << "contacts: OK" << std::endl;
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
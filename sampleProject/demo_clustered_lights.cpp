@@ -0,0 +1,114 @@
+#include <Viewer.hpp>
+#include <ShaderProgram.hpp>
+
+#include <lighting/Material.hpp>
+#include <lighting/LightedCubeRenderable.hpp>
+#include <lighting/LightedMeshRenderable.hpp>
+#include <lighting/PointLightRenderable.hpp>
+#include <lighting/DirectionalLightRenderable.hpp>
+#include <GeometricTransformation.hpp>
+#include <Utils.hpp>
+
+#include <cmath>
+#include <iostream>
+#include <string>
+
+// A street of 400 lamps, far beyond the 10 point lights of the block Lights.
+// The phong program reads its point lights from the clusters of the view: each
+// fragment only evaluates the few lamps reaching it. Press F6 for the number of
+// lights per cluster.
+//
+// Run ./demo_clustered_lights deferred to light the same scene with the
+// deferred shading instead: the lamps are applied once per pixel, over the
+// part of the screen each one reaches.
+
+static const int lamp_rows = 20;
+static const int lamp_columns = 20;
+static const float lamp_spacing = 4.0f;
+
+void initialize_scene( Viewer& viewer, bool deferred )
+{
+    viewer.getCamera().setViewMatrix( glm::lookAt( glm::vec3(0, 12, 45), glm::vec3(0, 0, 0), glm::vec3( 0, 1, 0 ) ) );
+
+    ShaderProgram::Defines flatDefines = deferred ? viewer.getDeferredShadingDefines() : ShaderProgram::Defines();
+    ShaderProgramPtr flatShader = std::make_shared<ShaderProgram>(  "../../sfmlGraphicsPipeline/shaders/flatVertex.glsl",
+                                                                    "../../sfmlGraphicsPipeline/shaders/flatFragment.glsl",
+                                                                    flatDefines);
+    viewer.addShaderProgram(flatShader);
+
+    // A dim moon
+    auto moon = std::make_shared<DirectionalLight>(glm::vec3(-1,-2,-1), glm::vec3(0.02), glm::vec3(0.05), glm::vec3(0));
+    viewer.addDirectionalLight(moon);
+
+    // The lamps, with warm and cold colors in turn. The attenuation limits
+    // each lamp to a few meters, i.e. to a few clusters.
+    const glm::vec3 warm(1.0, 0.7, 0.3), cold(0.4, 0.6, 1.0);
+    for(int row = 0; row < lamp_rows; ++row)
+    {
+        for(int column = 0; column < lamp_columns; ++column)
+        {
+            glm::vec3 position( (column - 0.5f * (lamp_columns - 1)) * lamp_spacing, 1.5f,
+                                (row - 0.5f * (lamp_rows - 1)) * lamp_spacing );
+            glm::vec3 color = ((row + column) % 2) ? warm : cold;
+            auto lamp = std::make_shared<PointLight>(position, glm::vec3(0), color, color, 1.0f, 0.35f, 0.44f);
+            viewer.addPointLight(lamp);
+
+            // The lamps sway, so that the clusters change every frame
+            float phase = 0.37f * (row * lamp_columns + column);
+            for(int key = 0; key <= 4; ++key)
+            {
+                float t = key * 2.0f;
+                glm::vec3 offset(0.5f * std::sin(phase + 0.5f * M_PI * key), 0, 0.5f * std::cos(phase + 0.5f * M_PI * key));
+                lamp->addGlobalTransformKeyframe(getTranslationMatrix(position + offset), t);
+            }
+
+            auto lamp_renderable = std::make_shared<PointLightRenderable>(flatShader, lamp);
+            lamp_renderable->setLocalTransform(getScaleMatrix(0.15));
+            viewer.addRenderable(lamp_renderable);
+        }
+    }
+
+    // Built once all the lights are added
+    ShaderProgramPtr phongShader = std::make_shared<ShaderProgram>(  "../../sfmlGraphicsPipeline/shaders/phongVertex.glsl",
+                                                                    "../../sfmlGraphicsPipeline/shaders/phongFragment.glsl",
+                                                                    deferred ? viewer.getDeferredShadingDefines()
+                                                                             : viewer.getClusteredLightDefines());
+    viewer.addShaderProgram(phongShader);
+
+    auto mat = std::make_shared<Material>(glm::vec3(1), glm::vec3(0.8), glm::vec3(0.3), 20.0f);
+
+    auto ground = std::make_shared<LightedCubeRenderable>(phongShader, false, mat);
+    ground->setLocalTransform(getTranslationMatrix(0,-0.1,0) * getScaleMatrix(lamp_columns * lamp_spacing, 0.2, lamp_rows * lamp_spacing));
+    viewer.addRenderable(ground);
+
+    std::string bunny_obj_path = "../../sfmlGraphicsPipeline/meshes/bunny.obj";
+    for(int row = 0; row < lamp_rows; row += 4)
+    {
+        for(int column = 0; column < lamp_columns; column += 4)
+        {
+            auto bunny = std::make_shared<LightedMeshRenderable>(phongShader, bunny_obj_path, mat);
+            bunny->setGlobalTransform(getTranslationMatrix( (column + 0.5f - 0.5f * lamp_columns) * lamp_spacing, 0.6f,
+                                                            (row + 0.5f - 0.5f * lamp_rows) * lamp_spacing ));
+            bunny->setLocalTransform(getScaleMatrix(1.5,1.5,1.5));
+            viewer.addRenderable(bunny);
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Viewer viewer(1280,720, glm::vec4(0,0,0,1));
+    initialize_scene(viewer, argc > 1 && std::string(argv[1]) == "deferred");
+    viewer.setAnimationLoop(true, 8.0);
+    viewer.startAnimation();
+
+    while( viewer.isRunning())
+    {
+        viewer.handleEvent();
+        viewer.animate();
+        viewer.draw();
+        viewer.display();
+    }
+
+    return EXIT_SUCCESS;
+}
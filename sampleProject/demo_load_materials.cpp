@@ -3,6 +3,7 @@
 #include <FrameRenderable.hpp>
 #include <Io.hpp>
 #include <lighting/LightedMeshRenderable.hpp>
+#include <lighting/StaticBatchRenderable.hpp>
 #include <lighting/Light.hpp>
 
 
@@ -22,49 +23,64 @@ void initialize_scene( Viewer& viewer )
     const std::string obj_path = "../../sfmlGraphicsPipeline/meshes/musclecar.obj";
     const std::string mtl_basepath = "../../sfmlGraphicsPipeline/meshes/";
 
-    std::vector<std::vector<glm::vec3>> all_positions;
-    std::vector<std::vector<glm::vec3>> all_normals;
-    std::vector<std::vector<glm::vec2>> all_texcoords;
-    std::vector<std::vector<unsigned int>> all_indices;
-    std::vector<MaterialPtr> materials;
+    // The parts of the car do not move relatively to each other: merged in
+    // shared buffers, they are drawn with one call per material
+    bool batched = true;
+
+    if (batched){
+        StaticBatchRenderablePtr car = std::make_shared<StaticBatchRenderable>(phong_shader);
+        car->addObj(obj_path, mtl_basepath);
+        car->addGlobalTransformKeyframe(getRotationMatrix(0.00 * 2 * M_PI, 0, 1, 0), 0);
+        car->addGlobalTransformKeyframe(getRotationMatrix(0.25 * 2 * M_PI, 0, 1, 0), 10);
+        car->addGlobalTransformKeyframe(getRotationMatrix(0.50 * 2 * M_PI, 0, 1, 0), 20);
+        car->addGlobalTransformKeyframe(getRotationMatrix(0.75 * 2 * M_PI, 0, 1, 0), 30);
+        car->addGlobalTransformKeyframe(getRotationMatrix(1.00 * 2 * M_PI, 0, 1, 0), 40);
+        viewer.addRenderable(car);
+    }else{
+        std::vector<std::vector<glm::vec3>> all_positions;
+        std::vector<std::vector<glm::vec3>> all_normals;
+        std::vector<std::vector<glm::vec2>> all_texcoords;
+        std::vector<std::vector<unsigned int>> all_indices;
+        std::vector<MaterialPtr> materials;
     
-    bool indexed = false;
+        bool indexed = false;
 
-    if (indexed)
-        read_obj_with_materials_indexed(obj_path, mtl_basepath, all_positions, all_normals, all_texcoords, all_indices, materials);
-    else
-        read_obj_with_materials(obj_path, mtl_basepath, all_positions, all_normals, all_texcoords, materials);
+        if (indexed)
+            read_obj_with_materials_indexed(obj_path, mtl_basepath, all_positions, all_normals, all_texcoords, all_indices, materials);
+        else
+            read_obj_with_materials(obj_path, mtl_basepath, all_positions, all_normals, all_texcoords, materials);
 
-    int n_object = materials.size();
-    std::vector<glm::vec4> colors;
+        int n_object = materials.size();
+        std::vector<glm::vec4> colors;
     
-    LightedMeshRenderablePtr root;
-
-    if (indexed)
-        root = std::make_shared<LightedMeshRenderable>(
-            phong_shader, all_positions[0], all_indices[0], all_normals[0], colors, materials[0]);
-    else
-        root = std::make_shared<LightedMeshRenderable>(
-            phong_shader, all_positions[0], all_normals[0], colors, materials[0]);
-    for (int i = 1 ; i < n_object ; ++i){
-        if (indexed){
-            LightedMeshRenderablePtr part = std::make_shared<LightedMeshRenderable>(
-            phong_shader, all_positions[i], all_indices[i], all_normals[i], colors, materials[i]);
-            HierarchicalRenderable::addChild(root, part);
-        }else{
-            LightedMeshRenderablePtr part = std::make_shared<LightedMeshRenderable>(
-            phong_shader, all_positions[i], all_normals[i], colors, materials[i]);
-            HierarchicalRenderable::addChild(root, part);
+        LightedMeshRenderablePtr root;
+
+        if (indexed)
+            root = std::make_shared<LightedMeshRenderable>(
+                phong_shader, all_positions[0], all_indices[0], all_normals[0], colors, materials[0]);
+        else
+            root = std::make_shared<LightedMeshRenderable>(
+                phong_shader, all_positions[0], all_normals[0], colors, materials[0]);
+        for (int i = 1 ; i < n_object ; ++i){
+            if (indexed){
+                LightedMeshRenderablePtr part = std::make_shared<LightedMeshRenderable>(
+                phong_shader, all_positions[i], all_indices[i], all_normals[i], colors, materials[i]);
+                HierarchicalRenderable::addChild(root, part);
+            }else{
+                LightedMeshRenderablePtr part = std::make_shared<LightedMeshRenderable>(
+                phong_shader, all_positions[i], all_normals[i], colors, materials[i]);
+                HierarchicalRenderable::addChild(root, part);
+            }
         }
-    }
 
-    root->addGlobalTransformKeyframe(getRotationMatrix(0.00 * 2 * M_PI, 0, 1, 0), 0);
-    root->addGlobalTransformKeyframe(getRotationMatrix(0.25 * 2 * M_PI, 0, 1, 0), 10);
-    root->addGlobalTransformKeyframe(getRotationMatrix(0.50 * 2 * M_PI, 0, 1, 0), 20);
-    root->addGlobalTransformKeyframe(getRotationMatrix(0.75 * 2 * M_PI, 0, 1, 0), 30);
-    root->addGlobalTransformKeyframe(getRotationMatrix(1.00 * 2 * M_PI, 0, 1, 0), 40);
+        root->addGlobalTransformKeyframe(getRotationMatrix(0.00 * 2 * M_PI, 0, 1, 0), 0);
+        root->addGlobalTransformKeyframe(getRotationMatrix(0.25 * 2 * M_PI, 0, 1, 0), 10);
+        root->addGlobalTransformKeyframe(getRotationMatrix(0.50 * 2 * M_PI, 0, 1, 0), 20);
+        root->addGlobalTransformKeyframe(getRotationMatrix(0.75 * 2 * M_PI, 0, 1, 0), 30);
+        root->addGlobalTransformKeyframe(getRotationMatrix(1.00 * 2 * M_PI, 0, 1, 0), 40);
 
-    viewer.addRenderable(root);
+        viewer.addRenderable(root);
+    }
 
     glm::vec3 dir = glm::normalize(glm::vec3(-1,-1,-1));
     glm::vec3 ambient = glm::vec3(0,0,0);
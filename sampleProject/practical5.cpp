@@ -11,6 +11,9 @@
 #include <dynamics/ConstantForceField.hpp>
 #include <dynamics/SpringForceField.hpp>
 #include <dynamics/EulerExplicitSolver.hpp>
+#include <dynamics/PositionBasedSolver.hpp>
+#include <dynamics/DistanceConstraint.hpp>
+#include <dynamics/BendingConstraint.hpp>
 
 #include <dynamics/ParticleRenderable.hpp>
 #include <dynamics/ParticleListRenderable.hpp>
@@ -21,6 +24,7 @@
 
 void particles(Viewer& viewer, DynamicSystemPtr& system, DynamicSystemRenderablePtr &systemRenderable);
 void springs(Viewer& viewer, DynamicSystemPtr& system, DynamicSystemRenderablePtr &systemRenderable);
+void constraints(Viewer& viewer, DynamicSystemPtr& system, DynamicSystemRenderablePtr &systemRenderable);
 void playPool(Viewer& viewer, DynamicSystemPtr& system, DynamicSystemRenderablePtr& systemRenderable);
 void collisions(Viewer& viewer, DynamicSystemPtr& system, DynamicSystemRenderablePtr &systemRenderable);
 
@@ -50,6 +54,7 @@ void initialize_scene( Viewer& viewer )
 
     //particles(viewer, system, systemRenderable);
     //springs(viewer, system, systemRenderable);
+    //constraints(viewer, system, systemRenderable);
     //collisions(viewer, system, systemRenderable);
     playPool(viewer, system, systemRenderable);
 
@@ -210,10 +215,12 @@ void springs(Viewer& viewer, DynamicSystemPtr& system, DynamicSystemRenderablePt
 
     //Create a particleListRenderable to efficiently visualize the particles of the system
     ParticleListRenderablePtr particleListRenderable = std::make_shared<ParticleListRenderable>( instancedShader, particles);
+    particleListRenderable->setInterpolation(systemRenderable);
     HierarchicalRenderable::addChild(systemRenderable, particleListRenderable);
 
     //Create a springListRenderable to efficiently visualize the springs of the system
     SpringListRenderablePtr springsRenderable = std::make_shared<SpringListRenderable>(flatShader, springForceFields);
+    springsRenderable->setInterpolation(systemRenderable);
     HierarchicalRenderable::addChild( systemRenderable, springsRenderable );
 
     //Display gravity
@@ -221,6 +228,105 @@ void springs(Viewer& viewer, DynamicSystemPtr& system, DynamicSystemRenderablePt
     HierarchicalRenderable::addChild( systemRenderable, gravityRenderable );
 }
 
+void constraints(Viewer& viewer, DynamicSystemPtr& system, DynamicSystemRenderablePtr &systemRenderable)
+{
+    //Initialize a shader for the following renderables
+    ShaderProgramPtr flatShader = std::make_shared<ShaderProgram>(  "../../sfmlGraphicsPipeline/shaders/flatVertex.glsl",
+                                                                    "../../sfmlGraphicsPipeline/shaders/flatFragment.glsl");
+    ShaderProgramPtr instancedShader = std::make_shared<ShaderProgram>(  "../../sfmlGraphicsPipeline/shaders/instancedVertex.glsl",
+                                                                    "../../sfmlGraphicsPipeline/shaders/instancedFragment.glsl");
+    viewer.addShaderProgram( flatShader );
+    viewer.addShaderProgram( instancedShader );
+
+    //The same cloth as in springs(), simulated with position constraints.
+    //It stays stiff with a much larger time step.
+    PositionBasedSolverPtr solver = std::make_shared<PositionBasedSolver>();
+    system->setSolver(solver);
+    system->setDt(0.04);
+
+    //Create particles on a squared uniform grid starting at origin
+    float pr = 0.1, pm = 10.0;
+    glm::vec3 px(0.0,0.0,0.0), pv(0.0,0.0,0.0);
+    std::vector<ParticlePtr> particles;
+    glm::vec3 origin(0.25,1.0,0.25), displacement(0.0,0.0,0.0);
+    int particlePerLine = 11;
+    float gridWidth=4.0, gridHeight=4.0;
+    float xstep = gridWidth / (float)(particlePerLine-1);
+    float zstep = gridHeight / (float)(particlePerLine-1);
+    particles.resize(particlePerLine*particlePerLine);
+    for( size_t i = 0; i < particlePerLine; ++ i )
+    {
+        for( size_t j = 0; j < particlePerLine; ++ j )
+        {
+            displacement = glm::vec3(i*xstep, 0.0, j*zstep);
+            px = origin + displacement;
+            particles[i*particlePerLine+j] = std::make_shared<Particle>( px, pv, pm, pr );
+            system->addParticle( particles[i*particlePerLine+j] );
+        }
+    }
+
+    //Fix particles on one border only: the cloth falls on the floor
+    for( size_t j = 0; j < particlePerLine; ++ j )
+        particles[0*particlePerLine+j]->setFixed( true );
+
+    //Infinitely stiff distance constraints along the grid
+    //Store them in a list to render them
+    std::list<DistanceConstraintPtr> distanceConstraints;
+    for( size_t i = 0; i < particlePerLine; ++ i )
+    {
+        for( size_t j = 0; j < particlePerLine; ++ j )
+        {
+            if( i > 0 )
+                distanceConstraints.push_back( std::make_shared<DistanceConstraint>( particles[(i-1)*particlePerLine+j], particles[i*particlePerLine+j], xstep ) );
+            if( j > 0 )
+                distanceConstraints.push_back( std::make_shared<DistanceConstraint>( particles[i*particlePerLine+(j-1)], particles[i*particlePerLine+j], zstep ) );
+        }
+    }
+    for( DistanceConstraintPtr c : distanceConstraints )
+        system->addConstraint( c );
+
+    //Soft bending constraints between the triangles of the grid.
+    //Each quad (i,j) is split by its diagonal into the triangles (a,b,c) and (a,c,d).
+    float bendingCompliance = 1e-3;
+    auto particle = [&]( size_t i, size_t j ) { return particles[i*particlePerLine+j]; };
+    for( size_t i = 0; i+1 < particlePerLine; ++ i )
+    {
+        for( size_t j = 0; j+1 < particlePerLine; ++ j )
+        {
+            //Diagonal of the quad
+            system->addConstraint( std::make_shared<BendingConstraint>( particle(i,j), particle(i+1,j+1), particle(i+1,j), particle(i,j+1), bendingCompliance ) );
+            //Edge shared with the next quad along i
+            if( i+2 < particlePerLine )
+                system->addConstraint( std::make_shared<BendingConstraint>( particle(i+1,j), particle(i+1,j+1), particle(i,j), particle(i+2,j+1), bendingCompliance ) );
+            //Edge shared with the next quad along j
+            if( j+2 < particlePerLine )
+                system->addConstraint( std::make_shared<BendingConstraint>( particle(i,j+1), particle(i+1,j+1), particle(i,j), particle(i+1,j+2), bendingCompliance ) );
+        }
+    }
+
+    //Floor, solved as a contact constraint
+    PlanePtr floor = std::make_shared<Plane>( glm::vec3(0,1,0), glm::vec3(0,-1.5,0) );
+    system->addPlaneObstacle( floor );
+    system->setCollisionsDetection( true );
+    QuadMeshRenderablePtr floorRenderable = std::make_shared<QuadMeshRenderable>( flatShader,
+        glm::vec3(-5,-1.5,-5), glm::vec3(-5,-1.5,5), glm::vec3(5,-1.5,5), glm::vec3(5,-1.5,-5), glm::vec4(0.3,0.5,0.9,1.0) );
+    HierarchicalRenderable::addChild( systemRenderable, floorRenderable );
+
+    //Gravity and air friction
+    ConstantForceFieldPtr gravityForceField = std::make_shared<ConstantForceField>(system->getParticles(), DynamicSystem::gravity );
+    system->addForceField( gravityForceField );
+    DampingForceFieldPtr dampingForceField = std::make_shared<DampingForceField>(system->getParticles(), 1.0);
+    system->addForceField( dampingForceField );
+
+    //Render the particles and the distance constraints as springs
+    ParticleListRenderablePtr particleListRenderable = std::make_shared<ParticleListRenderable>( instancedShader, particles);
+    particleListRenderable->setInterpolation(systemRenderable);
+    HierarchicalRenderable::addChild(systemRenderable, particleListRenderable);
+    SpringListRenderablePtr constraintsRenderable = std::make_shared<SpringListRenderable>(flatShader, distanceConstraints);
+    constraintsRenderable->setInterpolation(systemRenderable);
+    HierarchicalRenderable::addChild( systemRenderable, constraintsRenderable );
+}
+
 void collisions(Viewer& viewer, DynamicSystemPtr& system, DynamicSystemRenderablePtr &systemRenderable)
 {
     //Initialize a shader for the following renderables
@@ -11,11 +11,6 @@ void initialize_scene( Viewer& viewer )
         															"../../sfmlGraphicsPipeline/shaders/flatFragment.glsl");
 	viewer.addShaderProgram(flatShader);
 
-	//Define a shader that encode an illumination model
-    ShaderProgramPtr phongShader = std::make_shared<ShaderProgram>( "../../sfmlGraphicsPipeline/shaders/phongVertex.glsl", 
-                                                                    "../../sfmlGraphicsPipeline/shaders/phongFragment.glsl");
-    viewer.addShaderProgram(phongShader);
-
 	// Add light to the scene
 	glm::vec3 leafGreen(0,1,0);
 	{ // SpotLight
@@ -26,8 +21,16 @@ void initialize_scene( Viewer& viewer )
         viewer.addRenderable(spot_light_renderable);
     }
 
+	//Define a shader that encode an illumination model for the single spot light,
+	//compiled in the background: the scene is drawn flat until it is ready
+    ShaderProgramPtr phongShader = std::make_shared<ShaderProgram>( "../../sfmlGraphicsPipeline/shaders/phongVertex.glsl", 
+                                                                    "../../sfmlGraphicsPipeline/shaders/phongFragment.glsl",
+                                                                    flatShader, viewer.getLightDefines());
+    viewer.addShaderProgram(phongShader);
+
 	const std::string traing_path = "../../models3D/train2.obj";
     LightedMeshRenderablePtr traing = std::make_shared<LightedMeshRenderable>(phongShader, traing_path, Material::GreenRubber());
+    traing->generateLevelsOfDetail();
 	viewer.addRenderable(traing);
 
 	auto mat = std::make_shared<Material>(glm::vec3(0), glm::vec3(1), glm::vec3(0), 100.0f);
@@ -47,12 +50,17 @@ void initialize_scene( Viewer& viewer )
     lighted_cube->setLocalTransform(getScaleMatrix(100,.2,100)*getTranslationMatrix(0,0,0));
 }
 
-int main() 
+// Run ./scene0chenille to watch the scene, or render it off screen with
+// ./scene0chenille <image basename> <frame number> [fps]
+int main(int argc, char** argv) 
 {
     glm::vec4 background_color(0.0,0.0,0.0,1);
-	Viewer viewer(1280,720, background_color);
+    bool headless = argc > 2;
+	Viewer viewer(1280,720, background_color, headless);
 	initialize_scene(viewer);
 	viewer.startAnimation();
+	if (headless)
+		viewer.setImageSequence(argv[1], std::stoi(argv[2]), argc > 3 ? std::stof(argv[3]) : 24.0f);
 
 	while( viewer.isRunning() )
 	{
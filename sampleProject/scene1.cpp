@@ -11,10 +11,6 @@ void initialize_scene( Viewer& viewer )
     // and then ther will be a train that will pass by from left to right, on rails
     // and a black rectangle will appear next to the train
 
-    ShaderProgramPtr texShader = std::make_shared<ShaderProgram>(   "../../sfmlGraphicsPipeline/shaders/textureVertex.glsl",
-                                                                    "../../sfmlGraphicsPipeline/shaders/textureFragment.glsl");
-    viewer.addShaderProgram(texShader);
-
 	//Define a shader that encode an illumination model
     ShaderProgramPtr phongShader = std::make_shared<ShaderProgram>( "../../sfmlGraphicsPipeline/shaders/phongVertex.glsl", 
                                                                     "../../sfmlGraphicsPipeline/shaders/phongFragment.glsl");
@@ -65,6 +61,15 @@ void initialize_scene( Viewer& viewer )
         spot_light->addGlobalTransformKeyframe(lookAtModel(glm::vec3(0,5,-10.25), glm::vec3(0,0,-4.25), Light::base_forward), 30.0);
     }
 
+    // Now that the lights are known, the textured meshes share the smallest
+    // phong program for them: three directional lights and a spot light
+    ShaderProgram::Defines texDefines = viewer.getLightDefines();
+    texDefines["TEXTURED"] = "";
+    ShaderProgramPtr texShader = ShaderProgram::getPermutation( "../../sfmlGraphicsPipeline/shaders/phongVertex.glsl",
+                                                                "../../sfmlGraphicsPipeline/shaders/phongFragment.glsl",
+                                                                texDefines);
+    viewer.addShaderProgram(texShader);
+
 	//Rusty train
 	const std::string traing_path = "../../models3D/un_oldTrain.obj";
     const std::string train_texture_path = "../../models3D/metal.jpg";
@@ -62,6 +62,7 @@ void initialize_scene( Viewer& viewer )
 
     read_obj_with_materials(penguin_mesh_path, "../../models3D/penguinEileen/", all_positions, all_normals, all_texcoords, materials);
     TexturedLightedMeshRenderablePtr penguin = std::make_shared<TexturedLightedMeshRenderable>(texShader, penguin_mesh_path, materials[0], penguin_texture_path);
+    penguin->generateLevelsOfDetail();
     
     const std::string beakBot_path = "../../models3D/penguinEileen/beakBot.obj";
     const std::string beakTop_path = "../../models3D/penguinEileen/beakTop.obj";
@@ -0,0 +1,65 @@
+#ifndef BOUNDING_BOX_HPP
+#define BOUNDING_BOX_HPP
+
+/** @file
+ * @brief Define an axis aligned bounding box.
+ */
+
+#include <glm/glm.hpp>
+
+/** @brief An axis aligned bounding box, and the bounding sphere around it.
+ *
+ * A bounding box can be:
+ * - empty: it contains nothing, e.g. a mesh without vertices;
+ * - infinite: it contains everything. This is the bounding box of the
+ * renderables whose geometry is unknown on the CPU, which must never be
+ * considered out of view;
+ * - finite, between a minimum and a maximum corner.
+ */
+class BoundingBox
+{
+public:
+  /** @brief Build an empty bounding box. */
+  BoundingBox();
+  /** @brief Build a bounding box from its corners.
+   *
+   * @param min The corner of minimal coordinates.
+   * @param max The corner of maximal coordinates.
+   */
+  BoundingBox( const glm::vec3& min, const glm::vec3& max );
+
+  /** @brief Build an infinite bounding box, which contains everything. */
+  static BoundingBox infinite();
+
+  /** @brief Check if the box contains nothing. */
+  bool isEmpty() const;
+  /** @brief Check if the box is unbounded in a direction. */
+  bool isInfinite() const;
+
+  /** @brief Grow the box to contain a point. */
+  void extend( const glm::vec3& point );
+  /** @brief Grow the box to contain another box. */
+  void extend( const BoundingBox& box );
+
+  /** @brief Bounding box of this box transformed by an affine transformation.
+   *
+   * @param transform The affine transformation, e.g. a model matrix.
+   * @return The axis aligned box containing the transformed box.
+   */
+  BoundingBox transform( const glm::mat4& transform ) const;
+
+  /** @brief Access to the corner of minimal coordinates. */
+  const glm::vec3& getMin() const;
+  /** @brief Access to the corner of maximal coordinates. */
+  const glm::vec3& getMax() const;
+  /** @brief Center of the box, and of its bounding sphere. */
+  glm::vec3 getCenter() const;
+  /** @brief Radius of the bounding sphere, half the diagonal of the box. */
+  float getRadius() const;
+
+private:
+  glm::vec3 m_min;
+  glm::vec3 m_max;
+};
+
+#endif //BOUNDING_BOX_HPP
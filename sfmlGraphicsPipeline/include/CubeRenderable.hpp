@@ -2,6 +2,7 @@
 #define CUBE_RENDERABLE_HPP
 
 #include "Renderable.hpp"
+#include "VertexArray.hpp"
 #include <vector>
 #include <glm/glm.hpp>
 
@@ -18,6 +19,7 @@ class CubeRenderable : public Renderable
         std::vector< glm::vec4 > m_colors;
         unsigned int m_vBuffer;
         unsigned int m_cBuffer;
+        VertexArray m_vertexArray;
 
 };
 
@@ -0,0 +1,111 @@
+#ifndef FRAME_CAPTURE_HPP
+#define FRAME_CAPTURE_HPP
+
+/** @file
+ * @brief Define an asynchronous capture of frames to image files.
+ */
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <GL/glew.h>
+#include <SFML/Graphics.hpp>
+
+/** @brief Save frames to image files without stalling the rendering.
+ *
+ * Reading the pixels of a frame into client memory waits for the GPU to
+ * finish the frame, and encoding a PNG takes longer than drawing most
+ * frames. A capture splits the work so that neither happens on the render
+ * thread:
+ *
+ * - capture() starts the copy of the frame into one of
+ * FrameCapture::bufferNumber pixel buffer objects used in turn, and places a
+ * fence after it. It returns at once;
+ * - update(), called once per frame, maps the buffers whose fence is
+ * signaled, i.e. whose copy is done, and hands their pixels to a pool of
+ * worker threads which encode and write the images.
+ *
+ * A frame is thus read back a frame or two after it was drawn, and written
+ * while the next frames are drawn: frames can be recorded continuously. The
+ * render thread only waits when all the buffers are still being copied, or
+ * when the workers fall behind by more than FrameCapture::maxQueuedFrameNumber
+ * frames.
+ */
+class FrameCapture
+{
+public:
+  /** @brief Number of pixel buffer objects used in turn. */
+  static const unsigned int bufferNumber = 3;
+  /** @brief Number of frames waiting for a worker beyond which capture() waits. */
+  static const unsigned int maxQueuedFrameNumber = 32;
+
+  /** @brief Build a capture and start its worker threads.
+   *
+   * The GL buffers are created: GLEW must be initialized.
+   * @param threadNumber The number of threads encoding the images.
+   */
+  FrameCapture( unsigned int threadNumber = 2 );
+  /** @brief Write the pending frames, then stop the worker threads. */
+  ~FrameCapture();
+
+  /** @brief Start the capture of the current read framebuffer.
+   *
+   * @param width The width in pixels of the frame.
+   * @param height The height in pixels of the frame.
+   * @param filename The path of the image, whose extension gives the format (e.g. png).
+   */
+  void capture( unsigned int width, unsigned int height, const std::string& filename );
+
+  /** @brief Hand the frames already read back to the workers, without waiting. */
+  void update();
+
+  /** @brief Wait until all the captured frames are written. */
+  void finish();
+
+  /** @brief Number of frames captured and not written yet. */
+  unsigned int getPendingFrameNumber();
+
+private:
+  FrameCapture( const FrameCapture& );
+  FrameCapture& operator=( const FrameCapture& );
+
+  /** @brief A frame being copied into a pixel buffer object. */
+  struct Readback
+  {
+    GLuint buffer;
+    GLsync fence; /*!< Signaled once the copy is done, null if the buffer is free. */
+    unsigned int width;
+    unsigned int height;
+    std::string filename;
+  };
+
+  /** @brief A frame read back, waiting for a worker. */
+  struct Job
+  {
+    std::vector< sf::Uint8 > pixels;
+    unsigned int width;
+    unsigned int height;
+    std::string filename;
+  };
+
+  /** @brief Map a buffer whose copy is done, or wait for it, and queue its frame. */
+  void retire( Readback& readback );
+  /** @brief Encode and write the queued frames until the capture is destroyed. */
+  void work();
+
+  Readback m_readbacks[bufferNumber];
+  unsigned int m_next; /*!< Oldest buffer, the next one written. */
+
+  std::vector< std::thread > m_threads;
+  std::deque< Job > m_jobs;
+  std::mutex m_mutex; /*!< Protects the jobs, the busy workers and the stop request. */
+  std::condition_variable m_jobAdded;
+  std::condition_variable m_jobDone;
+  unsigned int m_busyThreadNumber;
+  bool m_stopping;
+};
+
+#endif //FRAME_CAPTURE_HPP
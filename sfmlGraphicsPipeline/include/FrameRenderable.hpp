@@ -32,6 +32,8 @@ public :
     FrameRenderable(ShaderProgramPtr shaderProgram);
 
 private:
+    /**@brief Not instanceable: do_draw() changes the line width. */
+    bool do_isInstanceable() const;
     void do_draw();
 };
 
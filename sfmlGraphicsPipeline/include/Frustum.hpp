@@ -0,0 +1,55 @@
+#ifndef FRUSTUM_HPP
+#define FRUSTUM_HPP
+
+/** @file
+ * @brief Define the view frustum of a camera.
+ */
+
+#include "BoundingBox.hpp"
+
+#include <glm/glm.hpp>
+
+/** @brief The volume seen by a camera, bounded by six planes.
+ *
+ * The planes are extracted from the product of the projection and the view
+ * matrices (Gribb and Hartmann, "Fast Extraction of Viewing Frustum Planes
+ * from the World-View-Projection Matrix", 2001). They are given in world
+ * space, with their normals pointing inside the frustum.
+ *
+ * The frustum is used to cull the renderables out of view: a renderable
+ * whose bounding volume does not intersect the frustum is not drawn.
+ */
+class Frustum
+{
+public:
+  /** @brief Build a frustum containing everything. */
+  Frustum();
+  /** @brief Build the frustum of a camera.
+   *
+   * @param projection The projection matrix of the camera.
+   * @param view The view matrix of the camera.
+   */
+  Frustum( const glm::mat4& projection, const glm::mat4& view );
+
+  /** @brief Conservative test of a box against the frustum.
+   *
+   * @param box A bounding box in world space.
+   * @return False if the box is entirely outside the frustum. It can be
+   * true for a box close to a corner of the frustum but outside of it.
+   */
+  bool intersects( const BoundingBox& box ) const;
+
+  /** @brief Conservative test of a sphere against the frustum.
+   *
+   * @param center The center of the sphere in world space.
+   * @param radius The radius of the sphere.
+   * @return False if the sphere is entirely outside the frustum.
+   */
+  bool intersects( const glm::vec3& center, float radius ) const;
+
+private:
+  /** The planes (normal, offset): left, right, bottom, top, near, far */
+  glm::vec4 m_planes[6];
+};
+
+#endif //FRUSTUM_HPP
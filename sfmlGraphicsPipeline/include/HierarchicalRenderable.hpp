@@ -40,6 +40,11 @@ typedef std::shared_ptr<HierarchicalRenderable> HierarchicalRenderablePtr;
  * scale for example, without needing to apply the reverse operation to all its
  * children.
  *
+ * The transforms of a hierarchy are stored in a flattened array, shared by all its
+ * instances, where a parent always comes before its children. Setting a transform
+ * only marks it as changed: updateModelMatrix() then recomputes, in one pass over
+ * this array, the model matrices of the changed subtrees only.
+ *
  * Only the root instance is meant to be added to the Viewer instance: that root
  * will take care itself to draw and animate all the hierarchy. However, if you want
  * to interact with all the hierarchy, you will have to propagate yourself the
@@ -94,13 +99,18 @@ public :
      * matrices \ref m_globalTransform. This computation is done in this function and should be
      * typically applied before drawing a hierarchical renderable. The result is stored
      * in \ref m_model.
+     *
+     * The model matrices of the whole hierarchy are brought up to date at once, only
+     * for the instances whose transforms, or the transforms of an ancestor, changed
+     * since the last call. Calling it again without any change costs nothing.
      */
     void updateModelMatrix();
 
     /** @brief Compute the total global transformation.
      *
      * This function composes recursively the global transformations until
-     * it reaches the root of the hierarchy.
+     * it reaches the root of the hierarchy. It does not use the cached transforms
+     * of updateModelMatrix().
      *
      * \return The total global transformation matrix.
      */
@@ -145,9 +155,69 @@ public :
      * Get the children of this hierarchical renderable.
      * @return A vector of hierarchical renderable shared pointers. */
     std::vector< HierarchicalRenderablePtr > & getChildren();
+
+    /**@brief Read only access to the children of this renderable.
+     *
+     * @return A vector of hierarchical renderable shared pointers. */
+    const std::vector< HierarchicalRenderablePtr > & getChildren() const;
     
 private:
 
+    /** @brief World bounds of the hierarchy rooted at this instance.
+     *
+     * The bounds of all the instances of a hierarchy are computed together, composing
+     * the global transforms down the hierarchy, once per frame of the viewer (see
+     * Viewer::getFrameNumber()): by the first instance culled, be it the root or a
+     * descendant also added to the viewer.
+     */
+    BoundingBox do_getWorldBounds() const;
+
+    /** @brief Number of instances of the hierarchy rooted at this instance. */
+    unsigned int do_getRenderableNumber() const;
+
+    /** @brief Transforms of a whole hierarchy, flattened parent before children.
+     *
+     * Shared by all the instances of the hierarchy, see HierarchicalRenderable.cpp.
+     */
+    struct Hierarchy;
+
+    /** @brief Bring the model matrices of a hierarchy up to date.
+     *
+     * \param hierarchy The hierarchy to update.
+     */
+    static void updateHierarchy( Hierarchy& hierarchy );
+
+    /** @brief Append this instance and its descendants to a hierarchy, in pre-order.
+     *
+     * \param hierarchy The hierarchy to fill.
+     * \param parent The index of the parent in the hierarchy, -1 for the root.
+     */
+    void flatten( Hierarchy& hierarchy, int parent );
+
+    /** @brief Make this instance and its descendants part of a hierarchy.
+     *
+     * \param hierarchy The hierarchy to join.
+     */
+    void joinHierarchy( const std::shared_ptr< Hierarchy >& hierarchy );
+
+    /** @brief The hierarchy this instance belongs to. */
+    std::shared_ptr< Hierarchy > m_hierarchy;
+
+    /** @brief Cached composition of the global transforms up to the root. */
+    glm::mat4 m_totalGlobalTransform;
+
+    /** @brief Whether \ref m_globalTransform changed since the last update. */
+    bool m_globalTransformChanged;
+
+    /** @brief Whether \ref m_localTransform changed since the last update. */
+    bool m_localTransformChanged;
+
+    /** @brief World bounds of the hierarchy rooted at this instance, see do_getWorldBounds(). */
+    mutable BoundingBox m_bounds;
+
+    /** @brief Number of instances of the hierarchy rooted at this instance. */
+    mutable unsigned int m_renderableNumber;
+
     /**@brief Pointer to the parent renderable.
      *
      * If it has no parent then the pointer value is nullptr.
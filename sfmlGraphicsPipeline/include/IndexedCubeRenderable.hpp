@@ -2,6 +2,7 @@
 #define INDEXED_CUBE_RENDERABLE_HPP
 
 #include "Renderable.hpp"
+#include "VertexArray.hpp"
 #include <vector>
 #include <glm/glm.hpp>
 
@@ -21,6 +22,7 @@ class IndexedCubeRenderable : public Renderable
         unsigned int m_vBuffer;
         unsigned int m_cBuffer;
         unsigned int m_iBuffer;
+        VertexArray m_vertexArray;
 
 };
 
@@ -2,12 +2,28 @@
 #define MESH_RENDERABLE_HPP
 
 #include "KeyframedHierarchicalRenderable.hpp"
+#include "VertexArray.hpp"
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <glm/glm.hpp>
 #include <GL/glew.h>
 
+/**@brief A renderable drawing a mesh stored in vertex buffers.
+ *
+ * A mesh renderable without children is instanceable when its shader program
+ * declares the per instance attribute "instanceModelMat" (and optionally
+ * "instanceNIT"): the viewer draws the renderables of the same mesh, material
+ * and program with a single instanced draw call. The meshes are identified by
+ * their content, so that identical meshes loaded or generated separately are
+ * drawn together. The derived classes overriding do_draw() must override
+ * do_drawInstances() too, or do_isInstanceable() to return false.
+ *
+ * An indexed triangle mesh can have levels of detail, simplified versions of
+ * it sharing its vertex buffers (see generateLevelsOfDetail()). Each frame, the
+ * coarsest level whose error on screen is below a threshold is drawn.
+ */
 class MeshRenderable : public KeyframedHierarchicalRenderable
 {
     public:
@@ -33,10 +49,36 @@ class MeshRenderable : public KeyframedHierarchicalRenderable
         void update_indices_buffer();
         virtual void update_all_buffers();
 
+        /**@brief Build the levels of detail of the mesh.
+         *
+         * The mesh is simplified with simplify_mesh() and the indices of the
+         * levels are stored after the indices of the mesh in its index buffer.
+         * The levels are dropped when the positions or the indices are updated.
+         * Only the indexed triangle meshes have levels of detail.
+         * @param levelNumber The maximum number of levels, the full mesh excluded.
+         * @param ratio The ratio of the triangle numbers of two consecutive levels.
+         */
+        void generateLevelsOfDetail(unsigned int levelNumber = 4, float ratio = 0.5f);
+        /**@brief Set the largest error on screen of the level drawn, in pixels (1 by default). */
+        void setLevelOfDetailThreshold(float pixels);
+        /**@brief Number of levels of detail, the full mesh excluded. */
+        unsigned int getLevelOfDetailNumber() const;
+        /**@brief Level drawn at the last frame: 0 for the full mesh, the coarsest is getLevelOfDetailNumber(). */
+        unsigned int getLevelOfDetail() const;
+
     protected:
         void do_draw();
+        void do_drawInstances(unsigned int buffer, std::size_t offset, unsigned int instanceNumber);
         MeshRenderable(ShaderProgramPtr program, bool indexed);
 
+        /**@brief Specify the vertex attributes and the element buffer.
+         *
+         * Called by do_draw() while the vertex array object of the current
+         * shader program is bound, only when this VAO has just been built.
+         * Renderables with additional attributes override it and call it.
+         */
+        virtual void set_vertex_attributes();
+
         GLenum m_mode;
         std::vector< glm::vec3 > m_positions;
         std::vector< glm::vec3 > m_normals;
@@ -49,11 +91,40 @@ class MeshRenderable : public KeyframedHierarchicalRenderable
         unsigned int m_cBuffer;
         unsigned int m_nBuffer;
         unsigned int m_iBuffer;
+        VertexArray m_vertexArray;
+        BoundingBox m_localBounds; /*!< Bounds of m_positions, updated with the position buffer. */
 
     private:
+        BoundingBox do_getLocalBounds() const;
+        bool do_isInstanceable() const;
+        /**@brief Identify the mesh by its content when instanceable, this renderable otherwise. */
+        const void* do_getMeshKey() const;
         void gen_buffers();
         void update_buffers();
         void set_random_colors();
+        /**@brief Choose the level of detail of the current frame.
+         *
+         * The level gets coarser when its error on screen falls well below the
+         * threshold, and finer as soon as it exceeds it, so that a mesh at the
+         * limit distance does not switch between two levels every frame.
+         */
+        void selectLevelOfDetail() const;
+
+        /**@brief A simplified version of the mesh: a range of the index buffer. */
+        struct LevelOfDetail
+        {
+            unsigned int firstIndex;
+            unsigned int indexNumber;
+            float error; /*!< Distance to the full mesh, in object space. */
+        };
+        std::vector< LevelOfDetail > m_levels;
+        float m_levelThreshold;
+        mutable unsigned int m_level; /*!< Level of the current frame, 0 for the full mesh. */
+
+        mutable std::shared_ptr< const std::uint64_t > m_geometryKey; /*!< Shared by the renderables of identical meshes. */
+        mutable std::vector< std::shared_ptr< const std::uint64_t > > m_levelKeys; /*!< Same for each level of detail. */
+        mutable bool m_geometryChanged; /*!< The buffers were updated since m_geometryKey was computed. */
+        mutable const ShaderProgram* m_geometryProgram; /*!< The program whose attributes m_geometryKey was computed for. */
 
 
 };
@@ -0,0 +1,55 @@
+#ifndef MESH_SIMPLIFICATION_HPP
+#define MESH_SIMPLIFICATION_HPP
+
+/**@file
+ *@brief Simplification of triangle meshes, to build levels of detail.*/
+
+#include <vector>
+#include <glm/glm.hpp>
+
+/**@brief A simplified version of a mesh.
+ *
+ * The simplified mesh reuses the vertices of the original mesh: only the
+ * triangles change, so that the vertex buffers (and the normals, colors and
+ * texture coordinates they hold) are shared by all the levels of detail.
+ */
+struct MeshLevel
+{
+    std::vector< unsigned int > indices; /*!< The vertex indices of the remaining triangles. */
+    float error; /*!< Upper estimate of the distance to the original surface, in object space. */
+};
+
+/**@brief Build a chain of simplified versions of an indexed triangle mesh.
+ *
+ * The vertices are removed one position at a time by collapsing them on a
+ * neighbor position, the collapse of smallest quadric error first (Garland and
+ * Heckbert, "Surface simplification using quadric error metrics", 1997). The
+ * borders of the surface are preserved by additional quadrics, and the
+ * collapses that would flip a triangle are rejected.
+ *
+ * The vertices duplicated at a seam (same position, different normals or
+ * texture coordinates, e.g. all the vertices of a flat shaded mesh) move
+ * together, so that the surface does not tear. A moved vertex takes the
+ * attributes of the vertex at the target position it shares a triangle with,
+ * or else of the one with the closest normal.
+ *
+ * Each level has about ratio times the triangles of the previous one. The
+ * chain stops early when the mesh cannot be simplified any further.
+ *
+ * @param positions The vertex positions.
+ * @param normals The vertex normals, possibly empty.
+ * @param indices The vertex indices of the triangles.
+ * @param levelNumber The maximum number of levels, the original mesh excluded.
+ * @param ratio The ratio of the triangle numbers of two consecutive levels, in ]0,1[.
+ * @param levels The levels, from the finest to the coarsest.
+ */
+void simplify_mesh(
+        const std::vector<glm::vec3>& positions,
+        const std::vector<glm::vec3>& normals,
+        const std::vector<unsigned int>& indices,
+        unsigned int levelNumber,
+        float ratio,
+        std::vector<MeshLevel>& levels
+        );
+
+#endif //MESH_SIMPLIFICATION_HPP
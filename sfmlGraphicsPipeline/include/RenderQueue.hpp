@@ -0,0 +1,198 @@
+#ifndef RENDER_QUEUE_HPP
+#define RENDER_QUEUE_HPP
+
+/** @file
+ * @brief Define the queue ordering the draws of a frame.
+ */
+
+#include "Renderable.hpp"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+
+/** @brief Order the draws of a frame so that consecutive draws share their state.
+ *
+ * Drawing the renderables in the order they were added to the viewer binds
+ * a shader program, a material and textures at almost every draw. At each
+ * frame, the render queue builds a 64 bits key per renderable and sorts
+ * the renderables by key:
+ *
+ * - the pass: the priority of the renderable (higher priorities first, as
+ * the viewer always did) and then opaque before transparent renderables;
+ * - for opaque renderables: the shader program, the material, the texture,
+ * the mesh and the depth, front to back so that the depth test discards
+ * hidden fragments early;
+ * - for transparent renderables: the depth first, back to front as blending
+ * requires, then the state.
+ *
+ * The states are ranked in the order they first appear in the frame, so
+ * that each field only needs a few bits. The keys are sorted with a radix
+ * sort, which is stable: renderables with the same key keep the order they
+ * were added in.
+ *
+ * Consecutive instanceable renderables with the same state (see
+ * Renderable::isInstanceable()) are grouped in a batch, drawn with a single
+ * instanced draw call. Opaque renderables only: the transparent ones are
+ * drawn one by one, back to front.
+ *
+ * The queue counts the state switches between consecutive draws, in the
+ * sorted order and in the priority order alone (the order the viewer used to
+ * draw in), to measure the switches avoided by the sort.
+ *
+ * A typical use at each frame:
+ * \code{.cpp}
+ * queue.clear();
+ * for( const RenderablePtr& r : renderables )
+ *   queue.add( r );
+ * queue.sort( camera.getPosition() );
+ * for( const RenderQueue::Batch& batch : queue.getBatches() )
+ *   // bind the state of queue.getRenderables()[batch.first] if it changed,
+ *   // draw the batch.count renderables from there
+ * \endcode
+ */
+class RenderQueue
+{
+public:
+  /** @brief Consecutive renderables drawn with a single draw call. */
+  struct Batch
+  {
+    unsigned int first; /*!< Index of the first renderable in getRenderables(). */
+    unsigned int count; /*!< Number of renderables, 1 for a renderable drawn alone. */
+  };
+
+  /** @brief Build an empty render queue, with state sorting enabled. */
+  RenderQueue();
+  ~RenderQueue();
+
+  /** @brief Empty the queue for a new frame. */
+  void clear();
+
+  /** @brief Add a renderable to draw in this frame.
+   *
+   * @param renderable The renderable to draw.
+   */
+  void add( const RenderablePtr& renderable );
+
+  /** @brief Sort the renderables of this frame and count the state switches.
+   *
+   * @param cameraPosition The position of the camera, for the depth ordering.
+   */
+  void sort( const glm::vec3& cameraPosition );
+
+  /** @brief Access to the renderables of this frame.
+   *
+   * @return The renderables in the order to draw them, once sort() has been called.
+   */
+  const std::vector< RenderablePtr >& getRenderables() const;
+
+  /** @brief Access to the draw calls of this frame.
+   *
+   * @return The batches of getRenderables(), in the order to draw them, once sort() has been called.
+   */
+  const std::vector< Batch >& getBatches() const;
+
+  /** @brief Enable or disable the state sorting.
+   *
+   * When disabled, the renderables are only sorted by priority, as the viewer
+   * used to do. This is useful to measure what the sort saves.
+   * @param onOff True to sort by state and depth.
+   */
+  void setStateSorting( bool onOff );
+  /** @brief Check if the renderables are sorted by state and depth. */
+  bool getStateSorting() const;
+
+  /** @brief Enable or disable the instancing.
+   *
+   * When disabled, each renderable is drawn by its own draw call.
+   * @param onOff True to group the instanceable renderables sharing their state.
+   */
+  void setInstancing( bool onOff );
+  /** @brief Check if the instanceable renderables are grouped in batches. */
+  bool getInstancing() const;
+
+  /** @name Statistics of the last sorted frame
+   * @{ */
+  /** @brief Number of draws. */
+  unsigned int getDrawNumber() const;
+  /** @brief Number of draw calls, the batches. */
+  unsigned int getDrawCallNumber() const;
+  /** @brief Number of renderables drawn as instances, in batches of several renderables. */
+  unsigned int getInstancedRenderableNumber() const;
+  /** @brief Number of shader program switches between consecutive draws. */
+  unsigned int getProgramSwitchNumber() const;
+  /** @brief Number of program switches avoided compared to the priority order alone.
+   *
+   * Negative when the back to front order of the transparent renderables
+   * costs more switches than it avoids. */
+  int getAvoidedProgramSwitchNumber() const;
+  /** @brief Number of material switches between consecutive draws. */
+  unsigned int getMaterialSwitchNumber() const;
+  /** @brief Number of material switches avoided compared to the priority order alone. */
+  int getAvoidedMaterialSwitchNumber() const;
+  /** @brief Number of texture switches between consecutive draws. */
+  unsigned int getTextureSwitchNumber() const;
+  /** @brief Number of texture switches avoided compared to the priority order alone. */
+  int getAvoidedTextureSwitchNumber() const;
+  /**@}*/
+
+private:
+  /** @brief The sort key of a renderable and its index in the queue. */
+  struct Item
+  {
+    std::uint64_t key;
+    unsigned int index;
+  };
+
+  /** @brief The state ranks of a renderable, computed by add(). */
+  struct State
+  {
+    int priority;
+    bool transparent;
+    unsigned int program;
+    unsigned int material;
+    unsigned int texture;
+    unsigned int mesh;
+    bool instanceable;
+  };
+
+  /** @brief Rank of a state, in order of first appearance in the frame. */
+  template< typename Key >
+  static unsigned int rank( std::unordered_map< Key, unsigned int >& ranks, const Key& state );
+  /** @brief Stable least significant digit radix sort of m_items on their keys. */
+  void radixSort();
+  /** @brief Check if two renderables can be drawn by the same instanced draw call. */
+  static bool sameInstance( const State& first, const State& other );
+  /** @brief Count the state switches when drawing the states in a given order. */
+  void countSwitches( const std::vector< unsigned int >& order,
+                      unsigned int& programSwitches, unsigned int& materialSwitches, unsigned int& textureSwitches ) const;
+
+  bool m_stateSorting;
+  bool m_instancing;
+
+  std::vector< RenderablePtr > m_added;
+  std::vector< State > m_states;
+  std::vector< Item > m_items;
+  std::vector< Item > m_buffer;
+  std::vector< unsigned int > m_order;
+  std::vector< RenderablePtr > m_sorted;
+  std::vector< Batch > m_batches;
+
+  std::unordered_map< const void*, unsigned int > m_programRanks;
+  std::unordered_map< const void*, unsigned int > m_materialRanks;
+  std::unordered_map< unsigned int, unsigned int > m_textureRanks;
+  std::unordered_map< const void*, unsigned int > m_meshRanks;
+  std::vector< int > m_priorities;
+  std::vector< float > m_depths;
+
+  unsigned int m_programSwitchNumber;
+  int m_avoidedProgramSwitchNumber;
+  unsigned int m_materialSwitchNumber;
+  int m_avoidedMaterialSwitchNumber;
+  unsigned int m_textureSwitchNumber;
+  int m_avoidedTextureSwitchNumber;
+  unsigned int m_instancedRenderableNumber;
+};
+
+#endif //RENDER_QUEUE_HPP
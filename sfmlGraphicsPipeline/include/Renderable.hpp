@@ -11,11 +11,13 @@
 
 
 #include <glm/glm.hpp>
+#include <cstddef>
 #include <unordered_set>
 #include <memory>
 #include <vector>
 
 #include "ShaderProgram.hpp"
+#include "BoundingBox.hpp"
 #include <SFML/Graphics.hpp>
 
 /* Forward declaration of the Viewer class in order to store a pointer to a
@@ -47,6 +49,16 @@ class Viewer;
  * - \c mat4 \c viewMat, for the view matrix
  * - \c mat4 \c projMat, for the projection matrix
  *
+ * These matrices are better declared in the uniform block shared by all the
+ * shader programs, uploaded once per frame by the viewer:
+ * \code{.glsl}
+ * layout(std140) uniform Camera
+ * {
+ *     mat4 projMat;
+ *     mat4 viewMat;
+ * };
+ * \endcode
+ *
  * \note As this class use virtuality, here are some words about the subject to
  * ease your learning of c++ as well as learning computer graphics. This note is
  * taken from a nice article available at http://www.gotw.ca/publications/mill18.htm.
@@ -111,6 +123,16 @@ public:
      */
     const glm::mat4& getModelMatrix() const;
 
+    /**@brief Get the normal matrix.
+     *
+     * The normal matrix is the inverse transpose of the upper 3x3 part of the
+     * model matrix, to transform the normals to world space ("NIT" in the
+     * shaders). It is cached: the inverse is only computed again when the model
+     * matrix changed.
+     * @return The normal matrix.
+     */
+    const glm::mat3& getNormalMatrix() const;
+
     /**@brief Change the shader program.
      *
      * Set a new shader program to use for the rendering.
@@ -226,6 +248,82 @@ public:
     RENDER_MODE getRenderMode() const;
     void setRenderMode(RENDER_MODE);
 
+    /** @name State of the renderable.
+     * The Viewer sorts the renderables of each frame so that consecutive draws
+     * share their state, see RenderQueue. */
+    /** @brief Check if this renderable is transparent.
+     *
+     * Transparent renderables are drawn after the opaque renderables of the
+     * same priority, from back to front.
+     * @return True if the renderable is transparent, false by default.
+     */
+    bool isTransparent() const;
+    /** @brief Set if this renderable is transparent.
+     * @param transparent True if the renderable is blended with what is behind.
+     */
+    void setTransparent(bool transparent);
+
+    /** @brief Identify the material sent by do_draw().
+     * @return The same address for renderables sharing a material, nullptr if none.
+     */
+    const void* getMaterialKey() const;
+    /** @brief Identify the texture bound by do_draw().
+     * @return The name of the (first) texture, 0 if none.
+     */
+    unsigned int getTextureKey() const;
+    /** @brief Identify the geometry drawn by do_draw().
+     * @return The same address for renderables sharing their buffers, this renderable by default.
+     */
+    const void* getMeshKey() const;
+
+    /** @name Bounding volumes of the renderable.
+     * The Viewer does not draw the renderables out of the view frustum of
+     * the camera, see Viewer::isCulled(). */
+    /** @brief Bounds of the geometry drawn by do_draw(), in object space.
+     * @return The bounding box, infinite (never culled) by default.
+     */
+    BoundingBox getLocalBounds() const;
+    /** @brief Bounds of this renderable, and of its children if any, in world space.
+     * @return The bounding box of the local bounds transformed by the model matrix by default.
+     */
+    BoundingBox getWorldBounds() const;
+    /** @brief Number of renderables drawn by draw(): this one and its descendants.
+     * @return 1 by default.
+     */
+    unsigned int getRenderableNumber() const;
+
+    /** @name Instanced drawing of the renderable.
+     * The Viewer draws the consecutive renderables of a frame that share their
+     * state (program, material, texture and mesh) with a single instanced draw
+     * call, see RenderQueue. */
+    /** @brief Per instance data of an instanced draw. */
+    struct InstanceData
+    {
+        glm::mat4 model;  /*!< Model matrix of the instance, "instanceModelMat" in the shaders. */
+        glm::mat3 normal; /*!< Normal matrix of the instance, "instanceNIT" in the shaders. */
+    };
+    /** @brief Check if this renderable can be drawn as an instance of another renderable.
+     *
+     * Instanceable renderables with the same state draw the same thing, except
+     * for their model matrices.
+     * @return False by default.
+     */
+    bool isInstanceable() const;
+    /** @brief Write the instance data of this renderable.
+     *
+     * The model matrix is brought up to date first, as draw() does.
+     * @param data The instance data to write to.
+     */
+    void writeInstanceData( InstanceData& data );
+    /** @brief Draw several instances of this renderable with a single draw call.
+     *
+     * As for draw(), the shader program is already bound.
+     * @param buffer The vertex buffer storing the instance data.
+     * @param offset The offset in bytes of the data of the first instance in the buffer.
+     * @param instanceNumber The number of instances to draw.
+     */
+    void drawInstances( unsigned int buffer, std::size_t offset, unsigned int instanceNumber );
+
     //void displayTextInViewer(std::string text) const;
 
 private:
@@ -306,6 +404,21 @@ private:
      */
     virtual void afterAnimate( float time );
 
+    /**@brief Implementation of getMaterialKey(), no material by default. */
+    virtual const void* do_getMaterialKey() const;
+    /**@brief Implementation of getTextureKey(), no texture by default. */
+    virtual unsigned int do_getTextureKey() const;
+    /**@brief Implementation of getMeshKey(), the renderable itself by default. */
+    virtual const void* do_getMeshKey() const;
+    /**@brief Implementation of getLocalBounds(), an infinite box by default. */
+    virtual BoundingBox do_getLocalBounds() const;
+    /**@brief Implementation of getWorldBounds(), the local bounds transformed by the model matrix by default. */
+    virtual BoundingBox do_getWorldBounds() const;
+    /**@brief Implementation of getRenderableNumber(), 1 by default. */
+    virtual unsigned int do_getRenderableNumber() const;
+    /**@brief Implementation of isInstanceable(), false by default. */
+    virtual bool do_isInstanceable() const;
+
     Viewer* getViewer() const;
 
     
@@ -321,6 +434,16 @@ protected:
      */
     virtual void do_draw() = 0;
 
+    /** \brief Instanced draw virtual function.
+     *
+     * Implementation to draw instances of this renderable, only called if
+     * do_isInstanceable() returns true. Does nothing by default.
+     * \param buffer The vertex buffer storing the instance data.
+     * \param offset The offset in bytes of the data of the first instance.
+     * \param instanceNumber The number of instances to draw.
+     */
+    virtual void do_drawInstances( unsigned int buffer, std::size_t offset, unsigned int instanceNumber );
+
     /** \brief Animate virtual function.
      *
      * Implementation to animate this renderable.
@@ -352,6 +475,11 @@ protected:
 
     int m_priority;
     RENDER_MODE m_render_mode;
+    bool m_transparent;
+
+private:
+    mutable glm::mat4 m_normalMatrixModel; /*!< Model matrix of which \ref m_normalMatrix is the normal matrix. */
+    mutable glm::mat3 m_normalMatrix; /*!< Cached normal matrix, see getNormalMatrix(). */
 };
 
 typedef std::shared_ptr<Renderable> RenderablePtr; /*!< Typedef for smart pointer to renderable.*/
@@ -8,9 +8,11 @@
  * executed on the GPU to perform the rendering of a Renderable.
  */
 
+# include <map>
 # include <string>
 # include <memory>
 # include <unordered_map>
+# include <vector>
 
 /**@brief Assembly of the graphics pipeline programmable steps.
  *
@@ -30,6 +32,48 @@
  */
 class ShaderProgram{
 public:
+  /**@brief Name of a uniform, an attribute or a block, resolved once per program.
+   *
+   * Looking a location up by name builds and hashes a string at each call.
+   * A handle interns the name once, usually as a static variable of the file
+   * drawing with it, and every shader program resolves the locations of all
+   * the handles in an array after its introspection (again on reload):
+   * a lookup by handle is an array access.
+   * \code{.cpp}
+   * static const ShaderProgram::Handle model_handle( "modelMat" );
+   * // in the draw function
+   * int modelLocation = m_shaderProgram->getUniformLocation( model_handle );
+   * \endcode
+   */
+  class Handle
+  {
+  public:
+    /**@brief Intern a name.
+     *
+     * Handles of the same name share their index.
+     * @param name The uniform, attribute or block name, as it appear in the shader sources.
+     */
+    explicit Handle( const std::string& name );
+    /**@brief Index of the handle in the locations of a shader program. */
+    unsigned int index() const { return m_index; }
+    /**@brief The name of the handle. */
+    const std::string& name() const;
+  private:
+    unsigned int m_index;
+  };
+
+  /**@brief Preprocessor definitions of a shader program, by macro name.
+   *
+   * The definitions are added after the \#version directive of both shaders,
+   * so that the sources select the code of a permutation at compile time:
+   * \code{.cpp}
+   * ShaderProgram::Defines defines;
+   * defines[ "TEXTURED" ] = "";
+   * defines[ "NR_DIRECTIONAL_LIGHTS" ] = "1";
+   * \endcode
+   */
+  typedef std::map< std::string, std::string > Defines;
+
   /**@brief Construct a null shader program.
    *
    * Null shader program constructor. Perfectly valid shader program, but does
@@ -49,8 +93,36 @@ public:
    *
    * @param vertex_file_path Path to the vertex shader file
    * @param fragment_file_path Path to the fragment shader file.
+   * @param defines The preprocessor definitions of this permutation, see load().
    */
-  ShaderProgram(const std::string& vertex_file_path, const std::string& fragment_file_path );
+  ShaderProgram(const std::string& vertex_file_path, const std::string& fragment_file_path,
+                const Defines& defines = Defines() );
+
+  /**@brief Construct a shader program compiled in the background.
+   *
+   * See loadAsync(). Until its link completes, this shader program draws as
+   * the fallback program.
+   *
+   * @param vertex_file_path Path to the vertex shader file
+   * @param fragment_file_path Path to the fragment shader file.
+   * @param fallback A shader program already linked, e.g. a flat one.
+   * @param defines The preprocessor definitions of this permutation, see load().
+   */
+  ShaderProgram(const std::string& vertex_file_path, const std::string& fragment_file_path,
+                const std::shared_ptr< ShaderProgram >& fallback, const Defines& defines = Defines() );
+
+  /**@brief Get the shader program of some files and definitions, built once.
+   *
+   * A permutation is shared by all its users, e.g. the renderables with the
+   * same inputs, and built again once they all released it.
+   * @param vertex_file_path Path to the vertex shader file
+   * @param fragment_file_path Path to the fragment shader file.
+   * @param defines The preprocessor definitions of the permutation.
+   * @return The shader program of the permutation.
+   */
+  static std::shared_ptr< ShaderProgram > getPermutation( const std::string& vertex_file_path,
+                                                          const std::string& fragment_file_path,
+                                                          const Defines& defines );
 
   /** @brief Destruction
    *
@@ -64,17 +136,69 @@ public:
    * (compilation stage) and they describe a valid program (linking stage),
    * this shader program would be valid. Otherwise, this remains unchanged.
    *
+   * The sources are preprocessed first: an \#include "file" directive is
+   * replaced by the file, relative to the directory of the including file,
+   * unless it was already included. The definitions are added after the
+   * \#version directive. The \#line directives added give the compilation
+   * errors in the right file: the log names the files by source string number.
+   *
+   * When the binary cache is enabled (see setBinaryCacheDirectory()), a
+   * program linked once is saved as a driver specific binary, and the next
+   * loads of the same sources with the same driver read it instead of
+   * compiling the sources again. A binary the driver rejects is replaced.
+   *
+   * @param vertex_file_path Path to the vertex shader file
+   * @param fragment_file_path Path to the fragment shader file.
+   * @param defines The preprocessor definitions of this permutation.
+   */
+  void load(const std::string& vertex_file_path, const std::string& fragment_file_path,
+            const Defines& defines = Defines() );
+
+  /**@brief Load new shaders from source files, without waiting for their compilation.
+   *
+   * The compilation and the link are started and this returns at once, so
+   * that the programs of a scene are compiled together while the viewer
+   * draws. With the extension ARB_parallel_shader_compile, the driver
+   * compiles in its own threads. Otherwise, a thread with its own OpenGL
+   * context compiles the programs one after the other.
+   *
+   * Until poll() or wait() finds the link complete, this shader program
+   * keeps its current program, or draws as the fallback program if it has
+   * none. The introspection is done once the program is linked, and the
+   * version then changes. A program found in the binary cache is used at once.
+   *
    * @param vertex_file_path Path to the vertex shader file
    * @param fragment_file_path Path to the fragment shader file.
+   * @param fallback A shader program already linked, used until this one is ready. May be null.
+   * @param defines The preprocessor definitions of this permutation, see load().
+   */
+  void loadAsync(const std::string& vertex_file_path, const std::string& fragment_file_path,
+                 const std::shared_ptr< ShaderProgram >& fallback, const Defines& defines = Defines() );
+
+  /**@brief Use the program started by loadAsync() if its link is complete.
+   *
+   * Does not wait for the compilation. Called at each frame by the viewer
+   * for the programs it manages (see Viewer::addShaderProgram()).
+   * @return True if this shader program has no compilation in progress any more.
    */
-  void load(const std::string& vertex_file_path, const std::string& fragment_file_path );
+  bool poll();
+
+  /**@brief Wait for the program started by loadAsync(), and use it. */
+  void wait();
+
+  /**@brief Check if this shader program has no compilation in progress.
+   * @return False between loadAsync() and the poll() or wait() which finds the link complete.
+   */
+  bool isReady() const;
 
   /** @brief Reload the shader sources
    *
    * Reload existing shader sources into this shader program. This is useful
    * if you decide to modify the shader sources while you execute the binary.
    * This way, you can check, improve, debug shaders and see the results
-   * immediately on the screen.
+   * immediately on the screen. The files of the last load() or loadAsync()
+   * are loaded again, even if they failed to compile: a shader program still
+   * drawn as its fallback then gets its own program.
    *
    * \sa Viewer::reloadShaderPrograms()
    */
@@ -117,6 +241,22 @@ public:
    */
   int getAttributeLocation( const std::string& name ) const;
 
+  /**@brief Get the location of an uniform thanks to its handle.
+   *
+   * Same as getUniformLocation( handle.name() ), without building nor hashing a string.
+   * @param handle The handle of the uniform name.
+   * @return The uniform location, null_location if there is no uniform with such name in this program
+   */
+  int getUniformLocation( const Handle& handle ) const;
+
+  /**@brief Get the location of an attribute thanks to its handle.
+   *
+   * Same as getAttributeLocation( handle.name() ), without building nor hashing a string.
+   * @param handle The handle of the attribute name.
+   * @return The attribute location, null_location if there is no attribute with such name in this program
+   */
+  int getAttributeLocation( const Handle& handle ) const;
+
 
   /**@brief Get the identifier of this shader program.
    *
@@ -124,6 +264,60 @@ public:
    * @return The program ID. */
   unsigned int programId();
 
+  /**@brief Get the version of this shader program.
+   *
+   * The version changes each time a program is successfully linked into this
+   * shader program, e.g. by reload(), and is never shared with another shader
+   * program. The data depending on the locations of the program, such as the
+   * vertex array objects of the renderables (see VertexArray), compare it to
+   * the version they were built for to know when to rebuild.
+   * @return The version, 0 for a null shader program. */
+  unsigned int getVersion() const;
+
+  /**@brief Get the preprocessor definitions of the program currently linked.
+   *
+   * @return The definitions given to load() or loadAsync(), none until a
+   * program is linked, e.g. while the fallback is drawn. */
+  const Defines& getDefines() const;
+
+  /**@brief Check if this shader program declares a uniform block.
+   *
+   * @param name The name of the block, as it appear in the shader sources.
+   * @return True if the block is used by this shader program.
+   */
+  bool hasUniformBlock( const std::string& name ) const;
+
+  /**@brief Check if this shader program declares a uniform block, thanks to its handle.
+   *
+   * @param handle The handle of the block name.
+   * @return True if the block is used by this shader program.
+   */
+  bool hasUniformBlock( const Handle& handle ) const;
+
+  /**@brief Bind the uniform blocks of a given name to a binding point.
+   *
+   * The uniform block of this name of every shader program linked after this
+   * call reads its data from the uniform buffer bound to this binding point.
+   * This way, the data shared by all the programs is stored once in a buffer
+   * (see UniformBuffer) instead of being sent to each program.
+   * @param name The name of the block, as it appear in the shader sources.
+   * @param binding_point The uniform buffer binding point.
+   */
+  static void setUniformBlockBinding( const std::string& name, unsigned int binding_point );
+
+  /**@brief Set the directory of the program binary cache.
+   *
+   * The binaries are named after a hash of the shader sources and of the
+   * vendor, renderer and version of the driver, so that a change of any of
+   * them compiles the sources again. The directory is created at the first
+   * save. It is "shader_cache" by default, relative to the working directory.
+   * @param directory The cache directory, or an empty string to always compile the sources.
+   */
+  static void setBinaryCacheDirectory( const std::string& directory );
+
+  /**@brief Get the directory of the program binary cache, empty if the cache is disabled. */
+  static const std::string& getBinaryCacheDirectory();
+
   /**@brief Special value to represent a null location.
    *
    * Sometimes, you can ask for a uniform or an attribute that does not exist in
@@ -140,15 +334,47 @@ public:
    */
   static int null_location; 
 
+  /**@brief State of a program compiled in the background, see loadAsync(). */
+  struct PendingLink;
+
 private:
 
+  /** Use a linked program, checking its link status first if requested, and save its binary if key is not empty.
+   * If the link failed, the program is deleted and this shader program is unchanged. */
+  bool adopt_program( unsigned int program, bool check_status,
+                      const std::string& vertex_file_path, const std::string& fragment_file_path,
+                      const Defines& defines, const std::string& key );
+  /** Draw as the fallback program until the link in progress completes */
+  void use_fallback( const std::shared_ptr< ShaderProgram >& fallback );
+  /** Use the program of the fallback again if it linked another one since use_fallback() */
+  void refresh_fallback();
+  /** Remember the files and definitions to load, for reload() to retry them even if they fail */
+  void record_request( const std::string& vertex_file_path, const std::string& fragment_file_path,
+                       const Defines& defines );
+  /** Use the program linked in the background */
+  void finish_link();
+  /** Abandon the program being linked in the background, if any */
+  void cancel_link();
   void resources_introspection();
+  /** Resolve the locations of the handles created since the last call */
+  void resolve_handles() const;
 
   unsigned int m_programId;
+  unsigned int m_version;
   std::unordered_map< std::string, int > m_uniforms;
   std::unordered_map< std::string, int > m_attributes;
-  std::string m_vertexFilename;
+  std::unordered_map< std::string, int > m_uniformBlocks;
+  // locations of the handles, by handle index
+  mutable std::vector< int > m_uniformHandles;
+  mutable std::vector< int > m_attributeHandles;
+  mutable std::vector< bool > m_blockHandles;
+  std::string m_vertexFilename; /*!< Files of the last load() or loadAsync(), linked or not. */
   std::string m_fragmentFilename;
+  Defines m_requestedDefines; /*!< Definitions of the last load() or loadAsync(), linked or not. */
+  Defines m_defines; /*!< Definitions of the program linked. */
+  std::shared_ptr< PendingLink > m_pending; /*!< Program being linked in the background, null if none. */
+  std::shared_ptr< ShaderProgram > m_fallback; /*!< Program whose program id this one uses until m_pending is linked. */
+  unsigned int m_fallbackVersion; /*!< Version of \ref m_fallback when its program id was copied. */
 };
 
 typedef std::shared_ptr<ShaderProgram> ShaderProgramPtr; /*!< Typedef for a smart pointer of ShaderProgram */
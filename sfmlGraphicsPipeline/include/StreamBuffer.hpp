@@ -0,0 +1,105 @@
+#ifndef STREAM_BUFFER_HPP
+#define STREAM_BUFFER_HPP
+
+/** @file
+ * @brief Define a vertex buffer rewritten at each frame.
+ */
+
+#include <cstddef>
+#include <GL/glew.h>
+
+/** @brief A vertex buffer whose content is rewritten at each frame.
+ *
+ * Uploading per frame data with glBufferData() reallocates the GPU storage
+ * of the buffer and copies the data from a CPU array filled beforehand. This
+ * class lets the renderables write their per frame data (particle positions,
+ * spring ends, ...) straight into buffer memory, without reallocations:
+ *
+ * - when ARB_buffer_storage (OpenGL 4.4) is available, the buffer is mapped
+ * once and for all (persistent and coherent mapping) and split in
+ * StreamBuffer::regionNumber regions used in turn. A fence is placed after
+ * the draw calls reading a region, and we only wait for it before writing
+ * again into this region, frames later: the CPU writes a region while the
+ * GPU reads the previous ones;
+ * - otherwise, the buffer storage is orphaned and mapped at each frame: the
+ * driver gives fresh memory without waiting for the draw calls still reading
+ * the previous data.
+ *
+ * A typical use at each frame:
+ * \code{.cpp}
+ * glm::vec4* data = static_cast<glm::vec4*>( buffer.map( count * sizeof(glm::vec4) ) );
+ * // write the data
+ * buffer.unmap();
+ * glVertexAttribPointer( location, 4, GL_FLOAT, GL_FALSE, 0, (void*)buffer.getOffset() );
+ * // draw calls
+ * buffer.fence();
+ * \endcode
+ */
+class StreamBuffer
+{
+public:
+  /** @brief Number of regions of a persistently mapped buffer. */
+  static const unsigned int regionNumber = 3;
+
+  /** @brief Build an empty stream buffer.
+   *
+   * The GL buffer is created, the storage is allocated at the first call to map().
+   */
+  StreamBuffer();
+  ~StreamBuffer();
+
+  /** @brief Get memory to write the data of this frame.
+   *
+   * The buffer is bound to GL_ARRAY_BUFFER. The storage grows if needed.
+   * @param size The size in bytes of the data to write.
+   * @return A pointer to write the data to, valid until unmap().
+   */
+  void* map( std::size_t size );
+
+  /** @brief Finish writing the data of this frame. */
+  void unmap();
+
+  /** @brief Place a fence after the draw calls reading the data of this frame.
+   *
+   * The region written at this frame will not be written again before
+   * these draw calls are done.
+   */
+  void fence();
+
+  /** @brief Access to the GL buffer.
+   *
+   * @return The name of the GL buffer.
+   */
+  GLuint getBuffer() const;
+
+  /** @brief Access to the offset of the data of this frame.
+   *
+   * @return The offset in bytes of the data of this frame in the buffer.
+   */
+  std::size_t getOffset() const;
+
+  /** @brief Check if the buffer is persistently mapped.
+   *
+   * @return True if ARB_buffer_storage is used, false if the buffer is orphaned at each frame.
+   */
+  bool isPersistent() const;
+
+private:
+  StreamBuffer( const StreamBuffer& );
+  StreamBuffer& operator=( const StreamBuffer& );
+
+  /** @brief (Re)allocate the storage for regions of a given size. */
+  void allocate( std::size_t regionSize );
+  /** @brief Wait for the GPU to be done with a region. */
+  void wait( unsigned int region );
+
+  GLuint m_buffer;
+  bool m_persistent;
+  std::size_t m_regionSize;
+  unsigned int m_region;
+  /** Persistently mapped memory of the whole buffer. */
+  char* m_data;
+  GLsync m_fences[regionNumber];
+};
+
+#endif //STREAM_BUFFER_HPP
@@ -0,0 +1,90 @@
+#ifndef UNIFORM_BUFFER_HPP
+#define UNIFORM_BUFFER_HPP
+
+/** @file
+ * @brief Define a uniform buffer shared by all the shader programs.
+ */
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <GL/glew.h>
+
+/** @brief The data of a uniform block, shared by all the shader programs.
+ *
+ * Uniforms belong to a shader program: data used by all the programs, such as
+ * the camera matrices or the lights, has to be sent again to each program,
+ * looking up the locations of its fields by name. A uniform block is instead
+ * backed by a buffer: the data is uploaded once per frame into this buffer,
+ * which is bound to a binding point, and every program declaring the block
+ * reads it from there.
+ *
+ * The uniform buffer registers its binding point for its block name with
+ * ShaderProgram::setUniformBlockBinding(): the block of the programs linked
+ * afterwards is bound to it. The block should use the std140 layout, whose
+ * offsets are fixed by the standard, so that a C++ structure can mirror it.
+ * For instance, the block:
+ * \code{.glsl}
+ * layout(std140) uniform Camera
+ * {
+ *     mat4 projMat;
+ *     mat4 viewMat;
+ * };
+ * \endcode
+ * is filled with:
+ * \code{.cpp}
+ * struct CameraData { glm::mat4 projMat; glm::mat4 viewMat; };
+ * UniformBuffer camera( "Camera", 0 );
+ * CameraData data = { projectionMatrix, viewMatrix };
+ * camera.update( &data, sizeof(CameraData) );
+ * \endcode
+ *
+ * The GL buffer is created at the first update, so that a uniform buffer can
+ * be built before the OpenGL functions are loaded.
+ */
+class UniformBuffer
+{
+public:
+  /** @brief Build a uniform buffer for a block.
+   *
+   * @param blockName The name of the block in the shader sources.
+   * @param bindingPoint The uniform buffer binding point to use, unique to this block.
+   */
+  UniformBuffer( const std::string& blockName, unsigned int bindingPoint );
+  ~UniformBuffer();
+
+  /** @brief Upload the data of the block and bind the buffer to its binding point.
+   *
+   * The upload is skipped when the data did not change since the previous update.
+   * @param data The data, laid out as the block in the shaders.
+   * @param size The size in bytes of the data.
+   */
+  void update( const void* data, std::size_t size );
+
+  /** @brief Bind the buffer to its binding point.
+   *
+   * The binding is a state of the OpenGL context: this is needed to draw
+   * in another context sharing the buffer. update() binds the buffer.
+   */
+  void bind() const;
+
+  /** @brief Access to the name of the block. */
+  const std::string& getBlockName() const;
+  /** @brief Access to the binding point of the block. */
+  unsigned int getBindingPoint() const;
+  /** @brief Number of updates that uploaded data to the GPU. */
+  unsigned int getUploadNumber() const;
+
+private:
+  UniformBuffer( const UniformBuffer& );
+  UniformBuffer& operator=( const UniformBuffer& );
+
+  std::string m_blockName;
+  unsigned int m_bindingPoint;
+  GLuint m_buffer;
+  unsigned int m_uploadNumber;
+  /** Copy of the last uploaded data. */
+  std::vector< char > m_data;
+};
+
+#endif //UNIFORM_BUFFER_HPP
@@ -0,0 +1,94 @@
+#ifndef VERTEX_ARRAY_HPP
+#define VERTEX_ARRAY_HPP
+
+/** @file
+ * @brief Define a cache of vertex array objects.
+ */
+
+#include <vector>
+#include <GL/glew.h>
+#include <SFML/Config.hpp>
+
+class ShaderProgram;
+
+/** @brief The vertex array objects of a renderable, one per shader program.
+ *
+ * Specifying the vertex attributes of a renderable means, for each attribute,
+ * looking up its location in the shader program, binding its buffer and
+ * describing its format with glVertexAttribPointer(). A vertex array object
+ * (VAO) records this specification together with the element buffer binding,
+ * so that it is done once and a draw only needs to bind the VAO back.
+ *
+ * As the attribute locations depend on the shader program, a renderable keeps
+ * a VAO per shader program it is drawn with. A VAO is rebuilt when its shader
+ * program is reloaded (see ShaderProgram::getVersion()), since the locations
+ * may have changed. A renderable replacing one of its buffers by another one
+ * must call invalidate(), while updating the content of a buffer with
+ * glBufferData() keeps the VAOs valid.
+ *
+ * A VAO is a container object, not shared between OpenGL contexts: a
+ * renderable drawn both in the window and in the render texture of the viewer
+ * has a VAO per context, the cache being keyed by the active context too (see
+ * sf::Context::getActiveContextId()).
+ *
+ * A typical do_draw():
+ * \code{.cpp}
+ * if( m_vertexArray.bind( *m_shaderProgram ) )
+ * {
+ *   // look up the locations, enable the attribute arrays, bind the buffers
+ *   // and call glVertexAttribPointer()
+ * }
+ * // send the uniforms, draw
+ * VertexArray::unbind();
+ * \endcode
+ */
+class VertexArray
+{
+public:
+  /** @brief Build an empty cache. The VAOs are created on demand by bind(). */
+  VertexArray();
+  ~VertexArray();
+
+  /** @brief Bind the VAO of a shader program in the active context.
+   *
+   * @param program The shader program the renderable is drawn with.
+   * @return True if the VAO has just been created: the attributes must then be
+   * specified while it is bound. False if it is ready to draw.
+   */
+  bool bind( const ShaderProgram& program );
+
+  /** @brief Unbind any VAO, to restore the default vertex array state. */
+  static void unbind();
+
+  /** @brief Delete all the VAOs, they will be rebuilt at the next bind().
+   *
+   * The VAOs of the other contexts than the active one can not be deleted
+   * from it: they are rebuilt at their next bind() in their context.
+   */
+  void invalidate();
+
+  /** @brief Access to the number of VAOs built since the creation of the cache.
+   *
+   * @return The number of attribute specifications, that should stay small.
+   */
+  unsigned int getBuildNumber() const;
+
+private:
+  VertexArray( const VertexArray& );
+  VertexArray& operator=( const VertexArray& );
+
+  /** @brief The VAO of a program in a context, built for a given version of this program. */
+  struct Entry
+  {
+    const ShaderProgram* program;
+    sf::Uint64 context;
+    unsigned int version;
+    bool invalid;
+    GLuint vao;
+  };
+
+  std::vector< Entry > m_entries;
+  unsigned int m_buildNumber;
+};
+
+#endif //VERTEX_ARRAY_HPP
@@ -9,13 +9,21 @@
  */
 
 #include "Renderable.hpp"
+#include "RenderQueue.hpp"
+#include "Frustum.hpp"
 #include "Camera.hpp"
 #include "lighting/Light.hpp"
+#include "lighting/LightBlock.hpp"
+#include "lighting/ClusteredLighting.hpp"
+#include "lighting/DeferredShading.hpp"
+#include "UniformBuffer.hpp"
+#include "StreamBuffer.hpp"
+#include "FrameCapture.hpp"
 //#include "TextEngine.hpp"
 #include "FPSCounter.hpp"
 
 #include <unordered_set>
-#include <set>
+#include <vector>
 #include <memory>
 #include <string>
 #include <chrono>
@@ -28,12 +36,6 @@
 #include <glm/gtc/type_ptr.hpp>
 
 
-struct PriorityComparator
-{
-	bool operator()(const RenderablePtr & a, const RenderablePtr & b) const;
-};
-
-
 /**
  * \brief Manage the rendering and the interaction in a window.
  *
@@ -67,10 +69,18 @@ public:
      *
      * Construct a new viewer that will display the scene in a window of
      * specified size.
+     *
+     * A headless viewer opens no window: it draws in a framebuffer object of
+     * the same size, in an OpenGL context of its own. Its frames are only seen
+     * through saveFrame() or an image sequence (see setImageSequence()), e.g.
+     * to render an animation on a machine without display, with Mesa's
+     * software rasterizer on a virtual X server.
      * \param width Width of the window in pixel.
      * \param height Height of the window in pixel.
+     * \param color The background color.
+     * \param headless True to draw off screen, without window.
      */
-    Viewer(float width, float height, const glm::vec4 & color=glm::vec4(1.0,1.0,1.0,1.0));
+    Viewer(float width, float height, const glm::vec4 & color=glm::vec4(1.0,1.0,1.0,1.0), bool headless=false);
     /**@}*/
 
     /** @name Shader Program management
@@ -84,7 +94,9 @@ public:
      */
     /**@brief Manage a shader program.
      *
-     * Add a shader program to the list of managed programs.
+     * Add a shader program to the list of managed programs. A managed
+     * program compiled in the background (see ShaderProgram::loadAsync()) is
+     * polled at each frame, and waited for by a headless viewer.
      * @param program The shader program to manage.
      */
     void addShaderProgram( const ShaderProgramPtr & program );
@@ -108,14 +120,25 @@ public:
     bool isRunning() const;
     /**@brief Display the scene on the windows.
      *
-     * Display the scene stored in the framebuffer onto the window.
+     * Display the scene stored in the framebuffer onto the window. When an
+     * image sequence is rendered, the frame is saved first.
      */
     void display();
+    /**@brief Check if the viewer draws off screen, without window. */
+    bool isHeadless() const;
     /**\brief Draw the renderables.
      *
-     * Iterate over all the renderables of \ref m_renderables and call their Renderable::draw() function.
-     * For each renderable, the viewer will first bind its shader, send camera information to
-     * the GPU, draw the renderable and unbind its shader.
+     * Cull the renderables of \ref m_renderables out of the view of the camera (see
+     * isCulled()), sort the others with the render queue \ref m_renderQueue
+     * and call their Renderable::draw() function in this order. The shader program of a
+     * renderable is only bound when it differs from the program of the previous renderable.
+     * The batches of instanceable renderables sharing their state are drawn with a single
+     * instanced draw call, their model matrices written in \ref m_instanceBuffer.
+     *
+     * The camera matrices and the lights are uploaded once per frame in the uniform
+     * buffers of the blocks "Camera" and "Lights", shared by all the shader programs.
+     * The programs without these blocks still receive them as uniforms: the camera
+     * when they are bound and the lights, for the managed programs, at each frame.
      */
     void draw();
 
@@ -167,12 +190,81 @@ public:
      */
     void addRenderable( const RenderablePtr & r );
 
+    /**@brief Get the render queue.
+     *
+     * Access to the queue ordering the draws, e.g. to read the state switches
+     * of the last frame or to disable the state sorting.
+     * @return A reference to the viewer's render queue. */
+    RenderQueue& getRenderQueue();
+
+    /**@brief Check if a renderable is out of the view, and count it.
+     *
+     * A renderable whose world bounds (see Renderable::getWorldBounds()) do not
+     * intersect the view frustum of the current frame is culled: it is not drawn,
+     * nor are its children. The culled renderables and the drawn ones are counted,
+     * see getCulledRenderableNumber() and getDrawnRenderableNumber().
+     * @param renderable The renderable about to be drawn.
+     * @return True if the renderable should not be drawn.
+     */
+    bool isCulled( const Renderable& renderable );
+
+    /**@brief Enable or disable the frustum culling.
+     *
+     * When disabled, every renderable is drawn. This is useful to measure what
+     * the culling saves.
+     * @param onOff True to skip the renderables out of the view.
+     */
+    void setFrustumCulling( bool onOff );
+    /**@brief Check if the renderables out of the view are skipped. */
+    bool getFrustumCulling() const;
+    /**@brief View frustum of the camera at the current frame.
+     *
+     * A renderable made of several parts can use it to skip the parts out of
+     * the view, see StaticBatchRenderable.
+     */
+    const Frustum& getFrustum() const;
+
+    /**@brief Enable or disable the levels of detail.
+     *
+     * When disabled, the meshes with levels of detail (see
+     * MeshRenderable::generateLevelsOfDetail()) are always drawn at full
+     * resolution.
+     * @param onOff True to draw the simplified meshes far from the camera.
+     */
+    void setLevelsOfDetail( bool onOff );
+    /**@brief Check if the meshes far from the camera are simplified. */
+    bool getLevelsOfDetail() const;
+    /**@brief Size on screen, in pixels, of a unit length at a distance from the camera.
+     *
+     * @param distance The distance to the camera, positive.
+     * @return The number of pixels covered vertically by a unit length facing the camera.
+     */
+    float getPixelsPerUnit( float distance ) const;
+
+    /**@brief Number of renderables culled at the last frame, with their descendants. */
+    unsigned int getCulledRenderableNumber() const;
+    /**@brief Number of renderables drawn at the last frame, including the children of hierarchies. */
+    unsigned int getDrawnRenderableNumber() const;
+    /**@brief Number of frames drawn so far, the current one included.
+     *
+     * It stamps the data computed once per frame, e.g. the world bounds of a hierarchy.
+     */
+    unsigned int getFrameNumber() const;
+
     /**
      * @brief Take a screen shot.
      *
-     * Save a screenshot of the window in a PNG file in the directory containing the executable.
+     * Save the next displayed frame in a PNG file in the directory containing the executable.
      */
     void takeScreenshot();
+    /**@brief Save the frame drawn in the framebuffer to an image file.
+     *
+     * To be called between draw() and display(), in a window or headless.
+     * The frame is read back and the image written in the background by
+     * \ref m_frameCapture: the file may not exist yet when this returns.
+     * @param filename The path of the image, whose extension gives the format (e.g. png).
+     */
+    void saveFrame( const std::string & filename );
     /**@}*/
 
     /**@name Animation
@@ -212,6 +304,42 @@ public:
      * \param loopDuration Set \ref m_loopDuration value. 0.0 is the default value.
      */
     void setAnimationLoop(bool animationLoop, float loopDuration=0.0);
+
+    /** \brief Set a fixed frame rate to the animation clock.
+     *
+     * With a fixed frame rate, the animation time no longer follows the real
+     * time: it moves forward by 1/fps at each display(), so that the frame n
+     * after the start of the animation is animated at the time n/fps, however
+     * long the frames take to render. The animation is then deterministic.
+     * \param fps The number of frames per animation second, 0 to follow the real time.
+     */
+    void setFixedFrameRate(float fps);
+    /** \brief Get the fixed frame rate of the animation clock, 0 if it follows the real time. */
+    float getFixedFrameRate() const;
+
+    /** \brief Render the animation into an image sequence.
+     *
+     * Restart the animation with a fixed frame rate (see setFixedFrameRate()).
+     * The main loop then saves each frame at its display(), in the files
+     * basename00000.png, basename00001.png, etc., and stops running once the
+     * last frame is saved:
+     * \code{.cpp}
+     * Viewer viewer(1920, 1080, background, true);
+     * initialize_scene(viewer);
+     * viewer.setImageSequence("frames/scene", 240, 24.0f);
+     * while( viewer.isRunning() )
+     * {
+     *     viewer.handleEvent();
+     *     viewer.animate();
+     *     viewer.draw();
+     *     viewer.display();
+     * }
+     * \endcode
+     * \param basename The path prefix of the images.
+     * \param frameNumber The number of frames to render.
+     * \param fps The number of frames per animation second.
+     */
+    void setImageSequence(const std::string & basename, unsigned int frameNumber, float fps);
     /**@}*/
 
     void addDirectionalLight(const DirectionalLightPtr & directionalLight);
@@ -220,6 +348,38 @@ public:
 
     void addSpotLight(const SpotLightPtr & spotLight);
 
+    /**@brief Definitions of the number of lights of each kind in the scene.
+     *
+     * A lighted shader program built with them (see ShaderProgram::Defines
+     * and shaders/include/lights.glsl) loops over these numbers of lights
+     * known at compile time, instead of the numbers of the light block. It
+     * ignores the lights added afterwards.
+     * @return The definitions NR_DIRECTIONAL_LIGHTS, NR_POINT_LIGHTS and NR_SPOT_LIGHTS.
+     */
+    ShaderProgram::Defines getLightDefines() const;
+
+    /**@brief Definitions of a lighted shader program reading its point and spot lights from clusters.
+     *
+     * Such a program only evaluates the point and spot lights reaching the
+     * cluster of each fragment (see ClusteredLighting), with no limit on
+     * their number. The clusters are built each frame as long as a managed
+     * program uses them.
+     * @return The definition CLUSTERED_LIGHTS and NR_DIRECTIONAL_LIGHTS.
+     */
+    ShaderProgram::Defines getClusteredLightDefines() const;
+
+    /**@brief Definitions of a shader program drawing into the G-buffer of the deferred shading.
+     *
+     * The renderables drawn in the window with such a program (see
+     * phongFragment.glsl and flatFragment.glsl) are shaded once per pixel,
+     * after they are all drawn, by each light over the part of the screen it
+     * reaches (see DeferredShading). The other renderables are drawn
+     * afterwards, as usual. A scene switches to the deferred shading by
+     * building its opaque programs with these definitions.
+     * @return The definition DEFERRED_SHADING.
+     */
+    ShaderProgram::Defines getDeferredShadingDefines() const;
+
     void setBackgroundColor(const glm::vec4 & color);
 
     const glm::vec4 & getBackgroundColor() const;
@@ -274,14 +434,44 @@ private:
      */
     void mouseMoveEvent(sf::Event& e);
 
+    /**@brief Create the framebuffer object a headless viewer draws in. */
+    void createOffscreenFramebuffer();
+    /**@brief Draw in the framebuffer object of a headless viewer again, e.g. after a draw in \ref m_texture. */
+    void bindOffscreenFramebuffer();
+    /**@brief Size of the frames, in the window or off screen. */
+    sf::Vector2u getFrameSize() const;
+    /**@brief Draw the batches of \ref m_renderQueue drawn into the G-buffer, or the others.
+     * \param deferred True for the batches of the deferred shader programs, see getDeferredShadingDefines().
+     * \param instanceOffset Offset in \ref m_instanceBuffer of the instance data of the first instanced batch. */
+    void drawBatches(bool deferred, std::size_t instanceOffset);
 
     Camera m_camera; /*!< Camera used to render the scene in the Viewer. */
-    sf::RenderWindow m_window; /*!< Pointer to the render window. */
+    sf::RenderWindow m_window; /*!< Pointer to the render window, not created when headless. */
+    std::unique_ptr<sf::Context> m_offscreenContext; /*!< OpenGL context of a headless viewer, null otherwise. */
+    sf::Vector2u m_offscreenSize; /*!< Size of the frames of a headless viewer. */
+    unsigned int m_offscreenFramebuffer; /*!< Multisampled framebuffer object a headless viewer draws in. */
+    unsigned int m_offscreenColorBuffer;
+    unsigned int m_offscreenDepthBuffer;
+    unsigned int m_resolveFramebuffer; /*!< Single sampled copy of \ref m_offscreenFramebuffer, read by saveFrame(). */
+    unsigned int m_resolveColorBuffer;
     sf::RenderTexture m_texture; /*!< Pointer to the render texture. */
-    std::multiset< RenderablePtr, PriorityComparator> m_renderables; /*!< Ordered set of renderables that the viewer displays. */
+    std::vector< RenderablePtr > m_renderables; /*!< Renderables that the viewer displays, in the order they were added. */
+    RenderQueue m_renderQueue; /*!< Order of the draws of a frame, by priority and then by state. */
+    Frustum m_frustum; /*!< View frustum of the camera at the current frame. */
+    bool m_frustumCulling; /*!< True if the renderables out of \ref m_frustum are not drawn. */
+    unsigned int m_culledRenderableNumber; /*!< Number of renderables culled at the current frame. */
+    unsigned int m_drawnRenderableNumber; /*!< Number of renderables drawn at the current frame. */
+    unsigned int m_frameNumber; /*!< Number of frames drawn, see getFrameNumber(). */
+    bool m_levelsOfDetail; /*!< True if the meshes far from the camera are drawn simplified. */
     std::vector<DirectionalLightPtr> m_directionalLights; /*!< Vector of pointer to the directional light. */
     std::vector<PointLightPtr> m_pointLights; /*!< Vector of pointer to the point lights. */
     std::vector<SpotLightPtr> m_spotLights; /*!< Vector of pointer to the spot lights. */
+    UniformBuffer m_cameraBlock; /*!< Uniform buffer of the block "Camera": the projection and view matrices. */
+    LightBlock m_lightBlock; /*!< Uniform buffer of the block "Lights": the lights of the scene. */
+    ClusteredLighting m_clusteredLighting; /*!< The point and spot lights in the clusters of the view, for the clustered programs. */
+    DeferredShading m_deferredShading; /*!< The G-buffer and the lighting passes, for the deferred programs. */
+    std::unique_ptr<StreamBuffer> m_instanceBuffer; /*!< Instance data of the batches of the current frame, created once GLEW is initialized. */
+    std::unique_ptr<FrameCapture> m_frameCapture; /*!< Writes the screenshots and the recorded frames without stalling the rendering. */
 
 
     std::unordered_set< ShaderProgramPtr > m_programs;
@@ -296,12 +486,20 @@ private:
     float m_loopDuration; /*!< Duration of the animation loop in seconds. */
     float m_simulationTime; /*!< Current simulation time in the animation loop. */
     TimePoint m_lastSimulationTimePoint; /*!< Date of the last simulation. */
+    float m_frameRate; /*!< Fixed frame rate of the animation clock, 0 when it follows the real time. */
+    unsigned int m_fixedStepNumber; /*!< Frames displayed since the animation was reset, with a fixed frame rate. */
+    std::string m_sequenceBasename; /*!< Path prefix of the images of the sequence being rendered, empty if none. */
+    unsigned int m_sequenceFrameNumber; /*!< Number of frames of the image sequence. */
+    unsigned int m_sequenceFrameCounter; /*!< Number of frames of the image sequence already saved. */
     glm::vec4 m_background_color;
 
     glm::vec3 m_currentMousePosition; /*!< Current mouse cursor coordinates normalized between [-1,1]. The z-value is set to 1. */
     glm::vec3 m_lastMousePosition; /*!< Previous mouse cursor coordinates normalized between [-1,1]. The z-value is set to 1. */
 
     unsigned int m_screenshotCounter; /*!< Number of screenshots since the beginning of the application. */
+    bool m_screenshotRequested; /*!< True if the next displayed frame is saved as a screenshot. */
+    bool m_recording; /*!< True if every displayed frame is saved. */
+    unsigned int m_recordCounter; /*!< Number of frames recorded since the beginning of the application. */
 
     FPSCounter m_fpsCounter; /*!< A framerate counter */
     bool m_helpDisplayed;
@@ -0,0 +1,60 @@
+#ifndef BENDING_CONSTRAINT_HPP
+#define BENDING_CONSTRAINT_HPP
+
+#include "Constraint.hpp"
+
+/**@brief Constraint on the bending angle between two triangles.
+ *
+ * The triangles (p1, p2, p3) and (p2, p1, p4) share the edge (p1, p2). The
+ * constraint keeps their dihedral angle at its rest value, measured when the
+ * constraint is built: C(x) = angle(x) - angle0. The gradients of the angle
+ * are the ones of Bridson et al. ("Simulation of Clothing with Folds and
+ * Wrinkles", 2003).
+ */
+class BendingConstraint : public Constraint
+{
+public:
+  /**@brief Build a bending constraint at the current angle of the triangles.
+   *
+   * @param p1 The first particle of the shared edge.
+   * @param p2 The second particle of the shared edge.
+   * @param p3 The third particle of the first triangle.
+   * @param p4 The third particle of the second triangle.
+   * @param compliance The compliance (inverse stiffness) of this constraint.
+   */
+  BendingConstraint(const ParticlePtr p1, const ParticlePtr p2,
+                    const ParticlePtr p3, const ParticlePtr p4, float compliance = 0.0f);
+  ~BendingConstraint();
+
+  /**@brief Access to the rest angle of this constraint.
+   *
+   * @return The rest dihedral angle, in radians, 0 for flat triangles.
+   */
+  float getRestAngle() const;
+  /**@brief Set the rest angle of this constraint.
+   *
+   * @param restAngle The new rest dihedral angle, in radians.
+   */
+  void setRestAngle(float restAngle);
+
+  /**@brief Compute the dihedral angle of two triangles.
+   *
+   * @param x1 The first point of the shared edge.
+   * @param x2 The second point of the shared edge.
+   * @param x3 The third point of the first triangle.
+   * @param x4 The third point of the second triangle.
+   * @return The signed dihedral angle in [-pi, pi], 0 for flat triangles.
+   */
+  static float computeAngle(const glm::vec3& x1, const glm::vec3& x2,
+                            const glm::vec3& x3, const glm::vec3& x4);
+
+private:
+  void do_project(ParticleStore& store, float dt);
+
+  const ParticlePtr m_p1, m_p2, m_p3, m_p4;
+  float m_restAngle;
+};
+
+typedef std::shared_ptr<BendingConstraint> BendingConstraintPtr;
+
+#endif //BENDING_CONSTRAINT_HPP
@@ -0,0 +1,154 @@
+#ifndef BROAD_PHASE_HPP
+#define BROAD_PHASE_HPP
+
+#include <cmath>
+#include <memory>
+#include <utility>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "ParticleStore.hpp"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/**@brief A pair of particle indices that may be colliding.
+ *
+ * The indices refer to the particle arrays given to the broad phase. The
+ * first index is always lower than the second one.
+ */
+typedef std::pair<unsigned int, unsigned int> CandidatePair;
+
+/**@brief Check if the bounding boxes of two particles overlap.
+ *
+ * Check if the axis aligned bounding boxes of two spheres overlap. This is
+ * the test used by the broad phases to accept a candidate pair.
+ * @param x1 The center of the first sphere.
+ * @param r1 The radius of the first sphere.
+ * @param x2 The center of the second sphere.
+ * @param r2 The radius of the second sphere.
+ * @return True if the bounding boxes overlap.
+ */
+inline bool testBoundingBoxes(const glm::vec3& x1, float r1, const glm::vec3& x2, float r2)
+{
+    const float r = r1 + r2;
+    return std::abs(x1.x - x2.x) <= r
+        && std::abs(x1.y - x2.y) <= r
+        && std::abs(x1.z - x2.z) <= r;
+}
+
+/**@brief Collision broad phase interface.
+ *
+ * A broad phase quickly discards the pairs of particles that cannot collide,
+ * so that the exact (and more expensive) particle-particle test is only
+ * performed on a small set of candidate pairs. A broad phase never misses a
+ * colliding pair, but it can report pairs that are not colliding.
+ */
+class BroadPhase
+{
+public:
+    BroadPhase();
+    virtual ~BroadPhase();
+
+    /**@brief Compute the candidate pairs of colliding particles.
+     *
+     * Compute the pairs of particles whose axis aligned bounding boxes
+     * overlap. Those pairs still have to be checked with the exact test,
+     * e.g. testParticleParticle(). The vector of pairs is cleared first, but
+     * its memory is kept to avoid reallocations between simulation steps.
+     * The released entries of a store are never part of a pair.
+     * @param positions The particle positions.
+     * @param radii The particle radii, of the same size as positions.
+     * @param flags The particle flags (see ParticleStore::getFixed()), of the
+     * same size as positions.
+     * @param pairs The resulting candidate pairs.
+     */
+    void computePairs(const std::vector<glm::vec3>& positions,
+                      const std::vector<float>& radii,
+                      const std::vector<unsigned char>& flags,
+                      std::vector<CandidatePair>& pairs);
+
+    /**@brief Access to the number of threads of this broad phase.
+     *
+     * Get the number of threads this broad phase may use.
+     * @return The number of threads.
+     */
+    unsigned int getThreadCount() const;
+    /**@brief Set the number of threads of this broad phase.
+     *
+     * Define the number of threads this broad phase may use. The dynamic
+     * system sets it at each step according to its execution mode.
+     * @param threadCount The number of threads, 1 for a sequential execution.
+     */
+    void setThreadCount(unsigned int threadCount);
+
+protected:
+    /**@brief Collect the candidate pairs of each particle, possibly in parallel.
+     *
+     * Call particlePairs(i, pairs) for each particle i, which appends the
+     * candidate pairs of this particle. With several threads, each thread
+     * appends to its own vector, over a contiguous range of particles, and
+     * the vectors are then concatenated: the pairs are in the same order as
+     * with a sequential execution.
+     * @param n The number of particles.
+     * @param particlePairs The function computing the pairs of a particle.
+     * @param pairs The resulting candidate pairs.
+     */
+    template<typename ParticlePairs>
+    void collectPairs(unsigned int n, ParticlePairs particlePairs,
+                      std::vector<CandidatePair>& pairs);
+
+private:
+    /**@brief Candidate pairs computation implementation.
+     *
+     * The actual implementation of the candidate pairs computation, that
+     * should be done in derived classes. The vector of pairs is already empty,
+     * and the pairs should skip the particles flagged as RELEASED.
+     * @param positions The particle positions.
+     * @param radii The particle radii.
+     * @param flags The particle flags.
+     * @param pairs The resulting candidate pairs.
+     */
+    virtual void do_computePairs(const std::vector<glm::vec3>& positions,
+                                 const std::vector<float>& radii,
+                                 const std::vector<unsigned char>& flags,
+                                 std::vector<CandidatePair>& pairs) = 0;
+
+    unsigned int m_threadCount;
+    /**@brief Candidate pairs found by each thread. */
+    std::vector< std::vector<CandidatePair> > m_threadPairs;
+};
+
+template<typename ParticlePairs>
+void BroadPhase::collectPairs(unsigned int n, ParticlePairs particlePairs,
+                              std::vector<CandidatePair>& pairs)
+{
+    if(m_threadCount <= 1)
+    {
+        for(unsigned int i=0; i<n; ++i)
+            particlePairs(i, pairs);
+        return;
+    }
+
+    m_threadPairs.resize(m_threadCount);
+    #pragma omp parallel num_threads(m_threadCount)
+    {
+#ifdef _OPENMP
+        std::vector<CandidatePair>& threadPairs = m_threadPairs[omp_get_thread_num()];
+#else
+        std::vector<CandidatePair>& threadPairs = m_threadPairs[0];
+#endif
+        threadPairs.clear();
+        #pragma omp for schedule(static)
+        for(unsigned int i=0; i<n; ++i)
+            particlePairs(i, threadPairs);
+    }
+
+    for(const std::vector<CandidatePair>& threadPairs : m_threadPairs)
+        pairs.insert(pairs.end(), threadPairs.begin(), threadPairs.end());
+}
+
+typedef std::shared_ptr<BroadPhase> BroadPhasePtr;
+
+#endif //BROAD_PHASE_HPP
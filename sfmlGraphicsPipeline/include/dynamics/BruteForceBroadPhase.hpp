@@ -0,0 +1,26 @@
+#ifndef BRUTE_FORCE_BROAD_PHASE_HPP
+#define BRUTE_FORCE_BROAD_PHASE_HPP
+
+#include "BroadPhase.hpp"
+
+/**@brief Brute force broad phase.
+ *
+ * Test the bounding boxes of every pair of distinct particles. This is the
+ * O(n^2) approach: it is only interesting for a few particles, or as a
+ * reference to check the other broad phases.
+ */
+class BruteForceBroadPhase : public BroadPhase
+{
+public:
+    BruteForceBroadPhase();
+    ~BruteForceBroadPhase();
+private:
+    void do_computePairs(const std::vector<glm::vec3>& positions,
+                         const std::vector<float>& radii,
+                         const std::vector<unsigned char>& flags,
+                         std::vector<CandidatePair>& pairs);
+};
+
+typedef std::shared_ptr<BruteForceBroadPhase> BruteForceBroadPhasePtr;
+
+#endif //BRUTE_FORCE_BROAD_PHASE_HPP
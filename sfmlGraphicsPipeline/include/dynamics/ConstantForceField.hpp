@@ -52,6 +52,8 @@ class ConstantForceField : public ForceField
     private:
         void do_addForce();
         std::vector<ParticlePtr> m_particles;
+        /**@brief Indices of the influenced particles in their store. */
+        ParticleStoreIndices m_indices;
         glm::vec3 m_force;
 };
 
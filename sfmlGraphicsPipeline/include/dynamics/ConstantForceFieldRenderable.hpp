@@ -24,6 +24,8 @@ protected:
     ConstantForceFieldPtr m_forceField;
 
 private:
+    /**@brief Not instanceable: do_draw() updates the vertices. */
+    bool do_isInstanceable() const;
     void update_particle_positions();
 };
 
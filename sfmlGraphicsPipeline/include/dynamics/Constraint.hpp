@@ -0,0 +1,102 @@
+#ifndef CONSTRAINT_HPP
+#define CONSTRAINT_HPP
+
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "Particle.hpp"
+#include "ParticleStore.hpp"
+
+/**@brief Position constraint interface.
+ *
+ * Define an interface for a constraint on the positions of some particles,
+ * solved by a PositionBasedSolver instead of applying forces. A constraint is
+ * a function C(x) of the positions of its particles which should be null.
+ *
+ * The constraints are solved with XPBD (Macklin et al., "XPBD: Position-Based
+ * Simulation of Compliant Constrained Dynamics", 2016): the compliance is the
+ * inverse of the stiffness, so that a null compliance gives an infinitely stiff
+ * constraint, and the result does not depend on the number of iterations nor
+ * on the time step.
+ */
+class Constraint
+{
+public:
+  /**@brief Build a constraint on particles.
+   *
+   * @param particles The particles of this constraint.
+   * @param compliance The compliance (inverse stiffness) of this constraint.
+   */
+  Constraint(const std::vector<ParticlePtr>& particles, float compliance);
+  virtual ~Constraint();
+
+  /**@brief Access to the particles of this constraint.
+   *
+   * @return The particles of this constraint.
+   */
+  const std::vector<ParticlePtr>& getParticles() const;
+
+  /**@brief Access to the compliance of this constraint.
+   *
+   * @return The compliance, the inverse of the stiffness.
+   */
+  float getCompliance() const;
+  /**@brief Set the compliance of this constraint.
+   *
+   * @param compliance The new compliance, 0 for an infinitely stiff constraint.
+   */
+  void setCompliance(float compliance);
+
+  /**@brief Prepare the constraint for a new time step.
+   *
+   * Reset the Lagrange multiplier accumulated by the projections.
+   */
+  void initialize();
+
+  /**@brief Project the particles on this constraint.
+   *
+   * Move the particles of the store to reduce the violation of this
+   * constraint. Nothing is done if a particle is not in the store.
+   * @param store The store of the particles, whose positions are updated.
+   * @param dt The time step.
+   */
+  void project(ParticleStore& store, float dt);
+
+protected:
+  /**@brief Update the Lagrange multiplier of this constraint.
+   *
+   * Compute the XPBD update of the Lagrange multiplier, knowing the value
+   * of the constraint and the weighted norm of its gradient. The particles
+   * should then be moved by their inverse mass times their gradient times
+   * the returned update.
+   * @param value The value of the constraint.
+   * @param gradientNorm The sum over the particles of their inverse mass
+   * times the square norm of the gradient.
+   * @param dt The time step.
+   * @return The update of the Lagrange multiplier.
+   */
+  float updateMultiplier(float value, float gradientNorm, float dt);
+
+  /**@brief Inverse mass of a particle of the store.
+   *
+   * @return The inverse mass of the particle, null if it is fixed or sleeping.
+   */
+  float getInverseMass(const ParticleStore& store, unsigned int index) const;
+
+private:
+  /**@brief Project implementation.
+   *
+   * The actual implementation of the projection, called only when all the
+   * particles are in the store. This should be implemented in derived classes.
+   */
+  virtual void do_project(ParticleStore& store, float dt) = 0;
+
+  std::vector<ParticlePtr> m_particles;
+  float m_compliance;
+  float m_multiplier;
+};
+
+typedef std::shared_ptr<Constraint> ConstraintPtr;
+
+#endif //CONSTRAINT_HPP
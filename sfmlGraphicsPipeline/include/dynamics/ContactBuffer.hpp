@@ -0,0 +1,114 @@
+#ifndef CONTACT_BUFFER_HPP
+#define CONTACT_BUFFER_HPP
+
+#include <vector>
+
+#include "Collision.hpp"
+#include "Particle.hpp"
+#include "ParticleStore.hpp"
+#include "../Plane.hpp"
+
+/**@brief A contact between a particle and a plane obstacle.
+ *
+ * The indices refer to the particle store and to the plane obstacles of the
+ * dynamic system.
+ */
+struct ParticlePlaneContact
+{
+    unsigned int particle;
+    unsigned int plane;
+};
+
+/**@brief A contact between two particles.
+ *
+ * The indices refer to the particle store of the dynamic system.
+ */
+struct ParticleParticleContact
+{
+    unsigned int particle1;
+    unsigned int particle2;
+};
+
+/**@brief The contacts detected during a simulation step.
+ *
+ * Contacts are stored as plain structures in one array per kind of contact,
+ * instead of one collision object allocated per contact. The arrays keep
+ * their memory from one step to the next, so that detecting and solving the
+ * contacts does not allocate anything once the buffer is large enough.
+ *
+ * The Collision classes are still available: createCollisions() builds the
+ * collision objects of the contacts, for the code that works with them.
+ */
+class ContactBuffer
+{
+public:
+    ContactBuffer();
+    ~ContactBuffer();
+
+    /**@brief Remove all the contacts, but keep the memory. */
+    void clear();
+
+    /**@brief Reserve memory for a number of contacts.
+     *
+     * @param particlePlaneNumber The number of particle-plane contacts.
+     * @param particleParticleNumber The number of particle-particle contacts.
+     */
+    void reserve(unsigned int particlePlaneNumber, unsigned int particleParticleNumber);
+
+    /**@brief Add a particle-plane contact.
+     *
+     * @param particle The index of the particle in the store.
+     * @param plane The index of the plane obstacle.
+     */
+    void addParticlePlane(unsigned int particle, unsigned int plane);
+    /**@brief Add a particle-particle contact.
+     *
+     * @param particle1 The index of the first particle in the store.
+     * @param particle2 The index of the second particle in the store.
+     */
+    void addParticleParticle(unsigned int particle1, unsigned int particle2);
+
+    /**@brief Append the contacts of another buffer at the end of this one.
+     *
+     * @param contacts The contacts to append.
+     */
+    void append(const ContactBuffer& contacts);
+
+    const std::vector<ParticlePlaneContact>& getParticlePlaneContacts() const;
+    const std::vector<ParticleParticleContact>& getParticleParticleContacts() const;
+
+    /**@brief Access to the number of contacts.
+     *
+     * @return The total number of contacts of all kinds.
+     */
+    unsigned int size() const;
+
+    /**@brief Solve the contacts.
+     *
+     * Solve the contacts on the arrays of a particle store: the
+     * particle-plane contacts first, then the particle-particle contacts,
+     * each kind in the order of detection.
+     * @param store The store of the particles.
+     * @param planes The plane obstacles.
+     * @param restitution The restitution factor of the collisions.
+     */
+    void solve(ParticleStore& store, const std::vector<PlanePtr>& planes, float restitution) const;
+
+    /**@brief Build the collision objects of the contacts.
+     *
+     * Append to a vector one collision object per contact, in the order in
+     * which solve() handles them.
+     * @param particles The particles, indexed as in the store.
+     * @param planes The plane obstacles.
+     * @param restitution The restitution factor of the collisions.
+     * @param collisions The vector of collisions to append to.
+     */
+    void createCollisions(const std::vector<ParticlePtr>& particles, const std::vector<PlanePtr>& planes,
+                          float restitution, std::vector<CollisionPtr>& collisions) const;
+
+private:
+    std::vector<ParticlePlaneContact> m_particlePlaneContacts;
+    std::vector<ParticleParticleContact> m_particleParticleContacts;
+};
+
+#endif //CONTACT_BUFFER_HPP
@@ -0,0 +1,46 @@
+#ifndef CONTACT_SOLVER_HPP
+#define CONTACT_SOLVER_HPP
+
+#include <memory>
+#include <vector>
+
+#include "ContactBuffer.hpp"
+#include "ParticleStore.hpp"
+#include "../Plane.hpp"
+
+/**@brief Contact solver interface.
+ *
+ * A contact solver resolves the contacts detected by the dynamic system at
+ * the end of a simulation step, once the particles have been integrated. It
+ * updates the positions and the velocities of the particles in the store.
+ */
+class ContactSolver
+{
+public:
+    ContactSolver();
+    virtual ~ContactSolver();
+
+    /**@brief Solve the contacts.
+     *
+     * @param store The store of the particles.
+     * @param contacts The contacts detected during this step.
+     * @param planes The plane obstacles, indexed as in the contacts.
+     * @param restitution The restitution factor of the collisions.
+     * @param dt The time step of the simulation.
+     */
+    void solve(ParticleStore& store, const ContactBuffer& contacts,
+               const std::vector<PlanePtr>& planes, float restitution, float dt);
+
+private:
+    /**@brief Solve implementation.
+     *
+     * The actual implementation to solve the contacts. This should be
+     * implemented in derived classes.
+     */
+    virtual void do_solve(ParticleStore& store, const ContactBuffer& contacts,
+                          const std::vector<PlanePtr>& planes, float restitution, float dt) = 0;
+};
+
+typedef std::shared_ptr<ContactSolver> ContactSolverPtr;
+
+#endif //CONTACT_SOLVER_HPP
@@ -51,7 +51,13 @@ class DampingForceField : public ForceField
 
     private:
         void do_addForce();
+        void do_addForceDifferential(const ParticleStore& store,
+                                     const std::vector<glm::vec3>& dx,
+                                     const std::vector<glm::vec3>& dv,
+                                     std::vector<glm::vec3>& df);
         std::vector<ParticlePtr> m_particles;
+        /**@brief Indices of the influenced particles in their store. */
+        ParticleStoreIndices m_indices;
         float m_damping;
 };
 
@@ -0,0 +1,50 @@
+#ifndef DISTANCE_CONSTRAINT_HPP
+#define DISTANCE_CONSTRAINT_HPP
+
+#include "Constraint.hpp"
+
+/**@brief Constraint on the distance between two particles.
+ *
+ * This constraint keeps two particles at a rest distance: it is the position
+ * based equivalent of a SpringForceField, whose stiffness does not limit the
+ * time step. C(x) = |x1 - x2| - l0.
+ */
+class DistanceConstraint : public Constraint
+{
+public:
+  /**@brief Build a distance constraint.
+   *
+   * @param p1 The first particle of this constraint.
+   * @param p2 The second particle of this constraint.
+   * @param restLength The rest distance between the particles.
+   * @param compliance The compliance (inverse stiffness) of this constraint.
+   */
+  DistanceConstraint(const ParticlePtr p1, const ParticlePtr p2, float restLength, float compliance = 0.0f);
+  ~DistanceConstraint();
+
+  /**@brief Access to the first particle of this constraint. */
+  ParticlePtr getParticle1() const;
+  /**@brief Access to the second particle of this constraint. */
+  ParticlePtr getParticle2() const;
+
+  /**@brief Access to the rest length of this constraint.
+   *
+   * @return The rest distance between the particles.
+   */
+  float getRestLength() const;
+  /**@brief Set the rest length of this constraint.
+   *
+   * @param restLength The new rest distance between the particles.
+   */
+  void setRestLength(float restLength);
+
+private:
+  void do_project(ParticleStore& store, float dt);
+
+  const ParticlePtr m_p1, m_p2;
+  float m_restLength;
+};
+
+typedef std::shared_ptr<DistanceConstraint> DistanceConstraintPtr;
+
+#endif //DISTANCE_CONSTRAINT_HPP
@@ -3,10 +3,14 @@
 
 #include <vector>
 
-#include "Collision.hpp"
+#include "BroadPhase.hpp"
+#include "ContactBuffer.hpp"
+#include "ContactSolver.hpp"
+#include "Constraint.hpp"
 #include "ForceField.hpp"
 #include "Particle.hpp"
 #include "Solver.hpp"
+#include "SpringForceAccumulator.hpp"
 #include "../Plane.hpp"
 
 /**@brief A dynamic system.
@@ -28,12 +32,51 @@ private:
    */
     std::vector<ParticlePtr> m_particles;
 
+    /**@brief The state of the particles managed by this system.
+     *
+     * The positions, velocities, forces, masses, radii and fixed flags of the
+     * particles, stored in contiguous arrays. The particles of m_particles
+     * are sorted by their index in this store: as long as no particle left
+     * the store, the i-th particle is a handle to the i-th entry.
+     */
+    ParticleStorePtr m_store;
+    /**@brief The version of m_store when m_particles was last updated.
+     *
+     * When the store changed without this system knowing it, some particles
+     * may have been added to another system: their handles are dropped from
+     * m_particles.
+     */
+    unsigned int m_storeVersion;
+
     /**@brief The set of force fields influencing particles of this system.
      *
      * The force fields that influence the particles of this system.
      */
     std::vector<ForceFieldPtr> m_forceFields;
 
+    /**@brief Accumulator of the spring forces in parallel mode.
+     *
+     * In parallel mode, the spring force fields of m_forceFields are not
+     * called one by one: their forces are accumulated by this object, without
+     * write conflicts between threads. The other force fields are stored in
+     * m_otherForceFields.
+     */
+    SpringForceAccumulator m_springAccumulator;
+    std::vector<ForceFieldPtr> m_otherForceFields;
+    /**@brief A flag set when m_forceFields changed.
+     *
+     * The force fields are sorted again between m_springAccumulator and
+     * m_otherForceFields at the next parallel step.
+     */
+    bool m_forceFieldsChanged;
+
+    /**@brief The set of position constraints of this system.
+     *
+     * The constraints between particles of this system, solved by a
+     * PositionBasedSolver. The other solvers ignore them.
+     */
+    std::vector<ConstraintPtr> m_constraints;
+
     /**@brief The set of fixed plane obstacles.
      *
      * The set of obstacles that would repel the particles after collisions.
@@ -56,13 +99,56 @@ private:
      */
     float m_dt;
 
-    /**@brief The set of collision events detected during a simulation step.
+    /**@brief The set of contacts detected during a simulation step.
      *
-     * Set of collision events between dynamic components during a simulation
-     * step. Those events would be resolved by updating velocities and positions
-     * of dynamic objects to avoid inter-penetration.
+     * Set of contacts between dynamic components during a simulation
+     * step. Those contacts would be resolved by updating velocities and positions
+     * of dynamic objects to avoid inter-penetration. The buffer keeps its
+     * memory between steps.
      */
-    std::vector<CollisionPtr> m_collisions;
+    ContactBuffer m_contacts;
+
+    /**@brief The broad phase of the collision detection.
+     *
+     * The broad phase computes the pairs of particles that may collide, so
+     * that the exact particle-particle test is not done for every pair of
+     * particles.
+     */
+    BroadPhasePtr m_broadPhase;
+
+    /**@brief The solver of the contacts.
+     *
+     * The contact solver updates the positions and velocities of the particles
+     * to resolve the contacts detected at each step.
+     */
+    ContactSolverPtr m_contactSolver;
+
+    /**@brief Candidate pairs of colliding particles.
+     *
+     * The pairs of particles computed by the broad phase at the last step.
+     * This vector is kept between steps to avoid reallocations.
+     */
+    std::vector<CandidatePair> m_candidatePairs;
+
+    /**@brief Contacts detected by each thread in parallel mode.
+     *
+     * Each thread detects the contacts of a contiguous range of particles
+     * or candidate pairs, then the contacts are gathered in m_contacts in
+     * the thread order: they are in the same order as in sequential mode.
+     */
+    std::vector<ContactBuffer> m_threadContacts;
+
+    /**@brief A flag to activate/desactivate the parallel execution.
+     *
+     * If set to true, the force fields, the solver and the collision
+     * detection are run on several threads (with OpenMP).
+     */
+    bool m_parallel;
+    /**@brief Number of threads used in parallel mode.
+     *
+     * A null value means all the threads available to OpenMP.
+     */
+    unsigned int m_threadCount;
 
     /**@brief A flag to activate/desactivate collision detection.
      *
@@ -85,7 +171,10 @@ public:
 
     /**@brief Add a particle to the system.
      *
-     * Add a particle to this dynamic system.
+     * Add a particle to this dynamic system. The state of the particle is
+     * moved into the store of this system, so a particle should belong to
+     * only one dynamic system: a particle added to another system leaves this
+     * one, and the next particle added here takes its entry in the store.
      * @param p The particle to add to this system.
      */
     void addParticle(ParticlePtr p);
@@ -95,6 +184,13 @@ public:
      * @param forceField The force field to add to this system.
      */
     void addForceField(ForceFieldPtr forceField);
+    /**@brief Add a position constraint to the system.
+     *
+     * Add a constraint between particles of this system. Constraints are
+     * only solved by a PositionBasedSolver.
+     * @param constraint The constraint to add to this system.
+     */
+    void addConstraint(ConstraintPtr constraint);
     /**@brief Add a plane obstacle to the system.
      *
      * Add an infinite plane obstacle to the dynamic system. If collisions
@@ -116,6 +212,35 @@ public:
      */
     void setSolver(SolverPtr solver);
 
+    /**@brief Access to the broad phase of the collision detection.
+     *
+     * Get the broad phase used to find the pairs of particles that may collide.
+     * @return The current broad phase.
+     */
+    BroadPhasePtr getBroadPhase();
+    /**@brief Set a new broad phase for the collision detection.
+     *
+     * Define the broad phase used to find the pairs of particles that may
+     * collide. A uniform grid is used by default.
+     * @param broadPhase The new broad phase to use.
+     */
+    void setBroadPhase(BroadPhasePtr broadPhase);
+
+    /**@brief Access to the contact solver.
+     *
+     * Get the solver used to resolve the contacts detected at each step.
+     * @return The current contact solver.
+     */
+    ContactSolverPtr getContactSolver();
+    /**@brief Set a new contact solver.
+     *
+     * Define the solver used to resolve the contacts detected at each step. A
+     * SinglePassContactSolver is used by default. The particles put to sleep
+     * by the previous contact solver are woken up.
+     * @param contactSolver The new contact solver to use.
+     */
+    void setContactSolver(ContactSolverPtr contactSolver);
+
     /**@brief Check if the collision detection is activated.
      *
      * Check if the collision are currently handled by this dynamic system.
@@ -125,16 +250,61 @@ public:
     /**@brief Set the collision detection mode.
      *
      * Define if the collisions are detected/handled by this dynamic system.
+     * The sleeping particles are woken up when the collisions are disabled.
      * @param onOff True if the collision should be detected/handled.
      */
     void setCollisionsDetection(bool onOff);
 
+    /**@brief Access to the contacts of the last simulation step.
+     *
+     * Get the contacts detected and solved at the last simulation step. Use
+     * ContactBuffer::createCollisions() to get them as collision objects.
+     * @return The contacts of the last step.
+     */
+    const ContactBuffer& getContacts() const;
+
+    /**@brief Check if the parallel execution is activated.
+     *
+     * Check if the simulation steps are computed on several threads.
+     * @return True if the simulation steps are computed in parallel.
+     */
+    bool getParallel() const;
+    /**@brief Set the execution mode.
+     *
+     * Define if the simulation steps are computed on several threads. The
+     * force fields, the integration and the collision detection are then
+     * split across threads. The collisions are still solved sequentially.
+     * @param onOff True if the simulation steps should be computed in parallel.
+     */
+    void setParallel(bool onOff);
+
+    /**@brief Access to the number of threads of the parallel mode.
+     *
+     * Get the number of threads used in parallel mode.
+     * @return The number of threads, a null value meaning all the available threads.
+     */
+    unsigned int getThreadCount() const;
+    /**@brief Set the number of threads of the parallel mode.
+     *
+     * Define the number of threads used in parallel mode.
+     * @param threadCount The number of threads, or zero to use all the threads
+     * available to OpenMP (see the OMP_NUM_THREADS environment variable).
+     */
+    void setThreadCount(unsigned int threadCount);
+
     /**@brief Access to the set of particles of this system.
      *
-     * Get the set of particles of this dynamic system.
+     * Get the set of particles of this dynamic system. The particles that
+     * were added to another system since are not part of it anymore.
      * @return The set of particles of this system.
      */
-    const std::vector<ParticlePtr>& getParticles() const;
+    const std::vector<ParticlePtr>& getParticles();
+    /**@brief Access to the state of the particles of this system.
+     *
+     * Get the store holding the state of the particles of this system.
+     * @return The particle store of this system.
+     */
+    const ParticleStorePtr& getStore() const;
     /**@brief Set the particles of this system.
      *
      * Define a new set of particles for this dynamic system.
@@ -155,6 +325,25 @@ public:
      */
     void setForceFields(const std::vector<ForceFieldPtr> &forceFields);
 
+    /**@brief Access to the position constraints of this system.
+     *
+     * Get the set of position constraints of this system.
+     * @return The set of constraints of this system.
+     */
+    const std::vector<ConstraintPtr>& getConstraints() const;
+    /**@brief Set the position constraints of this system.
+     *
+     * Define a new set of position constraints for this dynamic system.
+     * @param constraints The new set of constraints of this dynamic system.
+     */
+    void setConstraints(const std::vector<ConstraintPtr>& constraints);
+
+    /**@brief Access to the plane obstacles of this system.
+     *
+     * @return The set of plane obstacles of this system.
+     */
+    const std::vector<PlanePtr>& getPlaneObstacles() const;
+
 
     /**@brief Compute a simulation step for this system.
      *
@@ -163,6 +352,28 @@ public:
      */
     void computeSimulationStep();
 
+    /**@brief Compute the forces of the particles.
+     *
+     * Reset the forces of the particles, then add the forces of all the
+     * force fields at the current state of the particles. This is done at
+     * the beginning of each simulation step, and can be called again by the
+     * solvers that need the forces at other states.
+     */
+    void computeForces();
+    /**@brief Add the differentials of the forces of the particles.
+     *
+     * Add to df the variation of the forces when the positions and velocities
+     * of the particles vary by dx and dv (see ForceField::addForceDifferential()).
+     * This is used by the implicit solvers. The vectors are indexed as the
+     * particles of the store.
+     * @param dx The variation of the particle positions.
+     * @param dv The variation of the particle velocities.
+     * @param df The variation of the particle forces, to add to.
+     */
+    void addForceDifferentials(const std::vector<glm::vec3>& dx,
+                               const std::vector<glm::vec3>& dv,
+                               std::vector<glm::vec3>& df);
+
     /**@brief Access to the collision restitution factor.
      *
      * Get the current collision restitution factor of this system.
@@ -197,7 +408,11 @@ public:
     void clear();
 
 private:
-    void detectCollisions();
+    void clearParticles();
+    void dropReleasedParticles();
+    unsigned int computeThreadCount() const;
+    void sortForceFields();
+    void detectCollisions(unsigned int threadCount);
     void solveCollisions();
 };
 
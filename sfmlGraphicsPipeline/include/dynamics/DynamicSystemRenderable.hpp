@@ -36,15 +36,70 @@ public:
      */
     void setDynamicSystem(const DynamicSystemPtr &system);
 
+    /**@brief Access to the maximal number of simulation steps per frame.
+     *
+     * Get the maximal number of simulation steps computed in one frame.
+     * @return The maximal number of steps per frame.
+     */
+    unsigned int getMaxSubsteps() const;
+    /**@brief Set the maximal number of simulation steps per frame.
+     *
+     * When a frame takes too long, the simulation has to compute many steps
+     * to catch up with the time, which makes the next frame even longer. To
+     * avoid this spiral, at most this number of steps are computed per frame:
+     * the remaining steps are dropped and the simulation slows down.
+     * @param maxSubsteps The new maximal number of steps per frame.
+     */
+    void setMaxSubsteps(unsigned int maxSubsteps);
+
+    /**@brief Access to the number of simulation steps of the last frame.
+     *
+     * @return The number of steps computed at the last frame.
+     */
+    unsigned int getSubstepNumber() const;
+    /**@brief Access to the number of dropped simulation steps.
+     *
+     * Get the number of steps that were not computed since the simulation
+     * started, because of the maximal number of steps per frame.
+     * @return The number of dropped steps.
+     */
+    unsigned int getDroppedStepNumber() const;
+
+    /**@brief Access to the interpolation factor between the last two steps.
+     *
+     * The time of a frame is usually between two simulation steps. This
+     * factor, between 0 and 1, locates the frame time between the previous
+     * step and the last step. It can be used to render smooth positions.
+     * @return The interpolation factor.
+     */
+    float getInterpolationAlpha() const;
+    /**@brief Access to the interpolated positions of the particles.
+     *
+     * Get the positions of the particles of the system at the time of the
+     * frame, interpolated between the last two simulation steps. They are
+     * indexed as the particles of the store of the system.
+     * @return The interpolated positions.
+     */
+    const std::vector<glm::vec3>& getInterpolatedPositions() const;
+    /**@brief Access to the interpolated position of a particle.
+     *
+     * @param particle A particle.
+     * @return The interpolated position of the particle if it belongs to the
+     * system, its current position otherwise.
+     */
+    glm::vec3 getInterpolatedPosition(const ParticlePtr& particle) const;
+
 protected:
     void do_draw();
     /**@brief Update the dynamic system.
      *
      * This function will update the managed dynamic system, i.e. compute the
      * new positions and velocities of the particles. This update will be
-     * actually done only if the last time the system was updated was more
-     * than m_sytem->m_dt ago. This allows us to update the dynamic system
-     * at the specified time interval.
+     * actually done with a fixed time step: the time elapsed since the
+     * last frame is accumulated, and as many steps as fit in the accumulated
+     * time are computed (but no more than the maximal number of steps per
+     * frame). The remaining time is carried to the next frame, so that the
+     * simulation follows the time whatever the frame rate.
      */
     void do_animate( float time );
 
@@ -53,6 +108,7 @@ private:
     /**@brief Handle key pressed.
      *
      * If the key A is pressed, the collision detected is toggled.
+     * If the key P is pressed, the parallel execution is toggled.
      * If the key T is pressed, particles are titled in random directions.
      * If the key F5 is pressed, the particles are restarted.
      * Other key pressed are transmitted to the children of this renderable.
@@ -71,12 +127,27 @@ private:
      * the simulation steps and to handle use input events.
      */
     DynamicSystemPtr m_system;
-    /**@brief Last time the dynamic system was updated.
+    /**@brief Time of the last frame.
      *
-     * Store the last time the dynamic system was updated. This is used to
-     * keep updating the dynamic system at the specified time interval.
+     * Store the time of the last call to do_animate(), to know the time
+     * elapsed between two frames.
      */
     float m_lastUpdateTime;
+    /**@brief Time not simulated yet.
+     *
+     * The time elapsed since the last simulation step, always lower than
+     * the time step of the system after a frame.
+     */
+    float m_accumulatedTime;
+    unsigned int m_maxSubsteps;
+    unsigned int m_substepNumber;
+    unsigned int m_droppedStepNumber;
+    /**@brief True if steps were dropped at the last frame, to warn only once. */
+    bool m_droppingSteps;
+    /**@brief Positions of the particles before the last simulation step. */
+    std::vector<glm::vec3> m_previousPositions;
+    /**@brief Positions of the particles at the time of the last frame. */
+    std::vector<glm::vec3> m_interpolatedPositions;
 };
 
 typedef std::shared_ptr<DynamicSystemRenderable> DynamicSystemRenderablePtr;
@@ -5,7 +5,9 @@
 
 /**@brief Explicit Euler solver.
  *
- * Explicit Euler dynamic system solver.
+ * Explicit Euler dynamic system solver. The velocities are updated before
+ * the positions, which makes it the symplectic Euler scheme described by
+ * SymplecticEulerSolver.
  */
 class EulerExplicitSolver : public Solver
 {
@@ -13,7 +15,7 @@ public:
     EulerExplicitSolver();
     ~EulerExplicitSolver();
 private:
-    void do_solve(const float& dt, std::vector<ParticlePtr>& particles);
+    void do_solve(const float& dt, DynamicSystem& system);
 };
 
 typedef std::shared_ptr<EulerExplicitSolver> EulerExplicitSolverPtr;
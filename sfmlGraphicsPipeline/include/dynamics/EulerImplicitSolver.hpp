@@ -0,0 +1,88 @@
+#ifndef EULER_IMPLICIT_SOLVER_HPP
+#define EULER_IMPLICIT_SOLVER_HPP
+
+#include "Solver.hpp"
+
+/**@brief Implicit (backward) Euler solver.
+ *
+ * The new velocities are computed with the forces at the end of the step:
+ * v(t+dt) = v(t) + dt*f(x(t+dt),v(t+dt))/m
+ * x(t+dt) = x(t) + dt*v(t+dt)
+ * The forces are linearized around the current state, as in "Large Steps in
+ * Cloth Simulation" (Baraff and Witkin, 1998), which gives a linear system on
+ * the velocity change dv:
+ * (M - dt*df/dv - dt^2*df/dx) dv = dt*(f + dt*df/dx v)
+ *
+ * This system is solved with a conjugate gradient. The matrix is never built:
+ * its products with vectors are computed by the force fields, see
+ * DynamicSystem::addForceDifferentials(). This scheme is unconditionally
+ * stable for springs, so stiff cloths can be simulated with large time steps,
+ * at the price of some numerical damping.
+ */
+class EulerImplicitSolver : public Solver
+{
+public:
+    /**@brief Build an implicit Euler solver.
+     *
+     * @param maxIterations The maximal number of conjugate gradient iterations.
+     * @param tolerance The conjugate gradient stops when the residual is below
+     * this tolerance, relatively to the right hand side of the system.
+     */
+    EulerImplicitSolver(unsigned int maxIterations = 100, float tolerance = 1e-4f);
+    ~EulerImplicitSolver();
+
+    /**@brief Access to the maximal number of conjugate gradient iterations.
+     *
+     * @return The maximal number of iterations.
+     */
+    unsigned int getMaxIterations() const;
+    /**@brief Set the maximal number of conjugate gradient iterations.
+     *
+     * @param maxIterations The new maximal number of iterations.
+     */
+    void setMaxIterations(unsigned int maxIterations);
+
+    /**@brief Access to the tolerance of the conjugate gradient.
+     *
+     * @return The relative tolerance on the residual.
+     */
+    float getTolerance() const;
+    /**@brief Set the tolerance of the conjugate gradient.
+     *
+     * @param tolerance The new relative tolerance on the residual.
+     */
+    void setTolerance(float tolerance);
+
+    /**@brief Access to the number of iterations of the last step.
+     *
+     * @return The number of conjugate gradient iterations done at the last step.
+     */
+    unsigned int getIterationNumber() const;
+
+private:
+    void do_solve(const float& dt, DynamicSystem& system);
+
+    /**@brief Compute the product of the system matrix with a vector.
+     *
+     * Compute Ap = (M - dt*df/dv - dt^2*df/dx) p, with a null result for the
+     * fixed particles.
+     */
+    void multiply(DynamicSystem& system, float dt,
+                  const std::vector<glm::vec3>& p, std::vector<glm::vec3>& Ap);
+
+    unsigned int m_maxIterations;
+    float m_tolerance;
+    unsigned int m_iterationNumber;
+
+    /**@brief Vectors of the conjugate gradient, kept to avoid reallocations. */
+    std::vector<glm::vec3> m_deltaVelocities;
+    std::vector<glm::vec3> m_residual;
+    std::vector<glm::vec3> m_direction;
+    std::vector<glm::vec3> m_product;
+    std::vector<glm::vec3> m_dx;
+    std::vector<glm::vec3> m_dv;
+};
+
+typedef std::shared_ptr<EulerImplicitSolver> EulerImplicitSolverPtr;
+
+#endif //EULER_IMPLICIT_SOLVER_HPP
@@ -2,6 +2,10 @@
 #define FORCE_FIELD_HPP
 
 #include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "ParticleStore.hpp"
 
 /**@brief Force field interface.
  *
@@ -19,6 +23,37 @@ public:
    * Add a force to the particles influenced by this force field.
    */
   void addForce();
+
+  /**@brief Add the differential of the forces.
+   *
+   * Add to df the variation of the forces of this field when the positions
+   * and velocities of the particles vary by dx and dv, i.e.
+   * df += (df/dx) dx + (df/dv) dv at the current state of the particles.
+   * This is used by the implicit solvers. The vectors are indexed as the
+   * particles of the store.
+   * @param store The store of the particles.
+   * @param dx The variation of the particle positions.
+   * @param dv The variation of the particle velocities.
+   * @param df The variation of the particle forces, to add to.
+   */
+  void addForceDifferential(const ParticleStore& store,
+                            const std::vector<glm::vec3>& dx,
+                            const std::vector<glm::vec3>& dv,
+                            std::vector<glm::vec3>& df);
+
+  /**@brief Access to the number of threads of this force field.
+   *
+   * Get the number of threads this force field may use to add its forces.
+   * @return The number of threads.
+   */
+  unsigned int getThreadCount() const;
+  /**@brief Set the number of threads of this force field.
+   *
+   * Define the number of threads this force field may use to add its forces.
+   * The dynamic system sets it at each step according to its execution mode.
+   * @param threadCount The number of threads, 1 for a sequential execution.
+   */
+  void setThreadCount(unsigned int threadCount);
 private:
   /**@brief Add force implementation.
    *
@@ -26,6 +61,19 @@ private:
    * This should be implemented in derived classes.
    */
   virtual void do_addForce() = 0;
+
+  /**@brief Add force differential implementation.
+   *
+   * The actual implementation to add the differential of the forces. By
+   * default, nothing is added: the forces of this field are then handled
+   * explicitly by the implicit solvers.
+   */
+  virtual void do_addForceDifferential(const ParticleStore& store,
+                                       const std::vector<glm::vec3>& dx,
+                                       const std::vector<glm::vec3>& dv,
+                                       std::vector<glm::vec3>& df);
+
+  unsigned int m_threadCount;
 };
 
 typedef std::shared_ptr<ForceField> ForceFieldPtr;
@@ -5,6 +5,8 @@
 #include <memory>
 #include <glm/glm.hpp>
 
+#include "ParticleStore.hpp"
+
 /**@brief Represent a particle as a moving ball.
  *
  * This class is used to model particles in a dynamic system.
@@ -12,6 +14,13 @@
  * a position. This ball is affected by forces that will change
  * both its position and its velocity. This ball can be fixed,
  * making its position constant and its velocity null.
+ *
+ * The state of the particle is not stored in this class, but in a
+ * ParticleStore: a particle is a handle to an entry of a store. A new
+ * particle has its own store, and it is moved into the store of a dynamic
+ * system when it is added to this system (see DynamicSystem::addParticle()).
+ * The getters return copies of the state: a reference into the store would
+ * be invalidated by the next particle added to the same store.
  */
 class Particle
 {
@@ -39,19 +48,19 @@ public:
    * Get the position of this particle.
    * @return The particle's position.
    */
-  const glm::vec3& getPosition() const;
+  glm::vec3 getPosition() const;
   /**@brief Access to this particle's velocity.
    *
    * Get the velocity of this particle.
    * @return The particle's velocity.
    */
-  const glm::vec3& getVelocity() const;
+  glm::vec3 getVelocity() const;
   /**@brief Access to this particle's applied force.
    *
    * Get the force applied to this particle.
    * @return The particle's applied force.
    */
-  const glm::vec3& getForce() const;
+  glm::vec3 getForce() const;
   /**@brief Access to this particle's mass.
    *
    * Get the mass of this particle.
@@ -70,6 +79,18 @@ public:
    * @return True if the particle is fixed.
    */
   bool isFixed() const;
+  /**@brief Check if this particle is sleeping.
+   *
+   * A sleeping particle is at rest on a stack and is not moved by the solvers
+   * until something wakes it up, see SequentialImpulseContactSolver.
+   * @return True if the particle is sleeping.
+   */
+  bool isSleeping() const;
+  /**@brief Wake up this particle.
+   *
+   * Setting the position or the velocity of a particle also wakes it up.
+   */
+  void wakeUp();
 
   /**@brief Set the particle's position.
    *
@@ -130,6 +151,27 @@ public:
    */
   void restart();
 
+  /**@brief Access to the store of this particle.
+   *
+   * Get the store holding the state of this particle.
+   * @return The store of this particle.
+   */
+  const ParticleStorePtr& getStore() const;
+  /**@brief Access to the index of this particle in its store.
+   *
+   * Get the index of this particle in the arrays of its store.
+   * @return The index of this particle.
+   */
+  unsigned int getIndex() const;
+  /**@brief Move this particle into another store.
+   *
+   * Copy the state of this particle into a new entry of a store, then make
+   * this handle refer to this new entry. The entry in the previous store is
+   * released, to be reused by the next particle added to it.
+   * @param store The new store of this particle.
+   */
+  void moveToStore(const ParticleStorePtr& store);
+
 private:
   /**@brief The initial particle's position.
    *
@@ -142,37 +184,17 @@ private:
    */
   const glm::vec3 m_initialVelocity;
 
-  /**@brief The particle's position.
-   *
-   * The position of this particle.
-   */
-  glm::vec3 m_position;
-  /**@brief The particle's velocity.
-   *
-   * The position of this particle.
-   */
-  glm::vec3 m_velocity;
-  /**@brief The particle's applied force.
-   *
-   * The force applied to this particle.
-   */
-  glm::vec3 m_force;
-  /**@brief The particle's mass.
-   *
-   * The mass of this particle.
-   */
-  float m_mass;
-  /**@brief The particle's radius.
+  /**@brief The store of the particle's state.
    *
-   * The radius of this particle.
+   * The store holding the position, velocity, force, mass, radius and fixed
+   * flag of this particle.
    */
-  float m_radius;
-  /**@brief The particle's fixed flag.
+  ParticleStorePtr m_store;
+  /**@brief The particle's index in its store.
    *
-   * A flag that tells if this particle is fixed. If set to true,
-   * the position should be constant and the velocity null in simulation steps.
+   * The index of this particle in the arrays of m_store.
    */
-  bool m_isFixed;
+  unsigned int m_index;
 };
 
 typedef std::shared_ptr<Particle> ParticlePtr;
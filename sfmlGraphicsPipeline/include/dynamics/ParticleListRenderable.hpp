@@ -2,7 +2,10 @@
 # define PARTICLELISTRENDERABLE_HPP_
 
 #include "Particle.hpp"
+#include "DynamicSystemRenderable.hpp"
 #include "../HierarchicalRenderable.hpp"
+#include "../StreamBuffer.hpp"
+#include "../VertexArray.hpp"
 #include "../Utils.hpp"
 #include "../gl_helper.hpp"
 #include "../log.hpp"
@@ -34,6 +37,16 @@ public:
 
     void setColor(glm::vec4 color);
 
+    /**@brief Render the particles at interpolated positions.
+     *
+     * Render the particles at the positions interpolated at the frame time by
+     * a dynamic system renderable (see DynamicSystemRenderable::getInterpolatedPositions()),
+     * instead of their positions at the last simulation step.
+     * @param system The dynamic system renderable updating the particles, or
+     * nullptr to render the positions of the last step.
+     */
+    void setInterpolation(const DynamicSystemRenderablePtr& system);
+
 
 protected:
     void do_draw();
@@ -41,6 +54,8 @@ protected:
 private:
 
     void genbuffers();
+    /**@brief Specify the vertex attributes, when the VAO of the program is built. */
+    void set_vertex_attributes();
     void update_positions_buffer();
     void update_colors_buffer();
     void update_normals_buffer();
@@ -56,9 +71,12 @@ private:
     unsigned int m_cBuffer;
     unsigned int m_nBuffer;
     unsigned int m_iBuffer;
-    unsigned int m_idBuffer; // instance data
+    StreamBuffer m_instances; /*!< Instance data (position, radius), written in place at each frame */
+    VertexArray m_vertexArray; /*!< Vertex arrays of the sphere and the instances, per shader program */
 
     std::vector< ParticlePtr > m_particles;
+    ParticleStoreIndices m_storeIndices; /*!< Indices of the rendered particles in their store */
+    std::weak_ptr<DynamicSystemRenderable> m_interpolation; /*!< Source of the interpolated positions, if any */
 };
 
 typedef std::shared_ptr<ParticleListRenderable> ParticleListRenderablePtr;
@@ -30,4 +30,38 @@ typedef std::shared_ptr<ParticleParticleCollision> ParticleParticleCollisionPtr;
 
 bool testParticleParticle(const ParticlePtr& p1, const ParticlePtr& p2);
 
+/**@brief Test the collision between two particle states.
+ *
+ * Same test as testParticleParticle(), on the states of two distinct
+ * particles rather than on particle handles, so that it can be run on the
+ * arrays of a store.
+ * @param x1 The position of the first particle.
+ * @param r1 The radius of the first particle.
+ * @param x2 The position of the second particle.
+ * @param r2 The radius of the second particle.
+ * @return True if the particles intersect.
+ */
+bool testParticleParticle(const glm::vec3& x1, float r1, const glm::vec3& x2, float r2);
+
+/**@brief Solve the collision between two particle states.
+ *
+ * Update the positions and velocities of two colliding particles, at least
+ * one of them being not fixed. This is used by ParticleParticleCollision and
+ * by the contact buffer of the dynamic system.
+ * @param x1 The position of the first particle, updated.
+ * @param v1 The velocity of the first particle, updated.
+ * @param m1 The mass of the first particle.
+ * @param r1 The radius of the first particle.
+ * @param fixed1 True if the first particle is fixed.
+ * @param x2 The position of the second particle, updated.
+ * @param v2 The velocity of the second particle, updated.
+ * @param m2 The mass of the second particle.
+ * @param r2 The radius of the second particle.
+ * @param fixed2 True if the second particle is fixed.
+ * @param restitution The restitution factor of the collision.
+ */
+void solveParticleParticle(glm::vec3& x1, glm::vec3& v1, float m1, float r1, bool fixed1,
+                           glm::vec3& x2, glm::vec3& v2, float m2, float r2, bool fixed2,
+                           float restitution);
+
 #endif //PARTICLE_PARTICLE_COLLISION_HPP
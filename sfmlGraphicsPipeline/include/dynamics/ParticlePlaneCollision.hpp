@@ -37,4 +37,29 @@ typedef std::shared_ptr<ParticlePlaneCollision> ParticlePlaneCollisionPtr;
 
 bool testParticlePlane(const ParticlePtr& particle, const PlanePtr& plane);
 
+/**@brief Test the collision between a particle state and a plane.
+ *
+ * Same test as testParticlePlane(), on the state of a particle rather than
+ * on a particle handle, so that it can be run on the arrays of a store.
+ * @param position The particle position.
+ * @param radius The particle radius.
+ * @param plane The plane.
+ * @return True if the particle intersects the plane.
+ */
+bool testParticlePlane(const glm::vec3& position, float radius, const Plane& plane);
+
+/**@brief Solve the collision between a particle state and a fixed plane.
+ *
+ * Update the position and velocity of a (non fixed) particle after its
+ * collision with a fixed plane. This is used by ParticlePlaneCollision and
+ * by the contact buffer of the dynamic system.
+ * @param position The particle position, updated.
+ * @param velocity The particle velocity, updated.
+ * @param radius The particle radius.
+ * @param plane The plane.
+ * @param restitution The restitution factor of the collision.
+ */
+void solveParticlePlane(glm::vec3& position, glm::vec3& velocity, float radius,
+                        const Plane& plane, float restitution);
+
 #endif //PARTICLE_PLANE_COLLISION_HPP
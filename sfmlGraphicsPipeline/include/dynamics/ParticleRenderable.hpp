@@ -29,6 +29,11 @@ protected:
     void do_draw();
 
 private:
+    /**@brief Not instanceable: do_draw() places the particle. */
+    bool do_isInstanceable() const;
+    /**@brief Unknown bounds: the particle is placed by do_draw(), after culling. */
+    BoundingBox do_getLocalBounds() const;
+
     ParticlePtr m_particle;
 
 };
@@ -0,0 +1,180 @@
+#ifndef PARTICLE_STORE_HPP
+#define PARTICLE_STORE_HPP
+
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+
+/**@brief Contiguous storage of the particle states.
+ *
+ * The state of the particles is stored as a structure of arrays: all the
+ * positions are contiguous in memory, as well as all the velocities, forces,
+ * masses, radii and fixed flags. The solvers, the force fields and the
+ * renderables can then walk those arrays linearly, which is much more cache
+ * friendly (and easier to vectorize) than following a pointer per particle.
+ *
+ * The particles of a dynamic system are all stored in the store of this
+ * system. A Particle is a lightweight handle to one entry of a store, so that
+ * the scene code can keep manipulating individual particles.
+ */
+class ParticleStore
+{
+public:
+    /**@brief Flags of a particle, see getFixed().
+     *
+     * A fixed particle is never moved by the solvers. A sleeping particle is
+     * a particle at rest that the contact solver stopped simulating until
+     * something wakes it up. A released entry is not a particle anymore: it
+     * is also fixed, and the collision detection skips it.
+     */
+    enum Flag { FIXED = 1, SLEEPING = 2, RELEASED = 4 };
+
+    ParticleStore();
+    ~ParticleStore();
+
+    /**@brief Add a particle state to the store.
+     *
+     * Store the particle state in the last released entry if any, so that a
+     * store does not grow when particles move in and out of it. Otherwise,
+     * append a new particle state at the end of the arrays.
+     * @param position The particle position.
+     * @param velocity The particle velocity.
+     * @param force The force applied to the particle.
+     * @param mass The particle mass.
+     * @param radius The particle radius.
+     * @param fixed The particle fixed flag.
+     * @return The index of the new particle in this store.
+     */
+    unsigned int add(const glm::vec3& position, const glm::vec3& velocity, const glm::vec3& force,
+                     float mass, float radius, bool fixed);
+
+    /**@brief Mark a particle entry as released.
+     *
+     * Called when a particle handle leaves this store. The entry is kept (so
+     * that the indices of the other particles stay valid) but it is flagged
+     * as FIXED and RELEASED, until add() reuses it. The version of the store
+     * changes so that the cached indices are recomputed.
+     * @param index The index of the released particle.
+     */
+    void release(unsigned int index);
+
+    /**@brief Remove all the particles from the store. */
+    void clear();
+
+    /**@brief Reserve memory for a number of particles.
+     *
+     * @param number The number of particles to reserve memory for.
+     */
+    void reserve(unsigned int number);
+
+    /**@brief Access to the number of particles in the store.
+     *
+     * @return The number of particles in the store.
+     */
+    unsigned int size() const;
+
+    /**@brief Access to the version of the store.
+     *
+     * The version changes each time particles are added, released or
+     * removed. This allows the users of the store to know when the indices
+     * they cached are outdated.
+     * @return The current version of the store.
+     */
+    unsigned int getVersion() const;
+
+    /**@brief Reset the forces of all the particles to zero. */
+    void clearForces();
+
+    /**@brief Wake up all the sleeping particles. */
+    void wakeUp();
+
+    std::vector<glm::vec3>& getPositions();
+    const std::vector<glm::vec3>& getPositions() const;
+    std::vector<glm::vec3>& getVelocities();
+    const std::vector<glm::vec3>& getVelocities() const;
+    std::vector<glm::vec3>& getForces();
+    const std::vector<glm::vec3>& getForces() const;
+    std::vector<float>& getMasses();
+    const std::vector<float>& getMasses() const;
+    std::vector<float>& getRadii();
+    const std::vector<float>& getRadii() const;
+    /**@brief Access to the fixed flags.
+     *
+     * A char is used per particle instead of a std::vector<bool>, which
+     * is a bit field that cannot be accessed in parallel. It holds the flags
+     * of the particle (FIXED, SLEEPING, RELEASED): the solvers only move the
+     * particles without any flag.
+     * @return The flags, non zero for fixed or sleeping particles.
+     */
+    std::vector<unsigned char>& getFixed();
+    const std::vector<unsigned char>& getFixed() const;
+
+private:
+    std::vector<glm::vec3> m_positions;
+    std::vector<glm::vec3> m_velocities;
+    std::vector<glm::vec3> m_forces;
+    std::vector<float> m_masses;
+    std::vector<float> m_radii;
+    std::vector<unsigned char> m_fixed;
+    std::vector<unsigned int> m_released; /*!< The released entries, reused by add(). */
+    unsigned int m_version;
+};
+
+typedef std::shared_ptr<ParticleStore> ParticleStorePtr;
+
+class Particle;
+
+/**@brief Indices of a set of particles in their store.
+ *
+ * The force fields and the renderables are built from a set of particle
+ * handles. This class finds, once, the store and the indices of those
+ * particles, so that they can directly work on the store arrays. The indices
+ * are only recomputed when the particles moved to another store, or when
+ * the store changed.
+ */
+class ParticleStoreIndices
+{
+public:
+    ParticleStoreIndices();
+
+    /**@brief Update the indices of a set of particles.
+     *
+     * Update the indices if the particles or their store changed since the
+     * last call.
+     * @param particles The set of particles.
+     * @return True if all the particles are in the same store. Otherwise, the
+     * particles should be accessed through their handles.
+     */
+    bool update(const std::vector< std::shared_ptr<Particle> >& particles);
+
+    /**@brief Force the indices to be recomputed at the next update. */
+    void invalidate();
+
+    /**@brief Access to the common store of the particles.
+     *
+     * @return The store of the particles, null if they are not in the same store.
+     */
+    ParticleStore* getStore() const;
+
+    /**@brief Access to the indices of the particles in the store.
+     *
+     * @return The indices of the particles.
+     */
+    const std::vector<unsigned int>& getIndices() const;
+
+    /**@brief Check if the particles are exactly all the particles of the store.
+     *
+     * In this case, the i-th particle is at index i in the store, and the store
+     * arrays can be walked without indirection.
+     * @return True if the particles are the whole store, in the store order.
+     */
+    bool isWholeStore() const;
+
+private:
+    ParticleStorePtr m_store;
+    unsigned int m_version;
+    std::vector<unsigned int> m_indices;
+    bool m_wholeStore;
+};
+
+#endif //PARTICLE_STORE_HPP
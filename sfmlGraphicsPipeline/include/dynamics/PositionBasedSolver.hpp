@@ -0,0 +1,84 @@
+#ifndef POSITION_BASED_SOLVER_HPP
+#define POSITION_BASED_SOLVER_HPP
+
+#include "Solver.hpp"
+#include "BroadPhase.hpp"
+#include "ContactBuffer.hpp"
+
+/**@brief Position based solver (XPBD).
+ *
+ * Instead of integrating the forces of stiff springs, this solver moves the
+ * particles to satisfy the position constraints of the dynamic system (see
+ * DynamicSystem::addConstraint()), then deduces their velocities from their
+ * displacement:
+ * - the positions are predicted from the velocities and the forces of the
+ * force fields (gravity, damping, ...);
+ * - the constraints are projected one after the other (Gauss-Seidel) for a
+ * few iterations, together with the contacts with the plane obstacles and
+ * between particles when the collisions are activated;
+ * - the velocities are set to the displacement divided by the time step.
+ *
+ * The time step is split in substeps, which improves the convergence of the
+ * constraints more than additional iterations ("Small Steps in Physics
+ * Simulation", Macklin et al., 2019). Infinitely stiff constraints stay
+ * stable whatever the time step.
+ *
+ * The contacts are solved as constraints, without restitution: this solver
+ * resolves the collisions itself, the contact solver of the dynamic system is
+ * not used.
+ */
+class PositionBasedSolver : public Solver
+{
+public:
+    /**@brief Build a position based solver.
+     *
+     * @param substepNumber The number of substeps of a time step.
+     * @param iterationNumber The number of projections of the constraints per substep.
+     */
+    PositionBasedSolver(unsigned int substepNumber = 4, unsigned int iterationNumber = 2);
+    ~PositionBasedSolver();
+
+    /**@brief Access to the number of substeps.
+     *
+     * @return The number of substeps of a time step.
+     */
+    unsigned int getSubstepNumber() const;
+    /**@brief Set the number of substeps.
+     *
+     * @param substepNumber The new number of substeps of a time step, at least 1.
+     */
+    void setSubstepNumber(unsigned int substepNumber);
+
+    /**@brief Access to the number of iterations.
+     *
+     * @return The number of projections of the constraints per substep.
+     */
+    unsigned int getIterationNumber() const;
+    /**@brief Set the number of iterations.
+     *
+     * @param iterationNumber The new number of projections of the constraints per substep.
+     */
+    void setIterationNumber(unsigned int iterationNumber);
+
+private:
+    void do_solve(const float& dt, DynamicSystem& system);
+    bool do_solvesCollisions() const;
+
+    /**@brief Detect the contacts at the predicted positions. */
+    void detectContacts(DynamicSystem& system);
+    /**@brief Project the particles out of the plane obstacles and of each other. */
+    void projectContacts(ParticleStore& particles, const std::vector<PlanePtr>& planes);
+
+    unsigned int m_substepNumber;
+    unsigned int m_iterationNumber;
+
+    /**@brief Positions at the beginning of the substep, to compute the velocities. */
+    std::vector<glm::vec3> m_previousPositions;
+    /**@brief Contacts of the substep, kept to avoid reallocations. */
+    std::vector<CandidatePair> m_candidatePairs;
+    ContactBuffer m_contacts;
+};
+
+typedef std::shared_ptr<PositionBasedSolver> PositionBasedSolverPtr;
+
+#endif //POSITION_BASED_SOLVER_HPP
@@ -0,0 +1,43 @@
+#ifndef RUNGE_KUTTA_4_SOLVER_HPP
+#define RUNGE_KUTTA_4_SOLVER_HPP
+
+#include "Solver.hpp"
+
+/**@brief Classical fourth order Runge-Kutta solver.
+ *
+ * The derivatives of the positions and velocities are evaluated at four
+ * states during the step, and the new state is a weighted average of them.
+ * This is much more accurate than the Euler schemes, for four force
+ * computations per step. Note that the collisions are only handled at the
+ * end of the step.
+ */
+class RungeKutta4Solver : public Solver
+{
+public:
+    RungeKutta4Solver();
+    ~RungeKutta4Solver();
+private:
+    void do_solve(const float& dt, DynamicSystem& system);
+
+    /**@brief Evaluate the derivatives at the current state of the particles.
+     *
+     * Add weight times the derivatives to the sums, then move the particles
+     * to the next state to evaluate: the initial state plus step times the
+     * derivatives.
+     * @param particles The store of the particles.
+     * @param weight The weight of these derivatives in the final average.
+     * @param step The time from the initial state to the next state.
+     */
+    void evaluate(ParticleStore& particles, float weight, float step);
+
+    /**@brief State of the particles at the beginning of the step. */
+    std::vector<glm::vec3> m_initialPositions;
+    std::vector<glm::vec3> m_initialVelocities;
+    /**@brief Weighted sums of the derivatives of the positions and velocities. */
+    std::vector<glm::vec3> m_positionDerivatives;
+    std::vector<glm::vec3> m_velocityDerivatives;
+};
+
+typedef std::shared_ptr<RungeKutta4Solver> RungeKutta4SolverPtr;
+
+#endif //RUNGE_KUTTA_4_SOLVER_HPP
@@ -0,0 +1,237 @@
+#ifndef SEQUENTIAL_IMPULSE_CONTACT_SOLVER_HPP
+#define SEQUENTIAL_IMPULSE_CONTACT_SOLVER_HPP
+
+#include <cstdint>
+
+#include "ContactSolver.hpp"
+
+/**@brief Iterative contact solver, for piles and stacks of particles.
+ *
+ * The contacts are solved together with a projected Gauss-Seidel, also known
+ * as sequential impulses: each iteration goes through all the contacts and
+ * updates the impulse of each contact so that its particles stop approaching,
+ * the total impulse of a contact being kept positive. The penetrations are
+ * then removed by a few projection passes on the positions, leaving a small
+ * slop so that resting contacts are detected again at the next step. Unlike
+ * the single pass solver, the contacts have a Coulomb friction, without which
+ * a pile of particles spreads on the ground.
+ *
+ * The impulses are cached from one step to the next: a contact still present
+ * starts from its previous impulse (warm starting), which is close to the
+ * solution for resting contacts, so that few iterations are enough.
+ *
+ * The particles linked by contacts form islands. An island supported by a
+ * plane or a fixed particle, whose particles have been slower than a threshold
+ * for some time, is put to sleep: its particles are flagged as sleeping in the
+ * store and are not integrated nor solved anymore. A sleeping island wakes up
+ * when a moving particle touches it or when the force of one of its particles
+ * changes.
+ */
+class SequentialImpulseContactSolver : public ContactSolver
+{
+public:
+    /**@brief Build a sequential impulse contact solver.
+     *
+     * @param velocityIterations The number of iterations on the velocities.
+     * @param positionIterations The number of projection passes on the positions.
+     */
+    SequentialImpulseContactSolver(unsigned int velocityIterations = 10, unsigned int positionIterations = 4);
+    ~SequentialImpulseContactSolver();
+
+    /**@brief Access to the number of iterations on the velocities.
+     *
+     * @return The number of Gauss-Seidel iterations on the impulses.
+     */
+    unsigned int getVelocityIterations() const;
+    /**@brief Set the number of iterations on the velocities.
+     *
+     * @param velocityIterations The new number of iterations.
+     */
+    void setVelocityIterations(unsigned int velocityIterations);
+
+    /**@brief Access to the number of projection passes on the positions.
+     *
+     * @return The number of passes.
+     */
+    unsigned int getPositionIterations() const;
+    /**@brief Set the number of projection passes on the positions.
+     *
+     * @param positionIterations The new number of passes.
+     */
+    void setPositionIterations(unsigned int positionIterations);
+
+    /**@brief Check if the impulses of the previous step are reused. */
+    bool getWarmStarting() const;
+    /**@brief Enable or disable the warm starting of the impulses.
+     *
+     * @param onOff True to start each contact from its impulse at the previous step.
+     */
+    void setWarmStarting(bool onOff);
+
+    /**@brief Access to the penetration slop.
+     *
+     * @return The penetration depth left by the projection on the positions.
+     */
+    float getSlop() const;
+    /**@brief Set the penetration slop.
+     *
+     * @param slop The penetration depth left by the projection on the positions.
+     */
+    void setSlop(float slop);
+
+    /**@brief Access to the friction coefficient.
+     *
+     * @return The Coulomb friction coefficient of the contacts.
+     */
+    float getFriction() const;
+    /**@brief Set the friction coefficient.
+     *
+     * @param friction The Coulomb friction coefficient of the contacts, 0 for
+     * frictionless contacts as with the single pass solver.
+     */
+    void setFriction(float friction);
+
+    /**@brief Access to the restitution threshold.
+     *
+     * @return The approach speed under which the contacts do not bounce.
+     */
+    float getRestitutionThreshold() const;
+    /**@brief Set the restitution threshold.
+     *
+     * Contacts approaching slower than this threshold are solved as inelastic,
+     * otherwise the velocity gained in one step by a resting particle would be
+     * bounced back and the particle would never rest.
+     * @param threshold The approach speed under which the contacts do not bounce.
+     */
+    void setRestitutionThreshold(float threshold);
+
+    /**@brief Check if resting islands are put to sleep. */
+    bool getSleeping() const;
+    /**@brief Enable or disable sleeping.
+     *
+     * @param onOff True to put resting islands to sleep.
+     */
+    void setSleeping(bool onOff);
+
+    /**@brief Access to the sleep velocity.
+     *
+     * @return The speed under which a particle is considered at rest.
+     */
+    float getSleepVelocity() const;
+    /**@brief Set the sleep velocity.
+     *
+     * @param velocity The speed under which a particle is considered at rest.
+     */
+    void setSleepVelocity(float velocity);
+
+    /**@brief Access to the sleep delay.
+     *
+     * @return The time all the particles of an island must rest before it sleeps.
+     */
+    float getSleepDelay() const;
+    /**@brief Set the sleep delay.
+     *
+     * @param delay The time all the particles of an island must rest before it sleeps.
+     */
+    void setSleepDelay(float delay);
+
+    /**@brief Access to the number of contacts solved at the last step.
+     *
+     * Contacts between fixed or sleeping particles are not solved.
+     * @return The number of solved contacts.
+     */
+    unsigned int getSolvedContactNumber() const;
+    /**@brief Access to the number of sleeping particles after the last step.
+     *
+     * @return The number of sleeping particles.
+     */
+    unsigned int getSleepingParticleNumber() const;
+
+private:
+    void do_solve(ParticleStore& store, const ContactBuffer& contacts,
+                  const std::vector<PlanePtr>& planes, float restitution, float dt);
+
+    /**@brief A contact to solve.
+     *
+     * The normal goes from the second particle (or the plane) to the first
+     * particle, the impulse is applied along the normal to the first particle
+     * and in the opposite direction to the second one.
+     */
+    struct Constraint
+    {
+        std::uint64_t key;
+        unsigned int particle1;
+        unsigned int particle2;
+        unsigned int plane;
+        glm::vec3 normal;
+        float inverseMass1;
+        float inverseMass2;
+        float effectiveMass;
+        float targetVelocity;
+        float impulse;
+        glm::vec3 frictionImpulse;
+    };
+
+    /**@brief An impulse kept from one step to the next. */
+    struct CachedImpulse
+    {
+        std::uint64_t key;
+        float impulse;
+        glm::vec3 frictionImpulse;
+    };
+
+    /**@brief Build the constraints of the contacts to solve. */
+    void buildConstraints(const ParticleStore& store, const ContactBuffer& contacts,
+                          const std::vector<PlanePtr>& planes, float restitution);
+    /**@brief Find the impulse of a contact at the previous step.
+     *
+     * @return The cached impulse, null if the contact was not solved at the previous step.
+     */
+    const CachedImpulse* findCachedImpulse(const std::vector<CachedImpulse>& cache, std::uint64_t key) const;
+    /**@brief Store the impulses of this step, sorted by key. */
+    void cacheImpulses();
+
+    void solveVelocities(ParticleStore& store);
+    void solvePositions(ParticleStore& store, const std::vector<PlanePtr>& planes);
+
+    /**@brief Union-find over the particles, to build the islands. */
+    unsigned int findIsland(unsigned int particle);
+    void buildIslands(const ParticleStore& store, const ContactBuffer& contacts);
+    /**@brief Wake up the sleeping islands touched by a moving particle or whose forces changed. */
+    void wakeUpIslands(ParticleStore& store, float dt);
+    /**@brief Put to sleep the islands at rest for long enough. */
+    void sleepIslands(ParticleStore& store, float dt);
+
+    unsigned int m_velocityIterations;
+    unsigned int m_positionIterations;
+    bool m_warmStarting;
+    float m_slop;
+    float m_friction;
+    float m_restitutionThreshold;
+    bool m_sleeping;
+    float m_sleepVelocity;
+    float m_sleepDelay;
+    unsigned int m_sleepingParticleNumber;
+
+    std::vector<Constraint> m_constraints;
+    /**@brief The impulses of the previous step, for the particle-plane and
+     * the particle-particle contacts. */
+    std::vector<CachedImpulse> m_planeImpulses;
+    std::vector<CachedImpulse> m_pairImpulses;
+    /**@brief The version of the store the cached impulses refer to. */
+    unsigned int m_version;
+
+    /**@brief Per particle data of the islands: the parent in the union-find,
+     * the time spent at rest and the force when the particle fell asleep. */
+    std::vector<unsigned int> m_islands;
+    std::vector<float> m_restTimes;
+    std::vector<glm::vec3> m_sleepForces;
+    /**@brief Per island data, indexed by the root particle of the island. */
+    std::vector<unsigned char> m_islandSupported;
+    std::vector<unsigned char> m_islandAwake;
+    std::vector<float> m_islandRestTimes;
+};
+
+typedef std::shared_ptr<SequentialImpulseContactSolver> SequentialImpulseContactSolverPtr;
+
+#endif //SEQUENTIAL_IMPULSE_CONTACT_SOLVER_HPP
@@ -0,0 +1,28 @@
+#ifndef SINGLE_PASS_CONTACT_SOLVER_HPP
+#define SINGLE_PASS_CONTACT_SOLVER_HPP
+
+#include "ContactSolver.hpp"
+
+/**@brief Solve each contact once.
+ *
+ * Each contact is solved once, in the order of detection, by projecting the
+ * particles out of each other and reflecting their velocities (see
+ * ContactBuffer::solve()). This is the contact solver used by default.
+ *
+ * It is cheap and good enough for bouncing particles, but the particles of
+ * a pile push each other back into their neighbors and jitter.
+ */
+class SinglePassContactSolver : public ContactSolver
+{
+public:
+    SinglePassContactSolver();
+    ~SinglePassContactSolver();
+
+private:
+    void do_solve(ParticleStore& store, const ContactBuffer& contacts,
+                  const std::vector<PlanePtr>& planes, float restitution, float dt);
+};
+
+typedef std::shared_ptr<SinglePassContactSolver> SinglePassContactSolverPtr;
+
+#endif //SINGLE_PASS_CONTACT_SOLVER_HPP
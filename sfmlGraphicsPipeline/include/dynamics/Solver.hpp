@@ -3,33 +3,72 @@
 
 #include <memory>
 #include <vector>
-#include "Particle.hpp"
+#include "ParticleStore.hpp"
+
+class DynamicSystem;
 
 /**@brief Dynamic system solver interface.
  *
  * Define an interface for dynamic system solver.
+ *
+ * When a solver is called, the forces of the particles have already been
+ * computed at their current state. Solvers that need the forces at other
+ * states (e.g. multistep or implicit solvers) can ask the dynamic system to
+ * compute them again, see DynamicSystem::computeForces() and
+ * DynamicSystem::addForceDifferentials().
  */
 class Solver
 {
 public:
-  Solver(){}
-  virtual  ~Solver(){}
+  Solver();
+  virtual  ~Solver();
   /**@brief Solve the dynamic system of particles.
    *
    * Solve the dynamic system of particles for a specified time step.
    * @param dt The time step for the integration.
-   * @param particles The collection of particles.
+   * @param system The dynamic system, whose particle store is updated.
+   */
+  void solve( const float& dt, DynamicSystem& system );
+
+  /**@brief Check if this solver resolves the collisions itself.
+   *
+   * The dynamic system does not detect nor solve the collisions after the
+   * integration when its solver already does.
+   * @return True if the collisions are handled by this solver.
+   */
+  bool solvesCollisions() const;
+
+  /**@brief Access to the number of threads of this solver.
+   *
+   * Get the number of threads this solver may use to integrate the particles.
+   * @return The number of threads.
+   */
+  unsigned int getThreadCount() const;
+  /**@brief Set the number of threads of this solver.
+   *
+   * Define the number of threads this solver may use to integrate the
+   * particles. The dynamic system sets it at each step according to its
+   * execution mode.
+   * @param threadCount The number of threads, 1 for a sequential execution.
    */
-  void solve( const float& dt, std::vector<ParticlePtr>& particles );
+  void setThreadCount(unsigned int threadCount);
 private:
   /**@brief Solve implementation.
    *
    * The actual implementation to solve the dynamic system. This should
    * be implemented in derived classes.
    * @param dt The time step for the integration.
-   * @param particles The collection of particles.
+   * @param system The dynamic system, whose particle store is updated.
    */
-  virtual void do_solve(const float& dt, std::vector<ParticlePtr>& particles) = 0;
+  virtual void do_solve(const float& dt, DynamicSystem& system) = 0;
+
+  /**@brief Collision handling implementation.
+   *
+   * By default, the collisions are left to the dynamic system.
+   */
+  virtual bool do_solvesCollisions() const;
+
+  unsigned int m_threadCount;
 };
 
 typedef std::shared_ptr<Solver> SolverPtr;
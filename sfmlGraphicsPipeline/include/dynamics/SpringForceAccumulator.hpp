@@ -0,0 +1,95 @@
+#ifndef SPRING_FORCE_ACCUMULATOR_HPP
+#define SPRING_FORCE_ACCUMULATOR_HPP
+
+#include <vector>
+
+#include "ParticleStore.hpp"
+#include "SpringForceField.hpp"
+
+/**@brief Accumulate the forces of many springs in parallel.
+ *
+ * A particle is usually shared by several springs (e.g. in a cloth), so two
+ * threads adding the forces of two springs could write the same particle at
+ * the same time. To avoid this conflict without locks, the accumulation is
+ * done in two passes:
+ * - each spring computes its force into its own slot of a buffer, in parallel
+ *   over the springs;
+ * - each particle sums the forces of the springs attached to it, in parallel
+ *   over the particles.
+ *
+ * The springs attached to each particle are found once, and only found again
+ * when the springs or the particle store change. A particle always sums the
+ * forces of its springs in the same order, so the result does not depend on
+ * the number of threads.
+ */
+class SpringForceAccumulator
+{
+public:
+    SpringForceAccumulator();
+    ~SpringForceAccumulator();
+
+    /**@brief Set the springs to accumulate.
+     *
+     * @param springs The springs whose forces are accumulated.
+     */
+    void setSprings(const std::vector<SpringForceFieldPtr>& springs);
+
+    /**@brief Access to the springs to accumulate.
+     *
+     * @return The springs whose forces are accumulated.
+     */
+    const std::vector<SpringForceFieldPtr>& getSprings() const;
+
+    /**@brief Add the forces of the springs to the particles of a store.
+     *
+     * The springs whose particles are not in this store add their forces
+     * sequentially, through the particle handles.
+     * @param store The store of the particles.
+     * @param threadCount The number of threads to use.
+     */
+    void addForces(ParticleStore& store, unsigned int threadCount);
+
+    /**@brief Add the differentials of the forces of the springs.
+     *
+     * See ForceField::addForceDifferential().
+     * @param store The store of the particles.
+     * @param dx The variation of the particle positions.
+     * @param dv The variation of the particle velocities.
+     * @param df The variation of the particle forces, to add to.
+     * @param threadCount The number of threads to use.
+     */
+    void addForceDifferentials(const ParticleStore& store,
+                               const std::vector<glm::vec3>& dx,
+                               const std::vector<glm::vec3>& dv,
+                               std::vector<glm::vec3>& df,
+                               unsigned int threadCount);
+
+private:
+    /**@brief Find the springs attached to each particle of a store. */
+    void buildParticleSprings(const ParticleStore& store);
+    /**@brief Add the values of m_springForces to the particles of their springs. */
+    void gatherSpringForces(glm::vec3* f, unsigned int threadCount) const;
+
+    std::vector<SpringForceFieldPtr> m_springs;
+    /**@brief Springs whose particles are in the store. */
+    std::vector<SpringForceFieldPtr> m_storeSprings;
+    /**@brief Force (or force differential) of each spring of m_storeSprings
+     * on its second particle. */
+    std::vector<glm::vec3> m_springForces;
+    /**@brief Springs attached to each particle.
+     *
+     * The springs of the particle i are m_particleSprings[m_particleStart[i]]
+     * to m_particleSprings[m_particleStart[i+1]-1]. An entry 2*s (resp. 2*s+1)
+     * means the particle is the first (resp. second) particle of the spring
+     * m_storeSprings[s].
+     */
+    std::vector<unsigned int> m_particleStart;
+    std::vector<unsigned int> m_particleSprings;
+    /**@brief Springs whose particles are not in the store. */
+    std::vector<SpringForceFieldPtr> m_outsideSprings;
+
+    const ParticleStore* m_store;
+    unsigned int m_version;
+};
+
+#endif //SPRING_FORCE_ACCUMULATOR_HPP
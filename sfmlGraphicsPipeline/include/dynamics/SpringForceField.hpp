@@ -38,6 +38,32 @@ class SpringForceField : public ForceField
          */
         ParticlePtr getParticle2() const;
 
+        /**@brief Compute the force of this spring.
+         *
+         * Compute the force applied by this spring to its second particle,
+         * the first particle receiving the opposite force. The particles are
+         * not modified, so that the forces of many springs can be computed
+         * in parallel before being accumulated.
+         * @return The force applied to the second particle.
+         */
+        glm::vec3 computeForce() const;
+
+        /**@brief Compute the differential of the force of this spring.
+         *
+         * Compute the variation of the force applied to the second particle
+         * when the relative position and velocity of the second particle
+         * with respect to the first one vary by dx and dv. The first particle
+         * receives the opposite variation.
+         *
+         * The stiffness matrix of a compressed spring is not positive, which
+         * would prevent the implicit solvers from converging: as usual, its
+         * transverse part is ignored when the spring is compressed.
+         * @param dx The variation of the relative position.
+         * @param dv The variation of the relative velocity.
+         * @return The variation of the force applied to the second particle.
+         */
+        glm::vec3 computeForceDifferential(const glm::vec3& dx, const glm::vec3& dv) const;
+
     private:
         /**@brief Add the force of this spring to the two particles.
          *
@@ -45,6 +71,10 @@ class SpringForceField : public ForceField
          * and add them to the particles.
          */
         void do_addForce();
+        void do_addForceDifferential(const ParticleStore& store,
+                                     const std::vector<glm::vec3>& dx,
+                                     const std::vector<glm::vec3>& dv,
+                                     std::vector<glm::vec3>& df);
 
 
         const ParticlePtr m_p1, m_p2;
@@ -26,6 +26,9 @@ protected:
     void do_draw();
 
 private:
+    /**@brief Not instanceable: do_draw() changes the line width. */
+    bool do_isInstanceable() const;
+
     SpringForceFieldPtr m_springForceField;
 };
 
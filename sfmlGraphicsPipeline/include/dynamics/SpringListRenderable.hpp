@@ -3,6 +3,9 @@
 
 #include "../MeshRenderable.hpp"
 #include "SpringForceField.hpp"
+#include "DistanceConstraint.hpp"
+#include "DynamicSystemRenderable.hpp"
+#include "../StreamBuffer.hpp"
 #include <list>
 #include <vector>
 
@@ -12,6 +15,9 @@
  * Render a set of springs on screen. We could do much more here than just
  * rendering a line between the centers of the two spring's particles.
  * However, it is up to you to come with better idea :-).
+ *
+ * The distance constraints of a position based simulation can be rendered
+ * the same way.
  */
 class SpringListRenderable : public MeshRenderable
 {
@@ -25,14 +31,41 @@ public:
      * the springs we want to render.
      */
     SpringListRenderable( ShaderProgramPtr program, std::list<SpringForceFieldPtr>& springForceFields );
+    /**@brief Build a renderable to render a list of distance constraints.
+     *
+     * Build a new renderable to render a list of distance constraints as springs.
+     * @param program The shader program used to render the constraints.
+     * @param distanceConstraints The set of distance constraints to render.
+     */
+    SpringListRenderable( ShaderProgramPtr program, std::list<DistanceConstraintPtr>& distanceConstraints );
+
+    /**@brief Render the springs at interpolated positions.
+     *
+     * Render the springs between the positions interpolated at the frame time by
+     * a dynamic system renderable (see DynamicSystemRenderable::getInterpolatedPositions()),
+     * instead of the positions at the last simulation step.
+     * @param system The dynamic system renderable updating the particles, or
+     * nullptr to render the positions of the last step.
+     */
+    void setInterpolation(const DynamicSystemRenderablePtr& system);
 
 protected:
     void do_draw();
+    void set_vertex_attributes();
 
 private:
+    /**@brief Not instanceable: do_draw() streams the vertices. */
+    bool do_isInstanceable() const;
+    /**@brief Unknown bounds: the spring ends are streamed by do_draw(), after culling. */
+    BoundingBox do_getLocalBounds() const;
+    void initialize_springs();
     void update_spring_positions();
 
-    std::list<SpringForceFieldPtr> m_springForceFields;
+    /**@brief The particles at both ends of each spring. */
+    std::vector< std::pair<ParticlePtr, ParticlePtr> > m_springs;
+    /**@brief The positions of the spring ends, written in place at each frame. */
+    StreamBuffer m_springPositions;
+    std::weak_ptr<DynamicSystemRenderable> m_interpolation;
 };
 
 typedef std::shared_ptr<SpringListRenderable> SpringListRenderablePtr;
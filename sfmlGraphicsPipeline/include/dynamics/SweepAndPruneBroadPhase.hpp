@@ -0,0 +1,37 @@
+#ifndef SWEEP_AND_PRUNE_BROAD_PHASE_HPP
+#define SWEEP_AND_PRUNE_BROAD_PHASE_HPP
+
+#include "BroadPhase.hpp"
+
+/**@brief Sweep and prune broad phase.
+ *
+ * The bounding boxes of the particles are sorted along the x axis. Then the
+ * sorted boxes are swept: a box is only tested against the next boxes that
+ * start before its end along x. Particles move a little between two steps, so
+ * the order of the previous step is kept and updated with an insertion sort,
+ * which is almost linear on a nearly sorted sequence.
+ *
+ * This broad phase does not need a cell size, so it works well with particles
+ * of very different radii. However, it degrades when many particles are
+ * aligned on the x axis.
+ */
+class SweepAndPruneBroadPhase : public BroadPhase
+{
+public:
+    SweepAndPruneBroadPhase();
+    ~SweepAndPruneBroadPhase();
+private:
+    void do_computePairs(const std::vector<glm::vec3>& positions,
+                         const std::vector<float>& radii,
+                         const std::vector<unsigned char>& flags,
+                         std::vector<CandidatePair>& pairs);
+
+    /**@brief Particle indices sorted by the lower bound of their box along x. */
+    std::vector<unsigned int> m_order;
+    /**@brief Lower bound along x of the box of each particle. */
+    std::vector<float> m_lower;
+};
+
+typedef std::shared_ptr<SweepAndPruneBroadPhase> SweepAndPruneBroadPhasePtr;
+
+#endif //SWEEP_AND_PRUNE_BROAD_PHASE_HPP
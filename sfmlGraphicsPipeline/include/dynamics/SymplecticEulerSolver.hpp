@@ -0,0 +1,29 @@
+#ifndef SYMPLECTIC_EULER_SOLVER_HPP
+#define SYMPLECTIC_EULER_SOLVER_HPP
+
+#include "EulerExplicitSolver.hpp"
+
+/**@brief Symplectic (semi-implicit) Euler solver.
+ *
+ * The velocities are updated first with the forces, then the positions are
+ * updated with the new velocities:
+ * v(t+dt) = v(t) + dt*f(t)/m
+ * x(t+dt) = x(t) + dt*v(t+dt)
+ * Unlike the textbook explicit Euler scheme, which moves the particles with
+ * the old velocities, this scheme does not add energy to oscillating systems
+ * such as springs. It is as cheap as the explicit Euler scheme: a single
+ * force computation per step.
+ *
+ * This is the scheme EulerExplicitSolver already implements: this class only
+ * names it.
+ */
+class SymplecticEulerSolver : public EulerExplicitSolver
+{
+public:
+    SymplecticEulerSolver();
+    ~SymplecticEulerSolver();
+};
+
+typedef std::shared_ptr<SymplecticEulerSolver> SymplecticEulerSolverPtr;
+
+#endif //SYMPLECTIC_EULER_SOLVER_HPP
@@ -0,0 +1,79 @@
+#ifndef UNIFORM_GRID_BROAD_PHASE_HPP
+#define UNIFORM_GRID_BROAD_PHASE_HPP
+
+#include "BroadPhase.hpp"
+
+/**@brief Uniform grid broad phase, stored in a spatial hash.
+ *
+ * The space is divided into cubic cells of the same size. Each particle is
+ * stored in the cell containing its center, then its bounding box is only
+ * tested against the particles of the 27 cells around it. Since the grid is
+ * infinite, cells are stored in a hash table: its size is proportional to
+ * the number of particles, not to the size of the scene.
+ *
+ * When the cell size is at least twice the largest particle radius, two
+ * colliding particles are always in neighbor cells. By default, the cell size
+ * is computed at each step from the radii (see Particle::getRadius()).
+ */
+class UniformGridBroadPhase : public BroadPhase
+{
+public:
+    /**@brief Build a uniform grid broad phase.
+     *
+     * Build a uniform grid broad phase.
+     * @param cellSize The size of a grid cell. A null or negative value
+     * means the cell size is set at each step to twice the largest radius.
+     */
+    UniformGridBroadPhase(float cellSize = 0.0f);
+    ~UniformGridBroadPhase();
+
+    /**@brief Access to the cell size.
+     *
+     * Get the cell size set by the user.
+     * @return The cell size, a null value meaning it is computed automatically.
+     */
+    float getCellSize() const;
+    /**@brief Set the cell size.
+     *
+     * Define the size of a grid cell. This size should be at least twice the
+     * largest particle radius, otherwise it is enlarged at each step.
+     * @param cellSize The new cell size, or zero for an automatic cell size.
+     */
+    void setCellSize(float cellSize);
+
+private:
+    void do_computePairs(const std::vector<glm::vec3>& positions,
+                         const std::vector<float>& radii,
+                         const std::vector<unsigned char>& flags,
+                         std::vector<CandidatePair>& pairs);
+
+    /**@brief Hash a cell of the grid.
+     *
+     * Compute the index of a grid cell in the hash table.
+     * @param cell The integer coordinates of the cell.
+     * @return The index of the cell in the hash table.
+     */
+    unsigned int hashCell(const glm::ivec3& cell) const;
+
+    float m_cellSize;
+    /**@brief Number of entries of the hash table, minus one.
+     *
+     * The number of entries is a power of two, so that the modulo of the hash
+     * function is a simple binary and with this mask.
+     */
+    unsigned int m_tableMask;
+    /**@brief Start of each hash table entry in m_sortedParticles.
+     *
+     * The particles of the entry h are m_sortedParticles[m_entryStart[h]]
+     * to m_sortedParticles[m_entryStart[h+1]-1].
+     */
+    std::vector<unsigned int> m_entryStart;
+    /**@brief Particle indices sorted by hash table entries. */
+    std::vector<unsigned int> m_sortedParticles;
+    /**@brief Hash table entry of each particle. */
+    std::vector<unsigned int> m_particleEntry;
+};
+
+typedef std::shared_ptr<UniformGridBroadPhase> UniformGridBroadPhasePtr;
+
+#endif //UNIFORM_GRID_BROAD_PHASE_HPP
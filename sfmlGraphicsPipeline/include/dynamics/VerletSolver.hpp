@@ -0,0 +1,41 @@
+#ifndef VERLET_SOLVER_HPP
+#define VERLET_SOLVER_HPP
+
+#include "Solver.hpp"
+
+/**@brief Position Verlet solver.
+ *
+ * The new positions are computed from the two previous ones:
+ * x(t+dt) = 2*x(t) - x(t-dt) + dt^2*f(t)/m
+ * and the velocities are deduced from the positions:
+ * v(t+dt) = (x(t+dt) - x(t))/dt
+ *
+ * The previous positions are kept by the solver. When the position or the
+ * velocity of a particle has been changed since the last step (e.g. by a
+ * collision or by the user), its previous position is computed back from its
+ * velocity. The
+ * same is done for all the particles when the time step or the particles
+ * change.
+ */
+class VerletSolver : public Solver
+{
+public:
+    VerletSolver();
+    ~VerletSolver();
+private:
+    void do_solve(const float& dt, DynamicSystem& system);
+
+    /**@brief Positions of the particles at the previous step. */
+    std::vector<glm::vec3> m_previousPositions;
+    /**@brief Positions and velocities given to the particles at the previous step. */
+    std::vector<glm::vec3> m_positions;
+    std::vector<glm::vec3> m_velocities;
+    /**@brief Time step of the previous step. */
+    float m_dt;
+    /**@brief Version of the particle store at the previous step. */
+    unsigned int m_version;
+};
+
+typedef std::shared_ptr<VerletSolver> VerletSolverPtr;
+
+#endif //VERLET_SOLVER_HPP
@@ -0,0 +1,174 @@
+#ifndef CLUSTERED_LIGHTING_HPP
+#define CLUSTERED_LIGHTING_HPP
+
+#include "./../../include/UniformBuffer.hpp"
+#include "./../../include/ShaderProgram.hpp"
+#include "./../../include/Camera.hpp"
+#include "./Light.hpp"
+
+#include <vector>
+#include <glm/glm.hpp>
+
+/**
+ * @brief The point and spot lights of the scene, sorted into clusters of the view.
+ *
+ * The view frustum is split into clusterNumberX x clusterNumberY tiles of the
+ * screen, and into clusterNumberZ slices of depth, exponentially spaced between
+ * the near and the far planes of the camera. Each frame, the volume reached by
+ * each point or spot light (the sphere out of which its attenuation lowers it
+ * under cutOffIntensity) is assigned to the clusters it overlaps. A fragment
+ * then only evaluates the lights of its cluster, instead of all the lights of
+ * the scene: scenes with hundreds of local lights are lit at the cost of the
+ * few lights around each fragment.
+ *
+ * OpenGL 4.0 has no shader storage buffer: the lights and the clusters are
+ * read by the shaders from texture buffers, bound to the texture units from
+ * firstTextureUnit on, and the layout of the clusters is given by the std140
+ * uniform block "Clusters". A shader program is clustered when compiled with
+ * CLUSTERED_LIGHTS defined (see shaders/include/clustered.glsl): its point and
+ * spot lights then come from the clusters, with no limit on their number,
+ * while its directional lights still come from the block "Lights".
+ */
+class ClusteredLighting
+{
+    public:
+    /**@brief Number of tiles along the width of the screen. */
+    static const unsigned int clusterNumberX = 16;
+    /**@brief Number of tiles along the height of the screen. */
+    static const unsigned int clusterNumberY = 9;
+    /**@brief Number of depth slices. */
+    static const unsigned int clusterNumberZ = 24;
+    /**@brief First of the three texture units of the texture buffers, out of reach of the materials. */
+    static const unsigned int firstTextureUnit = 13;
+    /**@brief Intensity under which a light is ignored: it gives its range. */
+    static constexpr float cutOffIntensity = 1.0f / 256.0f;
+
+    /**
+     * @brief Constructor
+     *
+     * The GL objects are created at the first update, so that the clusters
+     * can be built before the OpenGL functions are loaded.
+     * @param bindingPoint The uniform buffer binding point of the block "Clusters".
+     */
+    ClusteredLighting(unsigned int bindingPoint);
+    ~ClusteredLighting();
+
+    /**
+     * @brief Assign the lights to the clusters of the view and upload them.
+     *
+     * The lights are assigned in parallel, one light then one depth slice per thread.
+     * @param camera The camera of the frame.
+     * @param width The width in pixels of the frame.
+     * @param height The height in pixels of the frame.
+     * @param pointLights The point lights of the scene.
+     * @param spotLights The spot lights of the scene.
+     */
+    void update(const Camera & camera, unsigned int width, unsigned int height,
+                const std::vector<PointLightPtr> & pointLights,
+                const std::vector<SpotLightPtr> & spotLights);
+
+    /**
+     * @brief Bind the texture buffers to their texture units and the block to its binding point.
+     */
+    void bind() const;
+
+    /**
+     * @brief Set the samplers of a clustered shader program to the texture units.
+     *
+     * @param program The program, bound.
+     */
+    void setSamplers(const ShaderProgramPtr & program) const;
+
+    /**
+     * @brief Number of point and spot lights at the last update.
+     *
+     * @return The number of lights.
+     */
+    unsigned int getLightNumber() const;
+
+    /**
+     * @brief Number of light indices in the clusters at the last update.
+     *
+     * Divided by the number of clusters, it is the average number of lights
+     * evaluated per fragment.
+     * @return The sum over the clusters of their number of lights.
+     */
+    unsigned int getAssignmentNumber() const;
+
+    /**
+     * @brief Distance beyond which a light is dimmer than cutOffIntensity.
+     *
+     * @param constant The constant attenuation coefficient.
+     * @param linear The linear attenuation coefficient.
+     * @param quadratic The quadratic attenuation coefficient.
+     * @param intensity The highest color component of the light.
+     * @return The range of the light, infinite if it is not attenuated.
+     */
+    static float getRange(float constant, float linear, float quadratic, float intensity);
+
+    /**
+     * @brief Rectangle of the screen covered by a sphere.
+     *
+     * The rectangle bounds the projection of the bounding box of the sphere.
+     * @param center The center of the sphere, in view space.
+     * @param radius The radius of the sphere.
+     * @param projection The projection matrix of the camera.
+     * @param znear The distance of the near plane of the camera.
+     * @param ndcMin The lower corner of the rectangle, in normalized device coordinates.
+     * @param ndcMax The upper corner of the rectangle, in normalized device coordinates.
+     * @return False if the sphere reaches the near plane: it may then cover the whole screen.
+     */
+    static bool getScreenBounds(const glm::vec3 & center, float radius, const glm::mat4 & projection, float znear,
+                                glm::vec2 & ndcMin, glm::vec2 & ndcMax);
+
+    private:
+    ClusteredLighting(const ClusteredLighting &);
+    ClusteredLighting & operator=(const ClusteredLighting &);
+
+    // std140 layout of the block "Clusters"
+    struct BlockData
+    {
+        glm::uvec4 grid;    /*!< Numbers of clusters along x, y and z, number of lights. */
+        glm::vec4 depth;    /*!< Slice of a view depth d: log(d) * depth.x + depth.y. */
+        glm::vec4 viewport; /*!< Size in pixels of the frame. */
+    };
+
+    // A light, as 5 RGBA texels of the light texture buffer. A point light
+    // is stored as a spot light whose cone is never cut off.
+    struct LightData
+    {
+        glm::vec3 position; float constant;
+        glm::vec3 spotDirection; float linear;
+        glm::vec3 ambient; float quadratic;
+        glm::vec3 diffuse; float innerCutOff;
+        glm::vec3 specular; float outerCutOff;
+    };
+
+    // The clusters overlapped by a light, from min to max included. Empty
+    // when min.x > max.x.
+    struct ClusterRange
+    {
+        glm::ivec3 min;
+        glm::ivec3 max;
+    };
+
+    /**@brief Clusters overlapped by the sphere of a light, in view space. */
+    ClusterRange getClusterRange(const glm::vec3 & center, float radius,
+                                 const glm::mat4 & projection, float znear, float zfar) const;
+    /**@brief Depth slice of a view depth, clamped to the slices. */
+    int getSlice(float depth) const;
+    /**@brief Fill a texture buffer, creating its storage. */
+    static void upload(unsigned int buffer, const void * data, std::size_t size);
+
+    BlockData m_data;
+    UniformBuffer m_block;                  /*!< The buffer of the block "Clusters". */
+    std::vector<LightData> m_lights;        /*!< The point lights, then the spot lights. */
+    std::vector<ClusterRange> m_ranges;     /*!< The clusters overlapped by each light. */
+    std::vector<glm::uvec2> m_clusters;     /*!< First index and number of lights of each cluster. */
+    std::vector< std::vector<unsigned int> > m_sliceIndices; /*!< Light indices of the clusters of each slice. */
+    std::vector<unsigned int> m_indices;    /*!< Light indices of all the clusters. */
+    unsigned int m_buffers[3];              /*!< Lights, clusters and indices. */
+    unsigned int m_textures[3];             /*!< Texture buffers of m_buffers. */
+};
+
+#endif //CLUSTERED_LIGHTING_HPP
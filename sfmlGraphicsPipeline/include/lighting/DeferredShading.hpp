@@ -0,0 +1,109 @@
+#ifndef DEFERRED_SHADING_HPP
+#define DEFERRED_SHADING_HPP
+
+#include "./../../include/ShaderProgram.hpp"
+#include "./../../include/Camera.hpp"
+#include "./Light.hpp"
+
+#include <vector>
+#include <glm/glm.hpp>
+
+/**
+ * @brief Shading of the opaque surfaces once per pixel, after they are all drawn.
+ *
+ * The forward shading computes all the lights for every fragment drawn, even
+ * those hidden afterwards by a closer surface. The deferred shading first
+ * draws the surfaces into a G-buffer, a set of textures holding for each pixel
+ * the position, the normal and the material of the closest surface, then
+ * shades each pixel once:
+ * - the directional lights are computed over the whole screen, which also
+ * copies the depth of the G-buffer into the target framebuffer, so that the
+ * forward renderables drawn afterwards are hidden by the deferred ones;
+ * - each point or spot light is computed over the rectangle of the screen its
+ * range reaches (see ClusteredLighting::getRange()), and added.
+ *
+ * A shader program writes the G-buffer when compiled with DEFERRED_SHADING
+ * defined (see Viewer::getDeferredShadingDefines() and
+ * shaders/include/gbuffer.glsl): phongFragment.glsl writes its surfels lit
+ * by the Phong illumination model, flatFragment.glsl its surfels unlit. The
+ * materials are stored on 8 bits, clamped to [0,1], and the G-buffer is not
+ * multisampled: the deferred surfaces are not antialiased. The transparent
+ * renderables keep a forward shader program.
+ */
+class DeferredShading
+{
+    public:
+    /**@brief Number of textures of the G-buffer, the depth included. */
+    static const unsigned int textureNumber = 6;
+
+    /**
+     * @brief Constructor
+     *
+     * The G-buffer and the lighting programs are created at the first
+     * geometry pass, once the OpenGL functions are loaded.
+     */
+    DeferredShading();
+    ~DeferredShading();
+
+    /**
+     * @brief Check if a shader program writes the G-buffer.
+     *
+     * @param program The shader program.
+     * @return True if the program linked was compiled with DEFERRED_SHADING defined.
+     */
+    static bool isDeferred(const ShaderProgram & program);
+
+    /**
+     * @brief Bind and clear the G-buffer, for the deferred renderables to be drawn.
+     *
+     * The G-buffer is created, or resized, to the size of the frame.
+     * @param width The width in pixels of the frame.
+     * @param height The height in pixels of the frame.
+     */
+    void beginGeometryPass(unsigned int width, unsigned int height);
+
+    /**
+     * @brief Light the G-buffer into the target framebuffer.
+     *
+     * The directional lights are read from the block "Lights".
+     * @param camera The camera of the frame.
+     * @param framebuffer The framebuffer drawn in, bound when returning.
+     * @param pointLights The point lights of the scene.
+     * @param spotLights The spot lights of the scene.
+     */
+    void shade(const Camera & camera, unsigned int framebuffer,
+               const std::vector<PointLightPtr> & pointLights,
+               const std::vector<SpotLightPtr> & spotLights);
+
+    /**
+     * @brief Number of point and spot lights drawn at the last shading.
+     *
+     * The lights out of the view are skipped.
+     * @return The number of light passes.
+     */
+    unsigned int getLightPassNumber() const;
+
+    private:
+    DeferredShading(const DeferredShading &);
+    DeferredShading & operator=(const DeferredShading &);
+
+    /**@brief Create the G-buffer textures for a size of frame, and the framebuffer at the first call. */
+    void create(unsigned int width, unsigned int height);
+    /**@brief Send the textures of the G-buffer and the camera position to a lighting program, bound. */
+    void setSamplers(const ShaderProgram & program, const glm::vec3 & cameraPosition) const;
+    /**@brief Add the light of a point or spot light, over the rectangle of the screen it reaches. */
+    void drawLight(const Camera & camera, const glm::vec3 & position, const glm::vec3 & spotDirection,
+                   const Light & light, float constant, float linear, float quadratic,
+                   float innerCutOff, float outerCutOff);
+
+    unsigned int m_framebuffer;                 /*!< The G-buffer. */
+    unsigned int m_textures[textureNumber];     /*!< Position, normal, ambient, diffuse, specular and depth. */
+    unsigned int m_width;                       /*!< Size of the textures. */
+    unsigned int m_height;
+    unsigned int m_vertexArray;                 /*!< Empty vertex array of the screen triangle. */
+    ShaderProgramPtr m_directionalProgram;      /*!< Lighting pass of the directional lights. */
+    ShaderProgramPtr m_localProgram;            /*!< Lighting pass of a point or spot light. */
+    unsigned int m_lightPassNumber;
+};
+
+#endif //DEFERRED_SHADING_HPP
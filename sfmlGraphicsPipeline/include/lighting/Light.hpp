@@ -313,7 +313,7 @@ class PointLight : public Light
      *
      * @return A const reference to m_quadratic.
      */
-    const float &quadratic() const { return m_linear; }
+    const float &quadratic() const { return m_quadratic; }
 
     /**
      * @brief Set the coefficient of quadratic attenuation of the light.
@@ -426,7 +426,7 @@ class SpotLight : public PointLight
      *
      * @return A const reference to m_outerCutOff.
      */
-    float outerCutOff() const { return m_innerCutOff; }
+    float outerCutOff() const { return m_outerCutOff; }
 
     /**
      * @brief Set the cosinus of the outer cut off angle of the spot.
@@ -0,0 +1,110 @@
+#ifndef LIGHT_BLOCK_HPP
+#define LIGHT_BLOCK_HPP
+
+#include "./../../include/UniformBuffer.hpp"
+#include "./Light.hpp"
+
+#include <vector>
+#include <glm/glm.hpp>
+
+/**
+ * @brief The lights of the scene, shared by all the shader programs.
+ *
+ * The lights are packed in the std140 uniform block "Lights" declared by
+ * the lit shaders (see phongFragment.glsl):
+ * \code{.glsl}
+ * layout(std140) uniform Lights
+ * {
+ *     DirectionalLight directionalLight[MAX_NR_DIRECTIONAL_LIGHTS];
+ *     PointLight pointLight[MAX_NR_POINT_LIGHTS];
+ *     SpotLight spotLight[MAX_NR_SPOT_LIGHTS];
+ *     int numberOfDirectionalLight;
+ *     int numberOfPointLight;
+ *     int numberOfSpotLight;
+ * };
+ * \endcode
+ * The lights are uploaded once per frame, whatever the number of shader
+ * programs using them, and not at all when they did not change.
+ */
+class LightBlock
+{
+    public:
+    /**
+     * @brief Maximal number of lights of each type, MAX_NR_*_LIGHTS in the shaders.
+     *
+     * The lights beyond are ignored, except by the programs reading their
+     * point and spot lights from clusters (see ClusteredLighting).
+     */
+    static const unsigned int maxLightNumber = 10;
+
+    /**
+     * @brief Constructor
+     *
+     * @param bindingPoint The uniform buffer binding point of the block.
+     */
+    LightBlock(unsigned int bindingPoint);
+
+    /**
+     * @brief Pack the lights in the block and upload it if it changed.
+     *
+     * @param directionalLights The directional lights of the scene.
+     * @param pointLights The point lights of the scene.
+     * @param spotLights The spot lights of the scene.
+     */
+    void update(const std::vector<DirectionalLightPtr> & directionalLights,
+                const std::vector<PointLightPtr> & pointLights,
+                const std::vector<SpotLightPtr> & spotLights);
+
+    /**
+     * @brief Access to the uniform buffer of the block.
+     *
+     * @return A reference to m_buffer.
+     */
+    UniformBuffer& buffer() { return m_buffer; }
+
+    private:
+    // std140 layout: a vec3 is aligned on 16 bytes, a scalar following
+    // a vec3 fills its last 4 bytes, and a structure is padded to 16 bytes.
+    struct DirectionalLightData
+    {
+        glm::vec3 direction; float padding0;
+        glm::vec3 ambient; float padding1;
+        glm::vec3 diffuse; float padding2;
+        glm::vec3 specular; float padding3;
+    };
+
+    struct PointLightData
+    {
+        glm::vec3 position; float padding0;
+        glm::vec3 ambient; float padding1;
+        glm::vec3 diffuse; float padding2;
+        glm::vec3 specular; float constant;
+        float linear; float quadratic; float padding3[2];
+    };
+
+    struct SpotLightData
+    {
+        glm::vec3 position; float padding0;
+        glm::vec3 spotDirection; float padding1;
+        glm::vec3 ambient; float padding2;
+        glm::vec3 diffuse; float padding3;
+        glm::vec3 specular; float constant;
+        float linear; float quadratic; float innerCutOff; float outerCutOff;
+    };
+
+    struct Data
+    {
+        DirectionalLightData directionalLight[maxLightNumber];
+        PointLightData pointLight[maxLightNumber];
+        SpotLightData spotLight[maxLightNumber];
+        int numberOfDirectionalLight;
+        int numberOfPointLight;
+        int numberOfSpotLight;
+        int padding;
+    };
+
+    Data m_data;            /*!< The block as laid out in the shaders. */
+    UniformBuffer m_buffer; /*!< The buffer of the block. */
+};
+
+#endif //LIGHT_BLOCK_HPP
@@ -38,8 +38,10 @@ class LightedMeshRenderable : public MeshRenderable
         LightedMeshRenderable(ShaderProgramPtr shaderProgram, bool indexed, const MaterialPtr & material);
 
         void do_draw();
+        void do_drawInstances(unsigned int buffer, std::size_t offset, unsigned int instanceNumber);
 
     private:
+        const void* do_getMaterialKey() const;
         MaterialPtr m_material;
 };
 
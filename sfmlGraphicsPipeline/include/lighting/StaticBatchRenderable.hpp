@@ -0,0 +1,134 @@
+#ifndef STATIC_BATCH_RENDERABLE_HPP
+#define STATIC_BATCH_RENDERABLE_HPP
+
+/**@file
+ *@brief Define a renderable merging static lighted meshes.
+ */
+
+#include "./../KeyframedHierarchicalRenderable.hpp"
+#include "./../VertexArray.hpp"
+#include "./../lighting/Material.hpp"
+
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include <GL/glew.h>
+
+/**@brief Lighted meshes that do not move relatively to each other, merged in shared buffers.
+ *
+ * A model split in one LightedMeshRenderable per material (see
+ * read_obj_with_materials()) has four vertex buffers and a draw call per part.
+ * A static batch merges the parts, placed once and for all in its object
+ * space, in a single set of vertex buffers and a single index buffer:
+ *
+ * - the parts are grouped by material, so that the parts of a material are
+ * contiguous in the index buffer;
+ * - at each frame, the parts out of the view frustum of the viewer are
+ * skipped, and the visible parts of each material are drawn with a single
+ * glMultiDrawElements() call. A material is sent once per frame.
+ *
+ * The batch as a whole is still a keyframed hierarchical renderable: it can
+ * be moved, animated and have children.
+ *
+ * A typical use:
+ * \code{.cpp}
+ * StaticBatchRenderablePtr train = std::make_shared<StaticBatchRenderable>(phongShader);
+ * train->addObj("train2.obj", "./");
+ * viewer.addRenderable(train);
+ * \endcode
+ */
+class StaticBatchRenderable : public KeyframedHierarchicalRenderable
+{
+    public:
+        ~StaticBatchRenderable();
+
+        /**@brief Build an empty batch.
+         *
+         * @param program The program drawing the batch, with the uniforms of a
+         * material (see Material::sendToGPU()).
+         */
+        StaticBatchRenderable(ShaderProgramPtr program);
+
+        /**@brief Add a mesh to the batch.
+         *
+         * @param positions The positions of the vertices.
+         * @param indices The indices of the triangles, empty for a non indexed mesh.
+         * @param normals The normals of the vertices.
+         * @param colors The colors of the vertices, white if empty.
+         * @param material The material of the mesh.
+         * @param transform The placement of the mesh in the object space of the batch.
+         */
+        void addMesh(const std::vector< glm::vec3 > & positions,
+                     const std::vector< unsigned int > & indices,
+                     const std::vector< glm::vec3 > & normals,
+                     const std::vector< glm::vec4 > & colors,
+                     const MaterialPtr & material,
+                     const glm::mat4 & transform = glm::mat4(1.0));
+
+        /**@brief Add the meshes of an OBJ file, one per material.
+         *
+         * @param obj_path The path of the OBJ file.
+         * @param mtl_basepath The directory of the material file.
+         * @param transform The placement of the meshes in the object space of the batch.
+         * @return False if the file could not be read.
+         */
+        bool addObj(const std::string & obj_path,
+                    const std::string & mtl_basepath,
+                    const glm::mat4 & transform = glm::mat4(1.0));
+
+        /**@brief Number of meshes added to the batch. */
+        unsigned int getMeshNumber() const;
+        /**@brief Number of materials, i.e. of draw calls when all the meshes are visible. */
+        unsigned int getMaterialNumber() const;
+        /**@brief Number of meshes drawn at the last frame, the others were out of view. */
+        unsigned int getDrawnMeshNumber() const;
+
+    private:
+        void do_draw();
+        BoundingBox do_getLocalBounds() const;
+
+        /**@brief Group the meshes by material and send the buffers to the GPU. */
+        void build();
+        void set_vertex_attributes();
+
+        /**@brief A mesh of the batch: a range of the index buffer. */
+        struct Mesh
+        {
+            MaterialPtr material;
+            unsigned int firstIndex;
+            unsigned int indexNumber;
+            BoundingBox bounds; /*!< In the object space of the batch. */
+        };
+
+        /**@brief The meshes of a material, contiguous in m_meshes once built. */
+        struct Group
+        {
+            MaterialPtr material;
+            unsigned int firstMesh;
+            unsigned int meshNumber;
+        };
+
+        std::vector< glm::vec3 > m_positions;
+        std::vector< glm::vec3 > m_normals;
+        std::vector< glm::vec4 > m_colors;
+        std::vector< unsigned int > m_indices;
+        std::vector< Mesh > m_meshes;
+        std::vector< Group > m_groups;
+        BoundingBox m_localBounds;
+        bool m_built; /*!< The buffers are up to date with the meshes. */
+
+        unsigned int m_pBuffer;
+        unsigned int m_nBuffer;
+        unsigned int m_cBuffer;
+        unsigned int m_iBuffer;
+        VertexArray m_vertexArray;
+
+        /**@brief The visible ranges of the index buffer of a material, for glMultiDrawElements(). */
+        std::vector< GLsizei > m_counts;
+        std::vector< const GLvoid* > m_offsets;
+        unsigned int m_drawnMeshNumber;
+};
+
+typedef std::shared_ptr<StaticBatchRenderable> StaticBatchRenderablePtr;
+
+#endif
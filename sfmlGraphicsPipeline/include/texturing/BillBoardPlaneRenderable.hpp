@@ -2,6 +2,7 @@
 #define BILLBOARD_PLANE_RENDERABLE_HPP
 
 #include "./../Renderable.hpp"
+#include "./../VertexArray.hpp"
 #include "./../lighting/Material.hpp"
 #include <vector>
 #include <glm/glm.hpp>
@@ -21,6 +22,8 @@ protected:
     void do_animate( float time );
 
 private:
+    const void* do_getMaterialKey() const;
+    unsigned int do_getTextureKey() const;
     void do_keyPressedEvent( sf::Event& e );
     void updateTextureOption();
 
@@ -32,6 +35,7 @@ private:
     unsigned int m_cBuffer;
     unsigned int m_tBuffer;
     unsigned int m_texId;
+    VertexArray m_vertexArray;
 
     MaterialPtr m_material;
 };
@@ -16,6 +16,11 @@ public:
     void update_textures_buffer();
 
 private:
+    /**@brief Not instanceable: the cube map is drawn alone, with its own depth test. */
+    bool do_isInstanceable() const;
+    unsigned int do_getTextureKey() const;
+    /**@brief Infinite bounds: the cube map surrounds the camera, it is never culled. */
+    BoundingBox do_getLocalBounds() const;
     void do_draw();
 
     cmutils::Cubemap m_cubemap;
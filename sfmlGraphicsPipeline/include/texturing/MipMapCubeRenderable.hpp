@@ -16,8 +16,12 @@ public :
 
 protected:
     void do_draw();
+    void set_vertex_attributes();
 
 private:
+    /**@brief Not instanceable: do_draw() binds the texture. */
+    bool do_isInstanceable() const;
+    unsigned int do_getTextureKey() const;
     void do_keyPressedEvent( sf::Event& e );
     void updateTextureOption();
     void gen_buffers();
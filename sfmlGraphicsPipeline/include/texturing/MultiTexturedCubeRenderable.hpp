@@ -17,8 +17,12 @@ public :
 
 protected:
     void do_draw();
+    void set_vertex_attributes();
 
 private:
+    /**@brief Not instanceable: do_draw() binds the textures. */
+    bool do_isInstanceable() const;
+    unsigned int do_getTextureKey() const;
     void gen_buffers();
     void update_buffers();
 
@@ -50,6 +50,7 @@ class TexturedLightedMeshRenderable : public TexturedMeshRenderable
         void do_draw();
 
     private:
+        const void* do_getMaterialKey() const;
         MaterialPtr m_material;
 };
 
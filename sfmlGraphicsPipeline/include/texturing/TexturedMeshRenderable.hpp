@@ -42,6 +42,7 @@ class TexturedMeshRenderable : public MeshRenderable
     protected:
         TexturedMeshRenderable(ShaderProgramPtr shaderProgram, bool indexed);
         void do_draw();
+        void set_vertex_attributes();
 
         unsigned int m_tBuffer;
         unsigned int m_texId;
@@ -50,6 +51,9 @@ class TexturedMeshRenderable : public MeshRenderable
         std::vector< glm::vec2 > m_original_tcoords;
 
     private:
+        /**@brief Not instanceable: do_draw() binds the texture. */
+        bool do_isInstanceable() const;
+        unsigned int do_getTextureKey() const;
         void do_keyPressedEvent( sf::Event& e );
         void updateTextureOption();
         void gen_buffers();
@@ -1,70 +1,14 @@
 #version 400
-uniform mat4  viewMat;
-//Structure definition for Material, DirectionalLight, PointLight and SpotLight
-//Parameters are exactly the same as the corresponding C++ classes
-//Refer to the C++ documentation for more information
-
-struct Material
-{
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-    float shininess;
-};
-
-struct DirectionalLight
-{
-    vec3 direction;
-
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-};
-
-struct PointLight
-{
-    vec3 position;
-
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-
-    float constant;
-    float linear;
-    float quadratic;
-};
-
-struct SpotLight
+layout(std140) uniform Camera
 {
-    vec3 position;
-    vec3 spotDirection;
-
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-
-    float constant;
-    float linear;
-    float quadratic;
-
-    float innerCutOff;
-    float outerCutOff;
+    mat4 projMat;
+    mat4 viewMat;
 };
+// Material and lights, shared with the other lighted shaders
+#include "include/lights.glsl"
 
 uniform Material material;
 
-#define MAX_NR_DIRECTIONAL_LIGHTS 10
-uniform int numberOfDirectionalLight = 0;
-uniform DirectionalLight directionalLight[MAX_NR_DIRECTIONAL_LIGHTS];
-
-#define MAX_NR_POINT_LIGHTS 10
-uniform int numberOfPointLight = 0;
-uniform PointLight pointLight[MAX_NR_POINT_LIGHTS];
-
-#define MAX_NR_SPOT_LIGHTS 10
-uniform int numberOfSpotLight = 0;
-uniform SpotLight spotLight[MAX_NR_SPOT_LIGHTS];
-
 uniform sampler2D texSampler;
 
 // Surfel: a SURFace ELement. All coordinates are in camera space
@@ -158,19 +102,15 @@ void main()
     //Surface to camera vector
     vec3 surfel_to_camera = normalize( - surfel_position );
 
-    int clampedNumberOfPointLight = max(0, min(numberOfPointLight, MAX_NR_POINT_LIGHTS));
-    int clampedNumberOfDirectionalLight = max(0, min(numberOfDirectionalLight, MAX_NR_DIRECTIONAL_LIGHTS));
-    int clampedNumberOfSpotLight = max(0, min(numberOfSpotLight, MAX_NR_SPOT_LIGHTS));
-
     vec3 tmpColor = vec3(0.0, 0.0, 0.0);
     
-    for(int i=0; i<clampedNumberOfDirectionalLight; ++i)
+    for(int i=0; i<DIRECTIONAL_LIGHT_NUMBER; ++i)
         tmpColor += computeDirectionalLight(directionalLight[i], surfel_to_camera);
 
-    for(int i=0; i<clampedNumberOfPointLight; ++i)
+    for(int i=0; i<POINT_LIGHT_NUMBER; ++i)
         tmpColor += computePointLight(pointLight[i], surfel_to_camera);
 
-    for(int i=0; i<clampedNumberOfSpotLight; ++i)
+    for(int i=0; i<SPOT_LIGHT_NUMBER; ++i)
         tmpColor += computeSpotLight(spotLight[i], surfel_to_camera);
 
     vec4 textureColor = texture(texSampler, surfel_texCoord);
@@ -1,6 +1,10 @@
 #version 400
 //uniforms
-uniform mat4 projMat, viewMat;
+layout(std140) uniform Camera
+{
+    mat4 projMat;
+    mat4 viewMat;
+};
 uniform vec3 billboard_world_position;
 uniform vec2 billboard_world_dimensions;
 
@@ -5,7 +5,11 @@ in vec3 vNormal;
 
 out vec3 tcoords;
 
-uniform mat4 projMat, viewMat;
+layout(std140) uniform Camera
+{
+    mat4 projMat;
+    mat4 viewMat;
+};
 
 void main()
 {
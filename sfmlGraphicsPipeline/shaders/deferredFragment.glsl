@@ -0,0 +1,63 @@
+#version 400
+
+// Lighting passes of the deferred shading (see the C++ class DeferredShading).
+// The surfels are read from the G-buffer written by the geometry pass:
+// - without LOCAL_LIGHT, the directional lights of the block Lights shade the
+//   whole screen, and the depth of the G-buffer is written;
+// - with LOCAL_LIGHT, the point or spot light "light" shades the rectangle of
+//   the screen it reaches, added to the previous passes.
+
+uniform sampler2D gPosition;
+uniform sampler2D gNormal;
+uniform sampler2D gAmbient;
+uniform sampler2D gDiffuse;
+uniform sampler2D gSpecular;
+uniform sampler2D gDepth;
+
+// Camera position in world space
+uniform vec3 cameraPosition;
+
+// The surfel of the fragment, read in main() before the lights are computed
+vec3 surfel_position;
+vec3 surfel_normal;
+
+// Material, lights and Phong illumination model, shared with the other lighted shaders
+#include "include/phong.glsl"
+
+#ifdef LOCAL_LIGHT
+// A point light is a spot light never cut off
+uniform SpotLight light;
+#endif
+
+out vec4 outColor;
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    float depth = texelFetch(gDepth, pixel, 0).r;
+    if(depth == 1.0)
+        discard;
+    vec4 normal = texelFetch(gNormal, pixel, 0);
+    surfel_position = texelFetch(gPosition, pixel, 0).xyz;
+    surfel_normal = normal.xyz;
+    material = Material(texelFetch(gAmbient, pixel, 0).rgb, texelFetch(gDiffuse, pixel, 0).rgb,
+                        texelFetch(gSpecular, pixel, 0).rgb, normal.w);
+    vec3 surfel_to_camera = normalize(cameraPosition - surfel_position);
+
+#ifdef LOCAL_LIGHT
+    if(surfel_normal == vec3(0.0))
+        discard;
+    outColor = vec4(computeSpotLight(light, surfel_to_camera), 1.0);
+#else
+    gl_FragDepth = depth;
+    if(surfel_normal == vec3(0.0))
+    {
+        outColor = vec4(material.diffuse, 1.0);
+        return;
+    }
+    vec3 color = vec3(0.0, 0.0, 0.0);
+    for(int i=0; i<DIRECTIONAL_LIGHT_NUMBER; ++i)
+        color += computeDirectionalLight(directionalLight[i], surfel_to_camera);
+    outColor = vec4(color, 1.0);
+#endif
+}
@@ -1,6 +1,11 @@
 #version 400
 
-uniform mat4 projMat, viewMat, modelMat;
+layout(std140) uniform Camera
+{
+    mat4 projMat;
+    mat4 viewMat;
+};
+uniform mat4 modelMat;
 
 // This is the normal inverse transpose matrix.
 // It is really important to obtain a normal in world coordinates.
@@ -1,8 +1,17 @@
 # version 400 // GLSL version, fit with OpenGL version
 in vec4 color;
 in vec3 normal;
+#ifdef DEFERRED_SHADING
+// The color is written to the G-buffer, unlit
+#include "include/gbuffer.glsl"
+void main ()
+{
+writeUnlitSurfel(color.rgb);
+}
+#else
 out vec4 fragmentColor;
 void main ()
 {
 fragmentColor = color;
 }
+#endif
@@ -1,5 +1,9 @@
 # version 400 // GLSL version, fit with OpenGL version
-uniform mat4 projMat, viewMat, modelMat;
+layout(std140) uniform Camera { mat4 projMat; mat4 viewMat; };
+uniform mat4 modelMat;
+// Model matrix of the instance, when the viewer draws identical renderables at once
+uniform bool instanced = false;
+in mat4 instanceModelMat;
 in vec3 vPosition;
 in vec4 vColor;
 in vec3 vNormal;
@@ -8,7 +12,8 @@ out vec3 normal;
 void main ()
 {
 // Transform coordinates from local space to clipped space
-gl_Position = projMat * viewMat * modelMat * vec4 (vPosition, 1);
+mat4 model = instanced ? instanceModelMat : modelMat;
+gl_Position = projMat * viewMat * model * vec4 (vPosition, 1);
 // remap vNormal from [-1,1] to [0,1]
 vec3 remappedNormal = (vNormal + 1.0) * 0.5;
 normal = remappedNormal;
@@ -0,0 +1,46 @@
+// Point and spot lights sorted into clusters of the view (see the C++ class
+// ClusteredLighting). A cluster is a tile of the screen times a slice of depth.
+
+// Layout of the clusters
+layout(std140) uniform Clusters
+{
+    uvec4 clusterGrid;      // Numbers of clusters along x, y and z, number of lights
+    vec4 clusterDepth;      // Slice of a view depth d: log(d) * clusterDepth.x + clusterDepth.y
+    vec4 clusterViewport;   // Size in pixels of the frame
+};
+
+layout(std140) uniform Camera
+{
+    mat4 projMat;
+    mat4 viewMat;
+};
+
+uniform samplerBuffer clusterLights;    // 5 texels per light, see fetchClusterLight()
+uniform usamplerBuffer clusterRanges;   // First index and number of lights of each cluster
+uniform usamplerBuffer clusterIndices;  // Light indices of the clusters
+
+// The range of clusterIndices listing the lights of the cluster of a fragment
+void getClusterLights(vec3 world_position, out int first, out int count)
+{
+    float depth = -(viewMat * vec4(world_position, 1.0)).z;
+    vec2 tile = clamp(floor(gl_FragCoord.xy / clusterViewport.xy * vec2(clusterGrid.xy)),
+                      vec2(0.0), vec2(clusterGrid.xy) - 1.0);
+    float slice = clamp(floor(log(max(depth, 1e-6)) * clusterDepth.x + clusterDepth.y),
+                        0.0, float(clusterGrid.z) - 1.0);
+    int cluster = int(tile.x) + int(clusterGrid.x) * (int(tile.y) + int(clusterGrid.y) * int(slice));
+    uvec2 range = texelFetch(clusterRanges, cluster).rg;
+    first = int(range.x);
+    count = int(range.y);
+}
+
+// A light of the clusters. The point lights are spot lights never cut off.
+SpotLight fetchClusterLight(int index)
+{
+    int texel = 5 * int(texelFetch(clusterIndices, index).r);
+    vec4 t0 = texelFetch(clusterLights, texel);
+    vec4 t1 = texelFetch(clusterLights, texel + 1);
+    vec4 t2 = texelFetch(clusterLights, texel + 2);
+    vec4 t3 = texelFetch(clusterLights, texel + 3);
+    vec4 t4 = texelFetch(clusterLights, texel + 4);
+    return SpotLight(t0.xyz, t1.xyz, t2.xyz, t3.xyz, t4.xyz, t0.w, t1.w, t2.w, t3.w, t4.w);
+}
@@ -0,0 +1,29 @@
+// Outputs of the geometry pass of the deferred shading (see the C++ class
+// DeferredShading). The lights are applied afterwards, by the lighting passes.
+// All coordinates are in world space.
+
+layout(location = 0) out vec4 gPosition;    // Position of the surfel
+layout(location = 1) out vec4 gNormal;      // Normal and shininess, a null normal for an unlit surfel
+layout(location = 2) out vec4 gAmbient;     // Material, modulated by the texture if any
+layout(location = 3) out vec4 gDiffuse;
+layout(location = 4) out vec4 gSpecular;
+
+// A surfel lit by the Phong illumination model
+void writeSurfel(vec3 position, vec3 normal, vec3 ambient, vec3 diffuse, vec3 specular, float shininess)
+{
+    gPosition = vec4(position, 1.0);
+    gNormal = vec4(normalize(normal), shininess);
+    gAmbient = vec4(ambient, 1.0);
+    gDiffuse = vec4(diffuse, 1.0);
+    gSpecular = vec4(specular, 1.0);
+}
+
+// A surfel displayed with its color, whatever the lights
+void writeUnlitSurfel(vec3 color)
+{
+    gPosition = vec4(0.0, 0.0, 0.0, 1.0);
+    gNormal = vec4(0.0);
+    gAmbient = vec4(0.0);
+    gDiffuse = vec4(color, 1.0);
+    gSpecular = vec4(0.0);
+}
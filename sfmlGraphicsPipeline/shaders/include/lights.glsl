@@ -0,0 +1,86 @@
+//Structure definition for Material, DirectionalLight, PointLight and SpotLight
+//Parameters are exactly the same as the corresponding C++ classes
+//Refer to the C++ documentation for more information
+
+struct Material
+{
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+    float shininess;
+};
+
+struct DirectionalLight
+{
+    vec3 direction;
+
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+};
+
+struct PointLight
+{
+    vec3 position;
+
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+
+    float constant;
+    float linear;
+    float quadratic;
+};
+
+struct SpotLight
+{
+    vec3 position;
+    vec3 spotDirection;
+
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+
+    float constant;
+    float linear;
+    float quadratic;
+
+    float innerCutOff;
+    float outerCutOff;
+};
+
+#define MAX_NR_DIRECTIONAL_LIGHTS 10
+#define MAX_NR_POINT_LIGHTS 10
+#define MAX_NR_SPOT_LIGHTS 10
+
+// The lights are shared by all the shader programs (std140 layout, see the C++ class LightBlock)
+layout(std140) uniform Lights
+{
+    DirectionalLight directionalLight[MAX_NR_DIRECTIONAL_LIGHTS];
+    PointLight pointLight[MAX_NR_POINT_LIGHTS];
+    SpotLight spotLight[MAX_NR_SPOT_LIGHTS];
+
+    int numberOfDirectionalLight;
+    int numberOfPointLight;
+    int numberOfSpotLight;
+};
+
+// Number of lights of each kind. A program compiled with NR_DIRECTIONAL_LIGHTS,
+// NR_POINT_LIGHTS and NR_SPOT_LIGHTS defined (see Viewer::getLightDefines())
+// knows them at compile time: its loops are unrolled, or removed for 0 lights.
+// Otherwise they are read from the block.
+#ifdef NR_DIRECTIONAL_LIGHTS
+#define DIRECTIONAL_LIGHT_NUMBER min(NR_DIRECTIONAL_LIGHTS, MAX_NR_DIRECTIONAL_LIGHTS)
+#else
+#define DIRECTIONAL_LIGHT_NUMBER max(0, min(numberOfDirectionalLight, MAX_NR_DIRECTIONAL_LIGHTS))
+#endif
+#ifdef NR_POINT_LIGHTS
+#define POINT_LIGHT_NUMBER min(NR_POINT_LIGHTS, MAX_NR_POINT_LIGHTS)
+#else
+#define POINT_LIGHT_NUMBER max(0, min(numberOfPointLight, MAX_NR_POINT_LIGHTS))
+#endif
+#ifdef NR_SPOT_LIGHTS
+#define SPOT_LIGHT_NUMBER min(NR_SPOT_LIGHTS, MAX_NR_SPOT_LIGHTS)
+#else
+#define SPOT_LIGHT_NUMBER max(0, min(numberOfSpotLight, MAX_NR_SPOT_LIGHTS))
+#endif
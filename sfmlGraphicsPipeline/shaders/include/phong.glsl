@@ -0,0 +1,117 @@
+// Phong illumination of a surfel by the lights of the block Lights.
+// The including shader declares the surfel inputs, in world space:
+//   in vec3 surfel_position;
+//   in vec3 surfel_normal;
+// With CLUSTERED_LIGHTS defined, the point and spot lights are instead those
+// of the cluster of the fragment, whatever their number.
+
+#include "lights.glsl"
+#ifdef CLUSTERED_LIGHTS
+#include "clustered.glsl"
+#endif
+
+#ifdef DEFERRED_LIGHTING
+// Read from the G-buffer by the lighting passes of the deferred shading
+Material material;
+#else
+uniform Material material;
+#endif
+
+//Phong illumination model for a directional light
+vec3 computeDirectionalLight(DirectionalLight light, vec3 surfel_to_camera)
+{
+    vec3 surfel_to_light = -light.direction;
+
+    // Diffuse shading
+    float diffuse_factor = max(dot(surfel_normal, surfel_to_light), 0.0);
+
+    // Specular shading
+    vec3 reflect_direction = reflect(-surfel_to_light, surfel_normal);
+    float specular_dot = clamp(dot(surfel_to_camera, reflect_direction), 0, 1);
+    float specular_factor = pow(specular_dot, material.shininess);
+
+    // Combine results
+    vec3 ambient  =                   light.ambient  * material.ambient ;
+    vec3 diffuse  = diffuse_factor  * light.diffuse  * material.diffuse ;
+    vec3 specular = specular_factor * light.specular * material.specular;
+
+    return (ambient + diffuse + specular);
+}
+
+//Phong illumination model for a point light
+vec3 computePointLight(PointLight light, vec3 surfel_to_camera)
+{
+    // Diffuse shading
+    vec3 surfel_to_light = light.position - surfel_position;
+    float distance = length( surfel_to_light );
+    surfel_to_light *= float(1) / distance;
+    float diffuse_factor = max(dot(surfel_normal, surfel_to_light), 0.0);
+
+    // Specular shading
+    vec3 reflect_direction = reflect(-surfel_to_light, surfel_normal);
+    float specular_dot = clamp(dot(surfel_to_camera, reflect_direction), 0, 1);
+    float specular_factor = pow(specular_dot, material.shininess);
+
+    // Attenuation
+    float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * distance * distance);
+
+    // Combine results
+    vec3 ambient  = attenuation *                   light.ambient  * material.ambient ;
+    vec3 diffuse  = attenuation * diffuse_factor  * light.diffuse  * material.diffuse ;
+    vec3 specular = attenuation * specular_factor * light.specular * material.specular;
+
+    return (ambient + diffuse + specular);
+}
+
+//Phong illumination model for a spot light
+vec3 computeSpotLight(SpotLight light, vec3 surfel_to_camera)
+{
+    // Diffuse
+    vec3 surfel_to_light = light.position - surfel_position;
+    float distance = length( surfel_to_light );
+    surfel_to_light *= float(1) / distance;
+    float diffuse_factor = max(dot(surfel_normal, surfel_to_light), 0.0);
+
+    // Specular
+    vec3 reflect_direction = reflect(-surfel_to_light, surfel_normal);
+    float specular_dot = clamp(dot(surfel_to_camera, reflect_direction), 0, 1);
+    float specular_factor = pow(specular_dot, material.shininess);
+
+    // Spotlight (soft edges)
+    float cos_phi = dot(surfel_to_light, -light.spotDirection);
+    float intensity = clamp((cos_phi - light.outerCutOff) / (light.innerCutOff - light.outerCutOff), 0, 1);
+
+    // Attenuation
+    float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * distance * distance);
+
+    // Combine results
+    vec3 ambient  =             attenuation *                   light.ambient  * material.ambient ;
+    vec3 diffuse  = intensity * attenuation * diffuse_factor  * light.diffuse  * material.diffuse ;
+    vec3 specular = intensity * attenuation * specular_factor * light.specular * material.specular;
+
+    return (ambient + diffuse + specular);
+}
+
+//Phong illumination model for all the lights
+vec3 computeLights(vec3 surfel_to_camera)
+{
+    vec3 color = vec3(0.0, 0.0, 0.0);
+
+    for(int i=0; i<DIRECTIONAL_LIGHT_NUMBER; ++i)
+        color += computeDirectionalLight(directionalLight[i], surfel_to_camera);
+
+#ifdef CLUSTERED_LIGHTS
+    int first, count;
+    getClusterLights(surfel_position, first, count);
+    for(int i=first; i<first+count; ++i)
+        color += computeSpotLight(fetchClusterLight(i), surfel_to_camera);
+#else
+    for(int i=0; i<POINT_LIGHT_NUMBER; ++i)
+        color += computePointLight(pointLight[i], surfel_to_camera);
+
+    for(int i=0; i<SPOT_LIGHT_NUMBER; ++i)
+        color += computeSpotLight(spotLight[i], surfel_to_camera);
+#endif
+
+    return color;
+}
@@ -1,6 +1,11 @@
 #version 400
 
-uniform mat4 projMat, viewMat, modelMat;
+layout(std140) uniform Camera
+{
+    mat4 projMat;
+    mat4 viewMat;
+};
+uniform mat4 modelMat;
 
 // This is the normal inverse transpose matrix.
 // It is really important to obtain a normal in world coordinates.
@@ -8,24 +13,42 @@ uniform mat4 projMat, viewMat, modelMat;
 // is quite expensive and the result is the same for all vertices.
 uniform mat3 NIT = mat3(1.0);
 
+// When the viewer draws identical renderables with a single draw call, their
+// model and normal matrices are per instance attributes instead.
+uniform bool instanced = false;
+in mat4 instanceModelMat;
+in mat3 instanceNIT;
+
 // Attributes
 in vec3 vPosition; 
 in vec4 vColor;   // Currently not used. You can use it to replace or combine with the diffuse component of the material
 in vec3 vNormal;
+#ifdef TEXTURED
+in vec2 vTexCoord;
+#endif
 
 // Surfel: a SURFace ELement. All coordinates are in world space
 out vec3 surfel_position;
 out vec3 surfel_normal;
 out vec4 surfel_color;
+#ifdef TEXTURED
+out vec2 surfel_texCoord;
+#endif
 
 out vec3 cameraPosition;
 
 void main()
 {
+    mat4 model = instanced ? instanceModelMat : modelMat;
+    mat3 normalMatrix = instanced ? instanceNIT : NIT;
+
     // All attributes are in world space
-    surfel_position = vec3(modelMat*vec4(vPosition,1.0f));
-    surfel_normal = normalize( NIT * vNormal);
+    surfel_position = vec3(model*vec4(vPosition,1.0f));
+    surfel_normal = normalize( normalMatrix * vNormal);
     surfel_color  = vColor;
+#ifdef TEXTURED
+    surfel_texCoord = vTexCoord;
+#endif
     
     // Compute the position of the camera in world space
     cameraPosition = - vec3( viewMat[3] ) * mat3( viewMat );
@@ -0,0 +1,80 @@
+#include "./../include/BoundingBox.hpp"
+
+#include <cmath>
+#include <limits>
+
+BoundingBox::BoundingBox()
+  : m_min( std::numeric_limits< float >::max() ), m_max( -std::numeric_limits< float >::max() )
+{}
+
+BoundingBox::BoundingBox( const glm::vec3& min, const glm::vec3& max )
+  : m_min( min ), m_max( max )
+{}
+
+BoundingBox BoundingBox::infinite()
+{
+  const float infinity = std::numeric_limits< float >::infinity();
+  return BoundingBox( glm::vec3( -infinity ), glm::vec3( infinity ) );
+}
+
+bool BoundingBox::isEmpty() const
+{
+  return m_min.x > m_max.x || m_min.y > m_max.y || m_min.z > m_max.z;
+}
+
+bool BoundingBox::isInfinite() const
+{
+  for( int i = 0; i < 3; ++ i )
+    if( std::isinf( m_min[i] ) || std::isinf( m_max[i] ) )
+      return true;
+  return false;
+}
+
+void BoundingBox::extend( const glm::vec3& point )
+{
+  m_min = glm::min( m_min, point );
+  m_max = glm::max( m_max, point );
+}
+
+void BoundingBox::extend( const BoundingBox& box )
+{
+  if( box.isEmpty() )
+    return;
+  m_min = glm::min( m_min, box.m_min );
+  m_max = glm::max( m_max, box.m_max );
+}
+
+BoundingBox BoundingBox::transform( const glm::mat4& transform ) const
+{
+  if( isEmpty() || isInfinite() )
+    return *this;
+
+  // The extents along the world axes are the sums of the transformed local
+  // extents, in absolute value (Arvo, Graphics Gems, 1990)
+  const glm::vec3 center = glm::vec3( transform * glm::vec4( getCenter(), 1.0f ) );
+  const glm::vec3 extent = 0.5f * ( m_max - m_min );
+  glm::vec3 transformedExtent( 0.0f );
+  for( int column = 0; column < 3; ++ column )
+    transformedExtent += glm::abs( glm::vec3( transform[column] ) ) * extent[column];
+  return BoundingBox( center - transformedExtent, center + transformedExtent );
+}
+
+const glm::vec3& BoundingBox::getMin() const
+{
+  return m_min;
+}
+
+const glm::vec3& BoundingBox::getMax() const
+{
+  return m_max;
+}
+
+glm::vec3 BoundingBox::getCenter() const
+{
+  return 0.5f * ( m_min + m_max );
+}
+
+float BoundingBox::getRadius() const
+{
+  return 0.5f * glm::length( m_max - m_min );
+}
@@ -6,6 +6,11 @@
 #include <glm/gtc/type_ptr.hpp>
 #include <GL/glew.h>
 
+// Names of the uniforms and attributes, resolved once per shader program
+static const ShaderProgram::Handle model_handle( "modelMat" );
+static const ShaderProgram::Handle position_handle( "vPosition" );
+static const ShaderProgram::Handle color_handle( "vColor" );
+
 CubeRenderable::CubeRenderable(ShaderProgramPtr shaderProgram)
 	: Renderable(shaderProgram), m_vBuffer(0), m_cBuffer(0)
 {
@@ -61,31 +66,34 @@ CubeRenderable::CubeRenderable(ShaderProgramPtr shaderProgram)
 void CubeRenderable::do_draw()
 {
 	// Get the identifier ( location ) of the uniform modelMat in the shader program
-	int modelLocation = m_shaderProgram->getUniformLocation("modelMat");
+	int modelLocation = m_shaderProgram->getUniformLocation(model_handle);
 	// Send the data corresponding to this identifier on the GPU
 	glUniformMatrix4fv(modelLocation, 1, GL_FALSE, glm::value_ptr(m_model));
 
-	// Get the identifier of the attribute vPosition in the shader program
-	int positionLocation = m_shaderProgram->getAttributeLocation("vPosition");
-	// Activate the attribute array at this location
-	glEnableVertexAttribArray(positionLocation);
-	// Bind the position buffer on the GL_ARRAY_BUFFER target
-	glBindBuffer(GL_ARRAY_BUFFER, m_vBuffer);
-	// Specify the location and the format of the vertex position attribute
-	glVertexAttribPointer(positionLocation, 3, GL_FLOAT, GL_FALSE, 0, (void *)0);
-
-	int colorLocation = m_shaderProgram->getAttributeLocation("vColor");
-	glEnableVertexAttribArray(colorLocation);
-	glBindBuffer(GL_ARRAY_BUFFER, m_cBuffer);
-	glVertexAttribPointer(colorLocation, 3, GL_FLOAT, GL_FALSE, 0, (void *)0);
+	// Bind the vertex array object of the shader program. The attributes are
+	// only specified when this VAO has just been built: it remembers them.
+	if (m_vertexArray.bind(*m_shaderProgram))
+	{
+		// Get the identifier of the attribute vPosition in the shader program
+		int positionLocation = m_shaderProgram->getAttributeLocation(position_handle);
+		// Activate the attribute array at this location
+		glEnableVertexAttribArray(positionLocation);
+		// Bind the position buffer on the GL_ARRAY_BUFFER target
+		glBindBuffer(GL_ARRAY_BUFFER, m_vBuffer);
+		// Specify the location and the format of the vertex position attribute
+		glVertexAttribPointer(positionLocation, 3, GL_FLOAT, GL_FALSE, 0, (void *)0);
 
+		int colorLocation = m_shaderProgram->getAttributeLocation(color_handle);
+		glEnableVertexAttribArray(colorLocation);
+		glBindBuffer(GL_ARRAY_BUFFER, m_cBuffer);
+		glVertexAttribPointer(colorLocation, 3, GL_FLOAT, GL_FALSE, 0, (void *)0);
+	}
 
 	// Draw the triangles
 	glDrawArrays(GL_TRIANGLES, 0, m_positions.size());
 
-	// Release the vertex attribute array
-	glDisableVertexAttribArray(positionLocation);
-	glDisableVertexAttribArray(colorLocation);
+	// Release the vertex array object
+	VertexArray::unbind();
 }
 
 CubeRenderable::~CubeRenderable()
@@ -0,0 +1,167 @@
+#include "./../include/FrameCapture.hpp"
+#include "./../include/gl_helper.hpp"
+#include "./../include/log.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+FrameCapture::FrameCapture( unsigned int threadNumber )
+  : m_next( 0 ), m_busyThreadNumber( 0 ), m_stopping( false )
+{
+  for( unsigned int i = 0; i < bufferNumber; ++ i )
+  {
+    glcheck(glGenBuffers( 1, &m_readbacks[i].buffer ));
+    m_readbacks[i].fence = 0;
+    m_readbacks[i].width = m_readbacks[i].height = 0;
+  }
+  for( unsigned int i = 0; i < std::max( threadNumber, 1u ); ++ i )
+    m_threads.push_back( std::thread( &FrameCapture::work, this ) );
+}
+
+FrameCapture::~FrameCapture()
+{
+  finish();
+  {
+    std::lock_guard< std::mutex > lock( m_mutex );
+    m_stopping = true;
+  }
+  m_jobAdded.notify_all();
+  for( std::thread& thread : m_threads )
+    thread.join();
+  for( unsigned int i = 0; i < bufferNumber; ++ i )
+    glcheck(glDeleteBuffers( 1, &m_readbacks[i].buffer ));
+}
+
+void FrameCapture::capture( unsigned int width, unsigned int height, const std::string& filename )
+{
+  update();
+
+  // All the buffers are busy: the oldest one is waited for
+  Readback& readback = m_readbacks[m_next];
+  if( readback.fence )
+    retire( readback );
+
+  // The copy into a pixel pack buffer returns before the frame is done
+  const GLsizeiptr size = 4 * GLsizeiptr( width ) * height;
+  glcheck(glBindBuffer( GL_PIXEL_PACK_BUFFER, readback.buffer ));
+  if( width != readback.width || height != readback.height )
+    glcheck(glBufferData( GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ ));
+  glcheck(glPixelStorei( GL_PACK_ALIGNMENT, 1 ));
+  glcheck(glReadPixels( 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, (void*)0 ));
+  glcheck(glBindBuffer( GL_PIXEL_PACK_BUFFER, 0 ));
+  readback.fence = glFenceSync( GL_SYNC_GPU_COMMANDS_COMPLETE, 0 );
+  readback.width = width;
+  readback.height = height;
+  readback.filename = filename;
+  m_next = ( m_next + 1 ) % bufferNumber;
+}
+
+void FrameCapture::update()
+{
+  // From the oldest copy, which completes first
+  for( unsigned int i = 0; i < bufferNumber; ++ i )
+  {
+    Readback& readback = m_readbacks[( m_next + i ) % bufferNumber];
+    if( !readback.fence )
+      continue;
+    GLenum status = glClientWaitSync( readback.fence, 0, 0 );
+    if( status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED )
+      break;
+    retire( readback );
+  }
+}
+
+void FrameCapture::retire( Readback& readback )
+{
+  // Flush the commands, so that the fence is eventually signaled
+  while( true )
+  {
+    GLenum status = glClientWaitSync( readback.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000 );
+    if( status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED )
+      break;
+    if( status == GL_WAIT_FAILED )
+    {
+      LOG( error, "waiting for the capture of " << readback.filename << " failed" );
+      break;
+    }
+  }
+  glcheck(glDeleteSync( readback.fence ));
+  readback.fence = 0;
+
+  Job job;
+  job.width = readback.width;
+  job.height = readback.height;
+  job.filename = readback.filename;
+  job.pixels.resize( 4 * std::size_t( job.width ) * job.height );
+  glcheck(glBindBuffer( GL_PIXEL_PACK_BUFFER, readback.buffer ));
+  const void* pixels = glMapBufferRange( GL_PIXEL_PACK_BUFFER, 0, job.pixels.size(), GL_MAP_READ_BIT );
+  if( pixels )
+  {
+    std::memcpy( job.pixels.data(), pixels, job.pixels.size() );
+    glcheck(glUnmapBuffer( GL_PIXEL_PACK_BUFFER ));
+  }
+  glcheck(glBindBuffer( GL_PIXEL_PACK_BUFFER, 0 ));
+  if( !pixels )
+  {
+    LOG( error, "the capture of " << job.filename << " could not be mapped" );
+    return;
+  }
+
+  // The render thread only waits when the workers are far behind
+  std::unique_lock< std::mutex > lock( m_mutex );
+  while( m_jobs.size() >= maxQueuedFrameNumber )
+    m_jobDone.wait( lock );
+  m_jobs.push_back( std::move( job ) );
+  lock.unlock();
+  m_jobAdded.notify_one();
+}
+
+void FrameCapture::finish()
+{
+  for( unsigned int i = 0; i < bufferNumber; ++ i )
+  {
+    Readback& readback = m_readbacks[( m_next + i ) % bufferNumber];
+    if( readback.fence )
+      retire( readback );
+  }
+  std::unique_lock< std::mutex > lock( m_mutex );
+  while( !m_jobs.empty() || m_busyThreadNumber )
+    m_jobDone.wait( lock );
+}
+
+unsigned int FrameCapture::getPendingFrameNumber()
+{
+  unsigned int number = 0;
+  for( unsigned int i = 0; i < bufferNumber; ++ i )
+    if( m_readbacks[i].fence )
+      ++ number;
+  std::lock_guard< std::mutex > lock( m_mutex );
+  return number + m_jobs.size() + m_busyThreadNumber;
+}
+
+void FrameCapture::work()
+{
+  std::unique_lock< std::mutex > lock( m_mutex );
+  while( true )
+  {
+    while( m_jobs.empty() && !m_stopping )
+      m_jobAdded.wait( lock );
+    if( m_jobs.empty() )
+      return;
+    Job job = std::move( m_jobs.front() );
+    m_jobs.pop_front();
+    ++ m_busyThreadNumber;
+    lock.unlock();
+
+    // The rows of OpenGL go upwards, those of the images downwards
+    sf::Image image;
+    image.create( job.width, job.height, job.pixels.data() );
+    image.flipVertically();
+    if( !image.saveToFile( job.filename ) )
+      LOG( error, "Error while saving " << job.filename );
+
+    lock.lock();
+    -- m_busyThreadNumber;
+    m_jobDone.notify_all();
+  }
+}
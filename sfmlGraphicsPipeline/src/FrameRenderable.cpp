@@ -149,4 +149,9 @@ void FrameRenderable::do_draw()
     glcheck(glLineWidth(1.0f));
 }
 
-FrameRenderable::~FrameRenderable(){}
\ No newline at end of file
+FrameRenderable::~FrameRenderable(){}
+
+bool FrameRenderable::do_isInstanceable() const
+{
+    return false;
+}
@@ -0,0 +1,53 @@
+#include "./../include/Frustum.hpp"
+
+Frustum::Frustum()
+{
+  for( int i = 0; i < 6; ++ i )
+    m_planes[i] = glm::vec4( 0.0f, 0.0f, 0.0f, 1.0f );
+}
+
+Frustum::Frustum( const glm::mat4& projection, const glm::mat4& view )
+{
+  // A point p is inside when -w <= x, y, z <= w in clip space, i.e. when
+  // (row3 +/- row_i) . p >= 0 for the rows of the projection-view matrix
+  const glm::mat4 clip = glm::transpose( projection * view );
+  for( int i = 0; i < 3; ++ i )
+  {
+    m_planes[2 * i] = clip[3] + clip[i];
+    m_planes[2 * i + 1] = clip[3] - clip[i];
+  }
+  // Normalized, so that the offset of a plane is a distance (sphere test)
+  for( int i = 0; i < 6; ++ i )
+    m_planes[i] /= glm::length( glm::vec3( m_planes[i] ) );
+}
+
+bool Frustum::intersects( const BoundingBox& box ) const
+{
+  if( box.isEmpty() )
+    return false;
+  if( box.isInfinite() )
+    return true;
+
+  // The box is outside when its corner furthest along the normal of a plane
+  // is behind this plane
+  const glm::vec3& min = box.getMin();
+  const glm::vec3& max = box.getMax();
+  for( int i = 0; i < 6; ++ i )
+  {
+    const glm::vec4& plane = m_planes[i];
+    const glm::vec3 corner( plane.x > 0.0f ? max.x : min.x,
+                            plane.y > 0.0f ? max.y : min.y,
+                            plane.z > 0.0f ? max.z : min.z );
+    if( glm::dot( glm::vec3( plane ), corner ) + plane.w < 0.0f )
+      return false;
+  }
+  return true;
+}
+
+bool Frustum::intersects( const glm::vec3& center, float radius ) const
+{
+  for( int i = 0; i < 6; ++ i )
+    if( glm::dot( glm::vec3( m_planes[i] ), center ) + m_planes[i].w < -radius )
+      return false;
+  return true;
+}
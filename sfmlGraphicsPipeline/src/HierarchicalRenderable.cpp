@@ -5,12 +5,38 @@
 #include <GL/glew.h>
 #include <iostream>
 
+struct HierarchicalRenderable::Hierarchy
+{
+    /** The root instance, from which the hierarchy is flattened. */
+    HierarchicalRenderable* root;
+    /** The instances, in pre-order: a parent always comes before its children. */
+    std::vector< HierarchicalRenderable* > nodes;
+    /** The index in nodes of the parent of each instance, -1 for the root. */
+    std::vector< int > parents;
+    /** Whether the total global transform of each instance changed during an update. */
+    std::vector< char > updated;
+    /** Whether nodes matches the hierarchy, i.e. no child was added since it was built. */
+    bool flattened;
+    /** Whether a transform changed since the last update. */
+    bool changed;
+    /** The frame of the viewer the bounds were computed for, 0 for none. */
+    unsigned int boundsFrame;
+};
+
 HierarchicalRenderable::~HierarchicalRenderable(){}
 
 HierarchicalRenderable::HierarchicalRenderable(ShaderProgramPtr shaderProgram) : 
-    Renderable(shaderProgram), m_parent( nullptr ),
+    Renderable(shaderProgram), m_hierarchy( std::make_shared< Hierarchy >() ),
+    m_totalGlobalTransform( glm::mat4(1.0) ),
+    m_globalTransformChanged( true ), m_localTransformChanged( true ),
+    m_renderableNumber( 1 ), m_parent( nullptr ),
     m_globalTransform( glm::mat4(1.0) ), m_localTransform( glm::mat4(1.0) )
-{}
+{
+    m_hierarchy->root = this;
+    m_hierarchy->flattened = false;
+    m_hierarchy->changed = true;
+    m_hierarchy->boundsFrame = 0;
+}
 
 
 const glm::mat4& HierarchicalRenderable::getGlobalTransform() const
@@ -20,14 +46,68 @@ const glm::mat4& HierarchicalRenderable::getGlobalTransform() const
 
 void HierarchicalRenderable::setGlobalTransform( const glm::mat4& globalTransform )
 {
+    //Keyframed animations set the same transform again once they reach their last keyframe
+    if( globalTransform == m_globalTransform )
+        return;
     m_globalTransform = globalTransform;
+    m_globalTransformChanged = true;
+    m_hierarchy->changed = true;
 }
 
 void HierarchicalRenderable::updateModelMatrix()
 {
-    //TODO: Get absolute model matrix
-    //m_model = m_globalTransform * m_localTransform;
-    m_model = computeTotalGlobalTransform()*m_localTransform;
+    updateHierarchy( *m_hierarchy );
+}
+
+void HierarchicalRenderable::updateHierarchy( Hierarchy& hierarchy )
+{
+    if( !hierarchy.changed )
+        return;
+
+    if( !hierarchy.flattened )
+    {
+        hierarchy.nodes.clear();
+        hierarchy.parents.clear();
+        hierarchy.root->flatten( hierarchy, -1 );
+        hierarchy.updated.resize( hierarchy.nodes.size() );
+        hierarchy.flattened = true;
+    }
+
+    //A parent is updated before its children: its total global transform is up to
+    //date when they are reached, and they know if it changed
+    for(size_t i=0; i<hierarchy.nodes.size(); ++i)
+    {
+        HierarchicalRenderable& node = *hierarchy.nodes[i];
+        const int parent = hierarchy.parents[i];
+        const bool globalChanged = node.m_globalTransformChanged || ( parent >= 0 && hierarchy.updated[parent] );
+        if( globalChanged )
+        {
+            node.m_totalGlobalTransform = parent >= 0 ?
+                hierarchy.nodes[parent]->m_totalGlobalTransform * node.m_globalTransform : node.m_globalTransform;
+        }
+        if( globalChanged || node.m_localTransformChanged )
+            node.m_model = node.m_totalGlobalTransform * node.m_localTransform;
+        hierarchy.updated[i] = globalChanged;
+        node.m_globalTransformChanged = false;
+        node.m_localTransformChanged = false;
+    }
+    hierarchy.changed = false;
+}
+
+void HierarchicalRenderable::flatten( Hierarchy& hierarchy, int parent )
+{
+    const int index = hierarchy.nodes.size();
+    hierarchy.nodes.push_back( this );
+    hierarchy.parents.push_back( parent );
+    for(size_t i=0; i<m_children.size(); ++i)
+        m_children[i]->flatten( hierarchy, index );
+}
+
+void HierarchicalRenderable::joinHierarchy( const std::shared_ptr< Hierarchy >& hierarchy )
+{
+    m_hierarchy = hierarchy;
+    for(size_t i=0; i<m_children.size(); ++i)
+        m_children[i]->joinHierarchy( hierarchy );
 }
 
 const glm::mat4& HierarchicalRenderable::getLocalTransform() const
@@ -37,7 +117,11 @@ const glm::mat4& HierarchicalRenderable::getLocalTransform() const
 
 void HierarchicalRenderable::setLocalTransform(const glm::mat4& localTransform)
 {
+    if( localTransform == m_localTransform )
+        return;
     m_localTransform = localTransform;
+    m_localTransformChanged = true;
+    m_hierarchy->changed = true;
 }
 
 glm::mat4 HierarchicalRenderable::computeTotalGlobalTransform() const
@@ -57,8 +141,8 @@ void HierarchicalRenderable::beforeDraw()
 {
     //Each time m_localTransform is modified we need to update the model matrix of the instance.
     //Each time m_globalTransform is modified we need to udpate the model matrix of the instance and its children.
-    //This could be implemented efficiently using a flag system to update the hierarchy whenever m_globalTransform is called.
-    //However this is a simple implementation and we chose to pay the price of a brutal update before each draw.
+    //The setters flag these modifications: the first instance drawn updates the whole hierarchy,
+    //and the next ones find it up to date.
     updateModelMatrix();
 }
 
@@ -71,7 +155,7 @@ void HierarchicalRenderable::afterDraw()
     //-Bind their respective shaderProgram
     //-Send projection and view matrix to the GPU
     //-Draw the object ;)
-    //-Unbind their respective shaderProgram.
+    //-Bind our shaderProgram again, the Viewer only binds a program when it changes.
     for(size_t i=0; i<m_children.size(); ++i)
     {
         // this affectation here is a little hack we use to keep the source code simple.
@@ -81,15 +165,57 @@ void HierarchicalRenderable::afterDraw()
         // affectation here: we are then sure this field is up-to-date when a do_draw() method is called.
         m_children[i]->m_viewer = m_viewer;
 
+        // A child out of the view is not drawn, nor are its own children
+        if( m_viewer->isCulled(*m_children[i]) )
+            continue;
+
         m_children[i]->bindShaderProgram();
         glcheck(glUniformMatrix4fv(m_children[i]->projectionLocation(), 1, GL_FALSE, glm::value_ptr(m_viewer->getCamera().projectionMatrix())));
         glcheck(glUniformMatrix4fv(m_children[i]->viewLocation(), 1, GL_FALSE, glm::value_ptr(m_viewer->getCamera().viewMatrix())));
         m_children[i]->draw();
-        m_children[i]->unbindShaderProgram();
     }
+    if(!m_children.empty())
+        bindShaderProgram();
 
 }
 
+BoundingBox HierarchicalRenderable::do_getWorldBounds() const
+{
+    //The bounds of the whole hierarchy are computed once per frame, by the first
+    //of its instances asked for them: the viewer may cull a descendant added to
+    //it before the root. Out of a viewer, they are computed at each call.
+    Hierarchy& hierarchy = *m_hierarchy;
+    const unsigned int frame = m_viewer ? m_viewer->getFrameNumber() : 0;
+    if( !frame || hierarchy.boundsFrame != frame )
+    {
+        //The bounds need the model matrices of this frame
+        updateHierarchy( hierarchy );
+
+        //The descendants of an instance come after it: going backwards, the bounds
+        //of an instance are complete when they are merged into its parent ones
+        for(size_t i=0; i<hierarchy.nodes.size(); ++i)
+        {
+            const HierarchicalRenderable& node = *hierarchy.nodes[i];
+            node.m_bounds = node.getLocalBounds().transform( node.m_model );
+            node.m_renderableNumber = 1;
+        }
+        for(size_t i=hierarchy.nodes.size(); i-- > 1; )
+        {
+            const HierarchicalRenderable& node = *hierarchy.nodes[i];
+            const HierarchicalRenderable& parent = *hierarchy.nodes[ hierarchy.parents[i] ];
+            parent.m_bounds.extend( node.m_bounds );
+            parent.m_renderableNumber += node.m_renderableNumber;
+        }
+        hierarchy.boundsFrame = frame;
+    }
+    return m_bounds;
+}
+
+unsigned int HierarchicalRenderable::do_getRenderableNumber() const
+{
+    return m_renderableNumber;
+}
+
 void HierarchicalRenderable::afterAnimate(float time)
 {
     //After the instance has been animated using do_animate,
@@ -102,9 +228,22 @@ void HierarchicalRenderable::addChild( HierarchicalRenderablePtr parent, Hierarc
 {
     child->m_parent = parent;
     parent->m_children.push_back(child);
+
+    //The hierarchy of the child is merged into the one of the parent, and the child
+    //is now positioned relatively to its parent
+    child->joinHierarchy( parent->m_hierarchy );
+    child->m_globalTransformChanged = true;
+    parent->m_hierarchy->flattened = false;
+    parent->m_hierarchy->changed = true;
+    parent->m_hierarchy->boundsFrame = 0;
 }
 
 std::vector< HierarchicalRenderablePtr > & HierarchicalRenderable::getChildren()
 {
     return m_children;
 }
+
+const std::vector< HierarchicalRenderablePtr > & HierarchicalRenderable::getChildren() const
+{
+    return m_children;
+}
@@ -3,6 +3,11 @@
 #include <glm/gtc/type_ptr.hpp>
 #include <GL/glew.h>
 
+// Names of the uniforms and attributes, resolved once per shader program
+static const ShaderProgram::Handle model_handle( "modelMat" );
+static const ShaderProgram::Handle position_handle( "vPosition" );
+static const ShaderProgram::Handle color_handle( "vColor" );
+
 IndexedCubeRenderable::IndexedCubeRenderable(ShaderProgramPtr shaderProgram)
     : Renderable(shaderProgram), m_vBuffer(0), m_cBuffer(0), m_iBuffer(0)
 {
@@ -49,28 +54,33 @@ IndexedCubeRenderable::IndexedCubeRenderable(ShaderProgramPtr shaderProgram)
 void IndexedCubeRenderable::do_draw()
 {
     // Send model matrix to GPU
-    int modelLocation = m_shaderProgram->getUniformLocation("modelMat");
+    int modelLocation = m_shaderProgram->getUniformLocation(model_handle);
     glUniformMatrix4fv(modelLocation, 1, GL_FALSE, glm::value_ptr(m_model));
 
-    // Bind vertex positions
-    int positionLocation = m_shaderProgram->getAttributeLocation("vPosition");
-    glEnableVertexAttribArray(positionLocation);
-    glBindBuffer(GL_ARRAY_BUFFER, m_vBuffer);
-    glVertexAttribPointer(positionLocation, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
+    // Specify the attributes only when the VAO of the program is built
+    if (m_vertexArray.bind(*m_shaderProgram))
+    {
+        // Bind vertex positions
+        int positionLocation = m_shaderProgram->getAttributeLocation(position_handle);
+        glEnableVertexAttribArray(positionLocation);
+        glBindBuffer(GL_ARRAY_BUFFER, m_vBuffer);
+        glVertexAttribPointer(positionLocation, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
 
-    // Bind vertex colors
-    int colorLocation = m_shaderProgram->getAttributeLocation("vColor");
-    glEnableVertexAttribArray(colorLocation);
-    glBindBuffer(GL_ARRAY_BUFFER, m_cBuffer);
-    glVertexAttribPointer(colorLocation, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
+        // Bind vertex colors
+        int colorLocation = m_shaderProgram->getAttributeLocation(color_handle);
+        glEnableVertexAttribArray(colorLocation);
+        glBindBuffer(GL_ARRAY_BUFFER, m_cBuffer);
+        glVertexAttribPointer(colorLocation, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
 
-    // Bind index buffer and draw
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_iBuffer);
+        // Bind index buffer, it is part of the VAO state
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_iBuffer);
+    }
+
+    // Draw
     glDrawElements(GL_TRIANGLES, m_indices.size(), GL_UNSIGNED_INT, (void*)0);
 
-    // Disable vertex attributes
-    glDisableVertexAttribArray(positionLocation);
-    glDisableVertexAttribArray(colorLocation);
+    // Release the vertex array object
+    VertexArray::unbind();
 }
 
 IndexedCubeRenderable::~IndexedCubeRenderable()
@@ -3,15 +3,60 @@
 #include "./../include/log.hpp"
 #include "./../include/Io.hpp"
 #include "./../include/Utils.hpp"
+#include "./../include/MeshSimplification.hpp"
+#include "./../include/Viewer.hpp"
 
 
 #include <glm/gtc/type_ptr.hpp>
+#include <unordered_map>
+
+// Names of the uniforms and attributes, resolved once per shader program
+static const ShaderProgram::Handle model_handle( "modelMat" );
+static const ShaderProgram::Handle nit_handle( "NIT" );
+static const ShaderProgram::Handle position_handle( "vPosition" );
+static const ShaderProgram::Handle color_handle( "vColor" );
+static const ShaderProgram::Handle normal_handle( "vNormal" );
+static const ShaderProgram::Handle instanced_handle( "instanced" );
+static const ShaderProgram::Handle instance_model_handle( "instanceModelMat" );
+static const ShaderProgram::Handle instance_nit_handle( "instanceNIT" );
+
+// A level of detail is only chosen when its error on screen is below this
+// fraction of the threshold, and kept until the error exceeds the threshold
+static const float lod_hysteresis = 0.75f;
+
+// 64 bits FNV-1a hash of the content of a vector, followed by its size
+template< typename T >
+static void hash_vector( std::uint64_t& hash, const std::vector< T >& values )
+{
+    const std::uint64_t prime = 1099511628211ull;
+    const unsigned char* bytes = reinterpret_cast< const unsigned char* >( values.data() );
+    for(size_t i=0; i<values.size()*sizeof(T); ++i)
+        hash = ( hash ^ bytes[i] ) * prime;
+    hash = ( hash ^ values.size() ) * prime;
+}
+
+// The key of a mesh content: the same address for all the meshes with this
+// content, as long as one of them is alive
+static std::shared_ptr< const std::uint64_t > geometry_key( std::uint64_t hash )
+{
+    static std::unordered_map< std::uint64_t, std::weak_ptr< const std::uint64_t > > keys;
+    std::weak_ptr< const std::uint64_t >& key = keys[hash];
+    std::shared_ptr< const std::uint64_t > shared = key.lock();
+    if(!shared)
+    {
+        shared = std::make_shared< const std::uint64_t >( hash );
+        key = shared;
+    }
+    return shared;
+}
 
 
 MeshRenderable::MeshRenderable(ShaderProgramPtr program,
                                const std::string & mesh_filename) :
     KeyframedHierarchicalRenderable(program),
-    m_pBuffer(0), m_cBuffer(0), m_nBuffer(0), m_iBuffer(0), m_mode(GL_TRIANGLES), m_indexed(true)
+    m_pBuffer(0), m_cBuffer(0), m_nBuffer(0), m_iBuffer(0), m_mode(GL_TRIANGLES), m_indexed(true),
+    m_levelThreshold(1.0f), m_level(0),
+    m_geometryChanged(true), m_geometryProgram(nullptr)
 {
     // TODO: 
     read_obj(mesh_filename, m_positions, m_indices, m_normals, m_tcoords);
@@ -27,7 +72,9 @@ MeshRenderable::MeshRenderable(ShaderProgramPtr program,
                                const std::vector< glm::vec4 > & colors) :
     KeyframedHierarchicalRenderable(program),
     m_positions(positions), m_indices(indices), m_normals(normals), m_colors(colors),
-    m_pBuffer(0), m_cBuffer(0), m_nBuffer(0), m_iBuffer(0), m_mode(GL_TRIANGLES), m_indexed(true)
+    m_pBuffer(0), m_cBuffer(0), m_nBuffer(0), m_iBuffer(0), m_mode(GL_TRIANGLES), m_indexed(true),
+    m_levelThreshold(1.0f), m_level(0),
+    m_geometryChanged(true), m_geometryProgram(nullptr)
 {
     set_random_colors();
     gen_buffers();
@@ -40,7 +87,9 @@ MeshRenderable::MeshRenderable(ShaderProgramPtr program,
                                const std::vector< glm::vec4 > & colors) :
     KeyframedHierarchicalRenderable(program),
     m_positions(positions), m_normals(normals), m_colors(colors),
-    m_pBuffer(0), m_cBuffer(0), m_nBuffer(0), m_iBuffer(0), m_mode(GL_TRIANGLES), m_indexed(false)
+    m_pBuffer(0), m_cBuffer(0), m_nBuffer(0), m_iBuffer(0), m_mode(GL_TRIANGLES), m_indexed(false),
+    m_levelThreshold(1.0f), m_level(0),
+    m_geometryChanged(true), m_geometryProgram(nullptr)
 {
     set_random_colors();
     gen_buffers();
@@ -49,7 +98,9 @@ MeshRenderable::MeshRenderable(ShaderProgramPtr program,
 
 MeshRenderable::MeshRenderable(ShaderProgramPtr program, bool indexed) :
     KeyframedHierarchicalRenderable(program), m_indexed(indexed),
-    m_pBuffer(0), m_cBuffer(0), m_nBuffer(0), m_iBuffer(0), m_mode(GL_TRIANGLES)
+    m_pBuffer(0), m_cBuffer(0), m_nBuffer(0), m_iBuffer(0), m_mode(GL_TRIANGLES),
+    m_levelThreshold(1.0f), m_level(0),
+    m_geometryChanged(true), m_geometryProgram(nullptr)
 {
     gen_buffers();
 }
@@ -79,32 +130,193 @@ void MeshRenderable::update_all_buffers(){
 void MeshRenderable::update_positions_buffer(){
     glcheck(glBindBuffer(GL_ARRAY_BUFFER, m_pBuffer));
     glcheck(glBufferData(GL_ARRAY_BUFFER, m_positions.size()*sizeof(glm::vec3), m_positions.data(), GL_STATIC_DRAW));
+
+    //The bounds follow the positions sent to the GPU
+    m_localBounds = BoundingBox();
+    for(const glm::vec3 & position : m_positions)
+        m_localBounds.extend(position);
+    m_geometryChanged = true;
+    m_levels.clear();
+    m_level = 0;
 }
 void MeshRenderable::update_colors_buffer(){
     glcheck(glBindBuffer(GL_ARRAY_BUFFER, m_cBuffer));
     glcheck(glBufferData(GL_ARRAY_BUFFER, m_colors.size()*sizeof(glm::vec4), m_colors.data(), GL_STATIC_DRAW));
+    m_geometryChanged = true;
 }
 void MeshRenderable::update_normals_buffer(){
     glcheck(glBindBuffer(GL_ARRAY_BUFFER, m_nBuffer));
     glcheck(glBufferData(GL_ARRAY_BUFFER, m_normals.size()*sizeof(glm::vec3), m_normals.data(), GL_STATIC_DRAW));
+    m_geometryChanged = true;
 }
 void MeshRenderable::update_indices_buffer(){
     glcheck(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_iBuffer));
     glcheck(glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_indices.size()*sizeof(unsigned int), m_indices.data(), GL_STATIC_DRAW));
+    m_geometryChanged = true;
+    m_levels.clear();
+    m_level = 0;
+}
+
+void MeshRenderable::generateLevelsOfDetail(unsigned int levelNumber, float ratio)
+{
+    if (!m_indexed || m_mode != GL_TRIANGLES){
+        LOG(warning, "only the indexed triangle meshes have levels of detail");
+        return;
+    }
+
+    std::vector< MeshLevel > levels;
+    simplify_mesh(m_positions, m_normals, m_indices, levelNumber, ratio, levels);
+
+    //The levels follow the full mesh in the index buffer
+    std::vector< unsigned int > indices(m_indices);
+    m_levels.clear();
+    for(const MeshLevel & level : levels)
+    {
+        LevelOfDetail lod = { (unsigned int)indices.size(), (unsigned int)level.indices.size(), level.error };
+        indices.insert(indices.end(), level.indices.begin(), level.indices.end());
+        m_levels.push_back(lod);
+    }
+    m_level = 0;
+    glcheck(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_iBuffer));
+    glcheck(glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size()*sizeof(unsigned int), indices.data(), GL_STATIC_DRAW));
+    m_geometryChanged = true;
+}
+
+void MeshRenderable::setLevelOfDetailThreshold(float pixels)
+{
+    m_levelThreshold = pixels;
+}
+
+unsigned int MeshRenderable::getLevelOfDetailNumber() const
+{
+    return m_levels.size();
+}
+
+unsigned int MeshRenderable::getLevelOfDetail() const
+{
+    return m_level;
+}
+
+void MeshRenderable::selectLevelOfDetail() const
+{
+    if (m_levels.empty() || !m_viewer || !m_viewer->getLevelsOfDetail()){
+        m_level = 0;
+        return;
+    }
+
+    //The errors are projected at the point of the bounds nearest to the camera
+    const glm::mat4 & model = getModelMatrix();
+    const BoundingBox bounds = m_localBounds.transform(model);
+    const float distance = glm::length(bounds.getCenter() - m_viewer->getCamera().getPosition()) - bounds.getRadius();
+    if (distance <= 0.0f){
+        m_level = 0;
+        return;
+    }
+    const float scale = std::max(glm::length(glm::vec3(model[0])), std::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+    const float pixelsPerError = scale * m_viewer->getPixelsPerUnit(distance);
+
+    //Finer while the error is visible, coarser while the next error is well below the threshold
+    while (m_level > 0 && m_levels[m_level-1].error * pixelsPerError > m_levelThreshold)
+        -- m_level;
+    while (m_level < m_levels.size() && m_levels[m_level].error * pixelsPerError < lod_hysteresis * m_levelThreshold)
+        ++ m_level;
 }
 
 void MeshRenderable::do_draw()
 {
-    
-    int positionLocation = m_shaderProgram->getAttributeLocation("vPosition");
-    int colorLocation = m_shaderProgram->getAttributeLocation("vColor");
-    int normalLocation = m_shaderProgram->getAttributeLocation("vNormal");
-    int modelLocation = m_shaderProgram->getUniformLocation("modelMat");
-    int nitLocation = m_shaderProgram->getUniformLocation("NIT");
+    int modelLocation = m_shaderProgram->getUniformLocation(model_handle);
+    int nitLocation = m_shaderProgram->getUniformLocation(nit_handle);
 
     if(modelLocation != ShaderProgram::null_location)
         glcheck(glUniformMatrix4fv(modelLocation, 1, GL_FALSE, glm::value_ptr(getModelMatrix())));
 
+    if( nitLocation != ShaderProgram::null_location )
+    {
+    glcheck(glUniformMatrix3fv( nitLocation, 1, GL_FALSE,
+        glm::value_ptr(getNormalMatrix())));
+    }
+
+    //The attributes are only specified when the VAO of the program is built
+    if (m_vertexArray.bind(*m_shaderProgram))
+        set_vertex_attributes();
+
+    //Draw triangles elements, of the level of detail of the frame
+    selectLevelOfDetail();
+    if (m_indexed && m_level > 0){
+        const LevelOfDetail & lod = m_levels[m_level-1];
+        glcheck(glDrawElements(m_mode, lod.indexNumber, GL_UNSIGNED_INT, (void*)(lod.firstIndex*sizeof(unsigned int))));
+    }else if (m_indexed){
+        glcheck(glDrawElements(m_mode, m_indices.size(), GL_UNSIGNED_INT, (void*)0));
+    }else{
+        glcheck(glDrawArrays(m_mode,0, m_positions.size()));
+    }
+
+    VertexArray::unbind();
+}
+
+void MeshRenderable::do_drawInstances(unsigned int buffer, std::size_t offset, unsigned int instanceNumber)
+{
+    //The uniform "instanced" is only true during this draw, so that the other
+    //renderables drawn with this program do not have to reset it
+    int instancedLocation = m_shaderProgram->getUniformLocation(instanced_handle);
+    int modelLocation = m_shaderProgram->getAttributeLocation(instance_model_handle);
+    int nitLocation = m_shaderProgram->getAttributeLocation(instance_nit_handle);
+
+    if(instancedLocation != ShaderProgram::null_location)
+        glcheck(glUniform1i(instancedLocation, GL_TRUE));
+
+    if (m_vertexArray.bind(*m_shaderProgram))
+        set_vertex_attributes();
+
+    //The instance attributes are only enabled for this draw: a matrix attribute
+    //takes one location per column
+    const GLsizei stride = sizeof(InstanceData);
+    glcheck(glBindBuffer(GL_ARRAY_BUFFER, buffer));
+    for(int column=0; column<4; ++column)
+    {
+        glcheck(glEnableVertexAttribArray(modelLocation + column));
+        glcheck(glVertexAttribPointer(modelLocation + column, 4, GL_FLOAT, GL_FALSE, stride,
+            (void*)(offset + column * sizeof(glm::vec4))));
+        glcheck(glVertexAttribDivisor(modelLocation + column, 1));
+    }
+    if(nitLocation != ShaderProgram::null_location)
+    {
+        for(int column=0; column<3; ++column)
+        {
+            glcheck(glEnableVertexAttribArray(nitLocation + column));
+            glcheck(glVertexAttribPointer(nitLocation + column, 3, GL_FLOAT, GL_FALSE, stride,
+                (void*)(offset + sizeof(glm::mat4) + column * sizeof(glm::vec3))));
+            glcheck(glVertexAttribDivisor(nitLocation + column, 1));
+        }
+    }
+
+    //The level of detail was selected with the mesh key: it is the same for all the instances
+    if (m_indexed && m_level > 0){
+        const LevelOfDetail & lod = m_levels[m_level-1];
+        glcheck(glDrawElementsInstanced(m_mode, lod.indexNumber, GL_UNSIGNED_INT, (void*)(lod.firstIndex*sizeof(unsigned int)), instanceNumber));
+    }else if (m_indexed){
+        glcheck(glDrawElementsInstanced(m_mode, m_indices.size(), GL_UNSIGNED_INT, (void*)0, instanceNumber));
+    }else{
+        glcheck(glDrawArraysInstanced(m_mode, 0, m_positions.size(), instanceNumber));
+    }
+
+    for(int column=0; column<4; ++column)
+        glcheck(glDisableVertexAttribArray(modelLocation + column));
+    if(nitLocation != ShaderProgram::null_location)
+        for(int column=0; column<3; ++column)
+            glcheck(glDisableVertexAttribArray(nitLocation + column));
+    if(instancedLocation != ShaderProgram::null_location)
+        glcheck(glUniform1i(instancedLocation, GL_FALSE));
+
+    VertexArray::unbind();
+}
+
+void MeshRenderable::set_vertex_attributes()
+{
+    int positionLocation = m_shaderProgram->getAttributeLocation(position_handle);
+    int colorLocation = m_shaderProgram->getAttributeLocation(color_handle);
+    int normalLocation = m_shaderProgram->getAttributeLocation(normal_handle);
+
     if(positionLocation != ShaderProgram::null_location)
     {
         glcheck(glEnableVertexAttribArray(positionLocation));
@@ -126,34 +338,52 @@ void MeshRenderable::do_draw()
         glcheck(glVertexAttribPointer(normalLocation, 3, GL_FLOAT, GL_FALSE, 0, (void*)0));
     }
 
-    if( nitLocation != ShaderProgram::null_location )
-    {
-    glcheck(glUniformMatrix3fv( nitLocation, 1, GL_FALSE,
-        glm::value_ptr(glm::transpose(glm::inverse(glm::mat3(getModelMatrix()))))));
-    }
-
-    //Draw triangles elements
-    if (m_indexed){
+    //The element buffer binding is part of the VAO state
+    if (m_indexed)
         glcheck(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_iBuffer));
-        glcheck(glDrawElements(m_mode, m_indices.size(), GL_UNSIGNED_INT, (void*)0));
-    }else{
-        glcheck(glDrawArrays(m_mode,0, m_positions.size()));
-    }
+}
 
-    if(positionLocation != ShaderProgram::null_location)
-    {
-        glcheck(glDisableVertexAttribArray(positionLocation));
-    }
+BoundingBox MeshRenderable::do_getLocalBounds() const
+{
+    return m_localBounds;
+}
 
-    if(colorLocation != ShaderProgram::null_location)
-    {
-        glcheck(glDisableVertexAttribArray(colorLocation));
-    }
+bool MeshRenderable::do_isInstanceable() const
+{
+    //The children of an instance would not be drawn
+    return getChildren().empty() && m_shaderProgram
+        && m_shaderProgram->getAttributeLocation(instance_model_handle) != ShaderProgram::null_location;
+}
 
-    if(normalLocation != ShaderProgram::null_location)
+const void* MeshRenderable::do_getMeshKey() const
+{
+    if(!isInstanceable())
+        return this;
+
+    //Hash what the program reads, only when the buffers or the program changed:
+    //meshes differing by their random colors are the same for a program ignoring them
+    if(m_geometryChanged || m_geometryProgram != m_shaderProgram.get())
     {
-        glcheck(glDisableVertexAttribArray(normalLocation));
+        std::uint64_t hash = 14695981039346656037ull;
+        hash_vector(hash, m_positions);
+        if(m_shaderProgram->getAttributeLocation(normal_handle) != ShaderProgram::null_location)
+            hash_vector(hash, m_normals);
+        if(m_shaderProgram->getAttributeLocation(color_handle) != ShaderProgram::null_location)
+            hash_vector(hash, m_colors);
+        hash_vector(hash, m_indices);
+        hash = (hash ^ m_mode) * 1099511628211ull;
+        hash = (hash ^ (m_indexed ? 1 : 0)) * 1099511628211ull;
+        m_geometryKey = geometry_key(hash);
+        m_levelKeys.clear();
+        for(size_t level=1; level<=m_levels.size(); ++level)
+            m_levelKeys.push_back(geometry_key((hash ^ level) * 1099511628211ull));
+        m_geometryProgram = m_shaderProgram.get();
+        m_geometryChanged = false;
     }
+
+    //The renderables of a mesh are only drawn together at the same level of detail
+    selectLevelOfDetail();
+    return m_level > 0 ? m_levelKeys[m_level-1].get() : m_geometryKey.get();
 }
 
 void MeshRenderable::set_random_colors(){
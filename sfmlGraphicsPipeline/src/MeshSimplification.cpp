@@ -0,0 +1,396 @@
+#include "./../include/MeshSimplification.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <unordered_map>
+
+// Weight of the planes along the borders, relatively to the planes of the triangles
+static const double border_weight = 10.0;
+// A collapse is rejected when it turns a triangle by more than about 80 degrees
+static const double min_normal_cosine = 0.2;
+
+namespace
+{
+    // Symmetric 4x4 matrix of a quadric error: the sum of the squared distances
+    // to some planes, weighted by the areas the planes come from
+    struct Quadric
+    {
+        double a[10];
+        double weight;
+
+        Quadric() : weight(0.0)
+        {
+            std::fill(a, a + 10, 0.0);
+        }
+
+        void addPlane(const glm::dvec3& n, double d, double w)
+        {
+            a[0] += w*n.x*n.x; a[1] += w*n.x*n.y; a[2] += w*n.x*n.z; a[3] += w*n.x*d;
+            a[4] += w*n.y*n.y; a[5] += w*n.y*n.z; a[6] += w*n.y*d;
+            a[7] += w*n.z*n.z; a[8] += w*n.z*d;
+            a[9] += w*d*d;
+            weight += w;
+        }
+
+        void add(const Quadric& other)
+        {
+            for(int i=0; i<10; ++i)
+                a[i] += other.a[i];
+            weight += other.weight;
+        }
+
+        double evaluate(const glm::dvec3& p) const
+        {
+            return a[0]*p.x*p.x + 2.0*a[1]*p.x*p.y + 2.0*a[2]*p.x*p.z + 2.0*a[3]*p.x
+                 + a[4]*p.y*p.y + 2.0*a[5]*p.y*p.z + 2.0*a[6]*p.y
+                 + a[7]*p.z*p.z + 2.0*a[8]*p.z
+                 + a[9];
+        }
+    };
+
+    // Removal of the vertices at a position by moving them on a neighbor position
+    struct Collapse
+    {
+        double cost;
+        float error;
+        unsigned int source; /*!< The removed position. */
+        unsigned int target;
+        unsigned int version; /*!< Version of the source when the collapse was computed. */
+
+        bool operator>(const Collapse& other) const
+        {
+            return cost > other.cost;
+        }
+    };
+
+    struct PositionHash
+    {
+        std::size_t operator()(const glm::vec3& p) const
+        {
+            std::uint32_t bits[3];
+            std::memcpy(bits, &p[0], sizeof(bits));
+            return std::hash<std::uint64_t>()((std::uint64_t(bits[0]) * 73856093u) ^ (std::uint64_t(bits[1]) * 19349663u) ^ (std::uint64_t(bits[2]) * 83492791u));
+        }
+    };
+
+    // The vertices duplicated at a seam share a position: the collapses move
+    // positions, i.e. all the vertices at a position, so that seams do not tear
+    class QuadricSimplifier
+    {
+    public:
+        QuadricSimplifier(const std::vector<glm::vec3>& positions, const std::vector<glm::vec3>& normals,
+                          const std::vector<unsigned int>& indices);
+
+        /**@brief Collapse positions until at most targetNumber triangles remain, or no collapse is left. */
+        void simplify(unsigned int targetNumber);
+        unsigned int getTriangleNumber() const { return m_triangleNumber; }
+        float getError() const { return m_error; }
+        void getIndices(std::vector<unsigned int>& indices) const;
+
+    private:
+        void computeQuadrics();
+        /**@brief Queue the cheapest valid collapse of a position, replacing the queued ones. */
+        void updateCollapse(unsigned int position);
+        /**@brief The vertex at the target position replacing a vertex at the source position. */
+        unsigned int getTargetVertex(unsigned int vertex, unsigned int target) const;
+        bool flips(unsigned int source, unsigned int target) const;
+        void collapse(const Collapse& c);
+        void getNeighbors(unsigned int position, std::vector<unsigned int>& neighbors) const;
+
+        const std::vector<glm::vec3>& m_positions;
+        const std::vector<glm::vec3>& m_normals;
+        std::vector<unsigned int> m_triangles; /*!< Three vertex indices per triangle, updated by the collapses. */
+        std::vector<bool> m_removedTriangles;
+        unsigned int m_triangleNumber;
+        std::vector< std::vector<unsigned int> > m_vertexTriangles; /*!< Triangles around each vertex, removed ones included. */
+        std::vector<unsigned int> m_welded; /*!< Position of each vertex: the first vertex at this position. */
+        std::vector< std::vector<unsigned int> > m_weldedVertices; /*!< Vertices at each position. */
+        std::vector<bool> m_removedPositions;
+        std::vector<unsigned int> m_versions;
+        std::vector<Quadric> m_quadrics; /*!< Quadric of each position. */
+        std::priority_queue< Collapse, std::vector<Collapse>, std::greater<Collapse> > m_queue;
+        float m_error;
+    };
+}
+
+QuadricSimplifier::QuadricSimplifier(const std::vector<glm::vec3>& positions, const std::vector<glm::vec3>& normals,
+                                     const std::vector<unsigned int>& indices) :
+    m_positions(positions), m_normals(normals), m_triangleNumber(0), m_error(0.0f)
+{
+    const unsigned int vertexNumber = positions.size();
+
+    //The vertices at the same position are welded
+    std::unordered_map< glm::vec3, unsigned int, PositionHash > welded;
+    m_welded.resize(vertexNumber);
+    m_weldedVertices.resize(vertexNumber);
+    for(unsigned int v=0; v<vertexNumber; ++v)
+    {
+        m_welded[v] = welded.insert(std::make_pair(positions[v], v)).first->second;
+        m_weldedVertices[m_welded[v]].push_back(v);
+    }
+
+    //Degenerate triangles are dropped
+    for(size_t i=0; i+2<indices.size(); i+=3)
+    {
+        const unsigned int a = indices[i], b = indices[i+1], c = indices[i+2];
+        if(a >= vertexNumber || b >= vertexNumber || c >= vertexNumber
+                || m_welded[a] == m_welded[b] || m_welded[b] == m_welded[c] || m_welded[c] == m_welded[a])
+            continue;
+        m_triangles.push_back(a);
+        m_triangles.push_back(b);
+        m_triangles.push_back(c);
+    }
+    m_triangleNumber = m_triangles.size() / 3;
+    m_removedTriangles.assign(m_triangleNumber, false);
+
+    m_vertexTriangles.resize(vertexNumber);
+    for(unsigned int t=0; t<m_triangleNumber; ++t)
+        for(int k=0; k<3; ++k)
+            m_vertexTriangles[m_triangles[3*t+k]].push_back(t);
+
+    computeQuadrics();
+
+    m_removedPositions.assign(vertexNumber, false);
+    m_versions.assign(vertexNumber, 0);
+    for(unsigned int v=0; v<vertexNumber; ++v)
+        if(m_welded[v] == v)
+            updateCollapse(v);
+}
+
+void QuadricSimplifier::computeQuadrics()
+{
+    m_quadrics.resize(m_positions.size());
+
+    //The planes of the triangles, and the number of triangles along each edge of the welded surface
+    std::unordered_map< std::uint64_t, unsigned int > edgeTriangleNumbers;
+    std::vector<glm::dvec3> normals(m_triangleNumber);
+    for(unsigned int t=0; t<m_triangleNumber; ++t)
+    {
+        const glm::dvec3 p0(m_positions[m_triangles[3*t]]);
+        const glm::dvec3 p1(m_positions[m_triangles[3*t+1]]);
+        const glm::dvec3 p2(m_positions[m_triangles[3*t+2]]);
+        glm::dvec3 n = glm::cross(p1 - p0, p2 - p0);
+        const double doubleArea = glm::length(n);
+        if(doubleArea == 0.0)
+            continue;
+        n /= doubleArea;
+        normals[t] = n;
+        for(int k=0; k<3; ++k)
+        {
+            m_quadrics[m_welded[m_triangles[3*t+k]]].addPlane(n, -glm::dot(n, p0), 0.5 * doubleArea);
+            const std::uint64_t a = m_welded[m_triangles[3*t+k]], b = m_welded[m_triangles[3*t+(k+1)%3]];
+            ++ edgeTriangleNumbers[std::min(a, b) << 32 | std::max(a, b)];
+        }
+    }
+
+    //The borders are kept in place by planes orthogonal to their triangle
+    for(unsigned int t=0; t<m_triangleNumber; ++t)
+    {
+        if(normals[t] == glm::dvec3(0.0))
+            continue;
+        for(int k=0; k<3; ++k)
+        {
+            const std::uint64_t a = m_welded[m_triangles[3*t+k]], b = m_welded[m_triangles[3*t+(k+1)%3]];
+            if(edgeTriangleNumbers[std::min(a, b) << 32 | std::max(a, b)] != 1)
+                continue;
+            const glm::dvec3 pa(m_positions[a]), pb(m_positions[b]);
+            const glm::dvec3 edge = pb - pa;
+            const glm::dvec3 n = glm::normalize(glm::cross(edge, normals[t]));
+            m_quadrics[a].addPlane(n, -glm::dot(n, pa), border_weight * glm::dot(edge, edge));
+            m_quadrics[b].addPlane(n, -glm::dot(n, pa), border_weight * glm::dot(edge, edge));
+        }
+    }
+}
+
+unsigned int QuadricSimplifier::getTargetVertex(unsigned int vertex, unsigned int target) const
+{
+    //A vertex of a triangle along the collapsed edge keeps its attributes...
+    for(unsigned int t : m_vertexTriangles[vertex])
+        if(!m_removedTriangles[t])
+            for(int k=0; k<3; ++k)
+                if(m_welded[m_triangles[3*t+k]] == target)
+                    return m_triangles[3*t+k];
+
+    //...the others, e.g. across the edges of a flat shaded mesh, take the closest normal
+    const std::vector<unsigned int>& candidates = m_weldedVertices[target];
+    unsigned int best = candidates.front();
+    if(m_normals.size() == m_positions.size())
+        for(unsigned int candidate : candidates)
+            if(glm::dot(m_normals[candidate], m_normals[vertex]) > glm::dot(m_normals[best], m_normals[vertex]))
+                best = candidate;
+    return best;
+}
+
+bool QuadricSimplifier::flips(unsigned int source, unsigned int target) const
+{
+    const glm::dvec3 targetPosition(m_positions[target]);
+    for(unsigned int vertex : m_weldedVertices[source])
+    {
+        for(unsigned int t : m_vertexTriangles[vertex])
+        {
+            if(m_removedTriangles[t])
+                continue;
+            glm::dvec3 before[3], after[3];
+            bool collapsed = false;
+            for(int k=0; k<3; ++k)
+            {
+                const unsigned int v = m_triangles[3*t+k];
+                collapsed = collapsed || m_welded[v] == target;
+                before[k] = glm::dvec3(m_positions[v]);
+                after[k] = v == vertex ? targetPosition : before[k];
+            }
+            //The triangles along the collapsed edge disappear
+            if(collapsed)
+                continue;
+            const glm::dvec3 nBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+            const glm::dvec3 nAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+            const double lengths = glm::length(nBefore) * glm::length(nAfter);
+            if(lengths == 0.0 || glm::dot(nBefore, nAfter) < min_normal_cosine * lengths)
+                return true;
+        }
+    }
+    return false;
+}
+
+void QuadricSimplifier::getNeighbors(unsigned int position, std::vector<unsigned int>& neighbors) const
+{
+    neighbors.clear();
+    for(unsigned int vertex : m_weldedVertices[position])
+        for(unsigned int t : m_vertexTriangles[vertex])
+            if(!m_removedTriangles[t])
+                for(int k=0; k<3; ++k)
+                    if(m_welded[m_triangles[3*t+k]] != position)
+                        neighbors.push_back(m_welded[m_triangles[3*t+k]]);
+    std::sort(neighbors.begin(), neighbors.end());
+    neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+}
+
+void QuadricSimplifier::updateCollapse(unsigned int position)
+{
+    //The collapses queued before are outdated
+    ++ m_versions[position];
+    if(m_removedPositions[position])
+        return;
+
+    std::vector<unsigned int> neighbors;
+    getNeighbors(position, neighbors);
+    Collapse best;
+    best.cost = std::numeric_limits<double>::infinity();
+    for(unsigned int target : neighbors)
+    {
+        Quadric quadric = m_quadrics[position];
+        quadric.add(m_quadrics[target]);
+        const double cost = std::max(0.0, quadric.evaluate(glm::dvec3(m_positions[target])));
+        if(cost >= best.cost || flips(position, target))
+            continue;
+        best.cost = cost;
+        best.error = quadric.weight > 0.0 ? float(std::sqrt(cost / quadric.weight)) : 0.0f;
+        best.source = position;
+        best.target = target;
+    }
+    if(best.cost == std::numeric_limits<double>::infinity())
+        return;
+    best.version = m_versions[position];
+    m_queue.push(best);
+}
+
+void QuadricSimplifier::collapse(const Collapse& c)
+{
+    for(unsigned int vertex : m_weldedVertices[c.source])
+    {
+        const unsigned int target = getTargetVertex(vertex, c.target);
+        for(unsigned int t : m_vertexTriangles[vertex])
+        {
+            if(m_removedTriangles[t])
+                continue;
+            bool collapsed = false;
+            for(int k=0; k<3; ++k)
+                collapsed = collapsed || m_welded[m_triangles[3*t+k]] == c.target;
+            if(collapsed)
+            {
+                m_removedTriangles[t] = true;
+                -- m_triangleNumber;
+                continue;
+            }
+            for(int k=0; k<3; ++k)
+                if(m_triangles[3*t+k] == vertex)
+                    m_triangles[3*t+k] = target;
+            m_vertexTriangles[target].push_back(t);
+        }
+        m_vertexTriangles[vertex].clear();
+    }
+    m_removedPositions[c.source] = true;
+    m_quadrics[c.target].add(m_quadrics[c.source]);
+    m_error = std::max(m_error, c.error);
+
+    for(unsigned int vertex : m_weldedVertices[c.target])
+    {
+        std::vector<unsigned int>& triangles = m_vertexTriangles[vertex];
+        triangles.erase(std::remove_if(triangles.begin(), triangles.end(),
+            [this](unsigned int t){ return (bool)m_removedTriangles[t]; }), triangles.end());
+    }
+
+    //The neighborhood of the target changed, so did the collapses around it
+    std::vector<unsigned int> neighbors;
+    getNeighbors(c.target, neighbors);
+    updateCollapse(c.target);
+    for(unsigned int position : neighbors)
+        updateCollapse(position);
+}
+
+void QuadricSimplifier::simplify(unsigned int targetNumber)
+{
+    while(m_triangleNumber > targetNumber && !m_queue.empty())
+    {
+        const Collapse c = m_queue.top();
+        m_queue.pop();
+        //A collapse stays valid as long as the triangles around its source do not change
+        if(c.version != m_versions[c.source] || m_removedPositions[c.target])
+            continue;
+        collapse(c);
+    }
+}
+
+void QuadricSimplifier::getIndices(std::vector<unsigned int>& indices) const
+{
+    indices.clear();
+    indices.reserve(3 * m_triangleNumber);
+    for(size_t t=0; t<m_removedTriangles.size(); ++t)
+        if(!m_removedTriangles[t])
+            indices.insert(indices.end(), m_triangles.begin() + 3*t, m_triangles.begin() + 3*t + 3);
+}
+
+void simplify_mesh(
+        const std::vector<glm::vec3>& positions,
+        const std::vector<glm::vec3>& normals,
+        const std::vector<unsigned int>& indices,
+        unsigned int levelNumber,
+        float ratio,
+        std::vector<MeshLevel>& levels
+        )
+{
+    levels.clear();
+    QuadricSimplifier simplifier(positions, normals, indices);
+
+    //The levels are snapshots of a single simplification
+    unsigned int triangleNumber = simplifier.getTriangleNumber();
+    for(unsigned int level=0; level<levelNumber; ++level)
+    {
+        simplifier.simplify((unsigned int)(triangleNumber * ratio));
+        //Stop when less than half the expected triangles could be removed
+        const unsigned int simplifiedNumber = simplifier.getTriangleNumber();
+        if(simplifiedNumber == 0 || simplifiedNumber > triangleNumber * (1.0f + ratio) / 2.0f)
+            break;
+
+        MeshLevel meshLevel;
+        simplifier.getIndices(meshLevel.indices);
+        meshLevel.error = simplifier.getError();
+        levels.push_back(meshLevel);
+        triangleNumber = simplifiedNumber;
+    }
+}
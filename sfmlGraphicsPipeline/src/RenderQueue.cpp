@@ -0,0 +1,279 @@
+#include "./../include/RenderQueue.hpp"
+
+#include <algorithm>
+
+// Layout of the keys, from the most significant bits:
+//  - priority rank (6 bits), transparency (1 bit);
+//  - opaque: program (9), material (10), texture (10), mesh (12), depth (16);
+//  - transparent: inverted depth (16), program (9), material (10), texture (10), mesh (12).
+// Ranks that do not fit in their field are clamped: they share the last value.
+static const unsigned int priority_bits = 6;
+static const unsigned int program_bits = 9;
+static const unsigned int material_bits = 10;
+static const unsigned int texture_bits = 10;
+static const unsigned int mesh_bits = 12;
+static const unsigned int depth_bits = 16;
+
+static std::uint64_t field( unsigned int value, unsigned int bits, unsigned int shift )
+{
+  const unsigned int maximum = ( 1u << bits ) - 1u;
+  return std::uint64_t( std::min( value, maximum ) ) << shift;
+}
+
+RenderQueue::RenderQueue()
+  : m_stateSorting( true ), m_instancing( true ),
+    m_programSwitchNumber( 0 ), m_avoidedProgramSwitchNumber( 0 ),
+    m_materialSwitchNumber( 0 ), m_avoidedMaterialSwitchNumber( 0 ),
+    m_textureSwitchNumber( 0 ), m_avoidedTextureSwitchNumber( 0 ),
+    m_instancedRenderableNumber( 0 )
+{}
+
+RenderQueue::~RenderQueue()
+{}
+
+void RenderQueue::clear()
+{
+  // Keep the capacities, so that a frame does not allocate once the scene is stable
+  m_added.clear();
+  m_states.clear();
+  m_programRanks.clear();
+  m_materialRanks.clear();
+  m_textureRanks.clear();
+  m_meshRanks.clear();
+}
+
+template< typename Key >
+unsigned int RenderQueue::rank( std::unordered_map< Key, unsigned int >& ranks, const Key& state )
+{
+  return ranks.insert( std::make_pair( state, (unsigned int)ranks.size() ) ).first->second;
+}
+
+void RenderQueue::add( const RenderablePtr& renderable )
+{
+  State state;
+  state.priority = renderable->priority();
+  state.transparent = renderable->isTransparent();
+  state.program = rank( m_programRanks, (const void*)renderable->getShaderProgram().get() );
+  state.material = rank( m_materialRanks, renderable->getMaterialKey() );
+  state.texture = rank( m_textureRanks, renderable->getTextureKey() );
+  state.mesh = rank( m_meshRanks, renderable->getMeshKey() );
+  // Only the draws in the window are instanced
+  state.instanceable = m_instancing && !state.transparent
+    && renderable->getRenderMode() == Renderable::RENDER_MODE::WINDOW
+    && renderable->isInstanceable();
+  m_added.push_back( renderable );
+  m_states.push_back( state );
+}
+
+void RenderQueue::sort( const glm::vec3& cameraPosition )
+{
+  const unsigned int size = m_added.size();
+
+  // Rank the priorities, higher priorities first
+  m_priorities.clear();
+  for( const State& state : m_states )
+    m_priorities.push_back( state.priority );
+  std::sort( m_priorities.begin(), m_priorities.end(), std::greater< int >() );
+  m_priorities.erase( std::unique( m_priorities.begin(), m_priorities.end() ), m_priorities.end() );
+
+  // Distances to the camera, quantized relatively to the farthest renderable
+  m_depths.resize( size );
+  float farthest = 0.0f;
+  for( unsigned int i = 0; i < size; ++ i )
+  {
+    m_depths[i] = glm::length( glm::vec3( m_added[i]->getModelMatrix()[3] ) - cameraPosition );
+    farthest = std::max( farthest, m_depths[i] );
+  }
+  const float depthScale = farthest > 0.0f ? float( ( 1u << depth_bits ) - 1u ) / farthest : 0.0f;
+
+  // Order of the priority sort alone, i.e. the order the viewer used to draw in
+  m_items.resize( size );
+  for( unsigned int i = 0; i < size; ++ i )
+  {
+    const State& state = m_states[i];
+    unsigned int priority = std::lower_bound( m_priorities.begin(), m_priorities.end(), state.priority, std::greater< int >() ) - m_priorities.begin();
+    m_items[i].key = field( priority, priority_bits, 64 - priority_bits );
+    m_items[i].index = i;
+  }
+  radixSort();
+  m_order.resize( size );
+  for( unsigned int i = 0; i < size; ++ i )
+    m_order[i] = m_items[i].index;
+  unsigned int programSwitches, materialSwitches, textureSwitches;
+  countSwitches( m_order, programSwitches, materialSwitches, textureSwitches );
+
+  if( m_stateSorting )
+  {
+    for( unsigned int i = 0; i < size; ++ i )
+    {
+      const unsigned int index = m_items[i].index;
+      const State& state = m_states[index];
+      const unsigned int depth = (unsigned int)( m_depths[index] * depthScale );
+      std::uint64_t key = m_items[i].key;
+      if( state.transparent )
+      {
+        key |= field( 1, 1, 63 - priority_bits );
+        key |= field( ( 1u << depth_bits ) - 1u - depth, depth_bits, 41 );
+        key |= field( state.program, program_bits, 32 );
+        key |= field( state.material, material_bits, 22 );
+        key |= field( state.texture, texture_bits, 12 );
+        key |= field( state.mesh, mesh_bits, 0 );
+      }
+      else
+      {
+        key |= field( state.program, program_bits, 48 );
+        key |= field( state.material, material_bits, 38 );
+        key |= field( state.texture, texture_bits, 28 );
+        key |= field( state.mesh, mesh_bits, 16 );
+        key |= field( depth, depth_bits, 0 );
+      }
+      m_items[i].key = key;
+    }
+    radixSort();
+    for( unsigned int i = 0; i < size; ++ i )
+      m_order[i] = m_items[i].index;
+  }
+
+  // The back to front order of the transparent renderables can cost switches
+  countSwitches( m_order, m_programSwitchNumber, m_materialSwitchNumber, m_textureSwitchNumber );
+  m_avoidedProgramSwitchNumber = int( programSwitches ) - int( m_programSwitchNumber );
+  m_avoidedMaterialSwitchNumber = int( materialSwitches ) - int( m_materialSwitchNumber );
+  m_avoidedTextureSwitchNumber = int( textureSwitches ) - int( m_textureSwitchNumber );
+
+  m_sorted.resize( size );
+  for( unsigned int i = 0; i < size; ++ i )
+    m_sorted[i] = m_added[ m_order[i] ];
+
+  // The renderables with the same state are consecutive once sorted
+  m_batches.clear();
+  m_instancedRenderableNumber = 0;
+  for( unsigned int i = 0; i < size; )
+  {
+    const State& state = m_states[ m_order[i] ];
+    Batch batch = { i, 1 };
+    if( state.instanceable )
+      while( i + batch.count < size && sameInstance( state, m_states[ m_order[i + batch.count] ] ) )
+        ++ batch.count;
+    if( batch.count > 1 )
+      m_instancedRenderableNumber += batch.count;
+    m_batches.push_back( batch );
+    i += batch.count;
+  }
+}
+
+bool RenderQueue::sameInstance( const State& first, const State& other )
+{
+  return other.instanceable && other.priority == first.priority
+    && other.program == first.program && other.material == first.material
+    && other.texture == first.texture && other.mesh == first.mesh;
+}
+
+void RenderQueue::radixSort()
+{
+  // One pass per byte, from the least significant one. A byte shared by all
+  // the keys (most of them: the fields are narrow) leaves the order unchanged
+  // and is skipped.
+  m_buffer.resize( m_items.size() );
+  for( unsigned int shift = 0; shift < 64; shift += 8 )
+  {
+    unsigned int counts[257] = { 0 };
+    for( const Item& item : m_items )
+      ++ counts[ ( ( item.key >> shift ) & 0xff ) + 1 ];
+    if( !m_items.empty() && counts[ ( ( m_items[0].key >> shift ) & 0xff ) + 1 ] == m_items.size() )
+      continue;
+    for( unsigned int digit = 1; digit < 257; ++ digit )
+      counts[digit] += counts[digit - 1];
+    for( const Item& item : m_items )
+      m_buffer[ counts[ ( item.key >> shift ) & 0xff ] ++ ] = item;
+    m_items.swap( m_buffer );
+  }
+}
+
+void RenderQueue::countSwitches( const std::vector< unsigned int >& order,
+                                 unsigned int& programSwitches, unsigned int& materialSwitches, unsigned int& textureSwitches ) const
+{
+  programSwitches = materialSwitches = textureSwitches = 0;
+  for( unsigned int i = 1; i < order.size(); ++ i )
+  {
+    const State& previous = m_states[ order[i - 1] ];
+    const State& current = m_states[ order[i] ];
+    programSwitches += previous.program != current.program ? 1 : 0;
+    materialSwitches += previous.material != current.material ? 1 : 0;
+    textureSwitches += previous.texture != current.texture ? 1 : 0;
+  }
+}
+
+const std::vector< RenderablePtr >& RenderQueue::getRenderables() const
+{
+  return m_sorted;
+}
+
+const std::vector< RenderQueue::Batch >& RenderQueue::getBatches() const
+{
+  return m_batches;
+}
+
+void RenderQueue::setStateSorting( bool onOff )
+{
+  m_stateSorting = onOff;
+}
+
+bool RenderQueue::getStateSorting() const
+{
+  return m_stateSorting;
+}
+
+void RenderQueue::setInstancing( bool onOff )
+{
+  m_instancing = onOff;
+}
+
+bool RenderQueue::getInstancing() const
+{
+  return m_instancing;
+}
+
+unsigned int RenderQueue::getDrawNumber() const
+{
+  return m_sorted.size();
+}
+
+unsigned int RenderQueue::getDrawCallNumber() const
+{
+  return m_batches.size();
+}
+
+unsigned int RenderQueue::getInstancedRenderableNumber() const
+{
+  return m_instancedRenderableNumber;
+}
+
+unsigned int RenderQueue::getProgramSwitchNumber() const
+{
+  return m_programSwitchNumber;
+}
+
+int RenderQueue::getAvoidedProgramSwitchNumber() const
+{
+  return m_avoidedProgramSwitchNumber;
+}
+
+unsigned int RenderQueue::getMaterialSwitchNumber() const
+{
+  return m_materialSwitchNumber;
+}
+
+int RenderQueue::getAvoidedMaterialSwitchNumber() const
+{
+  return m_avoidedMaterialSwitchNumber;
+}
+
+unsigned int RenderQueue::getTextureSwitchNumber() const
+{
+  return m_textureSwitchNumber;
+}
+
+int RenderQueue::getAvoidedTextureSwitchNumber() const
+{
+  return m_avoidedTextureSwitchNumber;
+}
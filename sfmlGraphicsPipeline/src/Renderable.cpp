@@ -5,6 +5,10 @@
 #include <iostream>
 #include <glm/gtx/string_cast.hpp>
 
+// Names of the uniforms and attributes, resolved once per shader program
+static const ShaderProgram::Handle projection_handle( "projMat" );
+static const ShaderProgram::Handle view_handle( "viewMat" );
+
 
 Renderable::~Renderable(){}
 
@@ -13,7 +17,9 @@ Renderable::Renderable(ShaderProgramPtr program)
     m_model(glm::mat4(1.0)), // default: loads the identity
     m_viewer(nullptr),
     m_priority(0),
-    m_render_mode(RENDER_MODE::WINDOW)
+    m_render_mode(RENDER_MODE::WINDOW),
+    m_transparent(false),
+    m_normalMatrixModel(glm::mat4(1.0)), m_normalMatrix(glm::mat3(1.0))
 {}
 
 void Renderable::bindShaderProgram()
@@ -28,12 +34,12 @@ void Renderable::unbindShaderProgram()
 
 int Renderable::projectionLocation()
 {
-    return m_shaderProgram->getUniformLocation("projMat");
+    return m_shaderProgram->getUniformLocation(projection_handle);
 }
 
 int Renderable::viewLocation()
 {
-    return m_shaderProgram->getUniformLocation("viewMat");
+    return m_shaderProgram->getUniformLocation(view_handle);
 }
 
 void Renderable::draw()
@@ -112,6 +118,18 @@ const glm::mat4& Renderable::getModelMatrix() const
     return m_model;
 }
 
+const glm::mat3& Renderable::getNormalMatrix() const
+{
+    // Comparing the matrices is cheaper than inverting one, and works whatever
+    // the way m_model was written
+    if( m_normalMatrixModel != m_model )
+    {
+        m_normalMatrix = glm::transpose(glm::inverse(glm::mat3(m_model)));
+        m_normalMatrixModel = m_model;
+    }
+    return m_normalMatrix;
+}
+
 void Renderable::setShaderProgram( ShaderProgramPtr prog )
 {
   m_shaderProgram = prog;
@@ -160,6 +178,103 @@ void Renderable::setRenderMode(Renderable::RENDER_MODE mode)
   m_render_mode = mode;
 }
 
+bool Renderable::isTransparent() const
+{
+  return m_transparent;
+}
+
+void Renderable::setTransparent(bool transparent)
+{
+  m_transparent = transparent;
+}
+
+const void* Renderable::getMaterialKey() const
+{
+  return do_getMaterialKey();
+}
+
+unsigned int Renderable::getTextureKey() const
+{
+  return do_getTextureKey();
+}
+
+const void* Renderable::getMeshKey() const
+{
+  return do_getMeshKey();
+}
+
+BoundingBox Renderable::getLocalBounds() const
+{
+  return do_getLocalBounds();
+}
+
+BoundingBox Renderable::getWorldBounds() const
+{
+  return do_getWorldBounds();
+}
+
+unsigned int Renderable::getRenderableNumber() const
+{
+  return do_getRenderableNumber();
+}
+
+const void* Renderable::do_getMaterialKey() const
+{
+  return nullptr;
+}
+
+unsigned int Renderable::do_getTextureKey() const
+{
+  return 0;
+}
+
+const void* Renderable::do_getMeshKey() const
+{
+  return this;
+}
+
+BoundingBox Renderable::do_getLocalBounds() const
+{
+  return BoundingBox::infinite();
+}
+
+BoundingBox Renderable::do_getWorldBounds() const
+{
+  return getLocalBounds().transform(m_model);
+}
+
+unsigned int Renderable::do_getRenderableNumber() const
+{
+  return 1;
+}
+
+bool Renderable::isInstanceable() const
+{
+  return do_isInstanceable();
+}
+
+void Renderable::writeInstanceData( InstanceData& data )
+{
+  beforeDraw();
+  data.model = m_model;
+  data.normal = getNormalMatrix();
+}
+
+void Renderable::drawInstances( unsigned int buffer, std::size_t offset, unsigned int instanceNumber )
+{
+  // beforeDraw() was called by writeInstanceData() for each instance
+  do_drawInstances( buffer, offset, instanceNumber );
+  afterDraw();
+}
+
+bool Renderable::do_isInstanceable() const
+{
+  return false;
+}
+
+void Renderable::do_drawInstances( unsigned int, std::size_t, unsigned int )
+{}
+
 //void Renderable::displayTextInViewer(std::string text) const
 //{
 //    getViewer()->displayText(text);
@@ -1,12 +1,26 @@
 #include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
 #include <fstream>
 #include <iostream>
 #include <iomanip>
+#include <map>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
+#ifdef _WIN32
+# include <direct.h>
+#else
+# include <sys/stat.h>
+#endif
+
 # include <GL/glew.h>
+# include <SFML/Window/Context.hpp>
 
 #include "./../include/ShaderProgram.hpp"
 #include "./../include/log.hpp"
@@ -16,6 +30,36 @@ using namespace std;
 
 int ShaderProgram::null_location = -1;
 
+// number of programs successfully linked so far, to give unique versions
+static unsigned int linked_program_number = 0;
+
+// binding points of the uniform blocks shared by the programs, by block name
+static std::unordered_map< std::string, unsigned int > uniform_block_bindings;
+
+// directory of the program binaries, empty if the cache is disabled
+static std::string binary_cache_directory = "shader_cache";
+
+// names of the handles, by index. Handles are usually static variables: the
+// names are stored in a function static variable, to be built before them.
+static std::vector< std::string >& handle_names()
+{
+  static std::vector< std::string > names;
+  return names;
+}
+
+ShaderProgram::Handle::Handle( const std::string& name )
+{
+  std::vector< std::string >& names = handle_names();
+  m_index = std::find( names.begin(), names.end(), name ) - names.begin();
+  if( m_index == names.size() )
+    names.push_back( name );
+}
+
+const std::string& ShaderProgram::Handle::name() const
+{
+  return handle_names()[ m_index ];
+}
+
 static void
 dump_shader_log( GLuint shader )
 {
@@ -50,17 +94,127 @@ check_program_status(GLuint program)
   return status;
 }
 
-static GLuint
-compile_shader( const std::string& gpu_name, GLuint type )
+// Directory of a file, with its trailing separator
+static std::string
+directory_of( const std::string& path )
+{
+  std::string::size_type separator = path.find_last_of( "/\\" );
+  return separator == std::string::npos ? std::string() : path.substr( 0, separator + 1 );
+}
+
+// The file of an #include "file" directive, false if the line is not one
+static bool
+parse_include( const std::string& line, std::string& included )
+{
+  std::string::size_type begin = line.find_first_not_of( " \t" );
+  if( begin == std::string::npos || line.compare( begin, 8, "#include" ) )
+    return false;
+  begin = line.find( '"', begin + 8 );
+  std::string::size_type end = begin == std::string::npos ? begin : line.find( '"', begin + 1 );
+  if( end == std::string::npos )
+    return false;
+  included = line.substr( begin + 1, end - begin - 1 );
+  return true;
+}
+
+// Append a shader file to the source, its #include "file" directives replaced
+// by the files, relative to its directory. A file is included once. Each file
+// is a source string of its own for the #line directives, numbered by its
+// index in files, for the compilation errors to give the line in the file.
+static bool
+include_shader_file( const std::string& gpu_name, std::vector< std::string >& files, std::string& gpu_string )
 {
-  // open the shader file
   std::ifstream gpu_file( gpu_name );
   if ( !gpu_file.is_open() )
     {
       LOG( error, "cannot open shader file " << gpu_name << ". Are you in the right directory?" );
-      return 0;
+      return false;
+    }
+
+  const std::size_t file_number = files.size();
+  files.push_back( gpu_name );
+  std::string line, included;
+  unsigned int line_number = 0;
+  while( std::getline( gpu_file, line ) )
+    {
+      ++ line_number;
+      if( !parse_include( line, included ) )
+        {
+          gpu_string += line + '\n';
+          continue;
+        }
+      included = directory_of( gpu_name ) + included;
+      if( std::find( files.begin(), files.end(), included ) == files.end() )
+        {
+          gpu_string += "#line 1 " + std::to_string( files.size() ) + '\n';
+          if( !include_shader_file( included, files, gpu_string ) )
+            return false;
+        }
+      gpu_string += "#line " + std::to_string( line_number + 1 ) + " " + std::to_string( file_number ) + '\n';
+    }
+  return true;
+}
+
+// Position of the line after the #version directive of a shader source, 0
+// if there is none. Blanks may surround the #, as in "# version 400".
+static std::string::size_type
+after_version_directive( const std::string& gpu_string )
+{
+  std::string::size_type line = 0;
+  while( line < gpu_string.size() )
+    {
+      std::string::size_type end = gpu_string.find( '\n', line );
+      if( end == std::string::npos )
+        end = gpu_string.size();
+      const std::string::size_type hash = gpu_string.find_first_not_of( " \t", line );
+      if( hash < end && gpu_string[hash] == '#' )
+        {
+          const std::string::size_type word = gpu_string.find_first_not_of( " \t", hash + 1 );
+          if( word < end && !gpu_string.compare( word, 7, "version" ) )
+            return end == gpu_string.size() ? end : end + 1;
+        }
+      line = end + 1;
     }
+  return 0;
+}
+
+// Read a shader file and the files it includes, with the definitions added
+// after its #version directive. The name of the shader in the logs lists the
+// files by source string number.
+static bool
+read_shader_file( const std::string& gpu_path, const ShaderProgram::Defines& defines,
+                  std::string& gpu_string, std::string& gpu_name )
+{
+  std::vector< std::string > files;
+  gpu_string.clear();
+  if( !include_shader_file( gpu_path, files, gpu_string ) )
+    return false;
 
+  std::string definitions;
+  for( const std::pair< const std::string, std::string >& define : defines )
+    definitions += "#define " + define.first + " " + define.second + '\n';
+  if( !definitions.empty() )
+    {
+      // the #version directive must come first
+      const std::string::size_type position = after_version_directive( gpu_string );
+      const std::size_t line_number = std::count( gpu_string.begin(), gpu_string.begin() + position, '\n' );
+      gpu_string.insert( position, definitions + "#line " + std::to_string( line_number + 1 ) + " 0\n" );
+    }
+
+  std::ostringstream name;
+  name << gpu_path;
+  for( std::size_t i = 1; i < files.size(); ++ i )
+    name << ( i == 1 ? " (includes " : ", " ) << i << ": " << files[i];
+  if( files.size() > 1 )
+    name << ")";
+  gpu_name = name.str();
+  return true;
+}
+
+// Create a shader and start its compilation, without waiting for it
+static GLuint
+create_shader( const std::string& gpu_name, const std::string& gpu_string, GLuint type )
+{
   // create a new shader object
   glcheck(GLuint shader = glCreateShader( type ));
   if ( !shader )
@@ -69,12 +223,6 @@ compile_shader( const std::string& gpu_name, GLuint type )
       return 0;
     }
 
-  // load the shader source in one string
-  std::stringstream gpu_data;
-  gpu_data << gpu_file.rdbuf();
-  gpu_file.close(); // no more needed, so close it now
-  const std::string gpu_string = gpu_data.str();
-
   // set the source of the shader (as one big cstring)
   const char*  strShaderVar = gpu_string.c_str();
   GLint iShaderLen = gpu_string.size();
@@ -82,101 +230,645 @@ compile_shader( const std::string& gpu_name, GLuint type )
 
   // compile the shader
   glcheck(glCompileShader( shader ));
+  return shader;
+}
+
+// Wait for the compilation of a shader, return false if it failed
+static bool
+check_shader_status( GLuint shader, const std::string& gpu_name )
+{
   GLint result;
   glcheck(glGetShaderiv( shader, GL_COMPILE_STATUS, &result ));
   if( GL_FALSE == result )
     {
       LOG( error, "shader [" << gpu_name << "] compilation failed!");
       dump_shader_log( shader );
+      return false;
+    }
+  return true;
+}
+
+static GLuint
+compile_shader( const std::string& gpu_name, const std::string& gpu_string, GLuint type )
+{
+  GLuint shader = create_shader( gpu_name, gpu_string, type );
+  if( shader && !check_shader_status( shader, gpu_name ) )
+    {
       glcheck(glDeleteShader( shader ));
       return 0;
     }
   return shader;
 }
 
+// Compile the shaders and link them in a new program, whose link status is
+// not checked yet. Return 0 if a shader does not compile.
+static GLuint
+link_program(
+    const std::string& vertex_file_path, const std::string& vertex_source,
+    const std::string& fragment_file_path, const std::string& fragment_source,
+    bool retrievable )
+{
+  // ids of the shaders that we will link together to form a program
+  GLuint vertex_shader_id = compile_shader( vertex_file_path, vertex_source, GL_VERTEX_SHADER );
+  GLuint fragment_shader_id = compile_shader( fragment_file_path, fragment_source, GL_FRAGMENT_SHADER );
+  if( !vertex_shader_id || !fragment_shader_id )
+    {
+      LOG( error, "cannot load shader program. Program unchanged...");
+      if( glIsShader( vertex_shader_id ) )
+        glcheck(glDeleteShader( vertex_shader_id ));
+      if( glIsShader( fragment_shader_id ) )
+        glcheck(glDeleteShader( fragment_shader_id ));
+      return 0;
+    }
+
+  //Create, attach, Link the program
+  glcheck(GLuint program = glCreateProgram());
+  if( retrievable )
+    glcheck(glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
+  glcheck(glAttachShader(program, vertex_shader_id));
+  glcheck(glAttachShader(program, fragment_shader_id));
+  glcheck(glLinkProgram(program));
+
+  //Delete vertex & fragment id. We do not need them anymore as they are already
+  //"in" this program. The only reason to keep those shaders somewhere would be
+  //to reused them in order to build another shader program.
+  glDeleteShader( vertex_shader_id );
+  glDeleteShader( fragment_shader_id );
+  return program;
+}
+
+// A binary is only valid for the driver which produced it: the key of a
+// program hashes its sources with the vendor, renderer and version strings.
+static std::string
+program_binary_key( const std::string& vertex_source, const std::string& fragment_source )
+{
+  std::string data = vertex_source + '\0' + fragment_source + '\0';
+  const GLenum driver_strings[3] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+  for( GLenum name : driver_strings )
+    {
+      const GLubyte* value = glGetString( name );
+      if( value )
+        data += (const char*)value;
+      data += '\0';
+    }
+
+  // 64 bits FNV-1a
+  std::uint64_t hash = 14695981039346656037ull;
+  for( unsigned char c : data )
+    {
+      hash ^= c;
+      hash *= 1099511628211ull;
+    }
+  std::ostringstream key;
+  key << std::hex << std::setw(16) << std::setfill('0') << hash;
+  return key.str();
+}
+
+static bool
+program_binary_supported()
+{
+  if( binary_cache_directory.empty() || !( GLEW_VERSION_4_1 || GLEW_ARB_get_program_binary ) )
+    return false;
+  GLint format_number = 0;
+  glcheck(glGetIntegerv( GL_NUM_PROGRAM_BINARY_FORMATS, &format_number ));
+  return format_number > 0;
+}
+
+static std::string
+program_binary_path( const std::string& key )
+{
+  return binary_cache_directory + "/" + key + ".bin";
+}
+
+// Magic number of the program binary files, followed by the binary format and the binary
+static const std::uint32_t program_binary_magic = 0x42505347; // "GSPB"
+
+// Create a program from its cached binary, 0 if there is none or if the driver rejects it
+static GLuint
+load_program_binary( const std::string& key )
+{
+  std::ifstream file( program_binary_path( key ), std::ios::binary );
+  if( !file.is_open() )
+    return 0;
+  std::uint32_t magic = 0, format = 0;
+  file.read( (char*)&magic, sizeof(magic) );
+  file.read( (char*)&format, sizeof(format) );
+  std::vector< char > binary( (std::istreambuf_iterator< char >( file )), std::istreambuf_iterator< char >() );
+  if( magic != program_binary_magic || binary.empty() )
+    return 0;
+
+  glcheck(GLuint program = glCreateProgram());
+  glcheck(glProgramBinary( program, format, binary.data(), binary.size() ));
+  GLint status = GL_FALSE;
+  glcheck(glGetProgramiv( program, GL_LINK_STATUS, &status ));
+  if( status == GL_FALSE )
+    {
+      // e.g. the driver was updated without changing its version string
+      LOG( info, "program binary " << program_binary_path( key ) << " rejected by the driver, compiling the sources" );
+      glcheck(glDeleteProgram( program ));
+      return 0;
+    }
+  return program;
+}
+
+static void
+save_program_binary( GLuint program, const std::string& key )
+{
+  GLint length = 0;
+  glcheck(glGetProgramiv( program, GL_PROGRAM_BINARY_LENGTH, &length ));
+  if( length <= 0 )
+    return;
+  std::vector< char > binary( length );
+  GLenum format = 0;
+  glcheck(glGetProgramBinary( program, length, nullptr, &format, binary.data() ));
+
+#ifdef _WIN32
+  _mkdir( binary_cache_directory.c_str() );
+#else
+  mkdir( binary_cache_directory.c_str(), 0755 );
+#endif
+  std::ofstream file( program_binary_path( key ), std::ios::binary );
+  if( !file.is_open() )
+    {
+      LOG( warning, "cannot write the program binary " << program_binary_path( key ) );
+      return;
+    }
+  const std::uint32_t magic = program_binary_magic, format32 = format;
+  file.write( (const char*)&magic, sizeof(magic) );
+  file.write( (const char*)&format32, sizeof(format32) );
+  file.write( binary.data(), binary.size() );
+}
+
+struct ShaderProgram::PendingLink
+{
+  std::string vertex_file_path;
+  std::string fragment_file_path;
+  ShaderProgram::Defines defines;
+  std::string vertex_name; // names in the logs, with the included files
+  std::string fragment_name;
+  std::string vertex_source;
+  std::string fragment_source;
+  std::string key; // key of the program binary, empty if the cache is disabled
+  std::chrono::steady_clock::time_point start;
+  bool parallel; // compiled by the threads of the driver, otherwise by the compiler thread
+  GLuint vertex_shader; // only kept with a parallel compilation
+  GLuint fragment_shader;
+  GLuint program;
+
+  // shared with the compiler thread
+  std::mutex mutex;
+  std::condition_variable linked;
+  bool done;
+  bool abandoned;
+};
+
+static bool
+parallel_compile_supported()
+{
+  static bool initialized = false, supported = false;
+  if( !initialized )
+    {
+      initialized = true;
+      supported = GLEW_ARB_parallel_shader_compile;
+      // as many compiler threads as the driver wants
+      if( supported )
+        glcheck(glMaxShaderCompilerThreadsARB( 0xFFFFFFFF ));
+    }
+  return supported;
+}
+
+// Without parallel compilation in the driver, the programs are compiled by a
+// thread of its own context. All the contexts created by SFML share their
+// objects, so that the viewer can use the programs once linked. The thread is
+// started by the first submit() and owned by a static instance, which stops
+// and joins it at exit, before the global state of SFML goes away.
+class CompilerThread
+{
+public:
+  static CompilerThread&
+  instance()
+  {
+    static CompilerThread compiler;
+    return compiler;
+  }
+
+  ~CompilerThread()
+  {
+    {
+      std::lock_guard< std::mutex > lock( m_mutex );
+      m_stopping = true;
+    }
+    m_wakeup.notify_one();
+    m_thread.join();
+  }
+
+  void
+  submit( const std::shared_ptr< ShaderProgram::PendingLink >& link )
+  {
+    {
+      std::lock_guard< std::mutex > lock( m_mutex );
+      m_queue.push_back( link );
+    }
+    m_wakeup.notify_one();
+  }
+
+private:
+  CompilerThread()
+    : m_stopping( false ), m_thread( &CompilerThread::work, this )
+  {}
+
+  void
+  work()
+  {
+    sf::Context context( sf::ContextSettings( 0, 0, 0, 4, 0 ), 1, 1 );
+    while( true )
+      {
+        std::shared_ptr< ShaderProgram::PendingLink > link;
+        {
+          std::unique_lock< std::mutex > lock( m_mutex );
+          while( m_queue.empty() && !m_stopping )
+            m_wakeup.wait( lock );
+          // the links still queued at exit are never waited for
+          if( m_stopping )
+            return;
+          link = m_queue.front();
+          m_queue.pop_front();
+        }
+        {
+          std::lock_guard< std::mutex > lock( link->mutex );
+          if( link->abandoned )
+            continue;
+        }
+
+        GLuint program = link_program( link->vertex_name, link->vertex_source,
+                                       link->fragment_name, link->fragment_source, !link->key.empty() );
+        // the link is waited for here rather than by the viewer, and the
+        // program made visible to the other contexts
+        GLint status;
+        if( program )
+          glcheck(glGetProgramiv( program, GL_LINK_STATUS, &status ));
+        glcheck(glFinish());
+
+        std::lock_guard< std::mutex > lock( link->mutex );
+        if( link->abandoned )
+          {
+            if( program )
+              glcheck(glDeleteProgram( program ));
+            continue;
+          }
+        link->program = program;
+        link->done = true;
+        link->linked.notify_all();
+      }
+  }
+
+  std::mutex m_mutex; // protects the queue and the stop request
+  std::condition_variable m_wakeup;
+  std::deque< std::shared_ptr< ShaderProgram::PendingLink > > m_queue; // links waiting for the thread
+  bool m_stopping;
+  std::thread m_thread; // started last, once the members it uses are built
+};
+
 ShaderProgram::ShaderProgram()
-  : m_programId{0}
+  : m_programId{0}, m_version{0}, m_fallbackVersion{0}
 {}
 
 ShaderProgram::ShaderProgram(
   const std::string& vertex_file_path,
-  const std::string& fragment_file_path )
-  : m_programId{0}
+  const std::string& fragment_file_path,
+  const Defines& defines )
+  : m_programId{0}, m_version{0}, m_fallbackVersion{0}
+{
+  load( vertex_file_path, fragment_file_path, defines );
+}
+
+ShaderProgram::ShaderProgram(
+  const std::string& vertex_file_path,
+  const std::string& fragment_file_path,
+  const std::shared_ptr< ShaderProgram >& fallback,
+  const Defines& defines )
+  : m_programId{0}, m_version{0}, m_fallbackVersion{0}
+{
+  loadAsync( vertex_file_path, fragment_file_path, fallback, defines );
+}
+
+// Programs built by getPermutation(), by files and definitions. They belong
+// to their users: a permutation nobody uses any more is built again.
+static std::map< std::string, std::weak_ptr< ShaderProgram > > permutations;
+
+std::shared_ptr< ShaderProgram > ShaderProgram::getPermutation(
+  const std::string& vertex_file_path,
+  const std::string& fragment_file_path,
+  const Defines& defines )
 {
-  load( vertex_file_path, fragment_file_path );
+  std::string key = vertex_file_path + '\n' + fragment_file_path;
+  for( const std::pair< const std::string, std::string >& define : defines )
+    key += '\n' + define.first + ' ' + define.second;
+
+  std::weak_ptr< ShaderProgram >& permutation = permutations[ key ];
+  std::shared_ptr< ShaderProgram > program = permutation.lock();
+  if( !program )
+    {
+      program = std::make_shared< ShaderProgram >( vertex_file_path, fragment_file_path, defines );
+      permutation = program;
+    }
+  return program;
 }
 
 ShaderProgram::~ShaderProgram()
 {
-  if( glIsProgram(m_programId) )
+  cancel_link();
+  if( !m_fallback && glIsProgram(m_programId) )
     glcheck(glDeleteProgram(m_programId));
 }
 
 void ShaderProgram::load(
     const std::string& vertex_file_path,
-    const std::string& fragment_file_path )
+    const std::string& fragment_file_path,
+    const Defines& defines )
 {
-  // ids of the shaders that we will link together to form a program
-  GLuint vertex_shader_id = compile_shader( vertex_file_path, GL_VERTEX_SHADER );
-  GLuint fragment_shader_id = compile_shader( fragment_file_path, GL_FRAGMENT_SHADER );
-  if( !vertex_shader_id || !fragment_shader_id )
+  record_request( vertex_file_path, fragment_file_path, defines );
+  const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  std::string vertex_source, fragment_source, vertex_name, fragment_name;
+  if( !read_shader_file( vertex_file_path, defines, vertex_source, vertex_name )
+      || !read_shader_file( fragment_file_path, defines, fragment_source, fragment_name ) )
     {
       LOG( error, "cannot load shader program. Program unchanged...");
-      if( glIsShader( vertex_shader_id ) )
-        glcheck(glDeleteShader( vertex_shader_id ));
-      if( glIsShader( fragment_shader_id ) )
-        glcheck(glDeleteShader( fragment_shader_id ));
       return;
     }
+  // a load replaces the program being compiled in the background, if any
+  cancel_link();
 
-  // previous program id, to restore in case of failure
-  unsigned int previous_id = m_programId;
+  // a program already linked with the same sources and driver skips the compilation
+  const bool use_binary_cache = program_binary_supported();
+  const std::string key = use_binary_cache ? program_binary_key( vertex_source, fragment_source ) : std::string();
+  GLuint cached_id = use_binary_cache ? load_program_binary( key ) : 0;
+  GLuint program = cached_id ? cached_id
+    : link_program( vertex_name, vertex_source, fragment_name, fragment_source, use_binary_cache );
+  if( !program )
+    return;
 
-  //Create, attach, Link the program
-  glcheck(m_programId = glCreateProgram());
-  glcheck(glAttachShader(m_programId, vertex_shader_id));
-  glcheck(glAttachShader(m_programId, fragment_shader_id));
-  glcheck(glLinkProgram(m_programId));
+  if( adopt_program( program, !cached_id, vertex_file_path, fragment_file_path, defines, cached_id ? std::string() : key ) )
+    {
+      std::chrono::duration< double, std::milli > duration = std::chrono::steady_clock::now() - start;
+      LOG( info, "ShaderProgram " << this << " (" << vertex_file_path << ", " << fragment_file_path << ") "
+           << ( cached_id ? "loaded from the binary cache" : "compiled" ) << " in " << duration.count() << " ms" );
+    }
+}
+
+void ShaderProgram::loadAsync(
+    const std::string& vertex_file_path,
+    const std::string& fragment_file_path,
+    const std::shared_ptr< ShaderProgram >& fallback,
+    const Defines& defines )
+{
+  record_request( vertex_file_path, fragment_file_path, defines );
+  const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  std::string vertex_source, fragment_source, vertex_name, fragment_name;
+  if( !read_shader_file( vertex_file_path, defines, vertex_source, vertex_name )
+      || !read_shader_file( fragment_file_path, defines, fragment_source, fragment_name ) )
+    {
+      LOG( error, "cannot load shader program. Program unchanged...");
+      return;
+    }
+  cancel_link();
+
+  // a cached binary is ready at once
+  const bool use_binary_cache = program_binary_supported();
+  const std::string key = use_binary_cache ? program_binary_key( vertex_source, fragment_source ) : std::string();
+  GLuint cached_id = use_binary_cache ? load_program_binary( key ) : 0;
+  if( cached_id )
+    {
+      if( adopt_program( cached_id, false, vertex_file_path, fragment_file_path, defines, std::string() ) )
+        LOG( info, "ShaderProgram " << this << " (" << vertex_file_path << ", " << fragment_file_path << ") "
+             << "loaded from the binary cache" );
+      return;
+    }
+
+  // until the link completes, the current program is kept, or else the fallback is drawn with
+  if( fallback && fallback.get() != this && ( !m_programId || m_fallback ) )
+    use_fallback( fallback );
 
-  // everything is ok: use this new program
-  if( check_program_status(m_programId) )
+  std::shared_ptr< PendingLink > link = std::make_shared< PendingLink >();
+  link->vertex_file_path = vertex_file_path;
+  link->fragment_file_path = fragment_file_path;
+  link->defines = defines;
+  link->vertex_name = vertex_name;
+  link->fragment_name = fragment_name;
+  link->key = key;
+  link->start = start;
+  link->parallel = parallel_compile_supported();
+  link->vertex_shader = link->fragment_shader = link->program = 0;
+  link->done = link->abandoned = false;
+  if( link->parallel )
     {
-      // if this is already a program, delete all data
-      if( glIsProgram( previous_id ) )
-        glcheck(glDeleteProgram( previous_id ));
-      m_vertexFilename = vertex_file_path;
-      m_fragmentFilename = fragment_file_path;
+      // the driver compiles and links in its threads: nothing is queried until poll()
+      link->vertex_shader = create_shader( vertex_name, vertex_source, GL_VERTEX_SHADER );
+      link->fragment_shader = create_shader( fragment_name, fragment_source, GL_FRAGMENT_SHADER );
+      glcheck(link->program = glCreateProgram());
+      if( use_binary_cache )
+        glcheck(glProgramParameteri( link->program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE ));
+      if( link->vertex_shader )
+        glcheck(glAttachShader( link->program, link->vertex_shader ));
+      if( link->fragment_shader )
+        glcheck(glAttachShader( link->program, link->fragment_shader ));
+      glcheck(glLinkProgram( link->program ));
+    }
+  else
+    {
+      link->vertex_source.swap( vertex_source );
+      link->fragment_source.swap( fragment_source );
+      CompilerThread::instance().submit( link );
+    }
+  m_pending = link;
+}
+
+bool ShaderProgram::isReady() const
+{
+  return !m_pending;
+}
 
-      // load attributes and uniforms
-      LOG( info, "resources info for ShaderProgram "<< this << " (" << vertex_file_path << ", " << fragment_file_path << ")");
-      resources_introspection();
+bool ShaderProgram::poll()
+{
+  refresh_fallback();
+  if( !m_pending )
+    return true;
+  if( m_pending->parallel )
+    {
+      GLint completed = GL_FALSE;
+      glcheck(glGetProgramiv( m_pending->program, GL_COMPLETION_STATUS_ARB, &completed ));
+      if( !completed )
+        return false;
     }
-  // it failed: delete new program and restore to previous state
   else
+    {
+      std::lock_guard< std::mutex > lock( m_pending->mutex );
+      if( !m_pending->done )
+        return false;
+    }
+  finish_link();
+  return true;
+}
+
+void ShaderProgram::wait()
+{
+  if( !m_pending )
+    return;
+  // with a parallel compilation, the status queries of finish_link() wait for the driver
+  if( !m_pending->parallel )
+    {
+      std::unique_lock< std::mutex > lock( m_pending->mutex );
+      while( !m_pending->done )
+        m_pending->linked.wait( lock );
+    }
+  finish_link();
+}
+
+void ShaderProgram::finish_link()
+{
+  std::shared_ptr< PendingLink > link = m_pending;
+  m_pending.reset();
+
+  GLuint program = link->program;
+  if( link->parallel )
+    {
+      // the compilation errors are only known now
+      bool compiled = link->vertex_shader && check_shader_status( link->vertex_shader, link->vertex_name );
+      compiled = link->fragment_shader && check_shader_status( link->fragment_shader, link->fragment_name ) && compiled;
+      if( link->vertex_shader )
+        glcheck(glDeleteShader( link->vertex_shader ));
+      if( link->fragment_shader )
+        glcheck(glDeleteShader( link->fragment_shader ));
+      if( !compiled )
+        {
+          LOG( error, "cannot load shader program. Program unchanged...");
+          glcheck(glDeleteProgram( program ));
+          program = 0;
+        }
+    }
+  if( !program )
+    return;
+
+  if( adopt_program( program, true, link->vertex_file_path, link->fragment_file_path, link->defines, link->key ) )
+    {
+      std::chrono::duration< double, std::milli > duration = std::chrono::steady_clock::now() - link->start;
+      LOG( info, "ShaderProgram " << this << " (" << link->vertex_file_path << ", " << link->fragment_file_path << ") "
+           << "compiled in the background in " << duration.count() << " ms" );
+    }
+}
+
+void ShaderProgram::cancel_link()
+{
+  if( !m_pending )
+    return;
+  std::shared_ptr< PendingLink > link = m_pending;
+  m_pending.reset();
+  if( link->parallel )
+    {
+      if( link->vertex_shader )
+        glcheck(glDeleteShader( link->vertex_shader ));
+      if( link->fragment_shader )
+        glcheck(glDeleteShader( link->fragment_shader ));
+      glcheck(glDeleteProgram( link->program ));
+      return;
+    }
+  // the compiler thread deletes the program it is linking
+  std::lock_guard< std::mutex > lock( link->mutex );
+  if( link->done && link->program )
+    glcheck(glDeleteProgram( link->program ));
+  link->abandoned = true;
+}
+
+bool ShaderProgram::adopt_program( unsigned int program, bool check_status,
+                                   const std::string& vertex_file_path, const std::string& fragment_file_path,
+                                   const Defines& defines, const std::string& key )
+{
+  // it failed: delete new program and leave this one unchanged
+  if( check_status && !check_program_status( program ) )
     {
       LOG( warning, "shader program described by (" << vertex_file_path << ", " << fragment_file_path
            << ") is invalid. ShaderProgram " << this << " remains unchanged...");
-      glcheck(glDeleteProgram( m_programId ));
-      m_programId = previous_id;
+      glcheck(glDeleteProgram( program ));
+      return false;
     }
 
-  //Delete vertex & fragment id. We do not need them anymore as they are already
-  //"in" this program. The only reason to keep those shaders somewhere would be
-  //to reused them in order to build another shader program.
-  glDeleteShader( vertex_shader_id );
-  glDeleteShader( fragment_shader_id );
+  // everything is ok: use this new program. The program of a fallback is not ours to delete
+  if( !m_fallback && glIsProgram( m_programId ) )
+    glcheck(glDeleteProgram( m_programId ));
+  m_fallback.reset();
+  m_programId = program;
+  m_defines = defines;
+
+  if( !key.empty() )
+    save_program_binary( m_programId, key );
+
+  // load attributes and uniforms
+  LOG( info, "resources info for ShaderProgram "<< this << " (" << vertex_file_path << ", " << fragment_file_path << ")");
+  resources_introspection();
+  m_version = ++ linked_program_number;
+  return true;
+}
+
+void ShaderProgram::use_fallback( const std::shared_ptr< ShaderProgram >& fallback )
+{
+  if( !m_fallback && glIsProgram( m_programId ) )
+    glcheck(glDeleteProgram( m_programId ));
+  m_fallback = fallback;
+  m_fallbackVersion = fallback->m_version;
+  m_programId = fallback->m_programId;
+  m_uniforms = fallback->m_uniforms;
+  m_attributes = fallback->m_attributes;
+  m_uniformBlocks = fallback->m_uniformBlocks;
+  m_uniformHandles.clear();
+  m_attributeHandles.clear();
+  m_blockHandles.clear();
+  resolve_handles();
+  // a new version, for the vertex arrays to be built again for the fallback
+  m_version = ++ linked_program_number;
+}
+
+void ShaderProgram::refresh_fallback()
+{
+  // the fallback linked another program, e.g. when reloaded: the one whose
+  // id was copied is deleted
+  if( m_fallback && m_fallback->m_version != m_fallbackVersion )
+    use_fallback( m_fallback );
+}
+
+void ShaderProgram::record_request( const std::string& vertex_file_path, const std::string& fragment_file_path,
+                                    const Defines& defines )
+{
+  // copied first, as reload() passes them back
+  std::string vertex = vertex_file_path, fragment = fragment_file_path;
+  Defines requested = defines;
+  m_vertexFilename.swap( vertex );
+  m_fragmentFilename.swap( fragment );
+  m_requestedDefines.swap( requested );
+}
+
+void ShaderProgram::setBinaryCacheDirectory( const std::string& directory )
+{
+  binary_cache_directory = directory;
+}
+
+const std::string& ShaderProgram::getBinaryCacheDirectory()
+{
+  return binary_cache_directory;
 }
 
 void
 ShaderProgram::reload()
 {
+  // the files requested last, even if they never linked, so that a fixed
+  // shader replaces the fallback
   if( !m_vertexFilename.empty() && !m_fragmentFilename.empty() )
-    load( m_vertexFilename, m_fragmentFilename );
+    load( m_vertexFilename, m_fragmentFilename, m_requestedDefines );
 }
 
 void
 ShaderProgram::bind()
 {
+  refresh_fallback();
   glcheck(glUseProgram( m_programId ));
 }
 
@@ -199,14 +891,26 @@ static const GLenum attribute_properties[2] = {
 
 GLuint ShaderProgram::programId()
 {
+    refresh_fallback();
     return m_programId;
 }
 
+unsigned int ShaderProgram::getVersion() const
+{
+  return m_version;
+}
+
+const ShaderProgram::Defines& ShaderProgram::getDefines() const
+{
+  return m_defines;
+}
+
 void ShaderProgram::resources_introspection()
 {
   //Clean the maps
   m_uniforms.clear();
   m_attributes.clear();
+  m_uniformBlocks.clear();
     
   GLint values[3];
 
@@ -243,6 +947,43 @@ void ShaderProgram::resources_introspection()
       delete[]name;
     }
 
+  GLint num_blocks = 0;
+  glGetProgramInterfaceiv( m_programId, GL_UNIFORM_BLOCK, GL_ACTIVE_RESOURCES, &num_blocks );
+  LOG( info, " * uniform blocks: " << num_blocks );
+  LOG( info, "\t Binding   Name");
+  for( int block = 0; block < num_blocks; ++ block )
+    {
+      const GLenum name_length = GL_NAME_LENGTH;
+      glcheck(glGetProgramResourceiv( m_programId, GL_UNIFORM_BLOCK, block, 1, &name_length, 1, NULL, values ));
+      char* name = new char[values[0]];
+      glcheck(glGetProgramResourceName(m_programId, GL_UNIFORM_BLOCK, block, values[0], NULL, &name[0]));
+      std::unordered_map< std::string, unsigned int >::const_iterator binding = uniform_block_bindings.find( name );
+      if( binding != uniform_block_bindings.end() )
+        {
+          glcheck(glUniformBlockBinding( m_programId, block, binding->second ));
+          LOG( info, "\t" << std::setw(8) << binding->second << "   " << name );
+        }
+      else
+        LOG( warning, "\t    none   " << name << " (no uniform buffer for this block)" );
+      m_uniformBlocks.insert( {{name, block}} );
+      delete[]name;
+    }
+
+  m_uniformHandles.clear();
+  m_attributeHandles.clear();
+  m_blockHandles.clear();
+  resolve_handles();
+}
+
+void ShaderProgram::resolve_handles() const
+{
+  const std::vector< std::string >& names = handle_names();
+  for( size_t index = m_uniformHandles.size(); index < names.size(); ++ index )
+    {
+      m_uniformHandles.push_back( getUniformLocation( names[index] ) );
+      m_attributeHandles.push_back( getAttributeLocation( names[index] ) );
+      m_blockHandles.push_back( hasUniformBlock( names[index] ) );
+    }
 }
 
 GLint ShaderProgram::getUniformLocation( const std::string& name ) const
@@ -254,6 +995,38 @@ GLint ShaderProgram::getUniformLocation( const std::string& name ) const
   return null_location;
 }
 
+GLint ShaderProgram::getUniformLocation( const Handle& handle ) const
+{
+  // a handle created after the introspection is resolved at its first use
+  if( handle.index() >= m_uniformHandles.size() )
+    resolve_handles();
+  return m_uniformHandles[ handle.index() ];
+}
+
+GLint ShaderProgram::getAttributeLocation( const Handle& handle ) const
+{
+  if( handle.index() >= m_attributeHandles.size() )
+    resolve_handles();
+  return m_attributeHandles[ handle.index() ];
+}
+
+bool ShaderProgram::hasUniformBlock( const std::string& name ) const
+{
+  return m_uniformBlocks.find( name ) != m_uniformBlocks.end();
+}
+
+bool ShaderProgram::hasUniformBlock( const Handle& handle ) const
+{
+  if( handle.index() >= m_blockHandles.size() )
+    resolve_handles();
+  return m_blockHandles[ handle.index() ];
+}
+
+void ShaderProgram::setUniformBlockBinding( const std::string& name, unsigned int binding_point )
+{
+  uniform_block_bindings[ name ] = binding_point;
+}
+
 GLint ShaderProgram::getAttributeLocation( const std::string& name ) const
 {
   std::unordered_map< std::string, int >::const_iterator search = m_attributes.find( name );
@@ -0,0 +1,126 @@
+#include "./../include/StreamBuffer.hpp"
+#include "./../include/gl_helper.hpp"
+
+#include <algorithm>
+
+StreamBuffer::StreamBuffer()
+  : m_buffer(0), m_persistent(GLEW_ARB_buffer_storage), m_regionSize(0), m_region(0), m_data(nullptr)
+{
+  for( unsigned int i = 0; i < regionNumber; ++ i )
+    m_fences[i] = 0;
+  glcheck(glGenBuffers(1, &m_buffer));
+}
+
+StreamBuffer::~StreamBuffer()
+{
+  for( unsigned int i = 0; i < regionNumber; ++ i )
+    if( m_fences[i] )
+      glcheck(glDeleteSync(m_fences[i]));
+  if( m_data )
+  {
+    glcheck(glBindBuffer(GL_ARRAY_BUFFER, m_buffer));
+    glcheck(glUnmapBuffer(GL_ARRAY_BUFFER));
+  }
+  glcheck(glDeleteBuffers(1, &m_buffer));
+}
+
+void StreamBuffer::allocate( std::size_t regionSize )
+{
+  // Grow geometrically, so that a slowly growing data does not reallocate at each frame
+  const std::size_t minimalSize = 256;
+  m_regionSize = std::max( std::max( regionSize, 2 * m_regionSize ), minimalSize );
+  if( m_persistent )
+  {
+    // The storage of a buffer is immutable: a new buffer is needed. The
+    // draw calls still reading the old buffer keep it alive.
+    for( unsigned int i = 0; i < regionNumber; ++ i )
+      if( m_fences[i] )
+      {
+        glcheck(glDeleteSync(m_fences[i]));
+        m_fences[i] = 0;
+      }
+    if( m_data )
+    {
+      glcheck(glBindBuffer(GL_ARRAY_BUFFER, m_buffer));
+      glcheck(glUnmapBuffer(GL_ARRAY_BUFFER));
+    }
+    glcheck(glDeleteBuffers(1, &m_buffer));
+    glcheck(glGenBuffers(1, &m_buffer));
+
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glcheck(glBindBuffer(GL_ARRAY_BUFFER, m_buffer));
+    glcheck(glBufferStorage(GL_ARRAY_BUFFER, regionNumber * m_regionSize, nullptr, flags));
+    m_data = static_cast<char*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, regionNumber * m_regionSize, flags));
+    m_region = 0;
+  }
+}
+
+void StreamBuffer::wait( unsigned int region )
+{
+  if( !m_fences[region] )
+    return;
+  // Flush the commands at the first try, so that the fence is eventually signaled
+  GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+  while( true )
+  {
+    GLenum result = glClientWaitSync(m_fences[region], flags, 1000000);
+    if( result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED || result == GL_WAIT_FAILED )
+      break;
+    flags = 0;
+  }
+  glcheck(glDeleteSync(m_fences[region]));
+  m_fences[region] = 0;
+}
+
+void* StreamBuffer::map( std::size_t size )
+{
+  if( size > m_regionSize || m_regionSize == 0 )
+    allocate( size );
+
+  glcheck(glBindBuffer(GL_ARRAY_BUFFER, m_buffer));
+  if( m_persistent )
+  {
+    m_region = (m_region + 1) % regionNumber;
+    wait( m_region );
+    return m_data + m_region * m_regionSize;
+  }
+
+  // Orphan the previous storage, then map the new one
+  glcheck(glBufferData(GL_ARRAY_BUFFER, m_regionSize, nullptr, GL_STREAM_DRAW));
+  return glMapBufferRange(GL_ARRAY_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+}
+
+void StreamBuffer::unmap()
+{
+  // A coherent mapping makes the writes visible to the GPU without unmapping
+  if( !m_persistent )
+  {
+    glcheck(glBindBuffer(GL_ARRAY_BUFFER, m_buffer));
+    glcheck(glUnmapBuffer(GL_ARRAY_BUFFER));
+  }
+}
+
+void StreamBuffer::fence()
+{
+  if( m_persistent )
+  {
+    if( m_fences[m_region] )
+      glcheck(glDeleteSync(m_fences[m_region]));
+    m_fences[m_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  }
+}
+
+GLuint StreamBuffer::getBuffer() const
+{
+  return m_buffer;
+}
+
+std::size_t StreamBuffer::getOffset() const
+{
+  return m_persistent ? m_region * m_regionSize : 0;
+}
+
+bool StreamBuffer::isPersistent() const
+{
+  return m_persistent;
+}
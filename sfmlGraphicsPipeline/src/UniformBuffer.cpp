@@ -0,0 +1,57 @@
+#include "./../include/UniformBuffer.hpp"
+#include "./../include/ShaderProgram.hpp"
+#include "./../include/gl_helper.hpp"
+
+#include <cstring>
+
+UniformBuffer::UniformBuffer( const std::string& blockName, unsigned int bindingPoint )
+  : m_blockName( blockName ), m_bindingPoint( bindingPoint ), m_buffer( 0 ), m_uploadNumber( 0 )
+{
+  ShaderProgram::setUniformBlockBinding( m_blockName, m_bindingPoint );
+}
+
+UniformBuffer::~UniformBuffer()
+{
+  if( m_buffer )
+    glcheck(glDeleteBuffers( 1, &m_buffer ));
+}
+
+void UniformBuffer::update( const void* data, std::size_t size )
+{
+  if( !m_buffer )
+    glcheck(glGenBuffers( 1, &m_buffer ));
+
+  // Most frames, the lights and the camera do not move
+  if( m_data.size() != size || std::memcmp( m_data.data(), data, size ) != 0 )
+  {
+    m_data.assign( static_cast< const char* >( data ), static_cast< const char* >( data ) + size );
+    // Respecify the whole storage: the draws of the previous frame keep the
+    // old one instead of stalling the upload
+    glcheck(glBindBuffer( GL_UNIFORM_BUFFER, m_buffer ));
+    glcheck(glBufferData( GL_UNIFORM_BUFFER, size, data, GL_STREAM_DRAW ));
+    glcheck(glBindBuffer( GL_UNIFORM_BUFFER, 0 ));
+    ++ m_uploadNumber;
+  }
+  bind();
+}
+
+void UniformBuffer::bind() const
+{
+  if( m_buffer )
+    glcheck(glBindBufferBase( GL_UNIFORM_BUFFER, m_bindingPoint, m_buffer ));
+}
+
+const std::string& UniformBuffer::getBlockName() const
+{
+  return m_blockName;
+}
+
+unsigned int UniformBuffer::getBindingPoint() const
+{
+  return m_bindingPoint;
+}
+
+unsigned int UniformBuffer::getUploadNumber() const
+{
+  return m_uploadNumber;
+}
@@ -0,0 +1,80 @@
+#include "./../include/VertexArray.hpp"
+#include "./../include/ShaderProgram.hpp"
+#include "./../include/gl_helper.hpp"
+
+#include <SFML/Window/Context.hpp>
+
+VertexArray::VertexArray()
+  : m_buildNumber(0)
+{}
+
+VertexArray::~VertexArray()
+{
+  // The VAOs of the other contexts are deleted with their context
+  invalidate();
+}
+
+bool VertexArray::bind( const ShaderProgram& program )
+{
+  const sf::Uint64 context = sf::Context::getActiveContextId();
+  for( Entry& entry : m_entries )
+    if( entry.program == &program && entry.context == context )
+    {
+      if( !entry.invalid && entry.version == program.getVersion() )
+      {
+        glcheck(glBindVertexArray( entry.vao ));
+        return false;
+      }
+      // The program has been reloaded: start from a fresh VAO rather than
+      // leaving enabled the arrays of locations that no longer exist
+      glcheck(glDeleteVertexArrays( 1, &entry.vao ));
+      glcheck(glGenVertexArrays( 1, &entry.vao ));
+      entry.version = program.getVersion();
+      entry.invalid = false;
+      glcheck(glBindVertexArray( entry.vao ));
+      ++ m_buildNumber;
+      return true;
+    }
+
+  Entry entry;
+  entry.program = &program;
+  entry.context = context;
+  entry.version = program.getVersion();
+  entry.invalid = false;
+  glcheck(glGenVertexArrays( 1, &entry.vao ));
+  m_entries.push_back( entry );
+  glcheck(glBindVertexArray( entry.vao ));
+  ++ m_buildNumber;
+  return true;
+}
+
+void VertexArray::unbind()
+{
+  glcheck(glBindVertexArray( 0 ));
+}
+
+void VertexArray::invalidate()
+{
+  // A VAO name is only meaningful in its context: the VAOs of the other
+  // contexts are kept, to be rebuilt when bound again in their context
+  const sf::Uint64 context = sf::Context::getActiveContextId();
+  std::vector< Entry > others;
+  for( Entry& entry : m_entries )
+  {
+    if( entry.context == context )
+    {
+      glcheck(glDeleteVertexArrays( 1, &entry.vao ));
+    }
+    else
+    {
+      entry.invalid = true;
+      others.push_back( entry );
+    }
+  }
+  m_entries.swap( others );
+}
+
+unsigned int VertexArray::getBuildNumber() const
+{
+  return m_buildNumber;
+}
@@ -9,15 +9,40 @@
 #include <iostream>
 #include <sstream>
 #include <iomanip>
+#include <cmath>
 
-bool PriorityComparator::operator()(const RenderablePtr & a, const RenderablePtr & b) const
-{
-    return a->priority() > b->priority(); 
-}
+// Names of the uniforms, attributes and blocks, resolved once per shader program
+static const ShaderProgram::Handle time_handle( "time" );
+static const ShaderProgram::Handle viewer_texsampler_handle( "ViewerTexSampler" );
+static const ShaderProgram::Handle lights_block_handle( "Lights" );
+static const ShaderProgram::Handle clusters_block_handle( "Clusters" );
 
 static const Viewer::Duration g_modeInformationTextTimeout = std::chrono::seconds( 3 );
 
 static const std::string screenshot_basename = "screenshot";
+static const std::string record_basename = "record";
+
+// Settings of the OpenGL context, of the window or of a headless viewer
+static const sf::ContextSettings context_settings{ 24 /* depth*/, 8 /*stencil*/, 4 /*anti aliasing level*/, 4 /*GL major version*/, 0 /*GL minor version*/};
+
+// Uniform buffer binding points of the blocks shared by the shader programs
+static const unsigned int camera_binding_point = 0;
+static const unsigned int lights_binding_point = 1;
+static const unsigned int clusters_binding_point = 2;
+
+// The std140 layout of the block "Camera"
+struct CameraBlockData
+{
+    glm::mat4 projMat;
+    glm::mat4 viewMat;
+};
+
+// True if a renderable is drawn into the G-buffer of the deferred shading
+static bool isDeferred(const Renderable & r)
+{
+    return r.getShaderProgram() && r.getRenderMode() == Renderable::RENDER_MODE::WINDOW
+        && DeferredShading::isDeferred( *r.getShaderProgram() );
+}
 
 static void initializeGL()
 {
@@ -41,24 +66,51 @@ glm::vec3 Viewer::KeyboardState::normalized_direction(){
 }
 
 Viewer::~Viewer()
-{}
+{
+    if( m_offscreenContext )
+        m_offscreenContext->setActive( true );
+    // The frames still captured are written before the context goes away
+    m_frameCapture.reset();
+    if( m_offscreenContext )
+    {
+        glcheck(glDeleteFramebuffers( 1, &m_offscreenFramebuffer ));
+        glcheck(glDeleteFramebuffers( 1, &m_resolveFramebuffer ));
+        glcheck(glDeleteRenderbuffers( 1, &m_offscreenColorBuffer ));
+        glcheck(glDeleteRenderbuffers( 1, &m_offscreenDepthBuffer ));
+        glcheck(glDeleteRenderbuffers( 1, &m_resolveColorBuffer ));
+    }
+}
 
-Viewer::Viewer(float width, float height, const glm::vec4 & background_color) :
-    m_window{
-        sf::VideoMode(width, height),
-        "Computer Graphics Practicals",
-        sf::Style::Default,
-        sf::ContextSettings{ 24 /* depth*/, 8 /*stencil*/, 4 /*anti aliasing level*/, 4 /*GL major version*/, 0 /*GL minor version*/}
-    },
+Viewer::Viewer(float width, float height, const glm::vec4 & background_color, bool headless) :
+    m_offscreenSize{ (unsigned int)width, (unsigned int)height },
+    m_offscreenFramebuffer{ 0 }, m_offscreenColorBuffer{ 0 }, m_offscreenDepthBuffer{ 0 },
+    m_resolveFramebuffer{ 0 }, m_resolveColorBuffer{ 0 },
     //m_modeInformationTextDisappearanceTime{ clock::now() + g_modeInformationTextTimeout },
     //m_modeInformationText{ "Arcball Camera Activated" },
+    m_frustumCulling{ true }, m_culledRenderableNumber{ 0 }, m_drawnRenderableNumber{ 0 }, m_frameNumber{ 0 },
+    m_levelsOfDetail{ true },
+    m_cameraBlock{ "Camera", camera_binding_point }, m_lightBlock{ lights_binding_point },
+    m_clusteredLighting{ clusters_binding_point },
     m_applicationRunning{ true }, m_animationLoop{ false }, m_animationIsStarted{ false },
     m_loopDuration{120}, m_simulationTime{0},
-    m_screenshotCounter{0}, m_helpDisplayed{false}, m_helpDisplayRequest{false},
+    m_frameRate{0}, m_fixedStepNumber{0}, m_sequenceFrameNumber{0}, m_sequenceFrameCounter{0},
+    m_screenshotCounter{0}, m_screenshotRequested{false}, m_recording{false}, m_recordCounter{0},
+    m_helpDisplayed{false}, m_helpDisplayRequest{false},
     m_lastEventHandleTime{ clock::now() },
     m_background_color{background_color}   
 {   
-    sf::ContextSettings settings = m_window.getSettings();
+    // A headless viewer has a context without window, and draws in a framebuffer object
+    if( headless )
+    {
+        m_offscreenContext.reset( new sf::Context( context_settings, width, height ) );
+        m_offscreenContext->setActive( true );
+    }
+    else
+    {
+        m_window.create( sf::VideoMode(width, height), "Computer Graphics Practicals", sf::Style::Default, context_settings );
+    }
+
+    sf::ContextSettings settings = headless ? m_offscreenContext->getSettings() : m_window.getSettings();
     LOG( info, "Settings of OPENGL Context created by SFML");
     LOG( info, "\tdepth bits:         " << settings.depthBits );
     LOG( info, "\tstencil bits:       " << settings.stencilBits );
@@ -71,6 +123,10 @@ Viewer::Viewer(float width, float height, const glm::vec4 & background_color) :
     m_camera.setRatio(ratio);
     //Set up GLEW
     initializeGL();
+    if( headless )
+        createOffscreenFramebuffer();
+    m_instanceBuffer.reset( new StreamBuffer() );
+    m_frameCapture.reset( new FrameCapture() );
     //Initialize OpenGL context
     setBackgroundColor(m_background_color);
     glcheck(glEnable(GL_DEPTH_TEST));
@@ -79,6 +135,7 @@ Viewer::Viewer(float width, float height, const glm::vec4 & background_color) :
     glcheck(glEnable(GL_TEXTURE_2D));
 
     m_texture.create(width, height, sf::ContextSettings{ 0 /* depth*/, 0 /*stencil*/, 4 /*anti aliasing level*/, 4 /*GL major version*/, 0 /*GL minor version*/});
+    bindOffscreenFramebuffer();
     //Initialize the text engine (this SHOULD be done after initializeGL, as the text
     //engine store some data on the graphic card)
     //m_tengine.init();
@@ -92,6 +149,11 @@ constexpr const char * g_help_message =
         "      [F3]  Reload all managed shader program from their sources\n"
         "      [F4]  Pause/Stop the animation\n"
         "      [F5]  Reset the animation\n"
+        "      [F6]  Print the draw statistics of the last frame\n"
+        "      [F7]  Enable/Disable the frustum culling\n"
+        "      [F8]  Enable/Disable the instancing\n"
+        "      [F9]  Enable/Disable the levels of detail\n"
+        "     [F10]  Start/Stop the recording of the frames\n"
         "       [c]  Switch the camera mode between First Person / Arcball / Trackball / Space ship\n"
         "[ctrl]+[w]  Quit the application\n"
         "\n"
@@ -121,63 +183,99 @@ constexpr const char * g_help_message =
 
 void Viewer::draw()
 {
+    bindOffscreenFramebuffer();
     glcheck(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
     float time = getTime();
+
+    // The camera and the lights are uploaded once for all the programs
+    CameraBlockData camera = { m_camera.projectionMatrix(), m_camera.viewMatrix() };
+    m_cameraBlock.update( &camera, sizeof(CameraBlockData) );
+    m_lightBlock.update( m_directionalLights, m_pointLights, m_spotLights );
+
+    // The programs compiled in the background replace their fallback once
+    // linked. A headless viewer waits for them, for its frames not to
+    // depend on the compilation time.
+    bool clustered = false;
+    for( const ShaderProgramPtr & prog : m_programs )
+    {
+        if( m_offscreenContext )
+            prog->wait();
+        else
+            prog->poll();
+        clustered = clustered || prog->hasUniformBlock( clusters_block_handle );
+    }
+
+    // The point and spot lights are sorted into the clusters of the view
+    // only when a program reads them
+    if( clustered )
+    {
+        const sf::Vector2u size = getFrameSize();
+        m_clusteredLighting.update( m_camera, size.x, size.y, m_pointLights, m_spotLights );
+    }
+
     for( const ShaderProgramPtr & prog : m_programs )
     {
         prog->bind();
+        if( prog->hasUniformBlock( clusters_block_handle ) )
+            m_clusteredLighting.setSamplers( prog );
 
-        Light::sendToGPU<DirectionalLight>( prog, m_directionalLights);
-        Light::sendToGPU<SpotLight>( prog, m_spotLights);
-        Light::sendToGPU<PointLight>( prog, m_pointLights);
+        // Programs still declaring the lights as plain uniforms
+        if( !prog->hasUniformBlock( lights_block_handle ) )
+        {
+            Light::sendToGPU<DirectionalLight>( prog, m_directionalLights);
+            Light::sendToGPU<SpotLight>( prog, m_spotLights);
+            Light::sendToGPU<PointLight>( prog, m_pointLights);
+        }
 
-        int timeLocation = prog->getUniformLocation("time");
+        int timeLocation = prog->getUniformLocation(time_handle);
         if(timeLocation != ShaderProgram::null_location)
             glcheck(glUniform1f(timeLocation, time));
     }
 
+    // Skip the renderables out of the view, and sort the draws of the others so
+    // that consecutive renderables share their state
+    m_frustum = Frustum( m_camera.projectionMatrix(), m_camera.viewMatrix() );
+    ++ m_frameNumber;
+    m_culledRenderableNumber = 0;
+    m_drawnRenderableNumber = 0;
+    m_renderQueue.clear();
     for(const RenderablePtr & r : m_renderables)
-    {   
-        if( r->getShaderProgram() )
-        {
-            r->bindShaderProgram();
-            int projectionLocation = r->projectionLocation();
-            if(projectionLocation != ShaderProgram::null_location)
-                glcheck(glUniformMatrix4fv(projectionLocation, 1, GL_FALSE, glm::value_ptr(m_camera.projectionMatrix())));
-            
-            int viewLocation = r->viewLocation();
-            if(viewLocation != ShaderProgram::null_location)
-                glcheck(glUniformMatrix4fv(viewLocation, 1, GL_FALSE, glm::value_ptr(m_camera.viewMatrix())));
-
-            // Texture 
-            int texsamplerLocation = r->getShaderProgram()->getUniformLocation("ViewerTexSampler");
-            if (texsamplerLocation != ShaderProgram::null_location)
-            {   
-                glEnable(GL_TEXTURE_2D);
-                glActiveTexture(GL_TEXTURE0);
-                sf::Texture::bind(&(m_texture.getTexture()));
-                glUniform1i(texsamplerLocation, 0) ;
-            }
-            
-        }
-        if(r->getRenderMode() <= Renderable::RENDER_MODE::WINDOW_TEXTURE)
-        {
-            r->draw();
-        }  
-        if(r->getRenderMode() >= Renderable::RENDER_MODE::WINDOW_TEXTURE)
-        {
-            m_texture.setActive(true);
-            r->draw();
-            m_texture.display();
-            m_texture.setActive(false);
-        }
-        if(r->getShaderProgram())
-        {
-            sf::Texture::bind(0);
-            glDisable(GL_TEXTURE_2D);
-        }
-        r->unbindShaderProgram();
+        if( !isCulled(*r) )
+            m_renderQueue.add(r);
+    m_renderQueue.sort(m_camera.getPosition());
+
+    // The instance data of all the batches of the frame are written at once
+    const std::vector<RenderablePtr> & renderables = m_renderQueue.getRenderables();
+    const std::vector<RenderQueue::Batch> & batches = m_renderQueue.getBatches();
+    const unsigned int instanceNumber = m_renderQueue.getInstancedRenderableNumber();
+    if( instanceNumber )
+    {
+        Renderable::InstanceData* instances = static_cast<Renderable::InstanceData*>(
+            m_instanceBuffer->map( instanceNumber * sizeof(Renderable::InstanceData) ) );
+        for(const RenderQueue::Batch & batch : batches)
+            if( batch.count > 1 )
+                for(unsigned int i = 0; i < batch.count; ++i)
+                    renderables[batch.first + i]->writeInstanceData( *(instances++) );
+        m_instanceBuffer->unmap();
     }
+    const std::size_t instanceOffset = m_instanceBuffer->getOffset();
+
+    // The deferred renderables are drawn into the G-buffer and lit there, then
+    // the forward renderables are drawn over them
+    bool deferred = false;
+    for(const RenderQueue::Batch & batch : batches)
+        deferred = deferred || isDeferred( *renderables[batch.first] );
+    if( deferred )
+    {
+        const sf::Vector2u size = getFrameSize();
+        m_deferredShading.beginGeometryPass( size.x, size.y );
+        drawBatches( true, instanceOffset );
+        m_deferredShading.shade( m_camera, m_offscreenContext ? m_offscreenFramebuffer : 0, m_pointLights, m_spotLights );
+    }
+    drawBatches( false, instanceOffset );
+    if( instanceNumber )
+        m_instanceBuffer->fence();
+    ShaderProgram::unbind();
 
     if (m_helpDisplayRequest && !m_helpDisplayed){
         LOG(info, g_help_message);
@@ -202,7 +300,12 @@ void Viewer::draw()
 
 float Viewer::getTime()
 {
-    if( m_animationIsStarted )
+    // With a fixed frame rate, the time only depends on the number of frames
+    if( m_frameRate > 0.0f )
+    {
+        m_simulationTime = m_fixedStepNumber / m_frameRate;
+    }
+    else if( m_animationIsStarted )
     {
         m_simulationTime += Duration( clock::now() - m_lastSimulationTimePoint).count();
         m_lastSimulationTimePoint = clock::now();
@@ -212,6 +315,87 @@ float Viewer::getTime()
     return m_simulationTime;
 }
 
+void Viewer::drawBatches(bool deferred, std::size_t instanceOffset)
+{
+    const std::vector<RenderablePtr> & renderables = m_renderQueue.getRenderables();
+    const std::vector<RenderQueue::Batch> & batches = m_renderQueue.getBatches();
+
+    // The camera matrices of the programs without the block "Camera" are
+    // uniforms of the program: they only need to be sent when the program changes
+    const ShaderProgram* boundProgram = nullptr;
+    for(const RenderQueue::Batch & batch : batches)
+    {   
+        const RenderablePtr & r = renderables[batch.first];
+        if( isDeferred(*r) != deferred )
+        {
+            if(batch.count > 1)
+                instanceOffset += batch.count * sizeof(Renderable::InstanceData);
+            continue;
+        }
+        int texsamplerLocation = ShaderProgram::null_location;
+        if( r->getShaderProgram() )
+        {
+            if( r->getShaderProgram().get() != boundProgram )
+            {
+                r->bindShaderProgram();
+                boundProgram = r->getShaderProgram().get();
+                int projectionLocation = r->projectionLocation();
+                if(projectionLocation != ShaderProgram::null_location)
+                    glcheck(glUniformMatrix4fv(projectionLocation, 1, GL_FALSE, glm::value_ptr(m_camera.projectionMatrix())));
+                
+                int viewLocation = r->viewLocation();
+                if(viewLocation != ShaderProgram::null_location)
+                    glcheck(glUniformMatrix4fv(viewLocation, 1, GL_FALSE, glm::value_ptr(m_camera.viewMatrix())));
+            }
+
+            // Texture, bound for each renderable as do_draw() may use the texture unit 0
+            texsamplerLocation = r->getShaderProgram()->getUniformLocation(viewer_texsampler_handle);
+            if (texsamplerLocation != ShaderProgram::null_location)
+            {   
+                glEnable(GL_TEXTURE_2D);
+                glActiveTexture(GL_TEXTURE0);
+                sf::Texture::bind(&(m_texture.getTexture()));
+                glUniform1i(texsamplerLocation, 0) ;
+            }
+            
+        }
+        else if( boundProgram )
+        {
+            r->unbindShaderProgram();
+            boundProgram = nullptr;
+        }
+        if(batch.count > 1)
+        {
+            // Only the renderables drawn in the window are batched
+            r->drawInstances( m_instanceBuffer->getBuffer(), instanceOffset, batch.count );
+            instanceOffset += batch.count * sizeof(Renderable::InstanceData);
+        }
+        else if(r->getRenderMode() <= Renderable::RENDER_MODE::WINDOW_TEXTURE)
+        {
+            r->draw();
+        }  
+        if(batch.count == 1 && r->getRenderMode() >= Renderable::RENDER_MODE::WINDOW_TEXTURE)
+        {
+            m_texture.setActive(true);
+            // The buffer bindings are a state of the context of the texture
+            m_cameraBlock.bind();
+            m_lightBlock.buffer().bind();
+            m_clusteredLighting.bind();
+            r->draw();
+            m_texture.display();
+            m_texture.setActive(false);
+            bindOffscreenFramebuffer();
+            // Bind the program again after a draw in the texture
+            boundProgram = nullptr;
+        }
+        if (texsamplerLocation != ShaderProgram::null_location)
+        {
+            sf::Texture::bind(0);
+            glDisable(GL_TEXTURE_2D);
+        }
+    }
+}
+
 void Viewer::animate()
 {
     if(m_animationIsStarted)
@@ -250,6 +434,30 @@ void Viewer::addSpotLight(const SpotLightPtr& spotLight)
     m_spotLights.push_back(spotLight);
 }
 
+ShaderProgram::Defines Viewer::getLightDefines() const
+{
+    ShaderProgram::Defines defines;
+    defines["NR_DIRECTIONAL_LIGHTS"] = std::to_string(m_directionalLights.size());
+    defines["NR_POINT_LIGHTS"] = std::to_string(m_pointLights.size());
+    defines["NR_SPOT_LIGHTS"] = std::to_string(m_spotLights.size());
+    return defines;
+}
+
+ShaderProgram::Defines Viewer::getClusteredLightDefines() const
+{
+    ShaderProgram::Defines defines;
+    defines["CLUSTERED_LIGHTS"] = "";
+    defines["NR_DIRECTIONAL_LIGHTS"] = std::to_string(m_directionalLights.size());
+    return defines;
+}
+
+ShaderProgram::Defines Viewer::getDeferredShadingDefines() const
+{
+    ShaderProgram::Defines defines;
+    defines["DEFERRED_SHADING"] = "";
+    return defines;
+}
+
 void Viewer::startAnimation()
 {
     m_lastSimulationTimePoint = clock::now();
@@ -265,6 +473,30 @@ void Viewer::resetAnimation()
 {
     m_lastSimulationTimePoint = clock::now();
     m_simulationTime = 0;
+    m_fixedStepNumber = 0;
+}
+
+void Viewer::setFixedFrameRate(float fps)
+{
+    // The animation goes on from the current time
+    m_fixedStepNumber = (unsigned int)std::round( getTime() * fps );
+    m_lastSimulationTimePoint = clock::now();
+    m_frameRate = fps;
+}
+
+float Viewer::getFixedFrameRate() const
+{
+    return m_frameRate;
+}
+
+void Viewer::setImageSequence(const std::string & basename, unsigned int frameNumber, float fps)
+{
+    m_sequenceBasename = basename;
+    m_sequenceFrameNumber = frameNumber;
+    m_sequenceFrameCounter = 0;
+    setFixedFrameRate(fps);
+    resetAnimation();
+    startAnimation();
 }
 
 
@@ -272,7 +504,7 @@ void Viewer::resetAnimation()
 void Viewer::addRenderable(const RenderablePtr & r)
 {   
     r->m_viewer = this;
-    m_renderables.insert(r);
+    m_renderables.push_back(r);
 }
 
 void Viewer::keyPressedEvent(sf::Event& e)
@@ -314,6 +546,39 @@ void Viewer::keyPressedEvent(sf::Event& e)
             r->keyPressedEvent(e);
         LOG(info, "Animation reset.")
         break;
+    case sf::Keyboard::F6:
+        LOG(info, m_renderQueue.getDrawNumber() << " draws in "
+            << m_renderQueue.getDrawCallNumber() << " draw calls ("
+            << m_renderQueue.getInstancedRenderableNumber() << " instanced), "
+            << m_renderQueue.getProgramSwitchNumber() << " program switches ("
+            << m_renderQueue.getAvoidedProgramSwitchNumber() << " avoided), "
+            << m_renderQueue.getMaterialSwitchNumber() << " material switches ("
+            << m_renderQueue.getAvoidedMaterialSwitchNumber() << " avoided), "
+            << m_renderQueue.getTextureSwitchNumber() << " texture switches ("
+            << m_renderQueue.getAvoidedTextureSwitchNumber() << " avoided), "
+            << m_drawnRenderableNumber << " renderables drawn, "
+            << m_culledRenderableNumber << " culled, "
+            << m_clusteredLighting.getLightNumber() << " clustered lights ("
+            << float(m_clusteredLighting.getAssignmentNumber()) / ( ClusteredLighting::clusterNumberX
+                * ClusteredLighting::clusterNumberY * ClusteredLighting::clusterNumberZ ) << " per cluster), "
+            << m_deferredShading.getLightPassNumber() << " deferred light passes")
+        break;
+    case sf::Keyboard::F7:
+        setFrustumCulling( !m_frustumCulling );
+        LOG(info, "frustum culling " << ( m_frustumCulling ? "enabled" : "disabled" ));
+        break;
+    case sf::Keyboard::F8:
+        m_renderQueue.setInstancing( !m_renderQueue.getInstancing() );
+        LOG(info, "instancing " << ( m_renderQueue.getInstancing() ? "enabled" : "disabled" ));
+        break;
+    case sf::Keyboard::F9:
+        setLevelsOfDetail( !m_levelsOfDetail );
+        LOG(info, "levels of detail " << ( m_levelsOfDetail ? "enabled" : "disabled" ));
+        break;
+    case sf::Keyboard::F10:
+        m_recording = !m_recording;
+        LOG(info, "recording " << ( m_recording ? "started" : "stopped" ) << ", " << m_recordCounter << " frames recorded");
+        break;
     case sf::Keyboard::W:
         if( e.key.control )
             m_applicationRunning = false;
@@ -577,21 +842,7 @@ void Viewer::handleEvent()
 
 void Viewer::takeScreenshot()
 {
-    int padding = 5;
-    sf::Texture screen;
-    screen.create(m_window.getSize().x, m_window.getSize().y);
-    screen.update(m_window);
-    std::ostringstream filename_sstr;
-    filename_sstr << screenshot_basename << std::setw(padding) << std::setfill('0') << m_screenshotCounter << ".png";
-    if( !screen.copyToImage().saveToFile(filename_sstr.str()) )
-    {
-        LOG( error, "Error while saving the screenshot")
-    }
-    else
-    {
-        LOG( info, "Screenshot successfully taken : " << filename_sstr.str())
-    }
-    m_screenshotCounter++;
+    m_screenshotRequested = true;
 }
 
 void Viewer::changeCameraMode()
@@ -607,7 +858,111 @@ bool Viewer::isRunning() const
 
 void Viewer::display()
 {
-    m_window.display();
+    int padding = 5;
+    if( m_screenshotRequested )
+    {
+        std::ostringstream filename_sstr;
+        filename_sstr << screenshot_basename << std::setw(padding) << std::setfill('0') << m_screenshotCounter << ".png";
+        saveFrame( filename_sstr.str() );
+        LOG( info, "Screenshot taken : " << filename_sstr.str())
+        m_screenshotCounter++;
+        m_screenshotRequested = false;
+    }
+    if( m_recording )
+    {
+        std::ostringstream filename_sstr;
+        filename_sstr << record_basename << std::setw(padding) << std::setfill('0') << m_recordCounter << ".png";
+        saveFrame( filename_sstr.str() );
+        m_recordCounter++;
+    }
+    if( !m_sequenceBasename.empty() && m_sequenceFrameCounter < m_sequenceFrameNumber )
+    {
+        std::ostringstream filename_sstr;
+        filename_sstr << m_sequenceBasename << std::setw(padding) << std::setfill('0') << m_sequenceFrameCounter << ".png";
+        saveFrame( filename_sstr.str() );
+        if( ++ m_sequenceFrameCounter == m_sequenceFrameNumber )
+        {
+            m_frameCapture->finish();
+            LOG( info, m_sequenceFrameNumber << " frames saved to " << m_sequenceBasename << "*.png" )
+            m_applicationRunning = false;
+        }
+    }
+
+    if( m_frameRate > 0.0f && m_animationIsStarted )
+        ++ m_fixedStepNumber;
+    if( !m_offscreenContext )
+        m_window.display();
+    // The frames captured earlier are handed to the encoding threads once read back
+    m_frameCapture->update();
+}
+
+bool Viewer::isHeadless() const
+{
+    return m_offscreenContext != nullptr;
+}
+
+sf::Vector2u Viewer::getFrameSize() const
+{
+    return m_offscreenContext ? m_offscreenSize : m_window.getSize();
+}
+
+void Viewer::createOffscreenFramebuffer()
+{
+    // Multisampled as the window would be
+    const GLsizei samples = context_settings.antialiasingLevel;
+    glcheck(glGenRenderbuffers( 1, &m_offscreenColorBuffer ));
+    glcheck(glBindRenderbuffer( GL_RENDERBUFFER, m_offscreenColorBuffer ));
+    glcheck(glRenderbufferStorageMultisample( GL_RENDERBUFFER, samples, GL_RGBA8, m_offscreenSize.x, m_offscreenSize.y ));
+    glcheck(glGenRenderbuffers( 1, &m_offscreenDepthBuffer ));
+    glcheck(glBindRenderbuffer( GL_RENDERBUFFER, m_offscreenDepthBuffer ));
+    glcheck(glRenderbufferStorageMultisample( GL_RENDERBUFFER, samples, GL_DEPTH24_STENCIL8, m_offscreenSize.x, m_offscreenSize.y ));
+    glcheck(glGenFramebuffers( 1, &m_offscreenFramebuffer ));
+    glcheck(glBindFramebuffer( GL_FRAMEBUFFER, m_offscreenFramebuffer ));
+    glcheck(glFramebufferRenderbuffer( GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_offscreenColorBuffer ));
+    glcheck(glFramebufferRenderbuffer( GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_offscreenDepthBuffer ));
+    if( glCheckFramebufferStatus( GL_FRAMEBUFFER ) != GL_FRAMEBUFFER_COMPLETE )
+        LOG( error, "the off screen framebuffer is incomplete" );
+
+    // The samples are resolved in a single sampled framebuffer to be read
+    glcheck(glGenRenderbuffers( 1, &m_resolveColorBuffer ));
+    glcheck(glBindRenderbuffer( GL_RENDERBUFFER, m_resolveColorBuffer ));
+    glcheck(glRenderbufferStorage( GL_RENDERBUFFER, GL_RGBA8, m_offscreenSize.x, m_offscreenSize.y ));
+    glcheck(glGenFramebuffers( 1, &m_resolveFramebuffer ));
+    glcheck(glBindFramebuffer( GL_FRAMEBUFFER, m_resolveFramebuffer ));
+    glcheck(glFramebufferRenderbuffer( GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_resolveColorBuffer ));
+    if( glCheckFramebufferStatus( GL_FRAMEBUFFER ) != GL_FRAMEBUFFER_COMPLETE )
+        LOG( error, "the resolve framebuffer is incomplete" );
+
+    glcheck(glBindRenderbuffer( GL_RENDERBUFFER, 0 ));
+    bindOffscreenFramebuffer();
+}
+
+void Viewer::bindOffscreenFramebuffer()
+{
+    if( !m_offscreenContext )
+        return;
+    m_offscreenContext->setActive( true );
+    glcheck(glBindFramebuffer( GL_FRAMEBUFFER, m_offscreenFramebuffer ));
+    glcheck(glViewport( 0, 0, m_offscreenSize.x, m_offscreenSize.y ));
+}
+
+void Viewer::saveFrame( const std::string & filename )
+{
+    const sf::Vector2u size = getFrameSize();
+    if( m_offscreenContext )
+    {
+        glcheck(glBindFramebuffer( GL_READ_FRAMEBUFFER, m_offscreenFramebuffer ));
+        glcheck(glBindFramebuffer( GL_DRAW_FRAMEBUFFER, m_resolveFramebuffer ));
+        glcheck(glBlitFramebuffer( 0, 0, size.x, size.y, 0, 0, size.x, size.y, GL_COLOR_BUFFER_BIT, GL_NEAREST ));
+        glcheck(glBindFramebuffer( GL_READ_FRAMEBUFFER, m_resolveFramebuffer ));
+    }
+    else
+    {
+        glcheck(glReadBuffer( GL_BACK ));
+    }
+
+    m_frameCapture->capture( size.x, size.y, filename );
+    bindOffscreenFramebuffer();
 }
 
 void Viewer::addShaderProgram( const ShaderProgramPtr & program )
@@ -626,6 +981,68 @@ Camera& Viewer::getCamera()
     return m_camera;
 }
 
+RenderQueue& Viewer::getRenderQueue()
+{
+    return m_renderQueue;
+}
+
+bool Viewer::isCulled( const Renderable& renderable )
+{
+    if( m_frustumCulling && !m_frustum.intersects( renderable.getWorldBounds() ) )
+    {
+        m_culledRenderableNumber += renderable.getRenderableNumber();
+        return true;
+    }
+    ++ m_drawnRenderableNumber;
+    return false;
+}
+
+void Viewer::setFrustumCulling( bool onOff )
+{
+    m_frustumCulling = onOff;
+}
+
+bool Viewer::getFrustumCulling() const
+{
+    return m_frustumCulling;
+}
+
+const Frustum& Viewer::getFrustum() const
+{
+    return m_frustum;
+}
+
+void Viewer::setLevelsOfDetail( bool onOff )
+{
+    m_levelsOfDetail = onOff;
+}
+
+bool Viewer::getLevelsOfDetail() const
+{
+    return m_levelsOfDetail;
+}
+
+float Viewer::getPixelsPerUnit( float distance ) const
+{
+    // The projection maps y / distance to [-1,1] with a factor projection[1][1]
+    return 0.5f * getFrameSize().y * m_camera.projectionMatrix()[1][1] / distance;
+}
+
+unsigned int Viewer::getCulledRenderableNumber() const
+{
+    return m_culledRenderableNumber;
+}
+
+unsigned int Viewer::getDrawnRenderableNumber() const
+{
+    return m_drawnRenderableNumber;
+}
+
+unsigned int Viewer::getFrameNumber() const
+{
+    return m_frameNumber;
+}
+
 glm::vec3 Viewer::windowToWorld( const glm::vec3& windowCoordinate )
 {
     sf::Vector2u size = m_window.getSize();
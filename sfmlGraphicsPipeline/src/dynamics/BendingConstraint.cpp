@@ -0,0 +1,80 @@
+#include "../../include/dynamics/BendingConstraint.hpp"
+
+#include <cmath>
+#include <glm/gtx/norm.hpp>
+
+BendingConstraint::BendingConstraint(const ParticlePtr p1, const ParticlePtr p2,
+                                     const ParticlePtr p3, const ParticlePtr p4, float compliance) :
+  Constraint({ p1, p2, p3, p4 }, compliance), m_p1(p1), m_p2(p2), m_p3(p3), m_p4(p4)
+{
+  m_restAngle = computeAngle(p1->getPosition(), p2->getPosition(), p3->getPosition(), p4->getPosition());
+}
+
+BendingConstraint::~BendingConstraint()
+{}
+
+float BendingConstraint::getRestAngle() const
+{
+  return m_restAngle;
+}
+
+void BendingConstraint::setRestAngle(float restAngle)
+{
+  m_restAngle = restAngle;
+}
+
+float BendingConstraint::computeAngle(const glm::vec3& x1, const glm::vec3& x2,
+                                      const glm::vec3& x3, const glm::vec3& x4)
+{
+  glm::vec3 edge = x2 - x1;
+  glm::vec3 n1 = glm::cross(x3 - x1, x3 - x2);
+  glm::vec3 n2 = glm::cross(x4 - x2, x4 - x1);
+  float edgeLength = glm::length(edge);
+  if(edgeLength <= 0.0f)
+    return 0.0f;
+  return std::atan2(glm::dot(glm::cross(n1, n2), edge) / edgeLength, glm::dot(n1, n2));
+}
+
+void BendingConstraint::do_project(ParticleStore& store, float dt)
+{
+  const unsigned int i1 = m_p1->getIndex(), i2 = m_p2->getIndex();
+  const unsigned int i3 = m_p3->getIndex(), i4 = m_p4->getIndex();
+  glm::vec3& x1 = store.getPositions()[i1];
+  glm::vec3& x2 = store.getPositions()[i2];
+  glm::vec3& x3 = store.getPositions()[i3];
+  glm::vec3& x4 = store.getPositions()[i4];
+  const float w1 = getInverseMass(store, i1), w2 = getInverseMass(store, i2);
+  const float w3 = getInverseMass(store, i3), w4 = getInverseMass(store, i4);
+
+  glm::vec3 edge = x2 - x1;
+  glm::vec3 n1 = glm::cross(x3 - x1, x3 - x2);
+  glm::vec3 n2 = glm::cross(x4 - x2, x4 - x1);
+  const float edgeLength = glm::length(edge);
+  const float n1Length2 = glm::length2(n1), n2Length2 = glm::length2(n2);
+  //Degenerated triangles have no bending direction
+  if(edgeLength <= 0.0f || n1Length2 <= 0.0f || n2Length2 <= 0.0f)
+    return;
+
+  //Gradients of the dihedral angle
+  n1 /= n1Length2;
+  n2 /= n2Length2;
+  glm::vec3 g3 = -edgeLength * n1;
+  glm::vec3 g4 = -edgeLength * n2;
+  glm::vec3 g1 = -(glm::dot(x3 - x2, edge) * n1 + glm::dot(x4 - x2, edge) * n2) / edgeLength;
+  glm::vec3 g2 = (glm::dot(x3 - x1, edge) * n1 + glm::dot(x4 - x1, edge) * n2) / edgeLength;
+
+  //Angle difference to the rest angle, in [-pi, pi]
+  float value = computeAngle(x1, x2, x3, x4) - m_restAngle;
+  if(value > M_PI)
+    value -= 2.0f * M_PI;
+  else if(value < -M_PI)
+    value += 2.0f * M_PI;
+
+  float gradientNorm = w1 * glm::length2(g1) + w2 * glm::length2(g2)
+                     + w3 * glm::length2(g3) + w4 * glm::length2(g4);
+  float multiplier = updateMultiplier(value, gradientNorm, dt);
+  x1 += w1 * multiplier * g1;
+  x2 += w2 * multiplier * g2;
+  x3 += w3 * multiplier * g3;
+  x4 += w4 * multiplier * g4;
+}
@@ -0,0 +1,28 @@
+#include "./../../include/dynamics/BroadPhase.hpp"
+
+#include <algorithm>
+
+BroadPhase::BroadPhase() : m_threadCount(1)
+{}
+
+BroadPhase::~BroadPhase()
+{}
+
+void BroadPhase::computePairs(const std::vector<glm::vec3>& positions,
+                              const std::vector<float>& radii,
+                              const std::vector<unsigned char>& flags,
+                              std::vector<CandidatePair>& pairs)
+{
+    pairs.clear();
+    do_computePairs(positions, radii, flags, pairs);
+}
+
+unsigned int BroadPhase::getThreadCount() const
+{
+    return m_threadCount;
+}
+
+void BroadPhase::setThreadCount(unsigned int threadCount)
+{
+    m_threadCount = std::max(threadCount, 1u);
+}
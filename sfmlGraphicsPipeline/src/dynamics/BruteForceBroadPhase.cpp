@@ -0,0 +1,26 @@
+#include "./../../include/dynamics/BruteForceBroadPhase.hpp"
+
+BruteForceBroadPhase::BruteForceBroadPhase()
+{}
+
+BruteForceBroadPhase::~BruteForceBroadPhase()
+{}
+
+void BruteForceBroadPhase::do_computePairs(const std::vector<glm::vec3>& positions,
+                                           const std::vector<float>& radii,
+                                           const std::vector<unsigned char>& flags,
+                                           std::vector<CandidatePair>& pairs)
+{
+    const unsigned int n = positions.size();
+    collectPairs(n, [&](unsigned int i, std::vector<CandidatePair>& particlePairs)
+    {
+        if(flags[i] & ParticleStore::RELEASED)
+            return;
+        for(unsigned int j=i+1; j<n; ++j)
+        {
+            if(!(flags[j] & ParticleStore::RELEASED)
+               && testBoundingBoxes(positions[i], radii[i], positions[j], radii[j]))
+                particlePairs.push_back(CandidatePair(i,j));
+        }
+    }, pairs);
+}
@@ -8,9 +8,34 @@ ConstantForceField::ConstantForceField(const std::vector<ParticlePtr>& particles
 
 void ConstantForceField::do_addForce()
 {
-    for(ParticlePtr p : m_particles)
+    if(m_indices.update(m_particles))
     {
-        p->incrForce(m_force*p->getMass());
+        //Work directly on the arrays of the particle store
+        ParticleStore* store = m_indices.getStore();
+        glm::vec3* f = store->getForces().data();
+        const float* m = store->getMasses().data();
+        if(m_indices.isWholeStore())
+        {
+            const unsigned int n = store->size();
+            #pragma omp parallel for num_threads(getThreadCount()) if(getThreadCount() > 1)
+            for(unsigned int i=0; i<n; ++i)
+                f[i] += m_force*m[i];
+        }
+        else
+        {
+            const std::vector<unsigned int>& indices = m_indices.getIndices();
+            const unsigned int n = indices.size();
+            #pragma omp parallel for num_threads(getThreadCount()) if(getThreadCount() > 1)
+            for(unsigned int k=0; k<n; ++k)
+                f[indices[k]] += m_force*m[indices[k]];
+        }
+    }
+    else
+    {
+        for(ParticlePtr p : m_particles)
+        {
+            p->incrForce(m_force*p->getMass());
+        }
     }
 }
 
@@ -22,6 +47,7 @@ const std::vector<ParticlePtr> ConstantForceField::getParticles()
 void ConstantForceField::setParticles(const std::vector<ParticlePtr>& particles)
 {
     m_particles = particles;
+    m_indices.invalidate();
 }
 
 const glm::vec3& ConstantForceField::getForce()
@@ -45,4 +45,9 @@ void ConstantForceFieldRenderable::do_draw()
     glLineWidth(3.0);
     MeshRenderable::do_draw();
     glLineWidth(1.0);
-}
\ No newline at end of file
+}
+
+bool ConstantForceFieldRenderable::do_isInstanceable() const
+{
+    return false;
+}
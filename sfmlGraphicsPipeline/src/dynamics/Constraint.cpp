@@ -0,0 +1,56 @@
+#include "../../include/dynamics/Constraint.hpp"
+
+#include <algorithm>
+
+Constraint::Constraint(const std::vector<ParticlePtr>& particles, float compliance) :
+  m_particles(particles), m_compliance(std::max(compliance, 0.0f)), m_multiplier(0.0f)
+{}
+
+Constraint::~Constraint()
+{}
+
+const std::vector<ParticlePtr>& Constraint::getParticles() const
+{
+  return m_particles;
+}
+
+float Constraint::getCompliance() const
+{
+  return m_compliance;
+}
+
+void Constraint::setCompliance(float compliance)
+{
+  m_compliance = std::max(compliance, 0.0f);
+}
+
+void Constraint::initialize()
+{
+  m_multiplier = 0.0f;
+}
+
+void Constraint::project(ParticleStore& store, float dt)
+{
+  for(const ParticlePtr& p : m_particles)
+  {
+    if(p->getStore().get() != &store)
+      return;
+  }
+  do_project(store, dt);
+}
+
+float Constraint::updateMultiplier(float value, float gradientNorm, float dt)
+{
+  //Compliance scaled by the time step: alpha/dt^2
+  const float alpha = m_compliance / (dt*dt);
+  if(gradientNorm + alpha <= 0.0f)
+    return 0.0f;
+  const float delta = (-value - alpha*m_multiplier) / (gradientNorm + alpha);
+  m_multiplier += delta;
+  return delta;
+}
+
+float Constraint::getInverseMass(const ParticleStore& store, unsigned int index) const
+{
+  return store.getFixed()[index] ? 0.0f : 1.0f / store.getMasses()[index];
+}
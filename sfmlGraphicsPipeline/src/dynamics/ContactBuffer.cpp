@@ -0,0 +1,91 @@
+#include "./../../include/dynamics/ContactBuffer.hpp"
+#include "./../../include/dynamics/ParticlePlaneCollision.hpp"
+#include "./../../include/dynamics/ParticleParticleCollision.hpp"
+
+ContactBuffer::ContactBuffer()
+{}
+
+ContactBuffer::~ContactBuffer()
+{}
+
+void ContactBuffer::clear()
+{
+    m_particlePlaneContacts.clear();
+    m_particleParticleContacts.clear();
+}
+
+void ContactBuffer::reserve(unsigned int particlePlaneNumber, unsigned int particleParticleNumber)
+{
+    m_particlePlaneContacts.reserve(particlePlaneNumber);
+    m_particleParticleContacts.reserve(particleParticleNumber);
+}
+
+void ContactBuffer::addParticlePlane(unsigned int particle, unsigned int plane)
+{
+    ParticlePlaneContact contact = { particle, plane };
+    m_particlePlaneContacts.push_back(contact);
+}
+
+void ContactBuffer::addParticleParticle(unsigned int particle1, unsigned int particle2)
+{
+    ParticleParticleContact contact = { particle1, particle2 };
+    m_particleParticleContacts.push_back(contact);
+}
+
+void ContactBuffer::append(const ContactBuffer& contacts)
+{
+    m_particlePlaneContacts.insert(m_particlePlaneContacts.end(),
+                                   contacts.m_particlePlaneContacts.begin(),
+                                   contacts.m_particlePlaneContacts.end());
+    m_particleParticleContacts.insert(m_particleParticleContacts.end(),
+                                      contacts.m_particleParticleContacts.begin(),
+                                      contacts.m_particleParticleContacts.end());
+}
+
+const std::vector<ParticlePlaneContact>& ContactBuffer::getParticlePlaneContacts() const
+{
+    return m_particlePlaneContacts;
+}
+
+const std::vector<ParticleParticleContact>& ContactBuffer::getParticleParticleContacts() const
+{
+    return m_particleParticleContacts;
+}
+
+unsigned int ContactBuffer::size() const
+{
+    return m_particlePlaneContacts.size() + m_particleParticleContacts.size();
+}
+
+void ContactBuffer::solve(ParticleStore& store, const std::vector<PlanePtr>& planes, float restitution) const
+{
+    glm::vec3* x = store.getPositions().data();
+    glm::vec3* v = store.getVelocities().data();
+    const float* m = store.getMasses().data();
+    const float* r = store.getRadii().data();
+    const unsigned char* fixed = store.getFixed().data();
+
+    for(const ParticlePlaneContact& c : m_particlePlaneContacts)
+    {
+        //The planes are fixed
+        if(!fixed[c.particle])
+            solveParticlePlane(x[c.particle], v[c.particle], r[c.particle], *planes[c.plane], restitution);
+    }
+
+    for(const ParticleParticleContact& c : m_particleParticleContacts)
+    {
+        const unsigned int i = c.particle1, j = c.particle2;
+        if(!fixed[i] || !fixed[j])
+            solveParticleParticle(x[i], v[i], m[i], r[i], fixed[i],
+                                  x[j], v[j], m[j], r[j], fixed[j], restitution);
+    }
+}
+
+void ContactBuffer::createCollisions(const std::vector<ParticlePtr>& particles, const std::vector<PlanePtr>& planes,
+                                     float restitution, std::vector<CollisionPtr>& collisions) const
+{
+    for(const ParticlePlaneContact& c : m_particlePlaneContacts)
+        collisions.push_back(std::make_shared<ParticlePlaneCollision>(particles[c.particle], planes[c.plane], restitution));
+    for(const ParticleParticleContact& c : m_particleParticleContacts)
+        collisions.push_back(std::make_shared<ParticleParticleCollision>(particles[c.particle1], particles[c.particle2], restitution));
+}
@@ -0,0 +1,13 @@
+#include "./../../include/dynamics/ContactSolver.hpp"
+
+ContactSolver::ContactSolver()
+{}
+
+ContactSolver::~ContactSolver()
+{}
+
+void ContactSolver::solve(ParticleStore& store, const ContactBuffer& contacts,
+                          const std::vector<PlanePtr>& planes, float restitution, float dt)
+{
+    do_solve(store, contacts, planes, restitution, dt);
+}
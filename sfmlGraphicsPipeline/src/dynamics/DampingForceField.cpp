@@ -8,9 +8,58 @@ DampingForceField::DampingForceField(const std::vector<ParticlePtr> particles, c
 
 void DampingForceField::do_addForce()
 {
-    for(ParticlePtr p : m_particles)
+    if(m_indices.update(m_particles))
     {
-        p->incrForce(-m_damping*p->getVelocity());
+        //Work directly on the arrays of the particle store
+        ParticleStore* store = m_indices.getStore();
+        glm::vec3* f = store->getForces().data();
+        const glm::vec3* v = store->getVelocities().data();
+        if(m_indices.isWholeStore())
+        {
+            const unsigned int n = store->size();
+            #pragma omp parallel for num_threads(getThreadCount()) if(getThreadCount() > 1)
+            for(unsigned int i=0; i<n; ++i)
+                f[i] -= m_damping*v[i];
+        }
+        else
+        {
+            const std::vector<unsigned int>& indices = m_indices.getIndices();
+            const unsigned int n = indices.size();
+            #pragma omp parallel for num_threads(getThreadCount()) if(getThreadCount() > 1)
+            for(unsigned int k=0; k<n; ++k)
+                f[indices[k]] -= m_damping*v[indices[k]];
+        }
+    }
+    else
+    {
+        for(ParticlePtr p : m_particles)
+        {
+            p->incrForce(-m_damping*p->getVelocity());
+        }
+    }
+}
+
+void DampingForceField::do_addForceDifferential(const ParticleStore& store,
+                                                const std::vector<glm::vec3>&,
+                                                const std::vector<glm::vec3>& dv,
+                                                std::vector<glm::vec3>& df)
+{
+    //The force -damping*v only depends on the velocity
+    if(m_indices.update(m_particles) && m_indices.getStore() == &store)
+    {
+        const std::vector<unsigned int>& indices = m_indices.getIndices();
+        const unsigned int n = indices.size();
+        #pragma omp parallel for num_threads(getThreadCount()) if(getThreadCount() > 1)
+        for(unsigned int k=0; k<n; ++k)
+            df[indices[k]] -= m_damping*dv[indices[k]];
+    }
+    else
+    {
+        for(ParticlePtr p : m_particles)
+        {
+            if(p->getStore().get() == &store)
+                df[p->getIndex()] -= m_damping*dv[p->getIndex()];
+        }
     }
 }
 
@@ -22,6 +71,7 @@ const std::vector<ParticlePtr> DampingForceField::getParticles()
 void DampingForceField::setParticles(const std::vector<ParticlePtr>& particles)
 {
     m_particles = particles;
+    m_indices.invalidate();
 }
 
 const float& DampingForceField::getDamping()
@@ -0,0 +1,47 @@
+#include "../../include/dynamics/DistanceConstraint.hpp"
+
+DistanceConstraint::DistanceConstraint(const ParticlePtr p1, const ParticlePtr p2, float restLength, float compliance) :
+  Constraint({ p1, p2 }, compliance), m_p1(p1), m_p2(p2), m_restLength(restLength)
+{}
+
+DistanceConstraint::~DistanceConstraint()
+{}
+
+ParticlePtr DistanceConstraint::getParticle1() const
+{
+  return m_p1;
+}
+
+ParticlePtr DistanceConstraint::getParticle2() const
+{
+  return m_p2;
+}
+
+float DistanceConstraint::getRestLength() const
+{
+  return m_restLength;
+}
+
+void DistanceConstraint::setRestLength(float restLength)
+{
+  m_restLength = restLength;
+}
+
+void DistanceConstraint::do_project(ParticleStore& store, float dt)
+{
+  const unsigned int i1 = m_p1->getIndex(), i2 = m_p2->getIndex();
+  glm::vec3& x1 = store.getPositions()[i1];
+  glm::vec3& x2 = store.getPositions()[i2];
+  const float w1 = getInverseMass(store, i1), w2 = getInverseMass(store, i2);
+
+  glm::vec3 delta = x1 - x2;
+  float length = glm::length(delta);
+  if(length <= 0.0f || w1 + w2 <= 0.0f)
+    return;
+
+  //The gradient is the direction for x1 and its opposite for x2
+  glm::vec3 direction = delta / length;
+  float multiplier = updateMultiplier(length - m_restLength, w1 + w2, dt);
+  x1 += w1 * multiplier * direction;
+  x2 -= w2 * multiplier * direction;
+}
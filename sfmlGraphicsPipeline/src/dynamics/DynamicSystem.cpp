@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <GL/glew.h>
@@ -8,25 +9,69 @@
 #include "./../../include/dynamics/DynamicSystem.hpp"
 #include "./../../include/dynamics/ParticlePlaneCollision.hpp"
 #include "./../../include/dynamics/ParticleParticleCollision.hpp"
+#include "./../../include/dynamics/SinglePassContactSolver.hpp"
+#include "./../../include/dynamics/UniformGridBroadPhase.hpp"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 
 DynamicSystem::DynamicSystem() :
+    m_store(std::make_shared<ParticleStore>()),
+    m_storeVersion(0),
+    m_forceFieldsChanged(true),
     m_dt(0.1),
-    m_restitution(1.0),
-    m_handleCollisions(true)
+    m_broadPhase(std::make_shared<UniformGridBroadPhase>()),
+    m_contactSolver(std::make_shared<SinglePassContactSolver>()),
+    m_parallel(false),
+    m_threadCount(0),
+    m_handleCollisions(true),
+    m_restitution(1.0)
 {}
 
 glm::vec3 DynamicSystem::gravity = glm::vec3(0.0, -9.81, 0.0);
 
 
-const std::vector<ParticlePtr>& DynamicSystem::getParticles() const
+const std::vector<ParticlePtr>& DynamicSystem::getParticles()
 {
+    dropReleasedParticles();
     return m_particles;
 }
 
+const ParticleStorePtr& DynamicSystem::getStore() const
+{
+    return m_store;
+}
+
 void DynamicSystem::setParticles(const std::vector<ParticlePtr> &particles)
 {
-    m_particles = particles;
+    clearParticles();
+    m_store->reserve(particles.size());
+    for(ParticlePtr p : particles)
+        addParticle(p);
+}
+
+void DynamicSystem::clearParticles()
+{
+    dropReleasedParticles();
+    //Give back to the particles their own store, as they can still be used
+    for(ParticlePtr p : m_particles)
+        p->moveToStore(std::make_shared<ParticleStore>());
+    m_particles.clear();
+    m_store->clear();
+    m_storeVersion = m_store->getVersion();
+}
+
+void DynamicSystem::dropReleasedParticles()
+{
+    if(m_store->getVersion() == m_storeVersion)
+        return;
+    //The particles added to another system left the store of this one
+    m_particles.erase(std::remove_if(m_particles.begin(), m_particles.end(),
+                                     [this](const ParticlePtr& p){ return p->getStore() != m_store; }),
+                      m_particles.end());
+    m_storeVersion = m_store->getVersion();
 }
 
 const std::vector<ForceFieldPtr>& DynamicSystem::getForceFields() const
@@ -37,8 +82,23 @@ const std::vector<ForceFieldPtr>& DynamicSystem::getForceFields() const
 void DynamicSystem::setForceFields(const std::vector<ForceFieldPtr> &forceFields)
 {
     m_forceFields = forceFields;
+    m_forceFieldsChanged = true;
+}
+
+const std::vector<ConstraintPtr>& DynamicSystem::getConstraints() const
+{
+    return m_constraints;
+}
+
+void DynamicSystem::setConstraints(const std::vector<ConstraintPtr>& constraints)
+{
+    m_constraints = constraints;
 }
 
+const std::vector<PlanePtr>& DynamicSystem::getPlaneObstacles() const
+{
+    return m_planeObstacles;
+}
 
 float DynamicSystem::getDt() const
 {
@@ -54,8 +114,10 @@ DynamicSystem::~DynamicSystem() {}
 
 void DynamicSystem::clear()
 {
-    m_particles.clear();
+    clearParticles();
     m_forceFields.clear();
+    m_forceFieldsChanged = true;
+    m_constraints.clear();
     m_planeObstacles.clear();
 }
 
@@ -67,16 +129,69 @@ bool DynamicSystem::getCollisionDetection()
 void DynamicSystem::setCollisionsDetection(bool onOff)
 {
     m_handleCollisions = onOff;
+    if(!onOff)
+        m_store->wakeUp();
+}
+
+const ContactBuffer& DynamicSystem::getContacts() const
+{
+    return m_contacts;
+}
+
+bool DynamicSystem::getParallel() const
+{
+    return m_parallel;
+}
+
+void DynamicSystem::setParallel(bool onOff)
+{
+    m_parallel = onOff;
+}
+
+unsigned int DynamicSystem::getThreadCount() const
+{
+    return m_threadCount;
+}
+
+void DynamicSystem::setThreadCount(unsigned int threadCount)
+{
+    m_threadCount = threadCount;
+}
+
+unsigned int DynamicSystem::computeThreadCount() const
+{
+#ifdef _OPENMP
+    if(m_parallel)
+        return m_threadCount > 0 ? m_threadCount : omp_get_max_threads();
+#endif
+    return 1;
 }
 
 void DynamicSystem::addParticle(ParticlePtr p)
 {
-    m_particles.push_back(p);
+    dropReleasedParticles();
+    if(p->getStore() == m_store)
+        return;
+    p->moveToStore(m_store);
+    //The entry of a particle which left the store may be reused: keep the
+    //particles sorted by index, so that the i-th particle is the i-th entry
+    //of the store once all the entries are used again
+    std::vector<ParticlePtr>::iterator it =
+        std::lower_bound(m_particles.begin(), m_particles.end(), p->getIndex(),
+                         [](const ParticlePtr& q, unsigned int index){ return q->getIndex() < index; });
+    m_particles.insert(it, p);
+    m_storeVersion = m_store->getVersion();
 }
 
 void DynamicSystem::addForceField(ForceFieldPtr forceField)
 {
     m_forceFields.push_back(forceField);
+    m_forceFieldsChanged = true;
+}
+
+void DynamicSystem::addConstraint(ConstraintPtr constraint)
+{
+    m_constraints.push_back(constraint);
 }
 
 void DynamicSystem::addPlaneObstacle(PlanePtr planeObstacle)
@@ -94,66 +209,169 @@ void DynamicSystem::setSolver(SolverPtr solver)
     m_solver = solver;
 }
 
-void DynamicSystem::detectCollisions()
+BroadPhasePtr DynamicSystem::getBroadPhase()
 {
-    //Detect particle plane collisions
-    for(ParticlePtr p : m_particles)
+    return m_broadPhase;
+}
+
+void DynamicSystem::setBroadPhase(BroadPhasePtr broadPhase)
+{
+    m_broadPhase = broadPhase;
+}
+
+ContactSolverPtr DynamicSystem::getContactSolver()
+{
+    return m_contactSolver;
+}
+
+void DynamicSystem::setContactSolver(ContactSolverPtr contactSolver)
+{
+    m_contactSolver = contactSolver;
+    m_store->wakeUp();
+}
+
+void DynamicSystem::detectCollisions(unsigned int threadCount)
+{
+    //Compute the pairs of particles that may collide
+    m_broadPhase->setThreadCount(threadCount);
+    m_broadPhase->computePairs(m_store->getPositions(), m_store->getRadii(), m_store->getFixed(), m_candidatePairs);
+
+    const glm::vec3* x = m_store->getPositions().data();
+    const float* r = m_store->getRadii().data();
+    const unsigned char* flags = m_store->getFixed().data();
+    const unsigned int particleNumber = m_store->size();
+    const unsigned int planeNumber = m_planeObstacles.size();
+    const unsigned int pairNumber = m_candidatePairs.size();
+
+    //In parallel mode, each thread fills its own buffer
+    m_contacts.clear();
+    m_threadContacts.resize(threadCount > 1 ? threadCount : 0);
+
+    #pragma omp parallel num_threads(threadCount) if(threadCount > 1)
     {
-        for(PlanePtr o : m_planeObstacles)
+#ifdef _OPENMP
+        ContactBuffer& contacts = (threadCount > 1) ? m_threadContacts[omp_get_thread_num()] : m_contacts;
+#else
+        ContactBuffer& contacts = m_contacts;
+#endif
+        if(threadCount > 1)
+            contacts.clear();
+
+        //Detect particle plane collisions
+        #pragma omp for schedule(static)
+        for(unsigned int i=0; i<particleNumber; ++i)
         {
-            if(testParticlePlane(p, o))
+            if(flags[i] & ParticleStore::RELEASED)
+                continue;
+            for(unsigned int o=0; o<planeNumber; ++o)
             {
-                ParticlePlaneCollisionPtr c = std::make_shared<ParticlePlaneCollision>(p,o,m_restitution);
-                m_collisions.push_back(c);
+                if(testParticlePlane(x[i], r[i], *m_planeObstacles[o]))
+                    contacts.addParticlePlane(i, o);
             }
         }
-    }
 
-    //Detect particle particle collisions
-    for(size_t i=0; i<m_particles.size(); ++i)
-    {
-        for(size_t j=i; j<m_particles.size(); ++j)
+        //Detect particle particle collisions among the pairs given by the broad phase
+        #pragma omp for schedule(static)
+        for(unsigned int k=0; k<pairNumber; ++k)
         {
-            ParticlePtr p1 = m_particles[i];
-            ParticlePtr p2 = m_particles[j];
-            if(testParticleParticle(p1,p2))
-            {
-                ParticleParticleCollisionPtr c = std::make_shared<ParticleParticleCollision>(p1,p2,m_restitution);
-                m_collisions.push_back(c);
-            }
+            const unsigned int i = m_candidatePairs[k].first, j = m_candidatePairs[k].second;
+            if(testParticleParticle(x[i], r[i], x[j], r[j]))
+                contacts.addParticleParticle(i, j);
         }
     }
+
+    for(const ContactBuffer& contacts : m_threadContacts)
+        m_contacts.append(contacts);
 }
 
 void DynamicSystem::solveCollisions()
 {
-    while(!m_collisions.empty())
+    m_contactSolver->solve(*m_store, m_contacts, m_planeObstacles, m_restitution, m_dt);
+}
+
+void DynamicSystem::sortForceFields()
+{
+    //Separate the springs, whose forces are accumulated together
+    std::vector<SpringForceFieldPtr> springs;
+    m_otherForceFields.clear();
+    for(ForceFieldPtr f : m_forceFields)
     {
-        CollisionPtr collision = m_collisions.back();
-        collision->solveCollision();
-        m_collisions.pop_back();
+        SpringForceFieldPtr spring = std::dynamic_pointer_cast<SpringForceField>(f);
+        if(spring)
+            springs.push_back(spring);
+        else
+            m_otherForceFields.push_back(f);
     }
+    m_springAccumulator.setSprings(springs);
+    m_forceFieldsChanged = false;
 }
 
-void DynamicSystem::computeSimulationStep()
+void DynamicSystem::computeForces()
 {
-    //Compute particle's force
-    for(ParticlePtr p : m_particles)
+    const unsigned int threadCount = computeThreadCount();
+    m_store->clearForces();
+
+    if(threadCount <= 1)
     {
-        p->setForce(glm::vec3(0.0,0.0,0.0));
+        for(ForceFieldPtr f : m_forceFields)
+        {
+            f->setThreadCount(1);
+            f->addForce();
+        }
+        return;
     }
-    for(ForceFieldPtr f : m_forceFields)
+
+    if(m_forceFieldsChanged)
+        sortForceFields();
+    for(ForceFieldPtr f : m_otherForceFields)
     {
+        f->setThreadCount(threadCount);
         f->addForce();
     }
+    m_springAccumulator.addForces(*m_store, threadCount);
+}
+
+void DynamicSystem::addForceDifferentials(const std::vector<glm::vec3>& dx,
+                                          const std::vector<glm::vec3>& dv,
+                                          std::vector<glm::vec3>& df)
+{
+    const unsigned int threadCount = computeThreadCount();
+
+    if(threadCount <= 1)
+    {
+        for(ForceFieldPtr f : m_forceFields)
+        {
+            f->setThreadCount(1);
+            f->addForceDifferential(*m_store, dx, dv, df);
+        }
+        return;
+    }
+
+    if(m_forceFieldsChanged)
+        sortForceFields();
+    for(ForceFieldPtr f : m_otherForceFields)
+    {
+        f->setThreadCount(threadCount);
+        f->addForceDifferential(*m_store, dx, dv, df);
+    }
+    m_springAccumulator.addForceDifferentials(*m_store, dx, dv, df, threadCount);
+}
+
+void DynamicSystem::computeSimulationStep()
+{
+    const unsigned int threadCount = computeThreadCount();
+
+    //Compute particle's force
+    computeForces();
 
     //Integrate position and velocity of particles
-    m_solver->solve(m_dt, m_particles);
+    m_solver->setThreadCount(threadCount);
+    m_solver->solve(m_dt, *this);
 
-    //Detect and resolve collisions
-    if(m_handleCollisions)
+    //Detect and resolve collisions, unless the solver already did
+    if(m_handleCollisions && !m_solver->solvesCollisions())
     {
-        detectCollisions();
+        detectCollisions(threadCount);
         solveCollisions();
     }
 }
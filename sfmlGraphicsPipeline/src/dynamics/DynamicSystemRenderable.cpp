@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <map>
@@ -6,6 +7,7 @@
 #include <glm/gtc/random.hpp>
 
 #include "./../../include/gl_helper.hpp"
+#include "./../../include/log.hpp"
 #include "./../../include/dynamics/DynamicSystemRenderable.hpp"
 #include "./../../include/Viewer.hpp"
 
@@ -13,7 +15,8 @@ DynamicSystemRenderable::~DynamicSystemRenderable()
 {}
 
 DynamicSystemRenderable::DynamicSystemRenderable(DynamicSystemPtr system) :
-    HierarchicalRenderable(nullptr), m_lastUpdateTime( 0 )
+    HierarchicalRenderable(nullptr), m_lastUpdateTime( 0 ), m_accumulatedTime( 0 ),
+    m_maxSubsteps( 8 ), m_substepNumber( 0 ), m_droppedStepNumber( 0 ), m_droppingSteps( false )
 {
     m_system = system;
 }
@@ -23,13 +26,84 @@ void DynamicSystemRenderable::do_draw()
 
 void DynamicSystemRenderable::do_animate(float time )
 {
-    if( time - m_lastUpdateTime >= m_system->getDt() )
+    const float dt = m_system->getDt();
+    const std::vector<glm::vec3>& positions = m_system->getStore()->getPositions();
+
+    //The time goes back when the animation is reset or loops
+    if( time < m_lastUpdateTime )
+        m_accumulatedTime = 0;
+    else
+        m_accumulatedTime += time - m_lastUpdateTime;
+    m_lastUpdateTime = time;
+
+    //Dynamic system steps, with a fixed time step
+    m_substepNumber = 0;
+    while( m_accumulatedTime >= dt && m_substepNumber < m_maxSubsteps )
     {
-        //Dynamic system step
+        m_previousPositions = positions;
         m_system->computeSimulationStep();
-        m_lastUpdateTime = time;
+        m_accumulatedTime -= dt;
+        ++m_substepNumber;
     }
 
+    //Drop the steps that could not be computed in this frame
+    if( m_accumulatedTime >= dt )
+    {
+        unsigned int dropped = std::floor( m_accumulatedTime / dt );
+        if( !m_droppingSteps )
+            LOG( warning, "simulation slower than real time, " << dropped << " step(s) dropped" );
+        m_droppedStepNumber += dropped;
+        m_accumulatedTime -= dropped * dt;
+        m_droppingSteps = true;
+    }
+    else
+        m_droppingSteps = false;
+
+    //Interpolate the positions at the frame time
+    if( m_previousPositions.size() != positions.size() )
+        m_previousPositions = positions;
+    const float alpha = getInterpolationAlpha();
+    m_interpolatedPositions.resize( positions.size() );
+    for( size_t i = 0; i < positions.size(); ++i )
+        m_interpolatedPositions[i] = glm::mix( m_previousPositions[i], positions[i], alpha );
+}
+
+unsigned int DynamicSystemRenderable::getMaxSubsteps() const
+{
+    return m_maxSubsteps;
+}
+
+void DynamicSystemRenderable::setMaxSubsteps(unsigned int maxSubsteps)
+{
+    m_maxSubsteps = maxSubsteps;
+}
+
+unsigned int DynamicSystemRenderable::getSubstepNumber() const
+{
+    return m_substepNumber;
+}
+
+unsigned int DynamicSystemRenderable::getDroppedStepNumber() const
+{
+    return m_droppedStepNumber;
+}
+
+float DynamicSystemRenderable::getInterpolationAlpha() const
+{
+    const float dt = m_system->getDt();
+    return dt > 0 ? std::min( m_accumulatedTime / dt, 1.0f ) : 1.0f;
+}
+
+const std::vector<glm::vec3>& DynamicSystemRenderable::getInterpolatedPositions() const
+{
+    return m_interpolatedPositions;
+}
+
+glm::vec3 DynamicSystemRenderable::getInterpolatedPosition(const ParticlePtr& particle) const
+{
+    if( particle->getStore() == m_system->getStore() && particle->getIndex() < m_interpolatedPositions.size() )
+        return m_interpolatedPositions[particle->getIndex()];
+    return particle->getPosition();
 }
 
 void DynamicSystemRenderable::setDynamicSystem(const DynamicSystemPtr &system)
@@ -43,6 +117,10 @@ void DynamicSystemRenderable::do_keyPressedEvent(sf::Event &e)
     {
         m_system->setCollisionsDetection( !m_system->getCollisionDetection() );
     }
+    else if(e.key.code == sf::Keyboard::P ) //Toggle parallel execution
+    {
+        m_system->setParallel( !m_system->getParallel() );
+    }
     else if(e.key.code == sf::Keyboard::T ) //Tilt particles
     {
         srand(time(0));
@@ -61,6 +139,10 @@ void DynamicSystemRenderable::do_keyPressedEvent(sf::Event &e)
             p->restart();
         }
         m_lastUpdateTime = 0;
+        m_accumulatedTime = 0;
+        m_droppedStepNumber = 0;
+        m_previousPositions = m_system->getStore()->getPositions();
+        m_interpolatedPositions = m_previousPositions;
     }
     else //Propagate events to the children
     {
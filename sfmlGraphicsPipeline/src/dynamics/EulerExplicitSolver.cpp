@@ -1,4 +1,5 @@
 #include "./../../include/dynamics/EulerExplicitSolver.hpp"
+#include "./../../include/dynamics/DynamicSystem.hpp"
 
 EulerExplicitSolver::EulerExplicitSolver()
 {
@@ -10,15 +11,24 @@ EulerExplicitSolver::~EulerExplicitSolver()
 
 }
 
-void EulerExplicitSolver::do_solve(const float& dt, std::vector<ParticlePtr>& particles)
+void EulerExplicitSolver::do_solve(const float& dt, DynamicSystem& system)
 {
-    for(ParticlePtr p : particles)
+    ParticleStore& particles = *system.getStore();
+    glm::vec3* x = particles.getPositions().data();
+    glm::vec3* v = particles.getVelocities().data();
+    const glm::vec3* f = particles.getForces().data();
+    const float* m = particles.getMasses().data();
+    const unsigned char* fixed = particles.getFixed().data();
+    const unsigned int n = particles.size();
+
+    #pragma omp parallel for num_threads(getThreadCount()) if(getThreadCount() > 1)
+    for(unsigned int i=0; i<n; ++i)
     {
-        if(!p->isFixed())
+        if(!fixed[i])
         {
             //Implement explicit euler solver
-            p->setVelocity(p->getVelocity() + p->getForce() / p->getMass() * dt);
-            p->setPosition(p->getPosition() + p->getVelocity() * dt);
+            v[i] += f[i] / m[i] * dt;
+            x[i] += v[i] * dt;
         }
     }
 }
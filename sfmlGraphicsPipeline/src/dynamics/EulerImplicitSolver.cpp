@@ -0,0 +1,144 @@
+#include "./../../include/dynamics/EulerImplicitSolver.hpp"
+#include "./../../include/dynamics/DynamicSystem.hpp"
+
+//Dot product of two vectors of vec3, accumulated in double precision
+static double dot(const std::vector<glm::vec3>& a, const std::vector<glm::vec3>& b,
+                  unsigned int threadCount)
+{
+    const unsigned int n = a.size();
+    double sum = 0.0;
+    #pragma omp parallel for num_threads(threadCount) if(threadCount > 1) reduction(+:sum)
+    for(unsigned int i=0; i<n; ++i)
+        sum += glm::dot(a[i], b[i]);
+    return sum;
+}
+
+EulerImplicitSolver::EulerImplicitSolver(unsigned int maxIterations, float tolerance) :
+    m_maxIterations(maxIterations), m_tolerance(tolerance), m_iterationNumber(0)
+{}
+
+EulerImplicitSolver::~EulerImplicitSolver()
+{}
+
+unsigned int EulerImplicitSolver::getMaxIterations() const
+{
+    return m_maxIterations;
+}
+
+void EulerImplicitSolver::setMaxIterations(unsigned int maxIterations)
+{
+    m_maxIterations = maxIterations;
+}
+
+float EulerImplicitSolver::getTolerance() const
+{
+    return m_tolerance;
+}
+
+void EulerImplicitSolver::setTolerance(float tolerance)
+{
+    m_tolerance = tolerance;
+}
+
+unsigned int EulerImplicitSolver::getIterationNumber() const
+{
+    return m_iterationNumber;
+}
+
+void EulerImplicitSolver::multiply(DynamicSystem& system, float dt,
+                                   const std::vector<glm::vec3>& p, std::vector<glm::vec3>& Ap)
+{
+    const ParticleStore& particles = *system.getStore();
+    const float* m = particles.getMasses().data();
+    const unsigned char* fixed = particles.getFixed().data();
+    const unsigned int n = particles.size();
+
+    //df = dt^2*df/dx p + dt*df/dv p
+    #pragma omp parallel for num_threads(getThreadCount()) if(getThreadCount() > 1)
+    for(unsigned int i=0; i<n; ++i)
+    {
+        m_dx[i] = dt*dt * p[i];
+        m_dv[i] = dt * p[i];
+        Ap[i] = glm::vec3(0.0,0.0,0.0);
+    }
+    system.addForceDifferentials(m_dx, m_dv, Ap);
+
+    #pragma omp parallel for num_threads(getThreadCount()) if(getThreadCount() > 1)
+    for(unsigned int i=0; i<n; ++i)
+        Ap[i] = fixed[i] ? glm::vec3(0.0,0.0,0.0) : m[i]*p[i] - Ap[i];
+}
+
+void EulerImplicitSolver::do_solve(const float& dt, DynamicSystem& system)
+{
+    ParticleStore& particles = *system.getStore();
+    glm::vec3* x = particles.getPositions().data();
+    glm::vec3* v = particles.getVelocities().data();
+    const glm::vec3* f = particles.getForces().data();
+    const unsigned char* fixed = particles.getFixed().data();
+    const unsigned int n = particles.size();
+    const unsigned int threadCount = getThreadCount();
+
+    m_deltaVelocities.assign(n, glm::vec3(0.0,0.0,0.0));
+    m_residual.resize(n);
+    m_direction.resize(n);
+    m_product.resize(n);
+    m_dx.resize(n);
+    m_dv.resize(n);
+
+    //Right hand side: b = dt*f + dt^2*df/dx v, null for the fixed particles
+    #pragma omp parallel for num_threads(threadCount) if(threadCount > 1)
+    for(unsigned int i=0; i<n; ++i)
+    {
+        m_dx[i] = fixed[i] ? glm::vec3(0.0,0.0,0.0) : dt*dt * v[i];
+        m_dv[i] = glm::vec3(0.0,0.0,0.0);
+        m_residual[i] = glm::vec3(0.0,0.0,0.0);
+    }
+    system.addForceDifferentials(m_dx, m_dv, m_residual);
+    #pragma omp parallel for num_threads(threadCount) if(threadCount > 1)
+    for(unsigned int i=0; i<n; ++i)
+    {
+        m_residual[i] = fixed[i] ? glm::vec3(0.0,0.0,0.0) : dt * f[i] + m_residual[i];
+        m_direction[i] = m_residual[i];
+    }
+
+    //Conjugate gradient, starting from a null velocity change
+    double residualNorm = dot(m_residual, m_residual, threadCount);
+    const double threshold = (double)m_tolerance * m_tolerance * residualNorm;
+    m_iterationNumber = 0;
+    while(m_iterationNumber < m_maxIterations && residualNorm > threshold && residualNorm > 0.0)
+    {
+        multiply(system, dt, m_direction, m_product);
+        double curvature = dot(m_direction, m_product, threadCount);
+        if(curvature <= 0.0)
+            break;
+        const float alpha = residualNorm / curvature;
+
+        #pragma omp parallel for num_threads(threadCount) if(threadCount > 1)
+        for(unsigned int i=0; i<n; ++i)
+        {
+            m_deltaVelocities[i] += alpha * m_direction[i];
+            m_residual[i] -= alpha * m_product[i];
+        }
+
+        double newResidualNorm = dot(m_residual, m_residual, threadCount);
+        const float beta = newResidualNorm / residualNorm;
+        residualNorm = newResidualNorm;
+
+        #pragma omp parallel for num_threads(threadCount) if(threadCount > 1)
+        for(unsigned int i=0; i<n; ++i)
+            m_direction[i] = m_residual[i] + beta * m_direction[i];
+
+        ++m_iterationNumber;
+    }
+
+    //Update the velocities then the positions
+    #pragma omp parallel for num_threads(threadCount) if(threadCount > 1)
+    for(unsigned int i=0; i<n; ++i)
+    {
+        if(!fixed[i])
+        {
+            v[i] += m_deltaVelocities[i];
+            x[i] += dt * v[i];
+        }
+    }
+}
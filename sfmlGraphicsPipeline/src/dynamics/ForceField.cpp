@@ -1,6 +1,8 @@
 #include "../../include/dynamics/ForceField.hpp"
 
-ForceField::ForceField(){}
+#include <algorithm>
+
+ForceField::ForceField() : m_threadCount(1) {}
 
 ForceField::~ForceField(){}
 
@@ -8,3 +10,27 @@ void ForceField::addForce()
 {
   do_addForce();
 }
+
+void ForceField::addForceDifferential(const ParticleStore& store,
+                                      const std::vector<glm::vec3>& dx,
+                                      const std::vector<glm::vec3>& dv,
+                                      std::vector<glm::vec3>& df)
+{
+  do_addForceDifferential(store, dx, dv, df);
+}
+
+void ForceField::do_addForceDifferential(const ParticleStore&,
+                                         const std::vector<glm::vec3>&,
+                                         const std::vector<glm::vec3>&,
+                                         std::vector<glm::vec3>&)
+{}
+
+unsigned int ForceField::getThreadCount() const
+{
+  return m_threadCount;
+}
+
+void ForceField::setThreadCount(unsigned int threadCount)
+{
+  m_threadCount = std::max(threadCount, 1u);
+}
@@ -2,98 +2,127 @@
 
 void Particle::setRadius(const float &radius)
 {
-    m_radius = radius;
+    m_store->getRadii()[m_index] = radius;
 }
 
 
 bool Particle::isFixed() const
 {
-    return m_isFixed;
+    return (m_store->getFixed()[m_index] & ParticleStore::FIXED) != 0;
 }
 
 void Particle::setFixed(bool isFixed)
 {
-    m_isFixed = isFixed;
+    m_store->getFixed()[m_index] = isFixed ? ParticleStore::FIXED : 0;
+}
+
+bool Particle::isSleeping() const
+{
+    return (m_store->getFixed()[m_index] & ParticleStore::SLEEPING) != 0;
+}
+
+void Particle::wakeUp()
+{
+    m_store->getFixed()[m_index] &= ~ParticleStore::SLEEPING;
 }
 
 Particle::Particle(const glm::vec3 &position, const glm::vec3 &velocity, const float &mass, const float &radius)
     : m_initialPosition( position ), m_initialVelocity( velocity ),
-        m_position(position),
-      m_velocity(velocity),
-      m_force(glm::vec3(0.0,0.0,0.0)),
-      m_mass(mass),
-      m_radius(radius), m_isFixed( false )
-{}
+      m_store( std::make_shared<ParticleStore>() )
+{
+    m_index = m_store->add(position, velocity, glm::vec3(0.0,0.0,0.0), mass, radius, false);
+}
 
 Particle::~Particle()
 {}
 
 
-const glm::vec3 & Particle::getPosition() const
+glm::vec3 Particle::getPosition() const
 {
-    return m_position;
+    return m_store->getPositions()[m_index];
 }
 
-const glm::vec3 & Particle::getVelocity() const
+glm::vec3 Particle::getVelocity() const
 {
-    return m_velocity;
+    return m_store->getVelocities()[m_index];
 }
 
-const glm::vec3 & Particle::getForce() const
+glm::vec3 Particle::getForce() const
 {
-    return m_force;
+    return m_store->getForces()[m_index];
 }
 
 float Particle::getMass() const
 {
-    return m_mass;
+    return m_store->getMasses()[m_index];
 }
 
 float Particle::getRadius() const
 {
-    return m_radius;
+    return m_store->getRadii()[m_index];
 }
 
 void Particle::setPosition(const glm::vec3 &pos)
 {
-    m_position = pos;
+    m_store->getPositions()[m_index] = pos;
+    wakeUp();
 }
 
 void Particle::setVelocity(const glm::vec3 &vel)
 {	
-    m_velocity = vel;
+    m_store->getVelocities()[m_index] = vel;
+    wakeUp();
 }
 
 void Particle::setForce(const glm::vec3 &force)
 {
-    m_force = force;
+    m_store->getForces()[m_index] = force;
 }
 
 void Particle::incrPosition(const glm::vec3 &pos)
 {
-    m_position += pos;
+    m_store->getPositions()[m_index] += pos;
 }
 
 void Particle::incrVelocity(const glm::vec3 &vel)
 {
-    m_velocity += vel;
+    m_store->getVelocities()[m_index] += vel;
 }
 
 void Particle::incrForce(const glm::vec3& force)
 {
-    m_force +=force;
+    m_store->getForces()[m_index] += force;
 }
 
 void Particle::restart()
 {
-  m_position = m_initialPosition;
-  m_velocity = m_initialVelocity;
+  setPosition(m_initialPosition);
+  setVelocity(m_initialVelocity);
+}
+
+const ParticleStorePtr& Particle::getStore() const
+{
+    return m_store;
+}
+
+unsigned int Particle::getIndex() const
+{
+    return m_index;
+}
+
+void Particle::moveToStore(const ParticleStorePtr& store)
+{
+    if(store == m_store) return;
+    unsigned int index = store->add(getPosition(), getVelocity(), getForce(), getMass(), getRadius(), isFixed());
+    m_store->release(m_index);
+    m_store = store;
+    m_index = index;
 }
 
 std::ostream& operator<<(std::ostream& os, const ParticlePtr& p)
 {
-    const glm::vec3& x = p->getPosition();
-    const glm::vec3& v = p->getVelocity();
+    glm::vec3 x = p->getPosition();
+    glm::vec3 v = p->getVelocity();
 
     os << "pos (" << x[0] << ", " << x[1] << ", " << x[2] << ")";
     os << " ; ";
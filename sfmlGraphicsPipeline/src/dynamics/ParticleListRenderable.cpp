@@ -4,18 +4,25 @@
 #include "../../include/dynamics/ParticleListRenderable.hpp"
 #include <glm/gtc/type_ptr.hpp>
 
+// Names of the uniforms and attributes, resolved once per shader program
+static const ShaderProgram::Handle model_handle( "modelMat" );
+static const ShaderProgram::Handle nit_handle( "NIT" );
+static const ShaderProgram::Handle instance_data_handle( "instanceData" );
+static const ShaderProgram::Handle position_handle( "vPosition" );
+static const ShaderProgram::Handle color_handle( "vColor" );
+static const ShaderProgram::Handle normal_handle( "vNormal" );
+
 ParticleListRenderable::~ParticleListRenderable()
 {
     glcheck(glDeleteBuffers(1, &m_pBuffer));
     glcheck(glDeleteBuffers(1, &m_cBuffer));
     glcheck(glDeleteBuffers(1, &m_nBuffer));
     glcheck(glDeleteBuffers(1, &m_iBuffer));
-    glcheck(glDeleteBuffers(1, &m_idBuffer));
 }
 
 ParticleListRenderable::ParticleListRenderable(ShaderProgramPtr program, std::vector<ParticlePtr>& particles, unsigned int strips, unsigned int slices) :
     HierarchicalRenderable( program ),
-    m_particles(particles), m_pBuffer(0), m_cBuffer(0), m_nBuffer(0), m_iBuffer(0), m_idBuffer(0)
+    m_particles(particles), m_pBuffer(0), m_cBuffer(0), m_nBuffer(0), m_iBuffer(0)
 {   
     std::vector<glm::uvec3> uvec3_indices;
     getUnitIndexedSphere( m_positions, m_normals, uvec3_indices, strips, slices);
@@ -35,16 +42,43 @@ ParticleListRenderable::ParticleListRenderable(ShaderProgramPtr program, std::ve
 void ParticleListRenderable::do_draw()
 {  
     update_instances_data_buffer();
-    int positionLocation = m_shaderProgram->getAttributeLocation("vPosition");
-    int colorLocation = m_shaderProgram->getAttributeLocation("vColor");
-    int normalLocation = m_shaderProgram->getAttributeLocation("vNormal");
-    int modelLocation = m_shaderProgram->getUniformLocation("modelMat");
-    int nitLocation = m_shaderProgram->getUniformLocation("NIT");
-    int instanceDataLocation = m_shaderProgram->getAttributeLocation("instanceData");
+    int modelLocation = m_shaderProgram->getUniformLocation(model_handle);
+    int nitLocation = m_shaderProgram->getUniformLocation(nit_handle);
+    int instanceDataLocation = m_shaderProgram->getAttributeLocation(instance_data_handle);
     
     if(modelLocation != ShaderProgram::null_location)
         glcheck(glUniformMatrix4fv(modelLocation, 1, GL_FALSE, glm::value_ptr(getModelMatrix())));
 
+    if( nitLocation != ShaderProgram::null_location )
+    {
+        glcheck(glUniformMatrix3fv( nitLocation, 1, GL_FALSE,
+        glm::value_ptr(getNormalMatrix())));
+    }
+
+    if (m_vertexArray.bind(*m_shaderProgram))
+        set_vertex_attributes();
+
+    //The instance data of this frame are somewhere else in the stream buffer
+    if ( instanceDataLocation != ShaderProgram::null_location )
+    {
+        glcheck(glBindBuffer(GL_ARRAY_BUFFER, m_instances.getBuffer()));
+        glcheck(glVertexAttribPointer(instanceDataLocation, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4), (void*)m_instances.getOffset()));
+    }
+
+    // Draw instanced triangles elements
+    glcheck(glDrawElementsInstanced(GL_TRIANGLES, m_indices.size(), GL_UNSIGNED_INT, 0, m_particles.size()));
+    m_instances.fence();
+
+    VertexArray::unbind();
+}
+
+void ParticleListRenderable::set_vertex_attributes()
+{
+    int positionLocation = m_shaderProgram->getAttributeLocation(position_handle);
+    int colorLocation = m_shaderProgram->getAttributeLocation(color_handle);
+    int normalLocation = m_shaderProgram->getAttributeLocation(normal_handle);
+    int instanceDataLocation = m_shaderProgram->getAttributeLocation(instance_data_handle);
+
     if(positionLocation != ShaderProgram::null_location)
     {
         glcheck(glEnableVertexAttribArray(positionLocation));
@@ -66,45 +100,14 @@ void ParticleListRenderable::do_draw()
         glcheck(glVertexAttribPointer(normalLocation, 3, GL_FLOAT, GL_FALSE, 0, (void*)0));
     }
 
-    if( nitLocation != ShaderProgram::null_location )
-    {
-        glcheck(glUniformMatrix3fv( nitLocation, 1, GL_FALSE,
-        glm::value_ptr(glm::transpose(glm::inverse(glm::mat3(getModelMatrix()))))));
-    }
-
+    //The buffer and offset of the instance data are set at each frame by do_draw()
     if ( instanceDataLocation != ShaderProgram::null_location )
     {
         glcheck(glEnableVertexAttribArray(instanceDataLocation));
-        glcheck(glBindBuffer(GL_ARRAY_BUFFER, m_idBuffer));
-        glcheck(glVertexAttribPointer(instanceDataLocation, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4), (void*)0));
-        glVertexAttribDivisor(instanceDataLocation, 1);
+        glcheck(glVertexAttribDivisor(instanceDataLocation, 1));
     }
 
-    // Draw instanced triangles elements
     glcheck(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_iBuffer));
-    glcheck(glDrawElementsInstanced(GL_TRIANGLES, m_indices.size(), GL_UNSIGNED_INT, 0, m_particles.size()));
-    glcheck(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
-
-    if(positionLocation != ShaderProgram::null_location)
-    {
-        glcheck(glDisableVertexAttribArray(positionLocation));
-    }
-
-    if(colorLocation != ShaderProgram::null_location)
-    {
-        glcheck(glDisableVertexAttribArray(colorLocation));
-    }
-
-    if(normalLocation != ShaderProgram::null_location)
-    {
-        glcheck(glDisableVertexAttribArray(normalLocation));
-    }
-
-    if(instanceDataLocation != ShaderProgram::null_location)
-    {
-        glcheck(glDisableVertexAttribArray(instanceDataLocation));
-        glVertexAttribDivisor(instanceDataLocation, 0);
-    }
 }
 
 void ParticleListRenderable::genbuffers(){
@@ -112,7 +115,6 @@ void ParticleListRenderable::genbuffers(){
     glGenBuffers(1, &m_cBuffer); //colors
     glGenBuffers(1, &m_nBuffer); //normals
     glGenBuffers(1, &m_iBuffer); //indices
-    glGenBuffers(1, &m_idBuffer); //instance data
 }
 
 void ParticleListRenderable::update_all_buffers(){
@@ -129,7 +131,7 @@ void ParticleListRenderable::update_positions_buffer(){
 }
 
 void ParticleListRenderable::update_normals_buffer(){
-    glcheck(glBindBuffer(GL_ARRAY_BUFFER, m_pBuffer));
+    glcheck(glBindBuffer(GL_ARRAY_BUFFER, m_nBuffer));
     glcheck(glBufferData(GL_ARRAY_BUFFER, m_normals.size()*sizeof(glm::vec3), m_normals.data(), GL_STATIC_DRAW));
 }
 
@@ -144,11 +146,33 @@ void ParticleListRenderable::update_indices_buffer(){
 }
 
 void ParticleListRenderable::update_instances_data_buffer(){
-    glcheck(glBindBuffer(GL_ARRAY_BUFFER, m_idBuffer));
-    std::vector<glm::vec4> instances_data(m_particles.size());
-    for (std::size_t i=0u; i<m_particles.size(); ++i)
-        instances_data[i] = glm::vec4(m_particles[i]->getPosition(), m_particles[i]->getRadius());
-    glcheck(glBufferData(GL_ARRAY_BUFFER, instances_data.size()*sizeof(glm::vec4), instances_data.data(), GL_STREAM_DRAW));
+    // Write straight into the buffer memory, no intermediate array nor reallocation
+    glm::vec4* instances_data = static_cast<glm::vec4*>(m_instances.map(m_particles.size()*sizeof(glm::vec4)));
+    if (m_storeIndices.update(m_particles))
+    {
+        // Read the positions and radii straight from the particle store arrays
+        const glm::vec3* x = m_storeIndices.getStore()->getPositions().data();
+        DynamicSystemRenderablePtr interpolation = m_interpolation.lock();
+        if (interpolation && interpolation->getInterpolatedPositions().size() == m_storeIndices.getStore()->size())
+            x = interpolation->getInterpolatedPositions().data();
+        const float* r = m_storeIndices.getStore()->getRadii().data();
+        const std::vector<unsigned int>& indices = m_storeIndices.getIndices();
+        if (m_storeIndices.isWholeStore())
+            for (std::size_t i=0u; i<m_particles.size(); ++i)
+                instances_data[i] = glm::vec4(x[i], r[i]);
+        else
+            for (std::size_t i=0u; i<m_particles.size(); ++i)
+                instances_data[i] = glm::vec4(x[indices[i]], r[indices[i]]);
+    }
+    else
+    {
+        DynamicSystemRenderablePtr interpolation = m_interpolation.lock();
+        for (std::size_t i=0u; i<m_particles.size(); ++i)
+            instances_data[i] = glm::vec4(interpolation ? interpolation->getInterpolatedPosition(m_particles[i])
+                                                        : m_particles[i]->getPosition(),
+                                          m_particles[i]->getRadius());
+    }
+    m_instances.unmap();
 }
 
 void ParticleListRenderable::setColor(glm::vec4 color){
@@ -162,4 +186,7 @@ void ParticleListRenderable::setColor(glm::vec4 color){
     glBindBuffer(GL_ARRAY_BUFFER, m_cBuffer);
     glBufferData(GL_ARRAY_BUFFER, m_colors.size() * sizeof(glm::vec4), m_colors.data(), GL_DYNAMIC_DRAW);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
-}
\ No newline at end of file
+}
+void ParticleListRenderable::setInterpolation(const DynamicSystemRenderablePtr& system){
+    m_interpolation = system;
+}
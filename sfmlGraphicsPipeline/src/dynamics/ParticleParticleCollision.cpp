@@ -18,41 +18,52 @@ void ParticleParticleCollision::do_solveCollision()
     //Don't process fixed particles (Let's assume that the ground plane is fixed)
     if (m_p1->isFixed() && m_p2->isFixed()) return;
 
+    glm::vec3 x1 = m_p1->getPosition(), v1 = m_p1->getVelocity();
+    glm::vec3 x2 = m_p2->getPosition(), v2 = m_p2->getVelocity();
+    solveParticleParticle(x1, v1, m_p1->getMass(), m_p1->getRadius(), m_p1->isFixed(),
+                          x2, v2, m_p2->getMass(), m_p2->getRadius(), m_p2->isFixed(),
+                          m_restitution);
+    m_p1->setPosition(x1);
+    m_p2->setPosition(x2);
+    m_p1->setVelocity(v1);
+    m_p2->setVelocity(v2);
+}
+
+void solveParticleParticle(glm::vec3& x1, glm::vec3& v1, float m1, float r1, bool fixed1,
+                           glm::vec3& x2, glm::vec3& v2, float m2, float r2, bool fixed2,
+                           float restitution)
+{
     //Compute interpenetration distance
-    float particleParticleDist = glm::distance(m_p1->getPosition(),m_p2->getPosition());
-    float interpenetrationDist = m_p1->getRadius()+m_p2->getRadius()-particleParticleDist;
+    glm::vec3 delta = x1-x2;
+    float particleParticleDist = glm::length(delta);
+    float interpenetrationDist = r1+r2-particleParticleDist;
 
-    //Compute particle-particle vector
-    glm::vec3 k = glm::normalize(m_p1->getPosition()-m_p2->getPosition());
+    //Compute particle-particle vector. Coincident centres have no direction:
+    //separate them along the vertical
+    glm::vec3 k = particleParticleDist > 0.0f ? delta/particleParticleDist : glm::vec3(0.0,1.0,0.0);
 
     //Project each particle along the particle-particle vector with half of the interpenetration distance
     //To be more precise, we ponderate the distance with the mass of the particle
-    glm::vec3 prev_x1 = m_p1->getPosition();
-    glm::vec3 prev_x2 = m_p2->getPosition();
-    if(m_p1->isFixed())
+    if(fixed1)
     {
-        m_p2->setPosition(prev_x2 - interpenetrationDist*k);
+        x2 = x2 - interpenetrationDist*k;
     }
-    else if(m_p2->isFixed())
+    else if(fixed2)
     {
-        m_p1->setPosition(prev_x1 + interpenetrationDist*k);
+        x1 = x1 + interpenetrationDist*k;
     }
     else
     {
-        float c1 = m_p1->getMass()/(m_p1->getMass()+m_p2->getMass());
-        float c2 = m_p2->getMass()/(m_p1->getMass()+m_p2->getMass());
-        m_p1->setPosition(prev_x1 + c2*interpenetrationDist*k);
-        m_p2->setPosition(prev_x2 - c1*interpenetrationDist*k);
+        float c1 = m1/(m1+m2);
+        float c2 = m2/(m1+m2);
+        x1 = x1 + c2*interpenetrationDist*k;
+        x2 = x2 - c1*interpenetrationDist*k;
     }
 
     //Compute post-collision velocity
-    glm::vec3 prev_v1 = m_p1->getVelocity();
-    glm::vec3 prev_v2 = m_p2->getVelocity();
-    float proj_v = (1.0f+m_restitution)*glm::dot(k, prev_v1-prev_v2)/(1.0 / m_p1->getMass() + 1.0 / m_p2->getMass());
-    glm::vec3 new_v1 = prev_v1 - proj_v/m_p1->getMass()*k;
-    glm::vec3 new_v2 = prev_v2 + proj_v/m_p2->getMass()*k;
-    m_p1->setVelocity(new_v1);
-    m_p2->setVelocity(new_v2);
+    float proj_v = (1.0f+restitution)*glm::dot(k, v1-v2)/(1.0 / m1 + 1.0 / m2);
+    v1 = v1 - proj_v/m1*k;
+    v2 = v2 + proj_v/m2*k;
 }
 
 
@@ -71,3 +82,10 @@ bool testParticleParticle(const ParticlePtr &p1, const ParticlePtr &p2)
     float c = glm::distance2(p1->getPosition(),p2->getPosition()) - r*r;
     return (c<0.0f) ? true : false;
 }
+
+bool testParticleParticle(const glm::vec3& x1, float r1, const glm::vec3& x2, float r2)
+{
+    float r = r1 + r2;
+    float c = glm::distance2(x1, x2) - r*r;
+    return c < 0.0f;
+}
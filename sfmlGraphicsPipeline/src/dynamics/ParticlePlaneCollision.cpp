@@ -16,29 +16,37 @@ void ParticlePlaneCollision::do_solveCollision()
     //Don't process fixed particles (Let's assume that the ground plane is fixed)
     if (m_particle->isFixed()) return;
 
+    glm::vec3 position = m_particle->getPosition();
+    glm::vec3 velocity = m_particle->getVelocity();
+    solveParticlePlane(position, velocity, m_particle->getRadius(), *m_plane, m_restitution);
+    m_particle->setPosition(position);
+    m_particle->setVelocity(velocity);
+}
+
+void solveParticlePlane(glm::vec3& position, glm::vec3& velocity, float radius,
+                        const Plane& plane, float restitution)
+{
     //TODO: Solve ParticlePlane collisions, update particle position and velocity after collision
     //Functions to use:
     //glm::dot(v1, v2): Return the dot product of two vector.
     //Plane::distanceToOrigin(): Return the distance to origin from the plane
     //Plane::normal(): Return the normal of the plane
-    //Particle::getRadius(), Particle::getPosition(), Particle::getVelocity(), Particle::setPosition(), Particle::setVelocity()
     // Compute the distance from the particle to the plane
-    float distance = glm::dot(m_particle->getPosition(), m_plane->normal()) - m_plane->distanceToOrigin();
+    float distance = glm::dot(position, plane.normal()) - plane.distanceToOrigin();
 
     // Check if the particle is colliding with the plane
-    if (std::abs(distance) > m_particle->getRadius()) return;
+    if (std::abs(distance) > radius) return;
 
     // Project the particle onto the plane
-    glm::vec3 projection = m_particle->getPosition() - distance * m_plane->normal();
+    glm::vec3 projection = position - distance * plane.normal();
 
     // Compute the post-collision velocity
-    glm::vec3 velocity = m_particle->getVelocity();
-    glm::vec3 normal = m_plane->normal();
-    glm::vec3 newVelocity = velocity - (1.0f + m_restitution) * glm::dot(velocity, normal) * normal;
+    glm::vec3 normal = plane.normal();
+    glm::vec3 newVelocity = velocity - (1.0f + restitution) * glm::dot(velocity, normal) * normal;
 
     // Update the particle's position and velocity
-    m_particle->setPosition(projection + m_particle->getRadius() * normal);
-    m_particle->setVelocity(newVelocity);
+    position = projection + radius * normal;
+    velocity = newVelocity;
 }
 
 
@@ -79,3 +87,9 @@ bool testParticlePlane(const ParticlePtr &particle, const PlanePtr &plane)
     return std::abs(distance) <= particle->getRadius();
     return false;
 }
+
+bool testParticlePlane(const glm::vec3& position, float radius, const Plane& plane)
+{
+    float distance = glm::dot(position, plane.normal()) - plane.distanceToOrigin();
+    return std::abs(distance) <= radius;
+}
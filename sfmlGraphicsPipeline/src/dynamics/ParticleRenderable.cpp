@@ -30,9 +30,19 @@ void ParticleRenderable::do_draw()
 {
     //Update the parent and local transform matrix to position the geometric data according to the particle's data.
     const float& pRadius = m_particle->getRadius();
-    const glm::vec3& pPosition = m_particle->getPosition();
+    glm::vec3 pPosition = m_particle->getPosition();
     glm::mat4 scale = glm::scale(glm::mat4(1.0), glm::vec3(pRadius));
     glm::mat4 translate = glm::translate(glm::mat4(1.0), glm::vec3(pPosition));
     setLocalTransform(translate*scale);
     MeshRenderable::do_draw();
-}
\ No newline at end of file
+}
+
+BoundingBox ParticleRenderable::do_getLocalBounds() const
+{
+    return BoundingBox::infinite();
+}
+
+bool ParticleRenderable::do_isInstanceable() const
+{
+    return false;
+}
@@ -0,0 +1,208 @@
+#include "./../../include/dynamics/ParticleStore.hpp"
+#include "./../../include/dynamics/Particle.hpp"
+
+#include <algorithm>
+
+ParticleStore::ParticleStore() : m_version(0)
+{}
+
+ParticleStore::~ParticleStore()
+{}
+
+unsigned int ParticleStore::add(const glm::vec3& position, const glm::vec3& velocity, const glm::vec3& force,
+                                float mass, float radius, bool fixed)
+{
+    if(!m_released.empty())
+    {
+        unsigned int index = m_released.back();
+        m_released.pop_back();
+        m_positions[index] = position;
+        m_velocities[index] = velocity;
+        m_forces[index] = force;
+        m_masses[index] = mass;
+        m_radii[index] = radius;
+        m_fixed[index] = fixed ? FIXED : 0;
+        ++m_version;
+        return index;
+    }
+
+    m_positions.push_back(position);
+    m_velocities.push_back(velocity);
+    m_forces.push_back(force);
+    m_masses.push_back(mass);
+    m_radii.push_back(radius);
+    m_fixed.push_back(fixed ? FIXED : 0);
+    ++m_version;
+    return m_positions.size()-1;
+}
+
+void ParticleStore::release(unsigned int index)
+{
+    //Keep the entry to not shift the indices, but make it inert
+    m_velocities[index] = glm::vec3(0.0,0.0,0.0);
+    m_radii[index] = 0.0f;
+    m_fixed[index] = FIXED | RELEASED;
+    m_released.push_back(index);
+    ++m_version;
+}
+
+void ParticleStore::clear()
+{
+    m_positions.clear();
+    m_velocities.clear();
+    m_forces.clear();
+    m_masses.clear();
+    m_radii.clear();
+    m_fixed.clear();
+    m_released.clear();
+    ++m_version;
+}
+
+void ParticleStore::reserve(unsigned int number)
+{
+    m_positions.reserve(number);
+    m_velocities.reserve(number);
+    m_forces.reserve(number);
+    m_masses.reserve(number);
+    m_radii.reserve(number);
+    m_fixed.reserve(number);
+}
+
+unsigned int ParticleStore::size() const
+{
+    return m_positions.size();
+}
+
+unsigned int ParticleStore::getVersion() const
+{
+    return m_version;
+}
+
+void ParticleStore::clearForces()
+{
+    std::fill(m_forces.begin(), m_forces.end(), glm::vec3(0.0,0.0,0.0));
+}
+
+void ParticleStore::wakeUp()
+{
+    for(unsigned char& flags : m_fixed)
+        flags &= ~SLEEPING;
+}
+
+std::vector<glm::vec3>& ParticleStore::getPositions()
+{
+    return m_positions;
+}
+
+const std::vector<glm::vec3>& ParticleStore::getPositions() const
+{
+    return m_positions;
+}
+
+std::vector<glm::vec3>& ParticleStore::getVelocities()
+{
+    return m_velocities;
+}
+
+const std::vector<glm::vec3>& ParticleStore::getVelocities() const
+{
+    return m_velocities;
+}
+
+std::vector<glm::vec3>& ParticleStore::getForces()
+{
+    return m_forces;
+}
+
+const std::vector<glm::vec3>& ParticleStore::getForces() const
+{
+    return m_forces;
+}
+
+std::vector<float>& ParticleStore::getMasses()
+{
+    return m_masses;
+}
+
+const std::vector<float>& ParticleStore::getMasses() const
+{
+    return m_masses;
+}
+
+std::vector<float>& ParticleStore::getRadii()
+{
+    return m_radii;
+}
+
+const std::vector<float>& ParticleStore::getRadii() const
+{
+    return m_radii;
+}
+
+std::vector<unsigned char>& ParticleStore::getFixed()
+{
+    return m_fixed;
+}
+
+const std::vector<unsigned char>& ParticleStore::getFixed() const
+{
+    return m_fixed;
+}
+
+
+ParticleStoreIndices::ParticleStoreIndices() :
+    m_store(nullptr), m_version(0), m_wholeStore(false)
+{}
+
+bool ParticleStoreIndices::update(const std::vector<ParticlePtr>& particles)
+{
+    if(particles.empty())
+    {
+        invalidate();
+        return false;
+    }
+
+    //Nothing changed since the last update
+    if(m_store && particles[0]->getStore() == m_store
+       && m_store->getVersion() == m_version && m_indices.size() == particles.size())
+        return true;
+
+    m_store = particles[0]->getStore();
+    m_indices.resize(particles.size());
+    m_wholeStore = (particles.size() == m_store->size());
+    for(size_t i=0; i<particles.size(); ++i)
+    {
+        if(particles[i]->getStore() != m_store)
+        {
+            //The particles are spread over several stores
+            invalidate();
+            return false;
+        }
+        m_indices[i] = particles[i]->getIndex();
+        m_wholeStore = m_wholeStore && (m_indices[i] == i);
+    }
+    m_version = m_store->getVersion();
+    return true;
+}
+
+void ParticleStoreIndices::invalidate()
+{
+    m_store = nullptr;
+    m_indices.clear();
+    m_wholeStore = false;
+}
+
+ParticleStore* ParticleStoreIndices::getStore() const
+{
+    return m_store.get();
+}
+
+const std::vector<unsigned int>& ParticleStoreIndices::getIndices() const
+{
+    return m_indices;
+}
+
+bool ParticleStoreIndices::isWholeStore() const
+{
+    return m_wholeStore;
+}
@@ -0,0 +1,160 @@
+#include "./../../include/dynamics/PositionBasedSolver.hpp"
+#include "./../../include/dynamics/DynamicSystem.hpp"
+#include "./../../include/dynamics/ParticlePlaneCollision.hpp"
+#include "./../../include/dynamics/ParticleParticleCollision.hpp"
+
+#include <algorithm>
+
+PositionBasedSolver::PositionBasedSolver(unsigned int substepNumber, unsigned int iterationNumber) :
+    m_substepNumber(std::max(substepNumber, 1u)), m_iterationNumber(iterationNumber)
+{}
+
+PositionBasedSolver::~PositionBasedSolver()
+{}
+
+unsigned int PositionBasedSolver::getSubstepNumber() const
+{
+    return m_substepNumber;
+}
+
+void PositionBasedSolver::setSubstepNumber(unsigned int substepNumber)
+{
+    m_substepNumber = std::max(substepNumber, 1u);
+}
+
+unsigned int PositionBasedSolver::getIterationNumber() const
+{
+    return m_iterationNumber;
+}
+
+void PositionBasedSolver::setIterationNumber(unsigned int iterationNumber)
+{
+    m_iterationNumber = iterationNumber;
+}
+
+bool PositionBasedSolver::do_solvesCollisions() const
+{
+    return true;
+}
+
+void PositionBasedSolver::do_solve(const float& dt, DynamicSystem& system)
+{
+    ParticleStore& particles = *system.getStore();
+    glm::vec3* x = particles.getPositions().data();
+    glm::vec3* v = particles.getVelocities().data();
+    const glm::vec3* f = particles.getForces().data();
+    const float* m = particles.getMasses().data();
+    const unsigned char* fixed = particles.getFixed().data();
+    const unsigned int n = particles.size();
+    const unsigned int threadCount = getThreadCount();
+
+    const std::vector<ConstraintPtr>& constraints = system.getConstraints();
+    const bool collisions = system.getCollisionDetection();
+    const float h = dt / m_substepNumber;
+    m_previousPositions.resize(n);
+
+    for(unsigned int substep=0; substep<m_substepNumber; ++substep)
+    {
+        //The forces of the first substep are already computed
+        if(substep > 0)
+            system.computeForces();
+
+        //Predict the positions
+        #pragma omp parallel for num_threads(threadCount) if(threadCount > 1)
+        for(unsigned int i=0; i<n; ++i)
+        {
+            m_previousPositions[i] = x[i];
+            if(!fixed[i])
+            {
+                v[i] += h * f[i] / m[i];
+                x[i] += h * v[i];
+            }
+        }
+
+        if(collisions)
+            detectContacts(system);
+
+        //Project the constraints and the contacts
+        for(const ConstraintPtr& c : constraints)
+            c->initialize();
+        for(unsigned int iteration=0; iteration<m_iterationNumber; ++iteration)
+        {
+            for(const ConstraintPtr& c : constraints)
+                c->project(particles, h);
+            if(collisions)
+                projectContacts(particles, system.getPlaneObstacles());
+        }
+
+        //Deduce the velocities from the displacements
+        #pragma omp parallel for num_threads(threadCount) if(threadCount > 1)
+        for(unsigned int i=0; i<n; ++i)
+        {
+            if(!fixed[i])
+                v[i] = (x[i] - m_previousPositions[i]) / h;
+        }
+    }
+}
+
+void PositionBasedSolver::detectContacts(DynamicSystem& system)
+{
+    const ParticleStore& particles = *system.getStore();
+    const glm::vec3* x = particles.getPositions().data();
+    const float* r = particles.getRadii().data();
+    const unsigned char* fixed = particles.getFixed().data();
+    const std::vector<PlanePtr>& planes = system.getPlaneObstacles();
+    const unsigned int n = particles.size();
+
+    m_contacts.clear();
+    for(unsigned int i=0; i<n; ++i)
+    {
+        if(fixed[i])
+            continue;
+        for(unsigned int o=0; o<planes.size(); ++o)
+        {
+            if(testParticlePlane(x[i], r[i], *planes[o]))
+                m_contacts.addParticlePlane(i, o);
+        }
+    }
+
+    BroadPhasePtr broadPhase = system.getBroadPhase();
+    broadPhase->setThreadCount(getThreadCount());
+    broadPhase->computePairs(particles.getPositions(), particles.getRadii(), particles.getFixed(), m_candidatePairs);
+    for(const CandidatePair& pair : m_candidatePairs)
+    {
+        const unsigned int i = pair.first, j = pair.second;
+        if((!fixed[i] || !fixed[j]) && testParticleParticle(x[i], r[i], x[j], r[j]))
+            m_contacts.addParticleParticle(i, j);
+    }
+}
+
+void PositionBasedSolver::projectContacts(ParticleStore& particles, const std::vector<PlanePtr>& planes)
+{
+    glm::vec3* x = particles.getPositions().data();
+    const float* m = particles.getMasses().data();
+    const float* r = particles.getRadii().data();
+    const unsigned char* fixed = particles.getFixed().data();
+
+    //The contacts only push the particles apart: C(x) >= 0
+    for(const ParticlePlaneContact& c : m_contacts.getParticlePlaneContacts())
+    {
+        const Plane& plane = *planes[c.plane];
+        float distance = glm::dot(x[c.particle], plane.normal()) - plane.distanceToOrigin();
+        if(distance < r[c.particle])
+            x[c.particle] += (r[c.particle] - distance) * plane.normal();
+    }
+
+    for(const ParticleParticleContact& c : m_contacts.getParticleParticleContacts())
+    {
+        const unsigned int i = c.particle1, j = c.particle2;
+        const float wi = fixed[i] ? 0.0f : 1.0f / m[i];
+        const float wj = fixed[j] ? 0.0f : 1.0f / m[j];
+        glm::vec3 delta = x[i] - x[j];
+        float distance = glm::length(delta);
+        float penetration = r[i] + r[j] - distance;
+        if(penetration <= 0.0f || distance <= 0.0f || wi + wj <= 0.0f)
+            continue;
+        glm::vec3 correction = penetration / (distance * (wi + wj)) * delta;
+        x[i] += wi * correction;
+        x[j] -= wj * correction;
+    }
+}
@@ -0,0 +1,64 @@
+#include "./../../include/dynamics/RungeKutta4Solver.hpp"
+#include "./../../include/dynamics/DynamicSystem.hpp"
+
+RungeKutta4Solver::RungeKutta4Solver()
+{}
+
+RungeKutta4Solver::~RungeKutta4Solver()
+{}
+
+void RungeKutta4Solver::evaluate(ParticleStore& particles, float weight, float step)
+{
+    glm::vec3* x = particles.getPositions().data();
+    glm::vec3* v = particles.getVelocities().data();
+    const glm::vec3* f = particles.getForces().data();
+    const float* m = particles.getMasses().data();
+    const unsigned char* fixed = particles.getFixed().data();
+    const unsigned int n = particles.size();
+
+    #pragma omp parallel for num_threads(getThreadCount()) if(getThreadCount() > 1)
+    for(unsigned int i=0; i<n; ++i)
+    {
+        if(fixed[i])
+            continue;
+        const glm::vec3 dx = v[i];
+        const glm::vec3 dv = f[i] / m[i];
+        m_positionDerivatives[i] += weight * dx;
+        m_velocityDerivatives[i] += weight * dv;
+        x[i] = m_initialPositions[i] + step * dx;
+        v[i] = m_initialVelocities[i] + step * dv;
+    }
+}
+
+void RungeKutta4Solver::do_solve(const float& dt, DynamicSystem& system)
+{
+    ParticleStore& particles = *system.getStore();
+    const unsigned int n = particles.size();
+
+    m_initialPositions = particles.getPositions();
+    m_initialVelocities = particles.getVelocities();
+    m_positionDerivatives.assign(n, glm::vec3(0.0,0.0,0.0));
+    m_velocityDerivatives.assign(n, glm::vec3(0.0,0.0,0.0));
+
+    //The forces at the initial state are already computed
+    evaluate(particles, 1.0f/6.0f, 0.5f*dt);
+    system.computeForces();
+    evaluate(particles, 2.0f/6.0f, 0.5f*dt);
+    system.computeForces();
+    evaluate(particles, 2.0f/6.0f, dt);
+    system.computeForces();
+    evaluate(particles, 1.0f/6.0f, 0.0f);
+
+    glm::vec3* x = particles.getPositions().data();
+    glm::vec3* v = particles.getVelocities().data();
+    const unsigned char* fixed = particles.getFixed().data();
+    #pragma omp parallel for num_threads(getThreadCount()) if(getThreadCount() > 1)
+    for(unsigned int i=0; i<n; ++i)
+    {
+        if(!fixed[i])
+        {
+            x[i] = m_initialPositions[i] + dt * m_positionDerivatives[i];
+            v[i] = m_initialVelocities[i] + dt * m_velocityDerivatives[i];
+        }
+    }
+}
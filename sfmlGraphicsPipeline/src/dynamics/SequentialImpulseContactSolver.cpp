@@ -0,0 +1,464 @@
+#include "./../../include/dynamics/SequentialImpulseContactSolver.hpp"
+
+#include <algorithm>
+#include <glm/gtx/norm.hpp>
+
+//Index of the second particle of a particle-plane constraint
+static const unsigned int NO_PARTICLE = ~0u;
+
+SequentialImpulseContactSolver::SequentialImpulseContactSolver(unsigned int velocityIterations,
+                                                               unsigned int positionIterations) :
+    m_velocityIterations(velocityIterations), m_positionIterations(positionIterations),
+    m_warmStarting(true), m_slop(0.005f), m_friction(0.3f), m_restitutionThreshold(0.5f),
+    m_sleeping(true), m_sleepVelocity(0.05f), m_sleepDelay(0.5f),
+    m_sleepingParticleNumber(0), m_version(0)
+{}
+
+SequentialImpulseContactSolver::~SequentialImpulseContactSolver()
+{}
+
+unsigned int SequentialImpulseContactSolver::getVelocityIterations() const
+{
+    return m_velocityIterations;
+}
+
+void SequentialImpulseContactSolver::setVelocityIterations(unsigned int velocityIterations)
+{
+    m_velocityIterations = velocityIterations;
+}
+
+unsigned int SequentialImpulseContactSolver::getPositionIterations() const
+{
+    return m_positionIterations;
+}
+
+void SequentialImpulseContactSolver::setPositionIterations(unsigned int positionIterations)
+{
+    m_positionIterations = positionIterations;
+}
+
+bool SequentialImpulseContactSolver::getWarmStarting() const
+{
+    return m_warmStarting;
+}
+
+void SequentialImpulseContactSolver::setWarmStarting(bool onOff)
+{
+    m_warmStarting = onOff;
+}
+
+float SequentialImpulseContactSolver::getSlop() const
+{
+    return m_slop;
+}
+
+void SequentialImpulseContactSolver::setSlop(float slop)
+{
+    m_slop = std::max(slop, 0.0f);
+}
+
+float SequentialImpulseContactSolver::getFriction() const
+{
+    return m_friction;
+}
+
+void SequentialImpulseContactSolver::setFriction(float friction)
+{
+    m_friction = std::max(friction, 0.0f);
+}
+
+float SequentialImpulseContactSolver::getRestitutionThreshold() const
+{
+    return m_restitutionThreshold;
+}
+
+void SequentialImpulseContactSolver::setRestitutionThreshold(float threshold)
+{
+    m_restitutionThreshold = std::max(threshold, 0.0f);
+}
+
+bool SequentialImpulseContactSolver::getSleeping() const
+{
+    return m_sleeping;
+}
+
+void SequentialImpulseContactSolver::setSleeping(bool onOff)
+{
+    m_sleeping = onOff;
+}
+
+float SequentialImpulseContactSolver::getSleepVelocity() const
+{
+    return m_sleepVelocity;
+}
+
+void SequentialImpulseContactSolver::setSleepVelocity(float velocity)
+{
+    m_sleepVelocity = velocity;
+}
+
+float SequentialImpulseContactSolver::getSleepDelay() const
+{
+    return m_sleepDelay;
+}
+
+void SequentialImpulseContactSolver::setSleepDelay(float delay)
+{
+    m_sleepDelay = delay;
+}
+
+unsigned int SequentialImpulseContactSolver::getSolvedContactNumber() const
+{
+    return m_constraints.size();
+}
+
+unsigned int SequentialImpulseContactSolver::getSleepingParticleNumber() const
+{
+    return m_sleepingParticleNumber;
+}
+
+void SequentialImpulseContactSolver::do_solve(ParticleStore& store, const ContactBuffer& contacts,
+                                              const std::vector<PlanePtr>& planes, float restitution, float dt)
+{
+    const unsigned int n = store.size();
+
+    //The cache refers to particle indices: forget it when the store changes
+    if(store.getVersion() != m_version)
+    {
+        m_planeImpulses.clear();
+        m_pairImpulses.clear();
+        m_restTimes.assign(n, 0.0f);
+        m_sleepForces.assign(n, glm::vec3(0.0,0.0,0.0));
+        store.wakeUp();
+        m_sleepingParticleNumber = 0;
+        m_version = store.getVersion();
+    }
+
+    if(m_sleeping)
+    {
+        buildIslands(store, contacts);
+        wakeUpIslands(store, dt);
+    }
+    else if(m_sleepingParticleNumber > 0)
+    {
+        store.wakeUp();
+        m_sleepingParticleNumber = 0;
+    }
+
+    buildConstraints(store, contacts, planes, restitution);
+    solveVelocities(store);
+    solvePositions(store, planes);
+    cacheImpulses();
+
+    if(m_sleeping)
+        sleepIslands(store, dt);
+}
+
+void SequentialImpulseContactSolver::buildConstraints(const ParticleStore& store, const ContactBuffer& contacts,
+                                                      const std::vector<PlanePtr>& planes, float restitution)
+{
+    const glm::vec3* x = store.getPositions().data();
+    const glm::vec3* v = store.getVelocities().data();
+    const float* m = store.getMasses().data();
+    const unsigned char* flags = store.getFixed().data();
+
+    m_constraints.clear();
+    m_constraints.reserve(contacts.size());
+
+    //Fixed and sleeping particles are not moved by the contacts
+    auto inverseMass = [&](unsigned int i) { return flags[i] ? 0.0f : 1.0f / m[i]; };
+
+    for(const ParticlePlaneContact& contact : contacts.getParticlePlaneContacts())
+    {
+        Constraint c;
+        c.particle1 = contact.particle;
+        c.particle2 = NO_PARTICLE;
+        c.plane = contact.plane;
+        c.inverseMass1 = inverseMass(c.particle1);
+        c.inverseMass2 = 0.0f;
+        if(c.inverseMass1 == 0.0f)
+            continue;
+        c.key = ((std::uint64_t)c.particle1 << 32) | c.plane;
+        c.normal = planes[c.plane]->normal();
+        m_constraints.push_back(c);
+    }
+
+    for(const ParticleParticleContact& contact : contacts.getParticleParticleContacts())
+    {
+        //Order the particles, so that the cached impulses have the same direction
+        Constraint c;
+        c.particle1 = std::min(contact.particle1, contact.particle2);
+        c.particle2 = std::max(contact.particle1, contact.particle2);
+        c.plane = 0;
+        c.inverseMass1 = inverseMass(c.particle1);
+        c.inverseMass2 = inverseMass(c.particle2);
+        if(c.inverseMass1 + c.inverseMass2 == 0.0f)
+            continue;
+        c.key = ((std::uint64_t)c.particle1 << 32) | c.particle2;
+        glm::vec3 delta = x[c.particle1] - x[c.particle2];
+        float distance = glm::length(delta);
+        c.normal = distance > 0.0f ? delta / distance : glm::vec3(0.0,1.0,0.0);
+        m_constraints.push_back(c);
+    }
+
+    for(Constraint& c : m_constraints)
+    {
+        c.effectiveMass = 1.0f / (c.inverseMass1 + c.inverseMass2);
+
+        //Bounce only the contacts approaching fast enough
+        glm::vec3 relativeVelocity = v[c.particle1];
+        if(c.particle2 != NO_PARTICLE)
+            relativeVelocity -= v[c.particle2];
+        float normalVelocity = glm::dot(c.normal, relativeVelocity);
+        c.targetVelocity = (normalVelocity < -m_restitutionThreshold) ? -restitution * normalVelocity : 0.0f;
+
+        c.impulse = 0.0f;
+        c.frictionImpulse = glm::vec3(0.0,0.0,0.0);
+        if(m_warmStarting)
+        {
+            const CachedImpulse* cached = findCachedImpulse(c.particle2 == NO_PARTICLE ? m_planeImpulses : m_pairImpulses, c.key);
+            if(cached)
+            {
+                c.impulse = cached->impulse;
+                //The normal may have turned since the last step
+                c.frictionImpulse = cached->frictionImpulse - glm::dot(cached->frictionImpulse, c.normal) * c.normal;
+            }
+        }
+    }
+}
+
+const SequentialImpulseContactSolver::CachedImpulse*
+SequentialImpulseContactSolver::findCachedImpulse(const std::vector<CachedImpulse>& cache, std::uint64_t key) const
+{
+    std::vector<CachedImpulse>::const_iterator it = std::lower_bound(cache.begin(), cache.end(), key,
+        [](const CachedImpulse& cached, std::uint64_t key) { return cached.key < key; });
+    return (it != cache.end() && it->key == key) ? &(*it) : nullptr;
+}
+
+void SequentialImpulseContactSolver::cacheImpulses()
+{
+    m_planeImpulses.clear();
+    m_pairImpulses.clear();
+    for(const Constraint& c : m_constraints)
+    {
+        CachedImpulse cached = { c.key, c.impulse, c.frictionImpulse };
+        if(c.particle2 == NO_PARTICLE)
+            m_planeImpulses.push_back(cached);
+        else
+            m_pairImpulses.push_back(cached);
+    }
+    auto compareKeys = [](const CachedImpulse& a, const CachedImpulse& b) { return a.key < b.key; };
+    std::sort(m_planeImpulses.begin(), m_planeImpulses.end(), compareKeys);
+    std::sort(m_pairImpulses.begin(), m_pairImpulses.end(), compareKeys);
+}
+
+void SequentialImpulseContactSolver::solveVelocities(ParticleStore& store)
+{
+    glm::vec3* v = store.getVelocities().data();
+
+    //The planes do not move: their velocity stays null as their inverse mass is null
+    glm::vec3 planeVelocity(0.0,0.0,0.0);
+
+    //Apply the impulses of the previous step
+    for(const Constraint& c : m_constraints)
+    {
+        glm::vec3& v1 = v[c.particle1];
+        glm::vec3& v2 = (c.particle2 != NO_PARTICLE) ? v[c.particle2] : planeVelocity;
+        glm::vec3 impulse = c.impulse * c.normal + c.frictionImpulse;
+        v1 += c.inverseMass1 * impulse;
+        v2 -= c.inverseMass2 * impulse;
+    }
+
+    for(unsigned int iteration=0; iteration<m_velocityIterations; ++iteration)
+    {
+        for(Constraint& c : m_constraints)
+        {
+            glm::vec3& v1 = v[c.particle1];
+            glm::vec3& v2 = (c.particle2 != NO_PARTICLE) ? v[c.particle2] : planeVelocity;
+
+            //Normal impulse, the total impulse being kept positive
+            float normalVelocity = glm::dot(c.normal, v1 - v2);
+            float impulse = std::max(c.impulse + (c.targetVelocity - normalVelocity) * c.effectiveMass, 0.0f);
+            glm::vec3 delta = (impulse - c.impulse) * c.normal;
+            c.impulse = impulse;
+            v1 += c.inverseMass1 * delta;
+            v2 -= c.inverseMass2 * delta;
+
+            //Friction impulse, inside the Coulomb cone
+            if(m_friction > 0.0f)
+            {
+                glm::vec3 relativeVelocity = v1 - v2;
+                glm::vec3 tangentVelocity = relativeVelocity - glm::dot(relativeVelocity, c.normal) * c.normal;
+                glm::vec3 frictionImpulse = c.frictionImpulse - tangentVelocity * c.effectiveMass;
+                float maxFriction = m_friction * c.impulse;
+                float friction2 = glm::length2(frictionImpulse);
+                if(friction2 > maxFriction * maxFriction)
+                    frictionImpulse *= maxFriction / std::sqrt(friction2);
+                delta = frictionImpulse - c.frictionImpulse;
+                c.frictionImpulse = frictionImpulse;
+                v1 += c.inverseMass1 * delta;
+                v2 -= c.inverseMass2 * delta;
+            }
+        }
+    }
+}
+
+void SequentialImpulseContactSolver::solvePositions(ParticleStore& store, const std::vector<PlanePtr>& planes)
+{
+    glm::vec3* x = store.getPositions().data();
+    const float* r = store.getRadii().data();
+
+    for(unsigned int iteration=0; iteration<m_positionIterations; ++iteration)
+    {
+        for(const Constraint& c : m_constraints)
+        {
+            glm::vec3& x1 = x[c.particle1];
+            glm::vec3 normal = c.normal;
+            float depth;
+            if(c.particle2 == NO_PARTICLE)
+            {
+                depth = r[c.particle1] - (glm::dot(x1, normal) - planes[c.plane]->distanceToOrigin());
+            }
+            else
+            {
+                glm::vec3 delta = x1 - x[c.particle2];
+                float distance = glm::length(delta);
+                if(distance > 0.0f)
+                    normal = delta / distance;
+                depth = r[c.particle1] + r[c.particle2] - distance;
+            }
+
+            //Leave the slop, so that the contact is still detected at the next step
+            if(depth <= m_slop)
+                continue;
+            glm::vec3 correction = (depth - m_slop) * c.effectiveMass * normal;
+            x1 += c.inverseMass1 * correction;
+            if(c.particle2 != NO_PARTICLE)
+                x[c.particle2] -= c.inverseMass2 * correction;
+        }
+    }
+}
+
+unsigned int SequentialImpulseContactSolver::findIsland(unsigned int particle)
+{
+    //Path halving
+    while(m_islands[particle] != particle)
+    {
+        m_islands[particle] = m_islands[m_islands[particle]];
+        particle = m_islands[particle];
+    }
+    return particle;
+}
+
+void SequentialImpulseContactSolver::buildIslands(const ParticleStore& store, const ContactBuffer& contacts)
+{
+    const unsigned char* flags = store.getFixed().data();
+    const unsigned int n = store.size();
+
+    m_islands.resize(n);
+    for(unsigned int i=0; i<n; ++i)
+        m_islands[i] = i;
+    m_islandSupported.assign(n, 0);
+    m_islandAwake.assign(n, 0);
+    m_islandRestTimes.assign(n, m_sleepDelay);
+
+    //Fixed particles do not link islands, they support them as the planes do
+    for(const ParticleParticleContact& c : contacts.getParticleParticleContacts())
+    {
+        if(!(flags[c.particle1] & ParticleStore::FIXED) && !(flags[c.particle2] & ParticleStore::FIXED))
+        {
+            unsigned int island1 = findIsland(c.particle1), island2 = findIsland(c.particle2);
+            //The root is the smallest index, so that the islands do not depend on the contact order
+            if(island1 < island2)
+                m_islands[island2] = island1;
+            else if(island2 < island1)
+                m_islands[island1] = island2;
+        }
+    }
+
+    for(const ParticlePlaneContact& c : contacts.getParticlePlaneContacts())
+        m_islandSupported[findIsland(c.particle)] = 1;
+    for(const ParticleParticleContact& c : contacts.getParticleParticleContacts())
+    {
+        if(flags[c.particle1] & ParticleStore::FIXED)
+            m_islandSupported[findIsland(c.particle2)] = 1;
+        if(flags[c.particle2] & ParticleStore::FIXED)
+            m_islandSupported[findIsland(c.particle1)] = 1;
+    }
+}
+
+void SequentialImpulseContactSolver::wakeUpIslands(ParticleStore& store, float dt)
+{
+    const glm::vec3* v = store.getVelocities().data();
+    const glm::vec3* f = store.getForces().data();
+    const float* m = store.getMasses().data();
+    unsigned char* flags = store.getFixed().data();
+    const unsigned int n = store.size();
+
+    m_restTimes.resize(n, 0.0f);
+    m_sleepForces.resize(n, glm::vec3(0.0,0.0,0.0));
+    if(m_sleepingParticleNumber == 0)
+        return;
+
+    for(unsigned int i=0; i<n; ++i)
+    {
+        if(flags[i] & ParticleStore::FIXED)
+            continue;
+        bool moving;
+        if(flags[i] & ParticleStore::SLEEPING)
+        {
+            //Wake up if the change of force would move the particle faster than the sleep velocity
+            moving = glm::length(f[i] - m_sleepForces[i]) * dt > m_sleepVelocity * m[i];
+        }
+        else
+        {
+            //Velocity at the beginning of the step, before the forces were integrated
+            moving = glm::length2(v[i] - dt * f[i] / m[i]) > m_sleepVelocity * m_sleepVelocity;
+        }
+        if(moving)
+            m_islandAwake[findIsland(i)] = 1;
+    }
+
+    for(unsigned int i=0; i<n; ++i)
+    {
+        if((flags[i] & ParticleStore::SLEEPING) && m_islandAwake[findIsland(i)])
+        {
+            flags[i] &= ~ParticleStore::SLEEPING;
+            m_restTimes[i] = 0.0f;
+            --m_sleepingParticleNumber;
+        }
+    }
+}
+
+void SequentialImpulseContactSolver::sleepIslands(ParticleStore& store, float dt)
+{
+    glm::vec3* v = store.getVelocities().data();
+    const glm::vec3* f = store.getForces().data();
+    unsigned char* flags = store.getFixed().data();
+    const unsigned int n = store.size();
+
+    //An island rests as long as its least rested particle
+    for(unsigned int i=0; i<n; ++i)
+    {
+        if(flags[i] & ParticleStore::FIXED)
+            continue;
+        if(!(flags[i] & ParticleStore::SLEEPING))
+            m_restTimes[i] = (glm::length2(v[i]) < m_sleepVelocity * m_sleepVelocity) ? m_restTimes[i] + dt : 0.0f;
+        unsigned int island = findIsland(i);
+        m_islandRestTimes[island] = std::min(m_islandRestTimes[island], m_restTimes[i]);
+    }
+
+    for(unsigned int i=0; i<n; ++i)
+    {
+        if(flags[i])
+            continue;
+        unsigned int island = findIsland(i);
+        if(m_islandSupported[island] && m_islandRestTimes[island] >= m_sleepDelay)
+        {
+            flags[i] |= ParticleStore::SLEEPING;
+            v[i] = glm::vec3(0.0,0.0,0.0);
+            m_sleepForces[i] = f[i];
+            ++m_sleepingParticleNumber;
+        }
+    }
+}
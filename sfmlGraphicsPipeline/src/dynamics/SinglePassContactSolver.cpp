@@ -0,0 +1,13 @@
+#include "./../../include/dynamics/SinglePassContactSolver.hpp"
+
+SinglePassContactSolver::SinglePassContactSolver()
+{}
+
+SinglePassContactSolver::~SinglePassContactSolver()
+{}
+
+void SinglePassContactSolver::do_solve(ParticleStore& store, const ContactBuffer& contacts,
+                                       const std::vector<PlanePtr>& planes, float restitution, float)
+{
+    contacts.solve(store, planes, restitution);
+}
@@ -1,6 +1,34 @@
 # include "../../include/dynamics/Solver.hpp"
 
-void Solver::solve( const float& dt, std::vector<ParticlePtr>& particles )
+# include <algorithm>
+
+Solver::Solver() : m_threadCount(1)
+{}
+
+Solver::~Solver()
+{}
+
+void Solver::solve( const float& dt, DynamicSystem& system )
+{
+  do_solve( dt, system );
+}
+
+bool Solver::solvesCollisions() const
+{
+  return do_solvesCollisions();
+}
+
+bool Solver::do_solvesCollisions() const
+{
+  return false;
+}
+
+unsigned int Solver::getThreadCount() const
+{
+  return m_threadCount;
+}
+
+void Solver::setThreadCount(unsigned int threadCount)
 {
-  do_solve( dt, particles );
+  m_threadCount = std::max(threadCount, 1u);
 }
@@ -0,0 +1,119 @@
+#include "./../../include/dynamics/SpringForceAccumulator.hpp"
+
+SpringForceAccumulator::SpringForceAccumulator() :
+    m_store(nullptr), m_version(0)
+{}
+
+SpringForceAccumulator::~SpringForceAccumulator()
+{}
+
+void SpringForceAccumulator::setSprings(const std::vector<SpringForceFieldPtr>& springs)
+{
+    m_springs = springs;
+    m_store = nullptr;
+}
+
+const std::vector<SpringForceFieldPtr>& SpringForceAccumulator::getSprings() const
+{
+    return m_springs;
+}
+
+void SpringForceAccumulator::buildParticleSprings(const ParticleStore& store)
+{
+    //Separate the springs whose particles are in the store
+    m_storeSprings.clear();
+    m_outsideSprings.clear();
+    for(SpringForceFieldPtr spring : m_springs)
+    {
+        if(spring->getParticle1()->getStore().get() == &store
+           && spring->getParticle2()->getStore().get() == &store)
+            m_storeSprings.push_back(spring);
+        else
+            m_outsideSprings.push_back(spring);
+    }
+
+    //Count the springs of each particle
+    const unsigned int n = store.size();
+    const unsigned int springNumber = m_storeSprings.size();
+    m_particleStart.assign(n+1, 0);
+    for(unsigned int s=0; s<springNumber; ++s)
+    {
+        ++m_particleStart[m_storeSprings[s]->getParticle1()->getIndex()+1];
+        ++m_particleStart[m_storeSprings[s]->getParticle2()->getIndex()+1];
+    }
+    for(unsigned int i=0; i<n; ++i)
+        m_particleStart[i+1] += m_particleStart[i];
+
+    //Fill the springs of each particle, in the springs order
+    std::vector<unsigned int> next(m_particleStart.begin(), m_particleStart.end()-1);
+    m_particleSprings.resize(m_particleStart[n]);
+    for(unsigned int s=0; s<springNumber; ++s)
+    {
+        m_particleSprings[next[m_storeSprings[s]->getParticle1()->getIndex()]++] = 2*s;
+        m_particleSprings[next[m_storeSprings[s]->getParticle2()->getIndex()]++] = 2*s+1;
+    }
+
+    m_springForces.resize(springNumber);
+    m_store = &store;
+    m_version = store.getVersion();
+}
+
+void SpringForceAccumulator::addForces(ParticleStore& store, unsigned int threadCount)
+{
+    if(m_store != &store || m_version != store.getVersion())
+        buildParticleSprings(store);
+
+    //Compute the force of each spring
+    const unsigned int springNumber = m_storeSprings.size();
+    #pragma omp parallel for num_threads(threadCount) if(threadCount > 1)
+    for(unsigned int s=0; s<springNumber; ++s)
+        m_springForces[s] = m_storeSprings[s]->computeForce();
+
+    gatherSpringForces(store.getForces().data(), threadCount);
+
+    for(SpringForceFieldPtr spring : m_outsideSprings)
+        spring->addForce();
+}
+
+void SpringForceAccumulator::addForceDifferentials(const ParticleStore& store,
+                                                   const std::vector<glm::vec3>& dx,
+                                                   const std::vector<glm::vec3>& dv,
+                                                   std::vector<glm::vec3>& df,
+                                                   unsigned int threadCount)
+{
+    if(m_store != &store || m_version != store.getVersion())
+        buildParticleSprings(store);
+
+    //Compute the force differential of each spring
+    const unsigned int springNumber = m_storeSprings.size();
+    #pragma omp parallel for num_threads(threadCount) if(threadCount > 1)
+    for(unsigned int s=0; s<springNumber; ++s)
+    {
+        const unsigned int i1 = m_storeSprings[s]->getParticle1()->getIndex();
+        const unsigned int i2 = m_storeSprings[s]->getParticle2()->getIndex();
+        m_springForces[s] = m_storeSprings[s]->computeForceDifferential(dx[i2]-dx[i1], dv[i2]-dv[i1]);
+    }
+
+    gatherSpringForces(df.data(), threadCount);
+
+    for(SpringForceFieldPtr spring : m_outsideSprings)
+        spring->addForceDifferential(store, dx, dv, df);
+}
+
+void SpringForceAccumulator::gatherSpringForces(glm::vec3* f, unsigned int threadCount) const
+{
+    //Sum the forces of the springs attached to each particle
+    const unsigned int n = m_particleStart.size()-1;
+    #pragma omp parallel for num_threads(threadCount) if(threadCount > 1)
+    for(unsigned int i=0; i<n; ++i)
+    {
+        for(unsigned int k=m_particleStart[i]; k<m_particleStart[i+1]; ++k)
+        {
+            const unsigned int entry = m_particleSprings[k];
+            if(entry & 1)
+                f[i] += m_springForces[entry/2];
+            else
+                f[i] -= m_springForces[entry/2];
+        }
+    }
+}
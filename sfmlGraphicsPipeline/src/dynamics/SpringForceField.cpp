@@ -1,5 +1,8 @@
 #include "./../../include/dynamics/SpringForceField.hpp"
 
+#include <algorithm>
+#include <limits>
+
 SpringForceField::SpringForceField(const ParticlePtr p1, const ParticlePtr p2, float stiffness, float equilibriumLength, float damping) :
     m_p1(p1),
     m_p2(p2),
@@ -9,6 +12,13 @@ SpringForceField::SpringForceField(const ParticlePtr p1, const ParticlePtr p2, f
 {}
 
 void SpringForceField::do_addForce()
+{
+    glm::vec3 force = computeForce();
+    m_p1->incrForce(-force);
+    m_p2->incrForce(force);
+}
+
+glm::vec3 SpringForceField::computeForce() const
 {
     //Implement a damped spring
     //Functions to use:
@@ -35,12 +45,40 @@ void SpringForceField::do_addForce()
         glm::vec3 velocity = m_p2->getVelocity() - m_p1->getVelocity();
         float dampingForce = m_damping * glm::dot(velocity, dir);
         force -= dampingForce*dir;
-        
-        m_p1->incrForce(-force);
-        m_p2->incrForce(force);
+        return force;
     }
-    
+    return glm::vec3(0.0,0.0,0.0);
+}
+
+void SpringForceField::do_addForceDifferential(const ParticleStore& store,
+                                               const std::vector<glm::vec3>& dx,
+                                               const std::vector<glm::vec3>& dv,
+                                               std::vector<glm::vec3>& df)
+{
+    if(m_p1->getStore().get() != &store || m_p2->getStore().get() != &store)
+        return;
+    const unsigned int i1 = m_p1->getIndex(), i2 = m_p2->getIndex();
+    glm::vec3 dForce = computeForceDifferential(dx[i2]-dx[i1], dv[i2]-dv[i1]);
+    df[i1] -= dForce;
+    df[i2] += dForce;
+}
+
+glm::vec3 SpringForceField::computeForceDifferential(const glm::vec3& dx, const glm::vec3& dv) const
+{
+    glm::vec3 dir = m_p2->getPosition() - m_p1->getPosition();
+    float len = glm::length(dir);
+    if(len <= std::numeric_limits<float>::epsilon())
+        return glm::vec3(0.0,0.0,0.0);
+    dir = dir/len;
+
+    //Stiffness: -k*(dir*dir^T + (1-l0/l)*(I-dir*dir^T))
+    float alongDx = glm::dot(dir, dx);
+    float transverse = std::max(0.0f, 1.0f - m_equilibriumLength/len);
+    glm::vec3 dForce = -m_stiffness * (alongDx*dir + transverse*(dx - alongDx*dir));
 
+    //Damping: -c*dir*dir^T, the variation of dir being neglected
+    dForce -= m_damping * glm::dot(dir, dv) * dir;
+    return dForce;
 }
 
 ParticlePtr SpringForceField::getParticle1() const
@@ -28,4 +28,9 @@ void SpringForceFieldRenderable::do_draw()
     glLineWidth(3.0);
     MeshRenderable::do_draw();
     glLineWidth(1.0);
-}
\ No newline at end of file
+}
+
+bool SpringForceFieldRenderable::do_isInstanceable() const
+{
+    return false;
+}
@@ -5,41 +5,135 @@
 #include <glm/gtc/type_ptr.hpp>
 #include <GL/glew.h>
 
+// Names of the uniforms and attributes, resolved once per shader program
+static const ShaderProgram::Handle position_handle( "vPosition" );
+static const ShaderProgram::Handle model_handle( "modelMat" );
+static const ShaderProgram::Handle nit_handle( "NIT" );
+static const ShaderProgram::Handle color_handle( "vColor" );
+static const ShaderProgram::Handle normal_handle( "vNormal" );
+
 SpringListRenderable::~SpringListRenderable()
 {}
 
 SpringListRenderable::SpringListRenderable(ShaderProgramPtr shaderProgram, std::list<SpringForceFieldPtr>& springForceFields) :
-    MeshRenderable(shaderProgram, false),
-    m_springForceFields(springForceFields)
+    MeshRenderable(shaderProgram, false)
+{
+    for (const SpringForceFieldPtr & spring : springForceFields)
+        m_springs.push_back(std::make_pair(spring->getParticle1(), spring->getParticle2()));
+    initialize_springs();
+}
+
+SpringListRenderable::SpringListRenderable(ShaderProgramPtr shaderProgram, std::list<DistanceConstraintPtr>& distanceConstraints) :
+    MeshRenderable(shaderProgram, false)
+{
+    for (const DistanceConstraintPtr & constraint : distanceConstraints)
+        m_springs.push_back(std::make_pair(constraint->getParticle1(), constraint->getParticle2()));
+    initialize_springs();
+}
+
+void SpringListRenderable::initialize_springs()
 {
     m_mode = GL_LINES;
     //Create geometric data
-    size_t springNumber =  m_springForceFields.size();
-    m_positions.resize(2*springNumber);
+    //The positions are streamed at each frame, see update_spring_positions()
+    size_t springNumber =  m_springs.size();
     m_colors.resize(2*springNumber, glm::vec4(0.0,0.0,1.0,1.0));
     m_normals.resize(2*springNumber, glm::vec3(1.0,1.0,1.0));
 
-    update_spring_positions();
-
     update_all_buffers();
 }
 
+void SpringListRenderable::setInterpolation(const DynamicSystemRenderablePtr& system){
+    m_interpolation = system;
+}
+
 void SpringListRenderable::update_spring_positions(){
+    //Write straight into the buffer memory, no intermediate array nor reallocation
+    glm::vec3* positions = static_cast<glm::vec3*>(m_springPositions.map(2*m_springs.size()*sizeof(glm::vec3)));
+    DynamicSystemRenderablePtr interpolation = m_interpolation.lock();
     size_t i = 0;
-    for (const SpringForceFieldPtr & spring : m_springForceFields){
-        m_positions[2*i+0] = spring->getParticle1()->getPosition();
-        m_positions[2*i+1] = spring->getParticle2()->getPosition();
+    for (const std::pair<ParticlePtr, ParticlePtr> & spring : m_springs){
+        if (interpolation) {
+            positions[2*i+0] = interpolation->getInterpolatedPosition(spring.first);
+            positions[2*i+1] = interpolation->getInterpolatedPosition(spring.second);
+        } else {
+            positions[2*i+0] = spring.first->getPosition();
+            positions[2*i+1] = spring.second->getPosition();
+        }
         ++i;
     }
+    m_springPositions.unmap();
 }
 
+// The implementation does not use MeshRenderable::do_draw because the
+// positions are read from the streamed buffer
 void SpringListRenderable::do_draw()
 {
     //Update vertices positions from particle's positions
     update_spring_positions();
-    update_positions_buffer();
+
+    int positionLocation = m_shaderProgram->getAttributeLocation(position_handle);
+    int modelLocation = m_shaderProgram->getUniformLocation(model_handle);
+    int nitLocation = m_shaderProgram->getUniformLocation(nit_handle);
+
+    if(modelLocation != ShaderProgram::null_location)
+        glcheck(glUniformMatrix4fv(modelLocation, 1, GL_FALSE, glm::value_ptr(getModelMatrix())));
+
+    if( nitLocation != ShaderProgram::null_location )
+    {
+        glcheck(glUniformMatrix3fv( nitLocation, 1, GL_FALSE,
+        glm::value_ptr(getNormalMatrix())));
+    }
+
+    if (m_vertexArray.bind(*m_shaderProgram))
+        set_vertex_attributes();
+
+    //The positions of this frame are somewhere else in the stream buffer
+    if(positionLocation != ShaderProgram::null_location)
+    {
+        glcheck(glBindBuffer(GL_ARRAY_BUFFER, m_springPositions.getBuffer()));
+        glcheck(glVertexAttribPointer(positionLocation, 3, GL_FLOAT, GL_FALSE, 0, (void*)m_springPositions.getOffset()));
+    }
 
     glLineWidth(3.0);
-    MeshRenderable::do_draw();
+    glcheck(glDrawArrays(GL_LINES, 0, 2*m_springs.size()));
     glLineWidth(1.0);
+    m_springPositions.fence();
+
+    VertexArray::unbind();
+}
+
+void SpringListRenderable::set_vertex_attributes()
+{
+    int positionLocation = m_shaderProgram->getAttributeLocation(position_handle);
+    int colorLocation = m_shaderProgram->getAttributeLocation(color_handle);
+    int normalLocation = m_shaderProgram->getAttributeLocation(normal_handle);
+
+    //The position buffer and offset are set at each frame by do_draw()
+    if(positionLocation != ShaderProgram::null_location)
+        glcheck(glEnableVertexAttribArray(positionLocation));
+
+    if(colorLocation != ShaderProgram::null_location)
+    {
+        glcheck(glEnableVertexAttribArray(colorLocation));
+        glcheck(glBindBuffer(GL_ARRAY_BUFFER, m_cBuffer));
+        glcheck(glVertexAttribPointer(colorLocation, 4, GL_FLOAT, GL_FALSE, 0, (void*)0));
+    }
+
+    if(normalLocation != ShaderProgram::null_location)
+    {
+        glcheck(glEnableVertexAttribArray(normalLocation));
+        glcheck(glBindBuffer(GL_ARRAY_BUFFER, m_nBuffer));
+        glcheck(glVertexAttribPointer(normalLocation, 3, GL_FLOAT, GL_FALSE, 0, (void*)0));
+    }
+}
+
+BoundingBox SpringListRenderable::do_getLocalBounds() const
+{
+    return BoundingBox::infinite();
+}
+
+bool SpringListRenderable::do_isInstanceable() const
+{
+    return false;
 }
@@ -0,0 +1,64 @@
+#include "./../../include/dynamics/SweepAndPruneBroadPhase.hpp"
+
+#include <algorithm>
+
+SweepAndPruneBroadPhase::SweepAndPruneBroadPhase()
+{}
+
+SweepAndPruneBroadPhase::~SweepAndPruneBroadPhase()
+{}
+
+void SweepAndPruneBroadPhase::do_computePairs(const std::vector<glm::vec3>& positions,
+                                              const std::vector<float>& radii,
+                                              const std::vector<unsigned char>& flags,
+                                              std::vector<CandidatePair>& pairs)
+{
+    const unsigned int n = positions.size();
+    if(n < 2) return;
+
+    m_lower.resize(n);
+    #pragma omp parallel for num_threads(getThreadCount()) if(getThreadCount() > 1)
+    for(unsigned int i=0; i<n; ++i)
+        m_lower[i] = positions[i].x - radii[i];
+
+    if(m_order.size() != n)
+    {
+        //The particles changed: sort from scratch
+        m_order.resize(n);
+        for(unsigned int i=0; i<n; ++i)
+            m_order[i] = i;
+        std::sort(m_order.begin(), m_order.end(),
+                  [this](unsigned int a, unsigned int b){ return m_lower[a] < m_lower[b]; });
+    }
+    else
+    {
+        //Insertion sort: the order of the previous step is nearly sorted
+        for(unsigned int k=1; k<n; ++k)
+        {
+            unsigned int i = m_order[k];
+            unsigned int l = k;
+            while(l > 0 && m_lower[m_order[l-1]] > m_lower[i])
+            {
+                m_order[l] = m_order[l-1];
+                --l;
+            }
+            m_order[l] = i;
+        }
+    }
+
+    //Sweep along x
+    collectPairs(n, [&](unsigned int k, std::vector<CandidatePair>& particlePairs)
+    {
+        unsigned int i = m_order[k];
+        if(flags[i] & ParticleStore::RELEASED)
+            return;
+        float upper = positions[i].x + radii[i];
+        for(unsigned int l=k+1; l<n && m_lower[m_order[l]] <= upper; ++l)
+        {
+            unsigned int j = m_order[l];
+            if(!(flags[j] & ParticleStore::RELEASED)
+               && testBoundingBoxes(positions[i], radii[i], positions[j], radii[j]))
+                particlePairs.push_back(i < j ? CandidatePair(i,j) : CandidatePair(j,i));
+        }
+    }, pairs);
+}
@@ -0,0 +1,7 @@
+#include "./../../include/dynamics/SymplecticEulerSolver.hpp"
+
+SymplecticEulerSolver::SymplecticEulerSolver()
+{}
+
+SymplecticEulerSolver::~SymplecticEulerSolver()
+{}
@@ -0,0 +1,96 @@
+#include "./../../include/dynamics/UniformGridBroadPhase.hpp"
+
+#include <algorithm>
+
+UniformGridBroadPhase::UniformGridBroadPhase(float cellSize) :
+    m_cellSize(cellSize), m_tableMask(0)
+{}
+
+UniformGridBroadPhase::~UniformGridBroadPhase()
+{}
+
+float UniformGridBroadPhase::getCellSize() const
+{
+    return m_cellSize;
+}
+
+void UniformGridBroadPhase::setCellSize(float cellSize)
+{
+    m_cellSize = cellSize;
+}
+
+unsigned int UniformGridBroadPhase::hashCell(const glm::ivec3& cell) const
+{
+    //Large primes, from "Optimized Spatial Hashing for Collision Detection of
+    //Deformable Objects", Teschner et al. 2003
+    unsigned int h = (unsigned int)(cell.x) * 73856093u
+                   ^ (unsigned int)(cell.y) * 19349663u
+                   ^ (unsigned int)(cell.z) * 83492791u;
+    return h & m_tableMask;
+}
+
+void UniformGridBroadPhase::do_computePairs(const std::vector<glm::vec3>& positions,
+                                            const std::vector<float>& radii,
+                                            const std::vector<unsigned char>& flags,
+                                            std::vector<CandidatePair>& pairs)
+{
+    const unsigned int n = positions.size();
+    if(n < 2) return;
+
+    //Two colliding particles have to be in neighbor cells
+    float maxRadius = *std::max_element(radii.begin(), radii.end());
+    float cellSize = std::max(m_cellSize, 2.0f*maxRadius);
+    if(cellSize <= 0.0f) return;
+    const float invCellSize = 1.0f / cellSize;
+
+    //Hash table with about twice more entries than particles
+    unsigned int tableSize = 1;
+    while(tableSize < 2*n) tableSize <<= 1;
+    m_tableMask = tableSize - 1;
+
+    m_entryStart.assign(tableSize+1, 0);
+    m_sortedParticles.resize(n);
+    m_particleEntry.resize(n);
+
+    //Counting sort of the particles by hash table entry
+    #pragma omp parallel for num_threads(getThreadCount()) if(getThreadCount() > 1)
+    for(unsigned int i=0; i<n; ++i)
+    {
+        glm::ivec3 cell(glm::floor(positions[i]*invCellSize));
+        m_particleEntry[i] = hashCell(cell);
+    }
+    for(unsigned int i=0; i<n; ++i)
+        ++m_entryStart[m_particleEntry[i]];
+    for(unsigned int h=0; h<tableSize; ++h)
+        m_entryStart[h+1] += m_entryStart[h];
+    for(unsigned int i=n; i-->0; )
+        m_sortedParticles[--m_entryStart[m_particleEntry[i]]] = i;
+
+    //Test each particle against the particles of the 27 cells around it
+    collectPairs(n, [&](unsigned int i, std::vector<CandidatePair>& particlePairs)
+    {
+        if(flags[i] & ParticleStore::RELEASED)
+            return;
+        unsigned int visited[27];
+        glm::ivec3 cell(glm::floor(positions[i]*invCellSize));
+        unsigned int visitedNumber = 0;
+        for(int dx=-1; dx<=1; ++dx)
+        for(int dy=-1; dy<=1; ++dy)
+        for(int dz=-1; dz<=1; ++dz)
+        {
+            //Different cells can share the same entry: visit it only once
+            unsigned int h = hashCell(cell + glm::ivec3(dx,dy,dz));
+            if(std::find(visited, visited+visitedNumber, h) != visited+visitedNumber)
+                continue;
+            visited[visitedNumber++] = h;
+
+            for(unsigned int k=m_entryStart[h]; k<m_entryStart[h+1]; ++k)
+            {
+                unsigned int j = m_sortedParticles[k];
+                if(j > i && !(flags[j] & ParticleStore::RELEASED)
+                   && testBoundingBoxes(positions[i], radii[i], positions[j], radii[j]))
+                    particlePairs.push_back(CandidatePair(i,j));
+            }
+        }
+    }, pairs);
+}
@@ -0,0 +1,48 @@
+#include "./../../include/dynamics/VerletSolver.hpp"
+#include "./../../include/dynamics/DynamicSystem.hpp"
+
+VerletSolver::VerletSolver() :
+    m_dt(0.0f), m_version(0)
+{}
+
+VerletSolver::~VerletSolver()
+{}
+
+void VerletSolver::do_solve(const float& dt, DynamicSystem& system)
+{
+    ParticleStore& particles = *system.getStore();
+    glm::vec3* x = particles.getPositions().data();
+    glm::vec3* v = particles.getVelocities().data();
+    const glm::vec3* f = particles.getForces().data();
+    const float* m = particles.getMasses().data();
+    const unsigned char* fixed = particles.getFixed().data();
+    const unsigned int n = particles.size();
+
+    //The previous positions are outdated: deduce them from the velocities
+    bool restart = (m_previousPositions.size() != n || m_dt != dt
+                    || m_version != particles.getVersion());
+    if(restart)
+    {
+        m_previousPositions.resize(n);
+        m_positions.resize(n);
+        m_velocities.resize(n);
+        m_dt = dt;
+        m_version = particles.getVersion();
+    }
+
+    #pragma omp parallel for num_threads(getThreadCount()) if(getThreadCount() > 1)
+    for(unsigned int i=0; i<n; ++i)
+    {
+        if(fixed[i])
+            continue;
+        if(restart || x[i] != m_positions[i] || v[i] != m_velocities[i])
+            m_previousPositions[i] = x[i] - dt * v[i];
+
+        glm::vec3 position = 2.0f*x[i] - m_previousPositions[i] + dt*dt * f[i] / m[i];
+        m_previousPositions[i] = x[i];
+        v[i] = (position - x[i]) / dt;
+        x[i] = position;
+        m_positions[i] = x[i];
+        m_velocities[i] = v[i];
+    }
+}
@@ -0,0 +1,279 @@
+#include "./../../include/lighting/ClusteredLighting.hpp"
+#include "./../../include/gl_helper.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// Samplers of the texture buffers in the clustered shaders, see clustered.glsl
+static const ShaderProgram::Handle cluster_samplers[3] = {
+    ShaderProgram::Handle("clusterLights"),
+    ShaderProgram::Handle("clusterRanges"),
+    ShaderProgram::Handle("clusterIndices")
+};
+
+// Formats of the texels of the lights, the clusters and the indices
+static const GLenum texture_formats[3] = { GL_RGBA32F, GL_RG32UI, GL_R32UI };
+
+// Below this number of lights, the threads cost more than the assignment
+static const unsigned int parallel_light_number = 32;
+
+// A cut off never reached by the cosine of the angle to the spot direction
+static const float no_cut_off = -2.0f;
+
+ClusteredLighting::ClusteredLighting(unsigned int bindingPoint)
+    : m_block("Clusters", bindingPoint),
+      m_clusters(clusterNumberX * clusterNumberY * clusterNumberZ),
+      m_sliceIndices(clusterNumberZ)
+{
+    static_assert(sizeof(BlockData) == 48, "std140 layout of Clusters");
+    static_assert(sizeof(LightData) == 5 * 4 * sizeof(float), "5 RGBA texels per light");
+    static_assert(sizeof(glm::uvec2) == 2 * sizeof(unsigned int), "RG texels per cluster");
+    for(unsigned int i=0; i<3; ++i)
+        m_buffers[i] = m_textures[i] = 0;
+}
+
+ClusteredLighting::~ClusteredLighting()
+{
+    if(m_buffers[0])
+    {
+        glcheck(glDeleteTextures(3, m_textures));
+        glcheck(glDeleteBuffers(3, m_buffers));
+    }
+}
+
+float ClusteredLighting::getRange(float constant, float linear, float quadratic, float intensity)
+{
+    // intensity / (constant + linear d + quadratic d^2) = cutOffIntensity
+    const float k = intensity / cutOffIntensity - constant;
+    if(k <= 0)
+        return 0;
+    if(quadratic > 0)
+        return (-linear + std::sqrt(linear * linear + 4 * quadratic * k)) / (2 * quadratic);
+    if(linear > 0)
+        return k / linear;
+    return std::numeric_limits<float>::infinity();
+}
+
+bool ClusteredLighting::getScreenBounds(const glm::vec3 & center, float radius, const glm::mat4 & projection, float znear,
+                                        glm::vec2 & ndcMin, glm::vec2 & ndcMax)
+{
+    // The projection of the bounding box of the sphere contains the
+    // projection of the sphere, when the box is in front of the camera
+    if(-center.z - radius <= znear)
+        return false;
+    ndcMin = glm::vec2(std::numeric_limits<float>::max());
+    ndcMax = glm::vec2(-std::numeric_limits<float>::max());
+    for(int corner=0; corner<8; ++corner)
+    {
+        glm::vec3 offset((corner & 1) ? radius : -radius, (corner & 2) ? radius : -radius, (corner & 4) ? radius : -radius);
+        glm::vec4 clip = projection * glm::vec4(center + offset, 1.0f);
+        glm::vec2 ndc = glm::vec2(clip) / clip.w;
+        ndcMin = glm::min(ndcMin, ndc);
+        ndcMax = glm::max(ndcMax, ndc);
+    }
+    return true;
+}
+
+int ClusteredLighting::getSlice(float depth) const
+{
+    int slice = (int)std::floor(std::log(depth) * m_data.depth.x + m_data.depth.y);
+    return std::min(std::max(slice, 0), (int)clusterNumberZ - 1);
+}
+
+ClusteredLighting::ClusterRange ClusteredLighting::getClusterRange(const glm::vec3 & center, float radius,
+                                                                   const glm::mat4 & projection, float znear, float zfar) const
+{
+    ClusterRange range;
+    range.min = glm::ivec3(0);
+    range.max = glm::ivec3(clusterNumberX - 1, clusterNumberY - 1, clusterNumberZ - 1);
+    if(std::isinf(radius))
+        return range;
+
+    ClusterRange empty;
+    empty.min = glm::ivec3(0);
+    empty.max = glm::ivec3(-1);
+
+    // Depth slices, the camera looking towards -z
+    const float depth = -center.z;
+    if(depth + radius < znear || depth - radius > zfar || radius <= 0)
+        return empty;
+    range.min.z = getSlice(std::max(depth - radius, znear));
+    range.max.z = getSlice(std::min(depth + radius, zfar));
+
+    // Tiles
+    glm::vec2 ndcMin, ndcMax;
+    if(!getScreenBounds(center, radius, projection, znear, ndcMin, ndcMax))
+        return range;
+    if(ndcMax.x < -1 || ndcMax.y < -1 || ndcMin.x > 1 || ndcMin.y > 1)
+        return empty;
+
+    const glm::vec2 tiles(clusterNumberX, clusterNumberY);
+    glm::ivec2 tileMin = glm::ivec2(glm::floor((ndcMin * 0.5f + 0.5f) * tiles));
+    glm::ivec2 tileMax = glm::ivec2(glm::floor((ndcMax * 0.5f + 0.5f) * tiles));
+    range.min.x = std::max(tileMin.x, 0);
+    range.min.y = std::max(tileMin.y, 0);
+    range.max.x = std::min(tileMax.x, (int)clusterNumberX - 1);
+    range.max.y = std::min(tileMax.y, (int)clusterNumberY - 1);
+    return range;
+}
+
+void ClusteredLighting::update(const Camera & camera, unsigned int width, unsigned int height,
+                               const std::vector<PointLightPtr> & pointLights,
+                               const std::vector<SpotLightPtr> & spotLights)
+{
+    const float znear = camera.znear(), zfar = camera.zfar();
+    m_data.grid = glm::uvec4(clusterNumberX, clusterNumberY, clusterNumberZ, pointLights.size() + spotLights.size());
+    m_data.depth.x = clusterNumberZ / std::log(zfar / znear);
+    m_data.depth.y = -std::log(znear) * m_data.depth.x;
+    m_data.depth.z = m_data.depth.w = 0;
+    m_data.viewport = glm::vec4(width, height, 0, 0);
+
+    // Pack the lights
+    m_lights.resize(m_data.grid.w);
+    for(std::size_t i=0; i<pointLights.size(); ++i)
+    {
+        const PointLight & light = *pointLights[i];
+        LightData & data = m_lights[i];
+        data.position = light.position();
+        data.spotDirection = glm::vec3(0, 0, -1);
+        data.ambient = light.ambient();
+        data.diffuse = light.diffuse();
+        data.specular = light.specular();
+        data.constant = light.constant();
+        data.linear = light.linear();
+        data.quadratic = light.quadratic();
+        data.innerCutOff = no_cut_off;
+        data.outerCutOff = no_cut_off - 1;
+    }
+    for(std::size_t i=0; i<spotLights.size(); ++i)
+    {
+        const SpotLight & light = *spotLights[i];
+        LightData & data = m_lights[pointLights.size() + i];
+        data.position = light.position();
+        data.spotDirection = light.spotDirection();
+        data.ambient = light.ambient();
+        data.diffuse = light.diffuse();
+        data.specular = light.specular();
+        data.constant = light.constant();
+        data.linear = light.linear();
+        data.quadratic = light.quadratic();
+        data.innerCutOff = light.innerCutOff();
+        data.outerCutOff = light.outerCutOff();
+    }
+
+    // Clusters overlapped by each light
+    const int lightNumber = m_lights.size();
+    const glm::mat4 & view = camera.viewMatrix();
+    const glm::mat4 & projection = camera.projectionMatrix();
+    m_ranges.resize(lightNumber);
+    #pragma omp parallel for schedule(static) if(lightNumber >= (int)parallel_light_number)
+    for(int i=0; i<lightNumber; ++i)
+    {
+        const LightData & light = m_lights[i];
+        glm::vec3 color = light.ambient + light.diffuse + light.specular;
+        float intensity = std::max(color.r, std::max(color.g, color.b));
+        float radius = getRange(light.constant, light.linear, light.quadratic, intensity);
+        glm::vec3 center = glm::vec3(view * glm::vec4(light.position, 1.0f));
+        m_ranges[i] = getClusterRange(center, radius, projection, znear, zfar);
+    }
+
+    // Lights of each cluster, one depth slice per thread
+    #pragma omp parallel for schedule(dynamic) if(lightNumber >= (int)parallel_light_number)
+    for(int z=0; z<(int)clusterNumberZ; ++z)
+    {
+        std::vector<unsigned int> & indices = m_sliceIndices[z];
+        indices.clear();
+        std::vector<unsigned int> sliceLights;
+        for(int i=0; i<lightNumber; ++i)
+            if(m_ranges[i].min.z <= z && z <= m_ranges[i].max.z)
+                sliceLights.push_back(i);
+
+        for(int y=0; y<(int)clusterNumberY; ++y)
+            for(int x=0; x<(int)clusterNumberX; ++x)
+            {
+                unsigned int first = indices.size();
+                for(unsigned int i : sliceLights)
+                {
+                    const ClusterRange & range = m_ranges[i];
+                    if(range.min.x <= x && x <= range.max.x && range.min.y <= y && y <= range.max.y)
+                        indices.push_back(i);
+                }
+                m_clusters[x + clusterNumberX * (y + clusterNumberY * z)] = glm::uvec2(first, indices.size() - first);
+            }
+    }
+
+    // Concatenate the slices
+    m_indices.clear();
+    const unsigned int sliceClusterNumber = clusterNumberX * clusterNumberY;
+    for(unsigned int z=0; z<clusterNumberZ; ++z)
+    {
+        const unsigned int offset = m_indices.size();
+        for(unsigned int c=0; c<sliceClusterNumber; ++c)
+            m_clusters[z * sliceClusterNumber + c].x += offset;
+        m_indices.insert(m_indices.end(), m_sliceIndices[z].begin(), m_sliceIndices[z].end());
+    }
+
+    // Upload
+    if(!m_buffers[0])
+    {
+        glcheck(glGenBuffers(3, m_buffers));
+        glcheck(glGenTextures(3, m_textures));
+        for(unsigned int i=0; i<3; ++i)
+        {
+            upload(m_buffers[i], nullptr, 0);
+            glcheck(glBindTexture(GL_TEXTURE_BUFFER, m_textures[i]));
+            glcheck(glTexBuffer(GL_TEXTURE_BUFFER, texture_formats[i], m_buffers[i]));
+        }
+        glcheck(glBindTexture(GL_TEXTURE_BUFFER, 0));
+    }
+    upload(m_buffers[0], m_lights.data(), m_lights.size() * sizeof(LightData));
+    upload(m_buffers[1], m_clusters.data(), m_clusters.size() * sizeof(glm::uvec2));
+    upload(m_buffers[2], m_indices.data(), m_indices.size() * sizeof(unsigned int));
+    m_block.update(&m_data, sizeof(BlockData));
+    bind();
+}
+
+void ClusteredLighting::upload(unsigned int buffer, const void * data, std::size_t size)
+{
+    // Respecify the whole storage, as UniformBuffer does. A texture buffer
+    // cannot be empty: it keeps at least one texel.
+    glcheck(glBindBuffer(GL_TEXTURE_BUFFER, buffer));
+    glcheck(glBufferData(GL_TEXTURE_BUFFER, std::max<std::size_t>(size, 4 * sizeof(float)), nullptr, GL_STREAM_DRAW));
+    if(size)
+        glcheck(glBufferSubData(GL_TEXTURE_BUFFER, 0, size, data));
+    glcheck(glBindBuffer(GL_TEXTURE_BUFFER, 0));
+}
+
+void ClusteredLighting::bind() const
+{
+    if(!m_buffers[0])
+        return;
+    for(unsigned int i=0; i<3; ++i)
+    {
+        glcheck(glActiveTexture(GL_TEXTURE0 + firstTextureUnit + i));
+        glcheck(glBindTexture(GL_TEXTURE_BUFFER, m_textures[i]));
+    }
+    glcheck(glActiveTexture(GL_TEXTURE0));
+    m_block.bind();
+}
+
+void ClusteredLighting::setSamplers(const ShaderProgramPtr & program) const
+{
+    for(unsigned int i=0; i<3; ++i)
+    {
+        int location = program->getUniformLocation(cluster_samplers[i]);
+        if(location != ShaderProgram::null_location)
+            glcheck(glUniform1i(location, firstTextureUnit + i));
+    }
+}
+
+unsigned int ClusteredLighting::getLightNumber() const
+{
+    return m_lights.size();
+}
+
+unsigned int ClusteredLighting::getAssignmentNumber() const
+{
+    return m_indices.size();
+}
@@ -0,0 +1,239 @@
+#include "./../../include/lighting/DeferredShading.hpp"
+#include "./../../include/lighting/ClusteredLighting.hpp"
+#include "./../../include/gl_helper.hpp"
+#include "./../../include/log.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <glm/gtc/type_ptr.hpp>
+
+// Definition of the shader programs writing the G-buffer
+static const std::string deferred_define = "DEFERRED_SHADING";
+
+// Samplers of the G-buffer textures in deferredFragment.glsl, in the order of
+// the texture units and of the color attachments
+static const ShaderProgram::Handle gbuffer_samplers[DeferredShading::textureNumber] = {
+    ShaderProgram::Handle("gPosition"),
+    ShaderProgram::Handle("gNormal"),
+    ShaderProgram::Handle("gAmbient"),
+    ShaderProgram::Handle("gDiffuse"),
+    ShaderProgram::Handle("gSpecular"),
+    ShaderProgram::Handle("gDepth")
+};
+
+// Formats of the G-buffer textures. The position needs the precision of the
+// depth buffer, the normal a sign and the shininess more than 1.
+static const GLenum gbuffer_formats[DeferredShading::textureNumber] = {
+    GL_RGBA32F, GL_RGBA16F, GL_RGBA8, GL_RGBA8, GL_RGBA8, GL_DEPTH_COMPONENT24
+};
+
+static const ShaderProgram::Handle camera_position_handle("cameraPosition");
+
+// Fields of the light of the local lighting pass
+static const ShaderProgram::Handle light_position_handle("light.position");
+static const ShaderProgram::Handle light_direction_handle("light.spotDirection");
+static const ShaderProgram::Handle light_ambient_handle("light.ambient");
+static const ShaderProgram::Handle light_diffuse_handle("light.diffuse");
+static const ShaderProgram::Handle light_specular_handle("light.specular");
+static const ShaderProgram::Handle light_constant_handle("light.constant");
+static const ShaderProgram::Handle light_linear_handle("light.linear");
+static const ShaderProgram::Handle light_quadratic_handle("light.quadratic");
+static const ShaderProgram::Handle light_inner_handle("light.innerCutOff");
+static const ShaderProgram::Handle light_outer_handle("light.outerCutOff");
+
+// A cut off never reached by the cosine of the angle to the spot direction
+static const float no_cut_off = -2.0f;
+
+DeferredShading::DeferredShading()
+    : m_framebuffer(0), m_width(0), m_height(0), m_vertexArray(0), m_lightPassNumber(0)
+{
+    for(unsigned int i=0; i<textureNumber; ++i)
+        m_textures[i] = 0;
+}
+
+DeferredShading::~DeferredShading()
+{
+    if(m_framebuffer)
+    {
+        glcheck(glDeleteFramebuffers(1, &m_framebuffer));
+        glcheck(glDeleteTextures(textureNumber, m_textures));
+        glcheck(glDeleteVertexArrays(1, &m_vertexArray));
+    }
+}
+
+bool DeferredShading::isDeferred(const ShaderProgram & program)
+{
+    return program.getDefines().count(deferred_define) != 0;
+}
+
+void DeferredShading::create(unsigned int width, unsigned int height)
+{
+    if(!m_framebuffer)
+    {
+        glcheck(glGenFramebuffers(1, &m_framebuffer));
+        glcheck(glGenTextures(textureNumber, m_textures));
+        glcheck(glGenVertexArrays(1, &m_vertexArray));
+
+        ShaderProgram::Defines defines;
+        defines["DEFERRED_LIGHTING"] = "";
+        m_directionalProgram = ShaderProgram::getPermutation("../../sfmlGraphicsPipeline/shaders/deferredVertex.glsl",
+                                                             "../../sfmlGraphicsPipeline/shaders/deferredFragment.glsl", defines);
+        defines["LOCAL_LIGHT"] = "";
+        m_localProgram = ShaderProgram::getPermutation("../../sfmlGraphicsPipeline/shaders/deferredVertex.glsl",
+                                                       "../../sfmlGraphicsPipeline/shaders/deferredFragment.glsl", defines);
+    }
+
+    // The pixels are fetched one by one: no filtering
+    for(unsigned int i=0; i<textureNumber; ++i)
+    {
+        const bool depth = gbuffer_formats[i] == GL_DEPTH_COMPONENT24;
+        glcheck(glBindTexture(GL_TEXTURE_2D, m_textures[i]));
+        glcheck(glTexImage2D(GL_TEXTURE_2D, 0, gbuffer_formats[i], width, height, 0,
+                             depth ? GL_DEPTH_COMPONENT : GL_RGBA, depth ? GL_UNSIGNED_INT : GL_FLOAT, nullptr));
+        glcheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+        glcheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+    }
+    glcheck(glBindTexture(GL_TEXTURE_2D, 0));
+
+    GLenum drawBuffers[textureNumber - 1];
+    glcheck(glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer));
+    for(unsigned int i=0; i<textureNumber - 1; ++i)
+    {
+        drawBuffers[i] = GL_COLOR_ATTACHMENT0 + i;
+        glcheck(glFramebufferTexture2D(GL_FRAMEBUFFER, drawBuffers[i], GL_TEXTURE_2D, m_textures[i], 0));
+    }
+    glcheck(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, m_textures[textureNumber - 1], 0));
+    glcheck(glDrawBuffers(textureNumber - 1, drawBuffers));
+    if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        LOG(error, "the G-buffer is incomplete");
+
+    m_width = width;
+    m_height = height;
+}
+
+void DeferredShading::beginGeometryPass(unsigned int width, unsigned int height)
+{
+    if(width != m_width || height != m_height)
+        create(width, height);
+    else
+        glcheck(glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer));
+
+    // Cleared without changing the clear color of the viewer
+    const GLfloat zero[4] = { 0, 0, 0, 0 };
+    const GLfloat farthest = 1;
+    for(unsigned int i=0; i<textureNumber - 1; ++i)
+        glcheck(glClearBufferfv(GL_COLOR, i, zero));
+    glcheck(glClearBufferfv(GL_DEPTH, 0, &farthest));
+}
+
+void DeferredShading::setSamplers(const ShaderProgram & program, const glm::vec3 & cameraPosition) const
+{
+    for(unsigned int i=0; i<textureNumber; ++i)
+    {
+        int location = program.getUniformLocation(gbuffer_samplers[i]);
+        if(location != ShaderProgram::null_location)
+            glcheck(glUniform1i(location, i));
+    }
+    int location = program.getUniformLocation(camera_position_handle);
+    if(location != ShaderProgram::null_location)
+        glcheck(glUniform3fv(location, 1, glm::value_ptr(cameraPosition)));
+}
+
+void DeferredShading::shade(const Camera & camera, unsigned int framebuffer,
+                            const std::vector<PointLightPtr> & pointLights,
+                            const std::vector<SpotLightPtr> & spotLights)
+{
+    glcheck(glBindFramebuffer(GL_FRAMEBUFFER, framebuffer));
+    for(unsigned int i=0; i<textureNumber; ++i)
+    {
+        glcheck(glActiveTexture(GL_TEXTURE0 + i));
+        glcheck(glBindTexture(GL_TEXTURE_2D, m_textures[i]));
+    }
+    glcheck(glBindVertexArray(m_vertexArray));
+    const glm::vec3 cameraPosition = camera.getPosition();
+
+    // The directional lights over the whole screen. The fragments keep the
+    // depth of the G-buffer, whatever the depth already there.
+    glcheck(glDepthFunc(GL_ALWAYS));
+    m_directionalProgram->bind();
+    setSamplers(*m_directionalProgram, cameraPosition);
+    glcheck(glDrawArrays(GL_TRIANGLES, 0, 3));
+    glcheck(glDepthFunc(GL_LESS));
+
+    // The point and spot lights, added
+    m_lightPassNumber = 0;
+    glcheck(glDisable(GL_DEPTH_TEST));
+    glcheck(glDepthMask(GL_FALSE));
+    glcheck(glEnable(GL_BLEND));
+    glcheck(glBlendFunc(GL_ONE, GL_ONE));
+    glcheck(glEnable(GL_SCISSOR_TEST));
+    m_localProgram->bind();
+    setSamplers(*m_localProgram, cameraPosition);
+    for(const PointLightPtr & light : pointLights)
+        drawLight(camera, light->position(), glm::vec3(0, 0, -1), *light,
+                  light->constant(), light->linear(), light->quadratic(), no_cut_off, no_cut_off - 1);
+    for(const SpotLightPtr & light : spotLights)
+        drawLight(camera, light->position(), light->spotDirection(), *light,
+                  light->constant(), light->linear(), light->quadratic(), light->innerCutOff(), light->outerCutOff());
+    glcheck(glDisable(GL_SCISSOR_TEST));
+    glcheck(glBlendFunc(GL_ONE, GL_ZERO));
+    glcheck(glDisable(GL_BLEND));
+    glcheck(glDepthMask(GL_TRUE));
+    glcheck(glEnable(GL_DEPTH_TEST));
+
+    ShaderProgram::unbind();
+    glcheck(glBindVertexArray(0));
+    for(unsigned int i=0; i<textureNumber; ++i)
+    {
+        glcheck(glActiveTexture(GL_TEXTURE0 + i));
+        glcheck(glBindTexture(GL_TEXTURE_2D, 0));
+    }
+    glcheck(glActiveTexture(GL_TEXTURE0));
+}
+
+void DeferredShading::drawLight(const Camera & camera, const glm::vec3 & position, const glm::vec3 & spotDirection,
+                                const Light & light, float constant, float linear, float quadratic,
+                                float innerCutOff, float outerCutOff)
+{
+    // Rectangle of the screen reached by the light
+    glm::vec3 color = light.ambient() + light.diffuse() + light.specular();
+    float radius = ClusteredLighting::getRange(constant, linear, quadratic, std::max(color.r, std::max(color.g, color.b)));
+    if(radius <= 0)
+        return;
+    glm::ivec2 pixelMin(0), pixelMax(m_width, m_height);
+    if(!std::isinf(radius))
+    {
+        glm::vec3 center = glm::vec3(camera.viewMatrix() * glm::vec4(position, 1.0f));
+        if(-center.z + radius < camera.znear() || -center.z - radius > camera.zfar())
+            return;
+        glm::vec2 ndcMin, ndcMax;
+        if(ClusteredLighting::getScreenBounds(center, radius, camera.projectionMatrix(), camera.znear(), ndcMin, ndcMax))
+        {
+            const glm::vec2 size(m_width, m_height);
+            pixelMin = glm::max(pixelMin, glm::ivec2(glm::floor((ndcMin * 0.5f + 0.5f) * size)));
+            pixelMax = glm::min(pixelMax, glm::ivec2(glm::ceil((ndcMax * 0.5f + 0.5f) * size)));
+        }
+    }
+    if(pixelMin.x >= pixelMax.x || pixelMin.y >= pixelMax.y)
+        return;
+    glcheck(glScissor(pixelMin.x, pixelMin.y, pixelMax.x - pixelMin.x, pixelMax.y - pixelMin.y));
+
+    const ShaderProgram & program = *m_localProgram;
+    glcheck(glUniform3fv(program.getUniformLocation(light_position_handle), 1, glm::value_ptr(position)));
+    glcheck(glUniform3fv(program.getUniformLocation(light_direction_handle), 1, glm::value_ptr(spotDirection)));
+    glcheck(glUniform3fv(program.getUniformLocation(light_ambient_handle), 1, glm::value_ptr(light.ambient())));
+    glcheck(glUniform3fv(program.getUniformLocation(light_diffuse_handle), 1, glm::value_ptr(light.diffuse())));
+    glcheck(glUniform3fv(program.getUniformLocation(light_specular_handle), 1, glm::value_ptr(light.specular())));
+    glcheck(glUniform1f(program.getUniformLocation(light_constant_handle), constant));
+    glcheck(glUniform1f(program.getUniformLocation(light_linear_handle), linear));
+    glcheck(glUniform1f(program.getUniformLocation(light_quadratic_handle), quadratic));
+    glcheck(glUniform1f(program.getUniformLocation(light_inner_handle), innerCutOff));
+    glcheck(glUniform1f(program.getUniformLocation(light_outer_handle), outerCutOff));
+    glcheck(glDrawArrays(GL_TRIANGLES, 0, 3));
+    ++m_lightPassNumber;
+}
+
+unsigned int DeferredShading::getLightPassNumber() const
+{
+    return m_lightPassNumber;
+}
@@ -0,0 +1,68 @@
+#include "./../../include/lighting/LightBlock.hpp"
+
+#include <algorithm>
+#include <cstddef>
+
+LightBlock::LightBlock(unsigned int bindingPoint)
+    : m_data(), m_buffer("Lights", bindingPoint)
+{
+    // Offsets of the std140 layout of the block in the shaders
+    static_assert(sizeof(DirectionalLightData) == 64, "std140 layout of DirectionalLight");
+    static_assert(sizeof(PointLightData) == 80, "std140 layout of PointLight");
+    static_assert(sizeof(SpotLightData) == 96, "std140 layout of SpotLight");
+    static_assert(offsetof(Data, pointLight) == 640, "std140 layout of Lights");
+    static_assert(offsetof(Data, spotLight) == 1440, "std140 layout of Lights");
+    static_assert(offsetof(Data, numberOfDirectionalLight) == 2400, "std140 layout of Lights");
+
+    // m_data is value-initialized, i.e. zeroed: the unused lights and the
+    // paddings are compared when checking for changes
+}
+
+void LightBlock::update(const std::vector<DirectionalLightPtr> & directionalLights,
+                        const std::vector<PointLightPtr> & pointLights,
+                        const std::vector<SpotLightPtr> & spotLights)
+{
+    m_data.numberOfDirectionalLight = std::min<std::size_t>(directionalLights.size(), maxLightNumber);
+    for(int i=0; i<m_data.numberOfDirectionalLight; ++i)
+    {
+        const DirectionalLight & light = *directionalLights[i];
+        DirectionalLightData & data = m_data.directionalLight[i];
+        data.direction = light.direction();
+        data.ambient = light.ambient();
+        data.diffuse = light.diffuse();
+        data.specular = light.specular();
+    }
+
+    m_data.numberOfPointLight = std::min<std::size_t>(pointLights.size(), maxLightNumber);
+    for(int i=0; i<m_data.numberOfPointLight; ++i)
+    {
+        const PointLight & light = *pointLights[i];
+        PointLightData & data = m_data.pointLight[i];
+        data.position = light.position();
+        data.ambient = light.ambient();
+        data.diffuse = light.diffuse();
+        data.specular = light.specular();
+        data.constant = light.constant();
+        data.linear = light.linear();
+        data.quadratic = light.quadratic();
+    }
+
+    m_data.numberOfSpotLight = std::min<std::size_t>(spotLights.size(), maxLightNumber);
+    for(int i=0; i<m_data.numberOfSpotLight; ++i)
+    {
+        const SpotLight & light = *spotLights[i];
+        SpotLightData & data = m_data.spotLight[i];
+        data.position = light.position();
+        data.spotDirection = light.spotDirection();
+        data.ambient = light.ambient();
+        data.diffuse = light.diffuse();
+        data.specular = light.specular();
+        data.constant = light.constant();
+        data.linear = light.linear();
+        data.quadratic = light.quadratic();
+        data.innerCutOff = light.innerCutOff();
+        data.outerCutOff = light.outerCutOff();
+    }
+
+    m_buffer.update(&m_data, sizeof(Data));
+}
@@ -47,6 +47,13 @@ void LightedMeshRenderable::do_draw()
     MeshRenderable::do_draw();
 }
 
+void LightedMeshRenderable::do_drawInstances(unsigned int buffer, std::size_t offset, unsigned int instanceNumber)
+{
+    //The instances share the material
+    Material::sendToGPU(m_shaderProgram, m_material);
+    MeshRenderable::do_drawInstances(buffer, offset, instanceNumber);
+}
+
 const MaterialPtr & LightedMeshRenderable::getMaterial() const
 {
     return m_material;
@@ -56,3 +63,8 @@ void LightedMeshRenderable::setMaterial(const MaterialPtr & mat)
 {
     m_material = mat;
 }
+
+const void* LightedMeshRenderable::do_getMaterialKey() const
+{
+    return m_material.get();
+}
@@ -1,6 +1,12 @@
 #include "./../../include/lighting/Material.hpp"
 #include <glm/gtc/type_ptr.hpp>
 
+// Names of the uniforms and attributes, resolved once per shader program
+static const ShaderProgram::Handle material_ambient_handle( "material.ambient" );
+static const ShaderProgram::Handle material_diffuse_handle( "material.diffuse" );
+static const ShaderProgram::Handle material_specular_handle( "material.specular" );
+static const ShaderProgram::Handle material_shininess_handle( "material.shininess" );
+
 Material::~Material()
 {}
 
@@ -78,7 +84,7 @@ bool Material::sendToGPU(const ShaderProgramPtr& program, const MaterialPtr &mat
         return false;
     }
 
-    location = program->getUniformLocation("material.ambient");
+    location = program->getUniformLocation(material_ambient_handle);
     if(location!=ShaderProgram::null_location)
     {
         glcheck(glUniform3fv(location, 1, glm::value_ptr(material->ambient())));
@@ -88,7 +94,7 @@ bool Material::sendToGPU(const ShaderProgramPtr& program, const MaterialPtr &mat
         success = false;
     }
 
-    location = program->getUniformLocation("material.diffuse");
+    location = program->getUniformLocation(material_diffuse_handle);
     if(location!=ShaderProgram::null_location)
     {
         glcheck(glUniform3fv(location, 1, glm::value_ptr(material->diffuse())));
@@ -98,7 +104,7 @@ bool Material::sendToGPU(const ShaderProgramPtr& program, const MaterialPtr &mat
         success = false;
     }
 
-    location = program->getUniformLocation("material.specular");
+    location = program->getUniformLocation(material_specular_handle);
     if(location!=ShaderProgram::null_location)
     {
         glcheck(glUniform3fv(location, 1, glm::value_ptr(material->specular())));
@@ -108,7 +114,7 @@ bool Material::sendToGPU(const ShaderProgramPtr& program, const MaterialPtr &mat
         success = false;
     }
 
-    location = program->getUniformLocation("material.shininess");
+    location = program->getUniformLocation(material_shininess_handle);
     if(location!=ShaderProgram::null_location)
     {
         // Just a small hack for pow(0,0) = NaN on NVidia hardware
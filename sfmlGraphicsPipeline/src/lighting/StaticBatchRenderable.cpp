@@ -0,0 +1,245 @@
+#include "./../../include/lighting/StaticBatchRenderable.hpp"
+#include "./../../include/gl_helper.hpp"
+#include "./../../include/log.hpp"
+#include "./../../include/Io.hpp"
+#include "./../../include/Viewer.hpp"
+
+#include <glm/gtc/type_ptr.hpp>
+#include <unordered_map>
+
+// Names of the uniforms and attributes, resolved once per shader program
+static const ShaderProgram::Handle model_handle( "modelMat" );
+static const ShaderProgram::Handle nit_handle( "NIT" );
+static const ShaderProgram::Handle position_handle( "vPosition" );
+static const ShaderProgram::Handle color_handle( "vColor" );
+static const ShaderProgram::Handle normal_handle( "vNormal" );
+
+StaticBatchRenderable::~StaticBatchRenderable()
+{
+    glcheck(glDeleteBuffers(1, &m_pBuffer));
+    glcheck(glDeleteBuffers(1, &m_nBuffer));
+    glcheck(glDeleteBuffers(1, &m_cBuffer));
+    glcheck(glDeleteBuffers(1, &m_iBuffer));
+}
+
+StaticBatchRenderable::StaticBatchRenderable(ShaderProgramPtr program) :
+    KeyframedHierarchicalRenderable(program),
+    m_built(false), m_pBuffer(0), m_nBuffer(0), m_cBuffer(0), m_iBuffer(0),
+    m_drawnMeshNumber(0)
+{
+    glcheck(glGenBuffers(1, &m_pBuffer));
+    glcheck(glGenBuffers(1, &m_nBuffer));
+    glcheck(glGenBuffers(1, &m_cBuffer));
+    glcheck(glGenBuffers(1, &m_iBuffer));
+}
+
+void StaticBatchRenderable::addMesh(const std::vector< glm::vec3 > & positions,
+                                    const std::vector< unsigned int > & indices,
+                                    const std::vector< glm::vec3 > & normals,
+                                    const std::vector< glm::vec4 > & colors,
+                                    const MaterialPtr & material,
+                                    const glm::mat4 & transform)
+{
+    //The meshes are placed in the object space of the batch once and for all
+    const unsigned int firstVertex = m_positions.size();
+    const glm::mat3 normalTransform = glm::transpose(glm::inverse(glm::mat3(transform)));
+    Mesh mesh;
+    mesh.material = material;
+    mesh.firstIndex = m_indices.size();
+    for(const glm::vec3 & position : positions)
+    {
+        m_positions.push_back(glm::vec3(transform * glm::vec4(position, 1.0f)));
+        mesh.bounds.extend(m_positions.back());
+    }
+    for(size_t i=0; i<positions.size(); ++i)
+    {
+        m_normals.push_back(i < normals.size() ? glm::normalize(normalTransform * normals[i]) : glm::vec3(0,0,1));
+        m_colors.push_back(i < colors.size() ? colors[i] : glm::vec4(1.0));
+    }
+
+    //The indices refer to the merged vertices
+    if(indices.empty())
+    {
+        for(unsigned int i=0; i<positions.size(); ++i)
+            m_indices.push_back(firstVertex + i);
+    }
+    else
+    {
+        for(unsigned int index : indices)
+            m_indices.push_back(firstVertex + index);
+    }
+    mesh.indexNumber = m_indices.size() - mesh.firstIndex;
+
+    m_localBounds.extend(mesh.bounds);
+    m_meshes.push_back(mesh);
+    m_built = false;
+}
+
+bool StaticBatchRenderable::addObj(const std::string & obj_path,
+                                   const std::string & mtl_basepath,
+                                   const glm::mat4 & transform)
+{
+    std::vector< std::vector< glm::vec3 > > all_positions;
+    std::vector< std::vector< glm::vec3 > > all_normals;
+    std::vector< std::vector< glm::vec2 > > all_texcoords;
+    std::vector< std::vector< unsigned int > > all_indices;
+    std::vector< MaterialPtr > materials;
+    if(!read_obj_with_materials_indexed(obj_path, mtl_basepath, all_positions, all_normals, all_texcoords, all_indices, materials))
+        return false;
+
+    const std::vector< glm::vec4 > colors;
+    for(size_t i=0; i<materials.size(); ++i)
+        addMesh(all_positions[i], all_indices[i], all_normals[i], colors, materials[i], transform);
+    return true;
+}
+
+void StaticBatchRenderable::build()
+{
+    //Group the meshes by material, in order of first appearance
+    std::unordered_map< const Material*, unsigned int > groupIndices;
+    m_groups.clear();
+    for(const Mesh & mesh : m_meshes)
+    {
+        auto inserted = groupIndices.insert(std::make_pair(mesh.material.get(), (unsigned int)m_groups.size()));
+        if(inserted.second)
+        {
+            Group group = { mesh.material, 0, 0 };
+            m_groups.push_back(group);
+        }
+        ++ m_groups[inserted.first->second].meshNumber;
+    }
+    for(size_t i=1; i<m_groups.size(); ++i)
+        m_groups[i].firstMesh = m_groups[i-1].firstMesh + m_groups[i-1].meshNumber;
+
+    //Reorder the meshes and their indices group by group
+    std::vector< Mesh > meshes(m_meshes.size());
+    std::vector< unsigned int > indices;
+    indices.reserve(m_indices.size());
+    std::vector< unsigned int > groupSizes(m_groups.size(), 0);
+    for(const Mesh & mesh : m_meshes)
+    {
+        const unsigned int group = groupIndices[mesh.material.get()];
+        Mesh & sorted = meshes[m_groups[group].firstMesh + groupSizes[group] ++];
+        sorted = mesh;
+    }
+    for(Mesh & mesh : meshes)
+    {
+        const unsigned int firstIndex = indices.size();
+        indices.insert(indices.end(), m_indices.begin() + mesh.firstIndex, m_indices.begin() + mesh.firstIndex + mesh.indexNumber);
+        mesh.firstIndex = firstIndex;
+    }
+    m_meshes.swap(meshes);
+    m_indices.swap(indices);
+
+    glcheck(glBindBuffer(GL_ARRAY_BUFFER, m_pBuffer));
+    glcheck(glBufferData(GL_ARRAY_BUFFER, m_positions.size()*sizeof(glm::vec3), m_positions.data(), GL_STATIC_DRAW));
+    glcheck(glBindBuffer(GL_ARRAY_BUFFER, m_nBuffer));
+    glcheck(glBufferData(GL_ARRAY_BUFFER, m_normals.size()*sizeof(glm::vec3), m_normals.data(), GL_STATIC_DRAW));
+    glcheck(glBindBuffer(GL_ARRAY_BUFFER, m_cBuffer));
+    glcheck(glBufferData(GL_ARRAY_BUFFER, m_colors.size()*sizeof(glm::vec4), m_colors.data(), GL_STATIC_DRAW));
+    glcheck(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_iBuffer));
+    glcheck(glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_indices.size()*sizeof(unsigned int), m_indices.data(), GL_STATIC_DRAW));
+    m_built = true;
+}
+
+void StaticBatchRenderable::do_draw()
+{
+    if(!m_built)
+        build();
+
+    int modelLocation = m_shaderProgram->getUniformLocation(model_handle);
+    int nitLocation = m_shaderProgram->getUniformLocation(nit_handle);
+    if(modelLocation != ShaderProgram::null_location)
+        glcheck(glUniformMatrix4fv(modelLocation, 1, GL_FALSE, glm::value_ptr(getModelMatrix())));
+    if(nitLocation != ShaderProgram::null_location)
+        glcheck(glUniformMatrix3fv(nitLocation, 1, GL_FALSE, glm::value_ptr(getNormalMatrix())));
+
+    if(m_vertexArray.bind(*m_shaderProgram))
+        set_vertex_attributes();
+
+    //The meshes out of the view are skipped, the visible ranges of a material
+    //are drawn together. Neighbor visible meshes make a single range.
+    const Frustum* frustum = (m_viewer && m_viewer->getFrustumCulling()) ? &m_viewer->getFrustum() : nullptr;
+    m_drawnMeshNumber = 0;
+    for(const Group & group : m_groups)
+    {
+        m_counts.clear();
+        m_offsets.clear();
+        unsigned int rangeEnd = 0;
+        for(unsigned int i=group.firstMesh; i<group.firstMesh+group.meshNumber; ++i)
+        {
+            const Mesh & mesh = m_meshes[i];
+            if(frustum && !frustum->intersects(mesh.bounds.transform(getModelMatrix())))
+                continue;
+            if(!m_counts.empty() && rangeEnd == mesh.firstIndex)
+                m_counts.back() += mesh.indexNumber;
+            else
+            {
+                m_counts.push_back(mesh.indexNumber);
+                m_offsets.push_back((const GLvoid*)(mesh.firstIndex * sizeof(unsigned int)));
+            }
+            rangeEnd = mesh.firstIndex + mesh.indexNumber;
+            ++ m_drawnMeshNumber;
+        }
+        if(m_counts.empty())
+            continue;
+
+        Material::sendToGPU(m_shaderProgram, group.material);
+        glcheck(glMultiDrawElements(GL_TRIANGLES, m_counts.data(), GL_UNSIGNED_INT, m_offsets.data(), m_counts.size()));
+    }
+
+    VertexArray::unbind();
+}
+
+void StaticBatchRenderable::set_vertex_attributes()
+{
+    int positionLocation = m_shaderProgram->getAttributeLocation(position_handle);
+    int colorLocation = m_shaderProgram->getAttributeLocation(color_handle);
+    int normalLocation = m_shaderProgram->getAttributeLocation(normal_handle);
+
+    if(positionLocation != ShaderProgram::null_location)
+    {
+        glcheck(glEnableVertexAttribArray(positionLocation));
+        glcheck(glBindBuffer(GL_ARRAY_BUFFER, m_pBuffer));
+        glcheck(glVertexAttribPointer(positionLocation, 3, GL_FLOAT, GL_FALSE, 0, (void*)0));
+    }
+
+    if(colorLocation != ShaderProgram::null_location)
+    {
+        glcheck(glEnableVertexAttribArray(colorLocation));
+        glcheck(glBindBuffer(GL_ARRAY_BUFFER, m_cBuffer));
+        glcheck(glVertexAttribPointer(colorLocation, 4, GL_FLOAT, GL_FALSE, 0, (void*)0));
+    }
+
+    if(normalLocation != ShaderProgram::null_location)
+    {
+        glcheck(glEnableVertexAttribArray(normalLocation));
+        glcheck(glBindBuffer(GL_ARRAY_BUFFER, m_nBuffer));
+        glcheck(glVertexAttribPointer(normalLocation, 3, GL_FLOAT, GL_FALSE, 0, (void*)0));
+    }
+
+    glcheck(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_iBuffer));
+}
+
+BoundingBox StaticBatchRenderable::do_getLocalBounds() const
+{
+    return m_localBounds;
+}
+
+unsigned int StaticBatchRenderable::getMeshNumber() const
+{
+    return m_meshes.size();
+}
+
+unsigned int StaticBatchRenderable::getMaterialNumber() const
+{
+    std::unordered_map< const Material*, bool > materials;
+    for(const Mesh & mesh : m_meshes)
+        materials[mesh.material.get()] = true;
+    return materials.size();
+}
+
+unsigned int StaticBatchRenderable::getDrawnMeshNumber() const
+{
+    return m_drawnMeshNumber;
+}
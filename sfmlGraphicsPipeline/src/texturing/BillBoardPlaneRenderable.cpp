@@ -8,6 +8,13 @@
 #include <SFML/Graphics/Image.hpp>
 #include <iostream>
 
+// Names of the uniforms and attributes, resolved once per shader program
+static const ShaderProgram::Handle texsampler_handle( "texSampler" );
+static const ShaderProgram::Handle billboard_position_handle( "billboard_world_position" );
+static const ShaderProgram::Handle billboard_dimensions_handle( "billboard_world_dimensions" );
+static const ShaderProgram::Handle color_handle( "vColor" );
+static const ShaderProgram::Handle shift_handle( "vShift" );
+
 BillBoardPlaneRenderable::~BillBoardPlaneRenderable()
 {
     glcheck(glDeleteBuffers(1, &m_cBuffer));
@@ -75,11 +82,9 @@ BillBoardPlaneRenderable::BillBoardPlaneRenderable(
 void BillBoardPlaneRenderable::do_draw()
 {
     //Location
-    int colorLocation = m_shaderProgram->getAttributeLocation("vColor");
-    int shiftLocation = m_shaderProgram->getAttributeLocation("vShift");
-    int texSampleLoc = m_shaderProgram->getUniformLocation("texSampler");
-    int billboardPositionLocation = m_shaderProgram->getUniformLocation("billboard_world_position");
-    int billboardDimensionsLocation = m_shaderProgram->getUniformLocation("billboard_world_dimensions");
+    int texSampleLoc = m_shaderProgram->getUniformLocation(texsampler_handle);
+    int billboardPositionLocation = m_shaderProgram->getUniformLocation(billboard_position_handle);
+    int billboardDimensionsLocation = m_shaderProgram->getUniformLocation(billboard_dimensions_handle);
 
     //Send material uniform to GPU
     Material::sendToGPU(m_shaderProgram, m_material);
@@ -93,38 +98,37 @@ void BillBoardPlaneRenderable::do_draw()
     {
         glcheck(glUniform2fv( billboardDimensionsLocation, 1, glm::value_ptr( m_billboardWorldDimension) ) );
     }
-    if(colorLocation != ShaderProgram::null_location)
+    //The attributes are only specified when the VAO of the program is built
+    if(m_vertexArray.bind(*m_shaderProgram))
     {
-        glcheck(glEnableVertexAttribArray(colorLocation));
-        glcheck(glBindBuffer(GL_ARRAY_BUFFER, m_cBuffer));
-        glcheck(glVertexAttribPointer(colorLocation, 4, GL_FLOAT, GL_FALSE, 0, (void*)0));
+        int colorLocation = m_shaderProgram->getAttributeLocation(color_handle);
+        int shiftLocation = m_shaderProgram->getAttributeLocation(shift_handle);
+        if(colorLocation != ShaderProgram::null_location)
+        {
+            glcheck(glEnableVertexAttribArray(colorLocation));
+            glcheck(glBindBuffer(GL_ARRAY_BUFFER, m_cBuffer));
+            glcheck(glVertexAttribPointer(colorLocation, 4, GL_FLOAT, GL_FALSE, 0, (void*)0));
+        }
+        if(shiftLocation != ShaderProgram::null_location)
+        {
+            glcheck(glEnableVertexAttribArray(shiftLocation));
+            glcheck(glBindBuffer(GL_ARRAY_BUFFER, m_tBuffer));
+            glcheck(glVertexAttribPointer(shiftLocation, 2, GL_FLOAT, GL_FALSE, 0, (void*)0));
+        }
     }
 
     //Bind texture in Textured Unit 0
-    if(shiftLocation != ShaderProgram::null_location)
-    {
-        glcheck(glActiveTexture(GL_TEXTURE0));
-        glcheck(glBindTexture(GL_TEXTURE_2D, m_texId));
-        //Send "texSampler" to Textured Unit 0
-        glcheck(glUniform1i(texSampleLoc, 0));
-        glcheck(glEnableVertexAttribArray(shiftLocation));
-        glcheck(glBindBuffer(GL_ARRAY_BUFFER, m_tBuffer));
-        glcheck(glVertexAttribPointer(shiftLocation, 2, GL_FLOAT, GL_FALSE, 0, (void*)0));
-    }
+    glcheck(glActiveTexture(GL_TEXTURE0));
+    glcheck(glBindTexture(GL_TEXTURE_2D, m_texId));
+    //Send "texSampler" to Textured Unit 0
+    glcheck(glUniform1i(texSampleLoc, 0));
 
     //Draw triangles elements
     glcheck(glDrawArrays(GL_TRIANGLES,0, 6));
 
-    //Release texture
+    //Release texture and vertex array object
     glcheck(glBindTexture(GL_TEXTURE_2D, 0));
-    if(colorLocation != ShaderProgram::null_location)
-    {
-        glcheck(glDisableVertexAttribArray(colorLocation));
-    }
-    if(shiftLocation != ShaderProgram::null_location)
-    {
-        glcheck(glDisableVertexAttribArray(shiftLocation));
-    }
+    VertexArray::unbind();
 }
 
 void BillBoardPlaneRenderable::do_animate(float time)
@@ -137,3 +141,13 @@ void BillBoardPlaneRenderable::setMaterial(const MaterialPtr& material)
 {
     m_material = material;
 }
+
+const void* BillBoardPlaneRenderable::do_getMaterialKey() const
+{
+    return m_material.get();
+}
+
+unsigned int BillBoardPlaneRenderable::do_getTextureKey() const
+{
+    return m_texId;
+}
@@ -8,6 +8,9 @@
 #include <SFML/Graphics/Image.hpp>
 #include <iostream>
 
+// Names of the uniforms and attributes, resolved once per shader program
+static const ShaderProgram::Handle cubemap_sampler_handle( "cubeMapSampler" );
+
 CubeMapRenderable::~CubeMapRenderable()
 {
     glcheck(glDeleteTextures(1, &m_texId));
@@ -70,7 +73,7 @@ void CubeMapRenderable::update_textures_buffer()
 void CubeMapRenderable::do_draw()
 {
     //Location
-    int cubeMapLocation = m_shaderProgram->getUniformLocation("cubeMapSampler");
+    int cubeMapLocation = m_shaderProgram->getUniformLocation(cubemap_sampler_handle);
     //Bind texture in Textured Unit 0
     if(cubeMapLocation != ShaderProgram::null_location)
     {
@@ -84,4 +87,19 @@ void CubeMapRenderable::do_draw()
 
     // Release texture
     glcheck(glBindTexture(GL_TEXTURE_CUBE_MAP, 0));
-}
\ No newline at end of file
+}
+
+unsigned int CubeMapRenderable::do_getTextureKey() const
+{
+    return m_texId;
+}
+
+BoundingBox CubeMapRenderable::do_getLocalBounds() const
+{
+    return BoundingBox::infinite();
+}
+
+bool CubeMapRenderable::do_isInstanceable() const
+{
+    return false;
+}
@@ -8,6 +8,10 @@
 #include <SFML/Graphics/Image.hpp>
 #include <iostream>
 
+// Names of the uniforms and attributes, resolved once per shader program
+static const ShaderProgram::Handle diffuse_sampler_handle( "diffuseSampler" );
+static const ShaderProgram::Handle specular_sampler_handle( "specularSampler" );
+
 EnvMapMeshRenderable::~EnvMapMeshRenderable()
 {
     glcheck(glDeleteTextures(1, &m_denvTexId));
@@ -81,8 +85,8 @@ void EnvMapMeshRenderable::update_textures_buffer()
 void EnvMapMeshRenderable::do_draw()
 {
     //Location
-    int denvmapLocation = m_shaderProgram->getUniformLocation("diffuseSampler");
-    int senvmapLocation = m_shaderProgram->getUniformLocation("specularSampler");
+    int denvmapLocation = m_shaderProgram->getUniformLocation(diffuse_sampler_handle);
+    int senvmapLocation = m_shaderProgram->getUniformLocation(specular_sampler_handle);
     //Bind texture in Textured Unit 0
     if(denvmapLocation != ShaderProgram::null_location)
     {
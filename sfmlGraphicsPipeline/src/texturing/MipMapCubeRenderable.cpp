@@ -8,6 +8,10 @@
 #include <SFML/Graphics/Image.hpp>
 #include <iostream>
 
+// Names of the uniforms and attributes, resolved once per shader program
+static const ShaderProgram::Handle texcoord_handle( "vTexCoord" );
+static const ShaderProgram::Handle texsampler_handle( "texSampler" );
+
 static const std::array<std::string, 4> filter_option_names = {
     "GL_LINEAR_MIPMAP_LINEAR",
     "GL_LINEAR_MIPMAP_NEAREST",
@@ -85,8 +89,8 @@ void MipMapCubeRenderable::update_tcoords_buffer(){
 void MipMapCubeRenderable::do_draw()
 {
     //Location
-    int texcoordLocation = m_shaderProgram->getAttributeLocation("vTexCoord");
-    int texsamplerLocation = m_shaderProgram->getUniformLocation("texSampler");
+    int texcoordLocation = m_shaderProgram->getAttributeLocation(texcoord_handle);
+    int texsamplerLocation = m_shaderProgram->getUniformLocation(texsampler_handle);
 
     //Bind texture in Textured Unit 0
     if(texcoordLocation != ShaderProgram::null_location)
@@ -95,17 +99,23 @@ void MipMapCubeRenderable::do_draw()
         glcheck(glBindTexture(GL_TEXTURE_2D, m_texId));
         //Send "texSampler" to Textured Unit 0
         glcheck(glUniform1i(texsamplerLocation, 0));
-        glcheck(glEnableVertexAttribArray(texcoordLocation));
-        glcheck(glBindBuffer(GL_ARRAY_BUFFER, m_tBuffer));
-        glcheck(glVertexAttribPointer(texcoordLocation, 2, GL_FLOAT, GL_FALSE, 0, (void*)0));
     }
 
     MeshRenderable::do_draw();
 
     glcheck(glBindTexture(GL_TEXTURE_2D, 0));
+}
+
+void MipMapCubeRenderable::set_vertex_attributes()
+{
+    MeshRenderable::set_vertex_attributes();
+
+    int texcoordLocation = m_shaderProgram->getAttributeLocation(texcoord_handle);
     if(texcoordLocation != ShaderProgram::null_location)
     {
-        glcheck(glDisableVertexAttribArray(texcoordLocation ));
+        glcheck(glEnableVertexAttribArray(texcoordLocation));
+        glcheck(glBindBuffer(GL_ARRAY_BUFFER, m_tBuffer));
+        glcheck(glVertexAttribPointer(texcoordLocation, 2, GL_FLOAT, GL_FALSE, 0, (void*)0));
     }
 }
 
@@ -157,3 +167,13 @@ void MipMapCubeRenderable::do_keyPressedEvent( sf::Event& e )
         updateTextureOption();
     }
 }
+
+unsigned int MipMapCubeRenderable::do_getTextureKey() const
+{
+    return m_texId;
+}
+
+bool MipMapCubeRenderable::do_isInstanceable() const
+{
+    return false;
+}
@@ -7,6 +7,11 @@
 #include <SFML/Graphics/Image.hpp>
 #include <iostream>
 
+// Names of the uniforms and attributes, resolved once per shader program
+static const ShaderProgram::Handle texsampler1_handle( "texSampler1" );
+static const ShaderProgram::Handle texsampler2_handle( "texSampler2" );
+static const ShaderProgram::Handle texcoord_handle( "vTexCoord" );
+
 MultiTexturedCubeRenderable::~MultiTexturedCubeRenderable()
 {
     glcheck(glDeleteBuffers(1, &m_tBuffer));
@@ -85,17 +90,10 @@ void MultiTexturedCubeRenderable::update_textures_buffer(){
 void MultiTexturedCubeRenderable::do_draw()
 {
     //Location
-    int tcoordsLocation = m_shaderProgram->getAttributeLocation("vTexCoord");
-    int texSampleLoc1 = m_shaderProgram->getUniformLocation("texSampler1");
-    int texSampleLoc2 = m_shaderProgram->getUniformLocation("texSampler2");
+    int texSampleLoc1 = m_shaderProgram->getUniformLocation(texsampler1_handle);
+    int texSampleLoc2 = m_shaderProgram->getUniformLocation(texsampler2_handle);
 
     //Bind texture in Textured Unit 0
-    if(tcoordsLocation != ShaderProgram::null_location)
-    {
-        glcheck(glEnableVertexAttribArray(tcoordsLocation));
-        glcheck(glBindBuffer(GL_ARRAY_BUFFER, m_tBuffer));
-        glcheck(glVertexAttribPointer(tcoordsLocation, 2, GL_FLOAT, GL_FALSE, 0, (void*)0));
-    }
     if(texSampleLoc1 != ShaderProgram::null_location){
         glcheck(glActiveTexture(GL_TEXTURE0));
         glcheck(glBindTexture(GL_TEXTURE_2D, m_texId1));
@@ -113,8 +111,27 @@ void MultiTexturedCubeRenderable::do_draw()
 
     //Release texture
     glcheck(glBindTexture(GL_TEXTURE_2D, 0));
+}
 
-    // Release tcoords
+void MultiTexturedCubeRenderable::set_vertex_attributes()
+{
+    MeshRenderable::set_vertex_attributes();
+
+    int tcoordsLocation = m_shaderProgram->getAttributeLocation(texcoord_handle);
     if(tcoordsLocation != ShaderProgram::null_location)
-        glcheck(glDisableVertexAttribArray(tcoordsLocation));
+    {
+        glcheck(glEnableVertexAttribArray(tcoordsLocation));
+        glcheck(glBindBuffer(GL_ARRAY_BUFFER, m_tBuffer));
+        glcheck(glVertexAttribPointer(tcoordsLocation, 2, GL_FLOAT, GL_FALSE, 0, (void*)0));
+    }
+}
+
+unsigned int MultiTexturedCubeRenderable::do_getTextureKey() const
+{
+    return m_texId1;
+}
+
+bool MultiTexturedCubeRenderable::do_isInstanceable() const
+{
+    return false;
 }
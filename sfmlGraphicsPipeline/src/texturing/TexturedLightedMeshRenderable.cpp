@@ -62,3 +62,8 @@ void TexturedLightedMeshRenderable::setMaterial(const MaterialPtr & mat)
 {
     m_material = mat;
 }
+
+const void* TexturedLightedMeshRenderable::do_getMaterialKey() const
+{
+    return m_material.get();
+}
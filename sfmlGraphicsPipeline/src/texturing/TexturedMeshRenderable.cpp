@@ -7,6 +7,10 @@
 #include <glm/gtc/type_ptr.hpp>
 #include <GL/glew.h>
 
+// Names of the uniforms and attributes, resolved once per shader program
+static const ShaderProgram::Handle texcoord_handle( "vTexCoord" );
+static const ShaderProgram::Handle texsampler_handle( "texSampler" );
+
 static const std::array<std::string, 5> wrap_option_names = {
     "GL_CLAMP_TO_EDGE with unchanged texture coordinates",
     "GL_REPEAT with a factor 10 on texture coordinates",
@@ -122,8 +126,8 @@ void TexturedMeshRenderable::update_tcoords_buffer(){
 void TexturedMeshRenderable::do_draw()
 {
     //Location
-    int texcoordLocation = m_shaderProgram->getAttributeLocation("vTexCoord");
-    int texsamplerLocation = m_shaderProgram->getUniformLocation("texSampler");
+    int texcoordLocation = m_shaderProgram->getAttributeLocation(texcoord_handle);
+    int texsamplerLocation = m_shaderProgram->getUniformLocation(texsampler_handle);
 
     //Bind texture in Textured Unit 0
     if(texcoordLocation != ShaderProgram::null_location)
@@ -132,18 +136,25 @@ void TexturedMeshRenderable::do_draw()
         glcheck(glBindTexture(GL_TEXTURE_2D, m_texId));
         //Send "texSampler" to Textured Unit 0
         glcheck(glUniform1i(texsamplerLocation, 0));
-        glcheck(glEnableVertexAttribArray(texcoordLocation));
-        glcheck(glBindBuffer(GL_ARRAY_BUFFER, m_tBuffer));
-        glcheck(glVertexAttribPointer(texcoordLocation, 2, GL_FLOAT, GL_FALSE, 0, (void*)0));
     }
 
     MeshRenderable::do_draw();
 
     // Release texture
     glcheck(glBindTexture(GL_TEXTURE_2D, 0));
-    // Release tcoord vertex attribute
+}
+
+void TexturedMeshRenderable::set_vertex_attributes()
+{
+    MeshRenderable::set_vertex_attributes();
+
+    int texcoordLocation = m_shaderProgram->getAttributeLocation(texcoord_handle);
     if(texcoordLocation != ShaderProgram::null_location)
-        glcheck(glDisableVertexAttribArray(texcoordLocation))
+    {
+        glcheck(glEnableVertexAttribArray(texcoordLocation));
+        glcheck(glBindBuffer(GL_ARRAY_BUFFER, m_tBuffer));
+        glcheck(glVertexAttribPointer(texcoordLocation, 2, GL_FLOAT, GL_FALSE, 0, (void*)0));
+    }
 }
 
 std::vector< glm::vec2 > & TexturedMeshRenderable::tcoords()
@@ -252,3 +263,13 @@ void TexturedMeshRenderable::do_keyPressedEvent( sf::Event& e )
 
     updateTextureOption();
 }
+
+unsigned int TexturedMeshRenderable::do_getTextureKey() const
+{
+    return m_texId;
+}
+
+bool TexturedMeshRenderable::do_isInstanceable() const
+{
+    return false;
+}